@@ -0,0 +1,1394 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* Throughput of the bit primitives, the message decoders and encoders and
+ * full stream framing and decoding, written as JSON to stdout.
+ *
+ *   librtcm_bench [--min-time-ms N] [--filter TEXT] [capture.rtcm ...]
+ *
+ * Each benchmark is run in batches of doubling size until a batch takes at
+ * least the minimum time, and the last batch is reported. Captures given on
+ * the command line are framed and decoded as a whole, in 1400 byte chunks. */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rtcm3/arena.h"
+#include "rtcm3/bits.h"
+#include "rtcm3/constants.h"
+#include "rtcm3/crc24q.h"
+#include "rtcm3/decode.h"
+#include "rtcm3/decode_frame.h"
+#include "rtcm3/encode.h"
+#include "rtcm3/eph_decode.h"
+#include "rtcm3/eph_encode.h"
+#include "rtcm3/epoch_encode.h"
+#include "rtcm3/framer.h"
+#include "rtcm3/messages.h"
+#include "rtcm3/msm_compact.h"
+#include "rtcm3/msm_utils.h"
+#include "rtcm3/ssr_decode.h"
+#include "rtcm3/sta_decode.h"
+#include "rtcm3/stats.h"
+
+#define DEFAULT_MIN_TIME_MS 200
+#define BITS_PER_OP 64 /* Fields read or written per bit benchmark op */
+#define STREAM_EPOCHS 100
+#define STREAM_CHUNK 1400 /* About one UDP datagram */
+#define SSR_BENCH_SATS 20
+#define SSR_BENCH_SIGNALS 3
+#define SSR_SPARSE_SIGNALS 0x0000FFFFu /* Keep signal ids 0 to 15 */
+#define STA_FW_VERSION "5.8.11"
+#define ARENA_SIZE (64 * 1024)
+
+typedef struct bench_case_s bench_case;
+
+struct bench_case_s {
+  const char *name;
+  /* Fills the payload (or stream) and the input message, may be NULL */
+  void (*prepare)(const bench_case *bench);
+  void (*run)(void);
+  uint16_t msg_num; /* Passed to prepare */
+  uint8_t num_sats; /* MSM only */
+  uint8_t num_sigs; /* MSM only */
+};
+
+/* Results are folded into this so the compiler keeps the calls */
+static volatile uint32_t sink;
+/* Set by a runner whose call failed, a benchmark of an error path is not
+ * what was asked for */
+static bool run_failed;
+
+/* The encoded message of the current benchmark */
+static uint8_t payload[RTCM3_MAX_MSG_LEN + 8];
+static uint16_t payload_len;
+/* Fields per op of the current benchmark, 1 for whole messages */
+static uint32_t items_per_op;
+
+static uint8_t scratch[RTCM3_MAX_MSG_LEN + 8];
+
+static rtcm_obs_message obs_in;
+static rtcm_msg_1005 msg_1005_in;
+static rtcm_msg_1006 msg_1006_in;
+static rtcm_msg_1007 msg_1007_in;
+static rtcm_msg_1008 msg_1008_in;
+static rtcm_msg_1013 msg_1013_in;
+static rtcm_msg_1029 msg_1029_in;
+static rtcm_msg_1033 msg_1033_in;
+static rtcm_msg_1230 msg_1230_in;
+static rtcm_msm_message msm_in;
+static rtcm_msg_eph eph_in;
+static rtcm_msg_swift_proprietary swift_in;
+static rtcm_msm_layout msm_layout;
+static rtcm_msm_obs epoch_obs[2 * MSM_MAX_CELLS];
+static rtcm_msm_epoch epoch_in;
+static uint8_t epoch_frames[2 * RTCM3_MAX_FRAME_LEN];
+static size_t epoch_len;
+
+/* Output of the decoders that write to caller-owned storage */
+static uint64_t arena_storage[ARENA_SIZE / sizeof(uint64_t)];
+static rtcm3_arena arena;
+static uint64_t compact_storage[sizeof(rtcm_msm_message) / sizeof(uint64_t)];
+static rtcm_msm_sat_data column_sats[RTCM_MAX_SATS];
+static uint8_t column_sat_index[MSM_MAX_CELLS];
+static uint8_t column_sig_index[MSM_MAX_CELLS];
+static double column_pseudorange_ms[MSM_MAX_CELLS];
+static double column_carrier_phase_ms[MSM_MAX_CELLS];
+static double column_range_rate_m_s[MSM_MAX_CELLS];
+static double column_cnr[MSM_MAX_CELLS];
+static double column_lock_time_s[MSM_MAX_CELLS];
+static rtcm_msg_ssr_code_bias_sig
+    sparse_code_signals[SSR_BENCH_SATS * SSR_BENCH_SIGNALS];
+static rtcm_msg_ssr_phase_bias_sig
+    sparse_phase_signals[SSR_BENCH_SATS * SSR_BENCH_SIGNALS];
+static rtcm3_stats stats;
+
+static uint8_t *stream;
+static size_t stream_len;
+static size_t stream_capacity;
+static rtcm3_framer framer;
+static rtcm3_any_msg any_msg;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void check_len(const char *what, uint16_t len) {
+  if (0 == len) {
+    fprintf(stderr, "librtcm_bench: failed to encode %s\n", what);
+    exit(EXIT_FAILURE);
+  }
+}
+
+/* Bit primitives, over a buffer of pseudo-random bytes */
+
+static void prepare_bits(const bench_case *bench) {
+  (void)bench;
+  uint32_t x = 12345;
+  for (size_t i = 0; i < sizeof(payload); i++) {
+    x = x * 1103515245u + 12345u;
+    payload[i] = (uint8_t)(x >> 16);
+  }
+  payload_len = RTCM3_MAX_MSG_LEN;
+  items_per_op = BITS_PER_OP;
+}
+
+/* Field positions advance by an odd number of bits so every alignment is
+ * covered */
+#define BIT_POS(i) (((i)*37u) % (8u * 1000u))
+
+static void run_getbitu(void) {
+  uint32_t acc = 0;
+  for (uint32_t i = 0; i < BITS_PER_OP; i++) {
+    acc += rtcm_getbitu(payload, BIT_POS(i), 22);
+  }
+  sink ^= acc;
+}
+
+static void run_getbits(void) {
+  int32_t acc = 0;
+  for (uint32_t i = 0; i < BITS_PER_OP; i++) {
+    acc += rtcm_getbits(payload, BIT_POS(i), 22);
+  }
+  sink ^= (uint32_t)acc;
+}
+
+static void run_getbitul(void) {
+  uint64_t acc = 0;
+  for (uint32_t i = 0; i < BITS_PER_OP; i++) {
+    acc += rtcm_getbitul(payload, BIT_POS(i), 38);
+  }
+  sink ^= (uint32_t)acc;
+}
+
+static void run_setbitu(void) {
+  for (uint32_t i = 0; i < BITS_PER_OP; i++) {
+    rtcm_setbitu(scratch, BIT_POS(i), 22, i);
+  }
+  sink ^= scratch[0];
+}
+
+static void run_bitreader(void) {
+  rtcm_bitreader reader;
+  rtcm_bitreader_init(&reader, payload, RTCM3_MAX_MSG_LEN);
+  uint32_t acc = 0;
+  for (uint32_t i = 0; i < BITS_PER_OP; i++) {
+    acc += rtcm_read_bitu(&reader, 22);
+  }
+  sink ^= acc;
+}
+
+static void run_bitwriter(void) {
+  rtcm_bitwriter writer;
+  rtcm_bitwriter_init(&writer, scratch, RTCM3_MAX_MSG_LEN, 0);
+  for (uint32_t i = 0; i < BITS_PER_OP; i++) {
+    rtcm_write_bitu(&writer, 22, i);
+  }
+  sink ^= rtcm_bitwriter_flush(&writer);
+}
+
+static void prepare_crc(const bench_case *bench) {
+  prepare_bits(bench);
+  items_per_op = 1;
+}
+
+static void run_crc24q(void) {
+  sink ^= rtcm3_crc24q(payload, RTCM3_MAX_MSG_LEN, 0);
+}
+
+static void run_crc24q_table(void) {
+  sink ^= rtcm3_crc24q_table(payload, RTCM3_MAX_MSG_LEN, 0);
+}
+
+static void run_decode_lock_time(void) {
+  double acc = 0;
+  for (uint32_t i = 0; i < BITS_PER_OP; i++) {
+    acc += rtcm3_decode_lock_time((uint8_t)i);
+  }
+  sink ^= (uint32_t)acc;
+}
+
+static void run_encode_lock_time(void) {
+  uint32_t acc = 0;
+  for (uint32_t i = 0; i < BITS_PER_OP; i++) {
+    acc += rtcm3_encode_lock_time(37.0 * i);
+  }
+  sink ^= acc;
+}
+
+/* Input messages */
+
+static void make_obs(uint16_t msg_num) {
+  bool glo = msg_num >= 1009;
+  memset(&obs_in, 0, sizeof(obs_in));
+  obs_in.header.msg_num = msg_num;
+  obs_in.header.stn_id = 7;
+  obs_in.header.tow_ms = glo ? 3600000 : 345600000;
+  obs_in.header.n_sat = glo ? 10 : 12;
+  double l1_hz = glo ? GLO_L1_HZ : GPS_L1_HZ;
+  double l2_hz = glo ? GLO_L2_HZ : GPS_L2_HZ;
+  for (uint8_t i = 0; i < obs_in.header.n_sat; i++) {
+    rtcm_sat_data *sat = &obs_in.sats[i];
+    sat->svId = i + 1;
+    sat->fcn = glo ? (uint8_t)(i % 14) : 0;
+    double pr = 20000000.0 + 123456.789 * i;
+    for (uint8_t f = 0; f < NUM_FREQS; f++) {
+      double hz = 0 == f ? l1_hz : l2_hz;
+      if (glo) {
+        hz += (sat->fcn - MT1012_GLO_FCN_OFFSET) *
+              (0 == f ? GLO_L1_DELTA_HZ : GLO_L2_DELTA_HZ);
+      }
+      sat->obs[f].pseudorange = pr + 3.2 * f;
+      sat->obs[f].carrier_phase = (pr + 3.2 * f) * hz / GPS_C;
+      sat->obs[f].lock = 900;
+      sat->obs[f].cnr = 44 - f;
+      sat->obs[f].flags.data = 0x0F;
+    }
+  }
+}
+
+static void make_msm(uint16_t msg_num, uint8_t num_sats, uint8_t num_sigs) {
+  /* 1C, 2W, 2L and 5Q for GPS, 1C, 1P, 2C and 2P for GLONASS */
+  static const uint8_t gps_sigs[] = {1, 9, 15, 23};
+  static const uint8_t glo_sigs[] = {1, 2, 7, 8};
+  bool glo = msg_num >= 1081 && msg_num <= 1087;
+  memset(&msm_in, 0, sizeof(msm_in));
+  msm_in.header.msg_num = msg_num;
+  msm_in.header.stn_id = 7;
+  msm_in.header.tow_ms = glo ? 3600000 : 345600000;
+  for (uint8_t i = 0; i < num_sats; i++) {
+    msm_in.header.satellite_mask[2 * i] = true;
+    msm_in.sats[i].glo_fcn = glo ? (uint8_t)(i % 14) : MSM_GLO_FCN_UNKNOWN;
+    msm_in.sats[i].rough_range_ms = 67.0 + 0.37 * i;
+    msm_in.sats[i].rough_range_rate_m_s = 100.0 * i - 500.0;
+  }
+  for (uint8_t j = 0; j < num_sigs; j++) {
+    msm_in.header.signal_mask[glo ? glo_sigs[j] : gps_sigs[j]] = true;
+  }
+  uint8_t cell = 0;
+  for (uint8_t i = 0; i < num_sats; i++) {
+    for (uint8_t j = 0; j < num_sigs; j++, cell++) {
+      rtcm_msm_signal_data *sig = &msm_in.signals[cell];
+      msm_in.header.cell_mask[cell] = true;
+      sig->pseudorange_ms = msm_in.sats[i].rough_range_ms + 1e-5 * (j + 1);
+      sig->carrier_phase_ms = msm_in.sats[i].rough_range_ms + 2e-5 * (j + 1);
+      sig->lock_time_s = 500;
+      sig->cnr = 40 + j;
+      sig->range_rate_m_s = msm_in.sats[i].rough_range_rate_m_s + 0.1 * j;
+      sig->flags.data = 0x1F;
+    }
+  }
+}
+
+static void make_messages(void) {
+  memset(&msg_1005_in, 0, sizeof(msg_1005_in));
+  msg_1005_in.stn_id = 7;
+  msg_1005_in.GPS_ind = 1;
+  msg_1005_in.GLO_ind = 1;
+  msg_1005_in.arp_x = 3578346.5475;
+  msg_1005_in.arp_y = -5578346.5578;
+  msg_1005_in.arp_z = 2578346.6757;
+  memset(&msg_1006_in, 0, sizeof(msg_1006_in));
+  msg_1006_in.msg_1005 = msg_1005_in;
+  msg_1006_in.ant_height = 1.567;
+  memset(&msg_1007_in, 0, sizeof(msg_1007_in));
+  msg_1007_in.stn_id = 7;
+  msg_1007_in.ant_descriptor_counter = 20;
+  memcpy(msg_1007_in.ant_descriptor, "TRM59800.00     NONE", 20);
+  msg_1008_in.msg_1007 = msg_1007_in;
+  msg_1008_in.ant_serial_num_counter = 9;
+  memcpy(msg_1008_in.ant_serial_num, "123456789", 9);
+
+  /* The messages of a typical MSM station */
+  static const uint16_t station_msgs[] = {1005, 1077, 1087, 1097, 1127, 1230};
+  memset(&msg_1013_in, 0, sizeof(msg_1013_in));
+  msg_1013_in.stn_id = 7;
+  msg_1013_in.mjd_num = 60000;
+  msg_1013_in.utc_sec_of_day = 43200;
+  msg_1013_in.leap_seconds = 18;
+  msg_1013_in.n_msgs = sizeof(station_msgs) / sizeof(station_msgs[0]);
+  for (uint8_t i = 0; i < msg_1013_in.n_msgs; i++) {
+    msg_1013_in.msgs[i].msg_num = station_msgs[i];
+    msg_1013_in.msgs[i].sync = i + 1 < msg_1013_in.n_msgs;
+    msg_1013_in.msgs[i].interval_s = 1005 == station_msgs[i] ? 10.0 : 1.0;
+  }
+
+  memset(&msg_1029_in, 0, sizeof(msg_1029_in));
+  msg_1029_in.stn_id = 7;
+  msg_1029_in.utf8_code_units_n = 64;
+  msg_1029_in.unicode_chars = 64;
+  memset(msg_1029_in.utf8_code_units, 'a', 64);
+
+  memset(&msg_1033_in, 0, sizeof(msg_1033_in));
+  msg_1033_in.stn_id = 7;
+  msg_1033_in.ant_descriptor_counter = 20;
+  memcpy(msg_1033_in.ant_descriptor, "TRM59800.00     NONE", 20);
+  msg_1033_in.rcv_descriptor_counter = 9;
+  memcpy(msg_1033_in.rcv_descriptor, "LEI - IGS", 9);
+  msg_1033_in.rcv_fw_version_counter = 6;
+  memcpy(msg_1033_in.rcv_fw_version, "1.2.14", 6);
+  msg_1033_in.rcv_serial_num_counter = 20;
+  memset(msg_1033_in.rcv_serial_num, '6', 20);
+
+  memset(&msg_1230_in, 0, sizeof(msg_1230_in));
+  msg_1230_in.stn_id = 7;
+  msg_1230_in.fdma_signal_mask = 0x0F;
+  msg_1230_in.L1_CA_cpb_meter = 1.22;
+  msg_1230_in.L1_P_cpb_meter = 2.34;
+  msg_1230_in.L2_CA_cpb_meter = -1.11;
+  msg_1230_in.L2_P_cpb_meter = -0.48;
+
+  memset(&swift_in, 0, sizeof(swift_in));
+  swift_in.msg_type = 0x4A;
+  swift_in.sender_id = 0x1234;
+  swift_in.len = 200;
+  for (uint8_t i = 0; i < swift_in.len; i++) {
+    swift_in.data[i] = i;
+  }
+}
+
+static void make_eph(uint16_t msg_num) {
+  memset(&eph_in, 0, sizeof(eph_in));
+  eph_in.sat_id = 5;
+  eph_in.wn = 2100 % 1024;
+  eph_in.toe = 7200;
+  eph_in.ura = 2;
+  eph_in.fit_interval = 4;
+  switch (msg_num) {
+    case 1019:
+      eph_in.constellation = RTCM_CONSTELLATION_GPS;
+      break;
+    case 1020:
+      eph_in.constellation = RTCM_CONSTELLATION_GLO;
+      eph_in.glo.t_b = 36;
+      eph_in.glo.fcn = 8;
+      eph_in.glo.pos[0] = 1234567;
+      return;
+    case 1042:
+      /* GEO satellites are not decoded */
+      eph_in.constellation = RTCM_CONSTELLATION_BDS;
+      eph_in.sat_id = 12;
+      break;
+    case 1044:
+      eph_in.constellation = RTCM_CONSTELLATION_QZS;
+      break;
+    default:
+      eph_in.constellation = RTCM_CONSTELLATION_GAL;
+      break;
+  }
+  eph_in.kepler.sqrta = 2702000000u;
+  eph_in.kepler.ecc = 40000000;
+  eph_in.kepler.m0 = 123456789;
+  eph_in.kepler.omega0 = -987654321;
+  eph_in.kepler.w = 55555555;
+  eph_in.kepler.inc = 666666666;
+  eph_in.kepler.toc = 7200;
+  eph_in.kepler.iode = 33;
+  eph_in.kepler.iodc = 33;
+}
+
+/* GPS SSR messages: an orbit/clock/bias message with the header fields of
+ * its type, then the satellite blocks filled with pseudo-random values */
+static uint16_t make_ssr(uint16_t msg_num) {
+  rtcm_bitwriter w;
+  memset(payload, 0, sizeof(payload));
+  rtcm_bitwriter_init(&w, payload, sizeof(payload), 0);
+  rtcm_write_bitu(&w, 12, msg_num);
+  rtcm_write_bitu(&w, 20, 345600);
+  rtcm_write_bitu(&w, 4, 2);
+  rtcm_write_bitu(&w, 1, 0);
+  if (1057 == msg_num || 1060 == msg_num) {
+    rtcm_write_bitu(&w, 1, 0);
+  }
+  rtcm_write_bitu(&w, 4, 1);
+  rtcm_write_bitu(&w, 16, 33);
+  rtcm_write_bitu(&w, 4, 1);
+  if (1265 == msg_num) {
+    rtcm_write_bitu(&w, 2, 3);
+  }
+  rtcm_write_bitu(&w, 6, SSR_BENCH_SATS);
+  uint32_t x = msg_num;
+  for (uint8_t i = 0; i < SSR_BENCH_SATS; i++) {
+    rtcm_write_bitu(&w, 6, i + 1);
+    uint32_t bits = 0;
+    switch (msg_num) {
+      case 1057:
+        bits = 8 + 121;
+        break;
+      case 1058:
+        bits = 70;
+        break;
+      case 1060:
+        bits = 8 + 121 + 70;
+        break;
+      case 1059:
+        rtcm_write_bitu(&w, 5, SSR_BENCH_SIGNALS);
+        bits = SSR_BENCH_SIGNALS * 19;
+        break;
+      case 1265:
+        rtcm_write_bitu(&w, 5, SSR_BENCH_SIGNALS);
+        bits = 9 + 8 + SSR_BENCH_SIGNALS * 32;
+        break;
+      default:
+        break;
+    }
+    for (; bits > 0; bits -= bits < 16 ? bits : 16) {
+      x = x * 1103515245u + 12345u;
+      uint8_t n = bits < 16 ? (uint8_t)bits : 16;
+      rtcm_write_bitu(&w, n, (x >> 16) & ((1u << n) - 1));
+    }
+  }
+  return rtcm_bitwriter_flush(&w);
+}
+
+/* STA firmware version, message 999 subtype 25 */
+static uint16_t make_sta_fw_version(void) {
+  rtcm_bitwriter w;
+  memset(payload, 0, sizeof(payload));
+  rtcm_bitwriter_init(&w, payload, sizeof(payload), 0);
+  rtcm_write_bitu(&w, 12, 999);
+  rtcm_write_bitu(&w, 8, 25);
+  rtcm_write_bitu(&w, 8, strlen(STA_FW_VERSION));
+  for (const char *c = STA_FW_VERSION; '\0' != *c; c++) {
+    rtcm_write_bitu(&w, 8, (uint8_t)*c);
+  }
+  return rtcm_bitwriter_flush(&w);
+}
+
+/* STA RF status, message 999 subtype 24, with every status section: CW,
+ * AGC, IFM, noise floor and antenna sense */
+static uint16_t make_sta_rf_status(void) {
+  rtcm_bitwriter w;
+  memset(payload, 0, sizeof(payload));
+  rtcm_bitwriter_init(&w, payload, sizeof(payload), 0);
+  rtcm_write_bitu(&w, 12, 999);
+  rtcm_write_bitu(&w, 8, 24);
+  rtcm_write_bitu(&w, 30, 345600000);
+  rtcm_write_bitu(&w, 8, 0x1F);
+  rtcm_write_bitu(&w, 4, 0x3);
+  rtcm_write_bitu(&w, 8, 0x01);
+  rtcm_write_bitu(&w, 32, 0x5);
+  rtcm_write_bitu(&w, 8, 0x03);
+  for (uint32_t i = 0; i < 8; i++) {
+    rtcm_write_bitu(&w, 32, 1000 + i);
+  }
+  rtcm_write_bitu(&w, 4, 0xF);
+  rtcm_write_bitu(&w, 8, 0);
+  for (uint32_t i = 0; i < 4; i++) {
+    rtcm_write_bitu(&w, 12, 2000 + i);
+  }
+  rtcm_write_bitu(&w, 6, 0x3);
+  rtcm_write_bitu(&w, 32, 0x5);
+  for (uint32_t i = 0; i < 6; i++) {
+    rtcm_write_bitu(&w, 32, 3000 + i);
+  }
+  rtcm_write_bitu(&w, 8, 0xA5);
+  return rtcm_bitwriter_flush(&w);
+}
+
+/* The MSM7 observations of a GPS and a GLONASS receiver at one epoch */
+static void make_epoch(uint8_t num_sats, uint8_t num_sigs) {
+  static const uint16_t msg_nums[] = {1077, 1087};
+  memset(&epoch_in, 0, sizeof(epoch_in));
+  epoch_in.msm_type = MSM7;
+  epoch_in.stn_id = 7;
+  uint16_t n = 0;
+  for (uint8_t m = 0; m < sizeof(msg_nums) / sizeof(msg_nums[0]); m++) {
+    make_msm(msg_nums[m], num_sats, num_sigs);
+    rtcm_constellation_t cons =
+        1087 == msg_nums[m] ? RTCM_CONSTELLATION_GLO : RTCM_CONSTELLATION_GPS;
+    epoch_in.tow_ms[cons] = msm_in.header.tow_ms;
+    uint8_t cell = 0;
+    for (uint8_t sat = 0; sat < MSM_SATELLITE_MASK_SIZE; sat++) {
+      if (!msm_in.header.satellite_mask[sat]) {
+        continue;
+      }
+      for (uint8_t sig = 0; sig < MSM_SIGNAL_MASK_SIZE; sig++) {
+        if (!msm_in.header.signal_mask[sig]) {
+          continue;
+        }
+        rtcm_msm_obs *obs = &epoch_obs[n++];
+        obs->cons = cons;
+        obs->sat = sat;
+        obs->sig = sig;
+        obs->glo_fcn = msm_in.sats[cell / num_sigs].glo_fcn;
+        obs->data = msm_in.signals[cell++];
+      }
+    }
+  }
+  epoch_in.num_obs = n;
+  epoch_in.obs = epoch_obs;
+}
+
+/* Prepare functions, these leave the encoded message in payload */
+
+#define ENCODE_INTO_PAYLOAD(What, Call)      \
+  do {                                       \
+    memset(payload, 0, sizeof(payload));     \
+    payload_len = (Call);                    \
+    check_len((What), payload_len);          \
+  } while (false)
+
+static void prepare_obs(const bench_case *bench) {
+  make_obs(bench->msg_num);
+  switch (bench->msg_num) {
+    case 1001:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_1001(&obs_in, payload));
+      break;
+    case 1002:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_1002(&obs_in, payload));
+      break;
+    case 1003:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_1003(&obs_in, payload));
+      break;
+    case 1004:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_1004(&obs_in, payload));
+      break;
+    case 1009:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_1009(&obs_in, payload));
+      break;
+    case 1010:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_1010(&obs_in, payload));
+      break;
+    case 1011:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_1011(&obs_in, payload));
+      break;
+    default:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_1012(&obs_in, payload));
+      break;
+  }
+}
+
+static void prepare_msg(const bench_case *bench) {
+  make_messages();
+  switch (bench->msg_num) {
+    case 1005:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_1005(&msg_1005_in, payload));
+      break;
+    case 1006:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_1006(&msg_1006_in, payload));
+      break;
+    case 1007:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_1007(&msg_1007_in, payload));
+      break;
+    case 1008:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_1008(&msg_1008_in, payload));
+      break;
+    case 1013:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_1013(&msg_1013_in, payload));
+      break;
+    case 1029:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_1029(&msg_1029_in, payload));
+      break;
+    case 1033:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_1033(&msg_1033_in, payload));
+      break;
+    case 1230:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_1230(&msg_1230_in, payload));
+      break;
+    default:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_4062(&swift_in, payload));
+      break;
+  }
+}
+
+static void encode_msm(const bench_case *bench) {
+  make_msm(bench->msg_num, bench->num_sats, bench->num_sigs);
+  switch (bench->msg_num % 10) {
+    case 4:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_msm4(&msm_in, payload));
+      break;
+    case 5:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_msm5(&msm_in, payload));
+      break;
+    case 6:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_msm6(&msm_in, payload));
+      break;
+    default:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_msm7(&msm_in, payload));
+      break;
+  }
+}
+
+static void prepare_msm(const bench_case *bench) {
+  encode_msm(bench);
+  rtcm_msm_masks masks;
+  msm_pack_masks(&msm_in.header, &masks);
+  if (!rtcm3_msm_layout_init(bench->msg_num, &masks, &msm_layout)) {
+    fprintf(stderr, "librtcm_bench: no layout for %s\n", bench->name);
+    exit(EXIT_FAILURE);
+  }
+  items_per_op = (uint32_t)bench->num_sats * bench->num_sigs;
+}
+
+static void prepare_epoch(const bench_case *bench) {
+  make_epoch(bench->num_sats, bench->num_sigs);
+  epoch_len =
+      rtcm3_encode_msm_epoch(&epoch_in, epoch_frames, sizeof(epoch_frames));
+  check_len(bench->name, (uint16_t)epoch_len);
+  items_per_op = epoch_in.num_obs;
+}
+
+static void prepare_eph(const bench_case *bench) {
+  make_eph(bench->msg_num);
+  switch (bench->msg_num) {
+    case 1019:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_gps_eph(&eph_in, payload));
+      break;
+    case 1020:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_glo_eph(&eph_in, payload));
+      break;
+    case 1042:
+      ENCODE_INTO_PAYLOAD(bench->name, rtcm3_encode_bds_eph(&eph_in, payload));
+      break;
+    case 1044:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_qzss_eph(&eph_in, payload));
+      break;
+    case 1045:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_gal_eph_fnav(&eph_in, payload));
+      break;
+    default:
+      ENCODE_INTO_PAYLOAD(bench->name,
+                          rtcm3_encode_gal_eph_inav(&eph_in, payload));
+      break;
+  }
+}
+
+static void prepare_ssr(const bench_case *bench) {
+  payload_len = make_ssr(bench->msg_num);
+  check_len(bench->name, payload_len);
+}
+
+static void prepare_sta(const bench_case *bench) {
+  payload_len = make_sta_fw_version();
+  check_len(bench->name, payload_len);
+}
+
+static void prepare_sta_rf_status(const bench_case *bench) {
+  payload_len = make_sta_rf_status();
+  check_len(bench->name, payload_len);
+}
+
+/* Message runners */
+
+#define DECODE_RUNNER(Name, Decoder, Type)                \
+  static void Name(void) {                                \
+    static Type out;                                      \
+    rtcm3_rc ret = Decoder(payload, payload_len, &out);   \
+    run_failed |= RC_OK != ret;                           \
+    sink ^= (uint32_t)ret;                                \
+  }
+
+/* The decoders without a payload length */
+#define UNBOUNDED_RUNNER(Name, Decoder, Type)  \
+  static void Name(void) {                     \
+    static Type out;                           \
+    rtcm3_rc ret = Decoder(payload, &out);     \
+    run_failed |= RC_OK != ret;                \
+    sink ^= (uint32_t)ret;                     \
+  }
+
+/* The arena is reset every call, as it would be every epoch */
+#define ARENA_RUNNER(Name, Decoder, Type)                         \
+  static void Name(void) {                                        \
+    Type *out;                                                    \
+    rtcm3_arena_reset(&arena);                                    \
+    rtcm3_rc ret = Decoder(payload, payload_len, &arena, &out);   \
+    run_failed |= RC_OK != ret;                                   \
+    sink ^= (uint32_t)ret;                                        \
+  }
+
+#define ENCODE_RUNNER(Name, Encoder, In)       \
+  static void Name(void) {                     \
+    uint16_t len = Encoder(&(In), scratch);    \
+    run_failed |= 0 == len;                    \
+    sink ^= len;                               \
+  }
+
+DECODE_RUNNER(decode_1001, rtcm3_decode_1001_bounded, rtcm_obs_message)
+DECODE_RUNNER(decode_1002, rtcm3_decode_1002_bounded, rtcm_obs_message)
+DECODE_RUNNER(decode_1003, rtcm3_decode_1003_bounded, rtcm_obs_message)
+DECODE_RUNNER(decode_1004, rtcm3_decode_1004_bounded, rtcm_obs_message)
+DECODE_RUNNER(decode_1005, rtcm3_decode_1005_bounded, rtcm_msg_1005)
+DECODE_RUNNER(decode_1006, rtcm3_decode_1006_bounded, rtcm_msg_1006)
+DECODE_RUNNER(decode_1007, rtcm3_decode_1007_bounded, rtcm_msg_1007)
+DECODE_RUNNER(decode_1008, rtcm3_decode_1008_bounded, rtcm_msg_1008)
+DECODE_RUNNER(decode_1009, rtcm3_decode_1009_bounded, rtcm_obs_message)
+DECODE_RUNNER(decode_1010, rtcm3_decode_1010_bounded, rtcm_obs_message)
+DECODE_RUNNER(decode_1011, rtcm3_decode_1011_bounded, rtcm_obs_message)
+DECODE_RUNNER(decode_1012, rtcm3_decode_1012_bounded, rtcm_obs_message)
+DECODE_RUNNER(decode_1013, rtcm3_decode_1013_bounded, rtcm_msg_1013)
+DECODE_RUNNER(decode_1029, rtcm3_decode_1029_bounded, rtcm_msg_1029)
+DECODE_RUNNER(decode_1033, rtcm3_decode_1033_bounded, rtcm_msg_1033)
+DECODE_RUNNER(decode_1230, rtcm3_decode_1230_bounded, rtcm_msg_1230)
+DECODE_RUNNER(decode_msm4, rtcm3_decode_msm4_bounded, rtcm_msm_message)
+DECODE_RUNNER(decode_msm5, rtcm3_decode_msm5_bounded, rtcm_msm_message)
+DECODE_RUNNER(decode_msm6, rtcm3_decode_msm6_bounded, rtcm_msm_message)
+DECODE_RUNNER(decode_msm7, rtcm3_decode_msm7_bounded, rtcm_msm_message)
+DECODE_RUNNER(decode_4062,
+              rtcm3_decode_4062_bounded,
+              rtcm_msg_swift_proprietary)
+DECODE_RUNNER(decode_gps_eph, rtcm3_decode_gps_eph_bounded, rtcm_msg_eph)
+DECODE_RUNNER(decode_glo_eph, rtcm3_decode_glo_eph_bounded, rtcm_msg_eph)
+DECODE_RUNNER(decode_bds_eph, rtcm3_decode_bds_eph_bounded, rtcm_msg_eph)
+DECODE_RUNNER(decode_gal_eph_fnav,
+              rtcm3_decode_gal_eph_fnav_bounded,
+              rtcm_msg_eph)
+DECODE_RUNNER(decode_gal_eph_inav,
+              rtcm3_decode_gal_eph_inav_bounded,
+              rtcm_msg_eph)
+DECODE_RUNNER(decode_orbit, rtcm3_decode_orbit_bounded, rtcm_msg_orbit)
+DECODE_RUNNER(decode_clock, rtcm3_decode_clock_bounded, rtcm_msg_clock)
+DECODE_RUNNER(decode_orbit_clock,
+              rtcm3_decode_orbit_clock_bounded,
+              rtcm_msg_orbit_clock)
+DECODE_RUNNER(decode_code_bias,
+              rtcm3_decode_code_bias_bounded,
+              rtcm_msg_code_bias)
+DECODE_RUNNER(decode_phase_bias,
+              rtcm3_decode_phase_bias_bounded,
+              rtcm_msg_phase_bias)
+DECODE_RUNNER(decode_qzss_eph, rtcm3_decode_qzss_eph_bounded, rtcm_msg_eph)
+DECODE_RUNNER(decode_frame, rtcm3_decode_frame, rtcm3_any_msg)
+
+UNBOUNDED_RUNNER(decode_1001_unbounded, rtcm3_decode_1001, rtcm_obs_message)
+UNBOUNDED_RUNNER(decode_1002_unbounded, rtcm3_decode_1002, rtcm_obs_message)
+UNBOUNDED_RUNNER(decode_1003_unbounded, rtcm3_decode_1003, rtcm_obs_message)
+UNBOUNDED_RUNNER(decode_1004_unbounded, rtcm3_decode_1004, rtcm_obs_message)
+UNBOUNDED_RUNNER(decode_1005_unbounded, rtcm3_decode_1005, rtcm_msg_1005)
+UNBOUNDED_RUNNER(decode_1006_unbounded, rtcm3_decode_1006, rtcm_msg_1006)
+UNBOUNDED_RUNNER(decode_1007_unbounded, rtcm3_decode_1007, rtcm_msg_1007)
+UNBOUNDED_RUNNER(decode_1008_unbounded, rtcm3_decode_1008, rtcm_msg_1008)
+UNBOUNDED_RUNNER(decode_1009_unbounded, rtcm3_decode_1009, rtcm_obs_message)
+UNBOUNDED_RUNNER(decode_1010_unbounded, rtcm3_decode_1010, rtcm_obs_message)
+UNBOUNDED_RUNNER(decode_1011_unbounded, rtcm3_decode_1011, rtcm_obs_message)
+UNBOUNDED_RUNNER(decode_1012_unbounded, rtcm3_decode_1012, rtcm_obs_message)
+UNBOUNDED_RUNNER(decode_1013_unbounded, rtcm3_decode_1013, rtcm_msg_1013)
+UNBOUNDED_RUNNER(decode_1029_unbounded, rtcm3_decode_1029, rtcm_msg_1029)
+UNBOUNDED_RUNNER(decode_1033_unbounded, rtcm3_decode_1033, rtcm_msg_1033)
+UNBOUNDED_RUNNER(decode_1230_unbounded, rtcm3_decode_1230, rtcm_msg_1230)
+UNBOUNDED_RUNNER(decode_msm4_unbounded, rtcm3_decode_msm4, rtcm_msm_message)
+UNBOUNDED_RUNNER(decode_msm5_unbounded, rtcm3_decode_msm5, rtcm_msm_message)
+UNBOUNDED_RUNNER(decode_msm6_unbounded, rtcm3_decode_msm6, rtcm_msm_message)
+UNBOUNDED_RUNNER(decode_msm7_unbounded, rtcm3_decode_msm7, rtcm_msm_message)
+UNBOUNDED_RUNNER(decode_4062_unbounded,
+                 rtcm3_decode_4062,
+                 rtcm_msg_swift_proprietary)
+UNBOUNDED_RUNNER(decode_gps_eph_unbounded, rtcm3_decode_gps_eph, rtcm_msg_eph)
+UNBOUNDED_RUNNER(decode_glo_eph_unbounded, rtcm3_decode_glo_eph, rtcm_msg_eph)
+UNBOUNDED_RUNNER(decode_bds_eph_unbounded, rtcm3_decode_bds_eph, rtcm_msg_eph)
+UNBOUNDED_RUNNER(decode_qzss_eph_unbounded,
+                 rtcm3_decode_qzss_eph,
+                 rtcm_msg_eph)
+UNBOUNDED_RUNNER(decode_gal_eph_fnav_unbounded,
+                 rtcm3_decode_gal_eph_fnav,
+                 rtcm_msg_eph)
+UNBOUNDED_RUNNER(decode_gal_eph_inav_unbounded,
+                 rtcm3_decode_gal_eph_inav,
+                 rtcm_msg_eph)
+UNBOUNDED_RUNNER(decode_orbit_unbounded, rtcm3_decode_orbit, rtcm_msg_orbit)
+UNBOUNDED_RUNNER(decode_clock_unbounded, rtcm3_decode_clock, rtcm_msg_clock)
+UNBOUNDED_RUNNER(decode_orbit_clock_unbounded,
+                 rtcm3_decode_orbit_clock,
+                 rtcm_msg_orbit_clock)
+UNBOUNDED_RUNNER(decode_code_bias_unbounded,
+                 rtcm3_decode_code_bias,
+                 rtcm_msg_code_bias)
+UNBOUNDED_RUNNER(decode_phase_bias_unbounded,
+                 rtcm3_decode_phase_bias,
+                 rtcm_msg_phase_bias)
+
+ARENA_RUNNER(decode_1029_arena, rtcm3_decode_1029_arena, rtcm_msg_1029_arena)
+ARENA_RUNNER(decode_1033_arena, rtcm3_decode_1033_arena, rtcm_msg_1033_arena)
+ARENA_RUNNER(decode_4062_arena,
+             rtcm3_decode_4062_arena,
+             rtcm_msg_swift_proprietary_arena)
+ARENA_RUNNER(decode_msm_arena, rtcm3_decode_msm_arena, rtcm_msm_compact)
+ARENA_RUNNER(decode_orbit_arena, rtcm3_decode_orbit_arena, rtcm_msg_orbit_arena)
+ARENA_RUNNER(decode_clock_arena, rtcm3_decode_clock_arena, rtcm_msg_clock_arena)
+ARENA_RUNNER(decode_orbit_clock_arena,
+             rtcm3_decode_orbit_clock_arena,
+             rtcm_msg_orbit_clock_arena)
+ARENA_RUNNER(decode_code_bias_arena,
+             rtcm3_decode_code_bias_arena,
+             rtcm_msg_code_bias_arena)
+ARENA_RUNNER(decode_phase_bias_arena,
+             rtcm3_decode_phase_bias_arena,
+             rtcm_msg_phase_bias_arena)
+
+static void decode_msm_columns(void) {
+  static rtcm_msm_header header;
+  rtcm_msm_signal_columns cells = {.sat_index = column_sat_index,
+                                   .sig_index = column_sig_index,
+                                   .pseudorange_ms = column_pseudorange_ms,
+                                   .carrier_phase_ms = column_carrier_phase_ms,
+                                   .range_rate_m_s = column_range_rate_m_s,
+                                   .cnr = column_cnr,
+                                   .lock_time_s = column_lock_time_s};
+  rtcm3_rc ret = rtcm3_decode_msm_columns(
+      payload, payload_len, &header, column_sats, &cells);
+  run_failed |= RC_OK != ret;
+  sink ^= (uint32_t)ret ^ cells.num_cells;
+}
+
+/* Sized per message, as a caller reserving just enough room would */
+static void decode_msm_compact(void) {
+  rtcm_msm_compact *compact = (rtcm_msm_compact *)compact_storage;
+  uint16_t size = rtcm3_msm_compact_size(payload, payload_len);
+  if (0 == size || size > sizeof(compact_storage)) {
+    run_failed = true;
+    return;
+  }
+  rtcm3_rc ret = rtcm3_decode_msm_compact(payload, payload_len, compact, size);
+  run_failed |= RC_OK != ret;
+  sink ^= (uint32_t)ret ^ size;
+}
+
+static void decode_code_bias_sparse(void) {
+  static rtcm_msg_code_bias_sparse out;
+  out.signals = sparse_code_signals;
+  out.max_signals =
+      sizeof(sparse_code_signals) / sizeof(sparse_code_signals[0]);
+  rtcm3_rc ret = rtcm3_decode_code_bias_sparse(
+      payload, payload_len, SSR_SPARSE_SIGNALS, &out);
+  run_failed |= RC_OK != ret;
+  sink ^= (uint32_t)ret;
+}
+
+static void decode_phase_bias_sparse(void) {
+  static rtcm_msg_phase_bias_sparse out;
+  out.signals = sparse_phase_signals;
+  out.max_signals =
+      sizeof(sparse_phase_signals) / sizeof(sparse_phase_signals[0]);
+  rtcm3_rc ret = rtcm3_decode_phase_bias_sparse(
+      payload, payload_len, SSR_SPARSE_SIGNALS, &out);
+  run_failed |= RC_OK != ret;
+  sink ^= (uint32_t)ret;
+}
+
+/* Counters only, without latency samples */
+static void decode_frame_counted(void) {
+  rtcm3_rc ret =
+      rtcm3_decode_frame_counted(&stats, payload, payload_len, &any_msg);
+  run_failed |= RC_OK != ret;
+  sink ^= (uint32_t)ret;
+}
+
+/* The STA decoders do not follow the bounded decoder signature */
+static void decode_sta_fw_version(void) {
+  static char fw_version[RTCM_MAX_STRING_LEN];
+  rtcm3_rc ret = sta_decode_fwver(payload, fw_version, sizeof(fw_version));
+  run_failed |= RC_OK != ret;
+  sink ^= (uint32_t)ret;
+}
+
+/* Takes the message length in bits */
+static void decode_sta_rf_status(void) {
+  static sta_rf_status rf_status;
+  rtcm3_rc ret = sta_decode_rfstatus(payload, &rf_status, payload_len * 8u);
+  run_failed |= RC_OK != ret;
+  sink ^= (uint32_t)ret;
+}
+
+ENCODE_RUNNER(encode_1001, rtcm3_encode_1001, obs_in)
+ENCODE_RUNNER(encode_1002, rtcm3_encode_1002, obs_in)
+ENCODE_RUNNER(encode_1003, rtcm3_encode_1003, obs_in)
+ENCODE_RUNNER(encode_1004, rtcm3_encode_1004, obs_in)
+ENCODE_RUNNER(encode_1005, rtcm3_encode_1005, msg_1005_in)
+ENCODE_RUNNER(encode_1006, rtcm3_encode_1006, msg_1006_in)
+ENCODE_RUNNER(encode_1007, rtcm3_encode_1007, msg_1007_in)
+ENCODE_RUNNER(encode_1008, rtcm3_encode_1008, msg_1008_in)
+ENCODE_RUNNER(encode_1009, rtcm3_encode_1009, obs_in)
+ENCODE_RUNNER(encode_1010, rtcm3_encode_1010, obs_in)
+ENCODE_RUNNER(encode_1011, rtcm3_encode_1011, obs_in)
+ENCODE_RUNNER(encode_1012, rtcm3_encode_1012, obs_in)
+ENCODE_RUNNER(encode_1013, rtcm3_encode_1013, msg_1013_in)
+ENCODE_RUNNER(encode_1029, rtcm3_encode_1029, msg_1029_in)
+ENCODE_RUNNER(encode_1033, rtcm3_encode_1033, msg_1033_in)
+ENCODE_RUNNER(encode_1230, rtcm3_encode_1230, msg_1230_in)
+ENCODE_RUNNER(encode_msm4, rtcm3_encode_msm4, msm_in)
+ENCODE_RUNNER(encode_msm5, rtcm3_encode_msm5, msm_in)
+ENCODE_RUNNER(encode_msm6, rtcm3_encode_msm6, msm_in)
+ENCODE_RUNNER(encode_msm7, rtcm3_encode_msm7, msm_in)
+ENCODE_RUNNER(encode_4062, rtcm3_encode_4062, swift_in)
+ENCODE_RUNNER(encode_gps_eph, rtcm3_encode_gps_eph, eph_in)
+ENCODE_RUNNER(encode_glo_eph, rtcm3_encode_glo_eph, eph_in)
+ENCODE_RUNNER(encode_bds_eph, rtcm3_encode_bds_eph, eph_in)
+ENCODE_RUNNER(encode_qzss_eph, rtcm3_encode_qzss_eph, eph_in)
+ENCODE_RUNNER(encode_gal_eph_fnav, rtcm3_encode_gal_eph_fnav, eph_in)
+ENCODE_RUNNER(encode_gal_eph_inav, rtcm3_encode_gal_eph_inav, eph_in)
+
+static void encode_msm_layout(void) {
+  uint16_t len = rtcm3_encode_msm_layout(&msm_layout, &msm_in, scratch);
+  run_failed |= 0 == len;
+  sink ^= len;
+}
+
+static void encode_msm_epoch(void) {
+  size_t len =
+      rtcm3_encode_msm_epoch(&epoch_in, epoch_frames, sizeof(epoch_frames));
+  run_failed |= 0 == len;
+  sink ^= (uint32_t)len;
+}
+
+static uint16_t encode_msm7_any(const void *msg, uint8_t buff[]) {
+  return rtcm3_encode_msm7(msg, buff);
+}
+
+static void encode_msm7_counted(void) {
+  uint16_t len = rtcm3_encode_counted(
+      &stats, msm_in.header.msg_num, encode_msm7_any, &msm_in, scratch);
+  run_failed |= 0 == len;
+  sink ^= len;
+}
+
+/* Streams: a synthetic one and recorded captures */
+
+static void stream_reserve(size_t len) {
+  if (stream_len + len <= stream_capacity) {
+    return;
+  }
+  size_t capacity = stream_capacity > 0 ? stream_capacity : 1u << 16;
+  while (capacity < stream_len + len) {
+    capacity *= 2;
+  }
+  uint8_t *grown = realloc(stream, capacity);
+  if (NULL == grown) {
+    fprintf(stderr, "librtcm_bench: out of memory\n");
+    exit(EXIT_FAILURE);
+  }
+  stream = grown;
+  stream_capacity = capacity;
+}
+
+static void stream_append_payload(void) {
+  stream_reserve(RTCM3_MAX_FRAME_LEN);
+  uint8_t *frame = stream + stream_len;
+  memcpy(frame + RTCM3_FRAME_HEADER_LEN, payload, payload_len);
+  stream_len += rtcm3_frame_finalize(frame, payload_len);
+  items_per_op++;
+}
+
+/* A reference station: GPS and GLONASS MSM7, legacy GPS observations and
+ * the station position every epoch, plus an SSR clock and phase bias
+ * stream */
+static void prepare_stream(const bench_case *bench) {
+  (void)bench;
+  stream_len = 0;
+  items_per_op = 0;
+  bench_case msm = {"stream", NULL, NULL, 1077, 12, 2};
+  for (uint32_t epoch = 0; epoch < STREAM_EPOCHS; epoch++) {
+    msm.msg_num = 1077;
+    encode_msm(&msm);
+    stream_append_payload();
+    msm.msg_num = 1087;
+    encode_msm(&msm);
+    stream_append_payload();
+    bench_case legacy = {"stream", NULL, NULL, 1004, 0, 0};
+    prepare_obs(&legacy);
+    stream_append_payload();
+    bench_case arp = {"stream", NULL, NULL, 1005, 0, 0};
+    prepare_msg(&arp);
+    stream_append_payload();
+    payload_len = make_ssr(1058);
+    stream_append_payload();
+    payload_len = make_ssr(1265);
+    stream_append_payload();
+  }
+}
+
+static void run_stream(void) {
+  rtcm3_framer_init(&framer);
+  rtcm3_frame frame;
+  uint32_t acc = 0;
+  uint32_t frames = 0;
+  for (size_t pos = 0; pos < stream_len; pos += STREAM_CHUNK) {
+    size_t len = stream_len - pos < STREAM_CHUNK ? stream_len - pos
+                                                 : STREAM_CHUNK;
+    rtcm3_framer_feed(&framer, stream + pos, len);
+    while (rtcm3_framer_next(&framer, &frame)) {
+      acc += (uint32_t)rtcm3_decode_frame(
+          frame.payload, frame.payload_len, &any_msg);
+      frames++;
+    }
+  }
+  /* Captures may hold messages the library does not decode, only the
+   * framing is checked */
+  run_failed |= frames != items_per_op;
+  sink ^= acc;
+}
+
+static bool load_capture(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (NULL == file) {
+    return false;
+  }
+  stream_len = 0;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    stream_reserve(n);
+    memcpy(stream + stream_len, chunk, n);
+    stream_len += n;
+  }
+  fclose(file);
+
+  /* count the frames once, outside the timing */
+  items_per_op = 0;
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, stream, stream_len);
+  rtcm3_frame frame;
+  while (rtcm3_framer_next(&framer, &frame)) {
+    items_per_op++;
+  }
+  return true;
+}
+
+/* The benchmark table */
+
+#define BITS(Name, Run) \
+  { "bits/" Name, prepare_bits, (Run), 0, 0, 0 }
+#define MSG(Prepare, Num, Decode, Unbounded, Encode)                \
+  {"decode/" #Num, (Prepare), (Decode), (Num), 0, 0},               \
+      {"decode/" #Num "/unbounded", (Prepare), (Unbounded), (Num),  \
+       0, 0},                                                       \
+      {"encode/" #Num, (Prepare), (Encode), (Num), 0, 0}
+#define ARENA(Prepare, Num, Decode) \
+  { "decode/" #Num "/arena", (Prepare), (Decode), (Num), 0, 0 }
+#define MSM_VARIANT(Dir, Num, Cells, Variant, Run, Sats, Sigs)      \
+  {Dir "/" #Num "/cells" #Cells Variant, prepare_msm, (Run), (Num), \
+   (Sats), (Sigs)}
+#define MSM_CELLS(Num, Sats, Sigs, Cells, Decode, Unbounded, Encode)   \
+  MSM_VARIANT("decode", Num, Cells, "", Decode, Sats, Sigs),           \
+      MSM_VARIANT(                                                     \
+          "decode", Num, Cells, "_unbounded", Unbounded, Sats, Sigs),  \
+      MSM_VARIANT("decode",                                            \
+                  Num,                                                 \
+                  Cells,                                               \
+                  "_columns",                                          \
+                  decode_msm_columns,                                  \
+                  Sats,                                                \
+                  Sigs),                                               \
+      MSM_VARIANT("decode",                                            \
+                  Num,                                                 \
+                  Cells,                                               \
+                  "_compact",                                          \
+                  decode_msm_compact,                                  \
+                  Sats,                                                \
+                  Sigs),                                               \
+      MSM_VARIANT(                                                     \
+          "decode", Num, Cells, "_arena", decode_msm_arena, Sats, Sigs), \
+      MSM_VARIANT("encode", Num, Cells, "", Encode, Sats, Sigs),       \
+      MSM_VARIANT(                                                     \
+          "encode", Num, Cells, "_layout", encode_msm_layout, Sats, Sigs)
+#define MSM(Num, Decode, Unbounded, Encode)                         \
+  MSM_CELLS(Num, 4, 2, 8, Decode, Unbounded, Encode),               \
+      MSM_CELLS(Num, 12, 2, 24, Decode, Unbounded, Encode),         \
+      MSM_CELLS(Num, 16, 4, 64, Decode, Unbounded, Encode)
+#define SSR(Num, Name, Decode, Unbounded, Arena)                          \
+  {"decode/" #Num "/" Name, prepare_ssr, (Decode), (Num), 0, 0},          \
+      {"decode/" #Num "/" Name "_unbounded", prepare_ssr, (Unbounded),    \
+       (Num), 0, 0},                                                      \
+      {"decode/" #Num "/" Name "_arena", prepare_ssr, (Arena), (Num), 0, 0}
+
+static const bench_case benches[] = {
+    BITS("getbitu22", run_getbitu),
+    BITS("getbits22", run_getbits),
+    BITS("getbitul38", run_getbitul),
+    BITS("setbitu22", run_setbitu),
+    BITS("bitreader22", run_bitreader),
+    BITS("bitwriter22", run_bitwriter),
+    {"bits/crc24q_1023B", prepare_crc, run_crc24q, 0, 0, 0},
+    {"bits/crc24q_table_1023B", prepare_crc, run_crc24q_table, 0, 0, 0},
+    BITS("lock_time_decode", run_decode_lock_time),
+    BITS("lock_time_encode", run_encode_lock_time),
+    MSG(prepare_obs, 1001, decode_1001, decode_1001_unbounded, encode_1001),
+    MSG(prepare_obs, 1002, decode_1002, decode_1002_unbounded, encode_1002),
+    MSG(prepare_obs, 1003, decode_1003, decode_1003_unbounded, encode_1003),
+    MSG(prepare_obs, 1004, decode_1004, decode_1004_unbounded, encode_1004),
+    MSG(prepare_msg, 1005, decode_1005, decode_1005_unbounded, encode_1005),
+    MSG(prepare_msg, 1006, decode_1006, decode_1006_unbounded, encode_1006),
+    MSG(prepare_msg, 1007, decode_1007, decode_1007_unbounded, encode_1007),
+    MSG(prepare_msg, 1008, decode_1008, decode_1008_unbounded, encode_1008),
+    MSG(prepare_obs, 1009, decode_1009, decode_1009_unbounded, encode_1009),
+    MSG(prepare_obs, 1010, decode_1010, decode_1010_unbounded, encode_1010),
+    MSG(prepare_obs, 1011, decode_1011, decode_1011_unbounded, encode_1011),
+    MSG(prepare_obs, 1012, decode_1012, decode_1012_unbounded, encode_1012),
+    MSG(prepare_msg, 1013, decode_1013, decode_1013_unbounded, encode_1013),
+    MSG(prepare_eph,
+        1019,
+        decode_gps_eph,
+        decode_gps_eph_unbounded,
+        encode_gps_eph),
+    MSG(prepare_eph,
+        1020,
+        decode_glo_eph,
+        decode_glo_eph_unbounded,
+        encode_glo_eph),
+    MSG(prepare_msg, 1029, decode_1029, decode_1029_unbounded, encode_1029),
+    ARENA(prepare_msg, 1029, decode_1029_arena),
+    MSG(prepare_msg, 1033, decode_1033, decode_1033_unbounded, encode_1033),
+    ARENA(prepare_msg, 1033, decode_1033_arena),
+    MSG(prepare_eph,
+        1042,
+        decode_bds_eph,
+        decode_bds_eph_unbounded,
+        encode_bds_eph),
+    MSG(prepare_eph,
+        1044,
+        decode_qzss_eph,
+        decode_qzss_eph_unbounded,
+        encode_qzss_eph),
+    MSG(prepare_eph,
+        1045,
+        decode_gal_eph_fnav,
+        decode_gal_eph_fnav_unbounded,
+        encode_gal_eph_fnav),
+    MSG(prepare_eph,
+        1046,
+        decode_gal_eph_inav,
+        decode_gal_eph_inav_unbounded,
+        encode_gal_eph_inav),
+    MSG(prepare_msg, 1230, decode_1230, decode_1230_unbounded, encode_1230),
+    MSG(prepare_msg, 4062, decode_4062, decode_4062_unbounded, encode_4062),
+    ARENA(prepare_msg, 4062, decode_4062_arena),
+    {"decode/999/fw_version", prepare_sta, decode_sta_fw_version, 999, 0, 0},
+    {"decode/999/fw_version_dispatch", prepare_sta, decode_frame, 999, 0, 0},
+    {"decode/999/rf_status",
+     prepare_sta_rf_status,
+     decode_sta_rf_status,
+     999,
+     0,
+     0},
+    {"decode/999/rf_status_dispatch",
+     prepare_sta_rf_status,
+     decode_frame,
+     999,
+     0,
+     0},
+    MSM(1074, decode_msm4, decode_msm4_unbounded, encode_msm4),
+    MSM(1075, decode_msm5, decode_msm5_unbounded, encode_msm5),
+    MSM(1076, decode_msm6, decode_msm6_unbounded, encode_msm6),
+    MSM(1077, decode_msm7, decode_msm7_unbounded, encode_msm7),
+    MSM(1087, decode_msm7, decode_msm7_unbounded, encode_msm7),
+    SSR(1057,
+        "sats20",
+        decode_orbit,
+        decode_orbit_unbounded,
+        decode_orbit_arena),
+    SSR(1058,
+        "sats20",
+        decode_clock,
+        decode_clock_unbounded,
+        decode_clock_arena),
+    SSR(1059,
+        "sats20_sigs3",
+        decode_code_bias,
+        decode_code_bias_unbounded,
+        decode_code_bias_arena),
+    {"decode/1059/sats20_sigs3_sparse",
+     prepare_ssr,
+     decode_code_bias_sparse,
+     1059,
+     0,
+     0},
+    SSR(1060,
+        "sats20",
+        decode_orbit_clock,
+        decode_orbit_clock_unbounded,
+        decode_orbit_clock_arena),
+    SSR(1265,
+        "sats20_sigs3",
+        decode_phase_bias,
+        decode_phase_bias_unbounded,
+        decode_phase_bias_arena),
+    {"decode/1265/sats20_sigs3_sparse",
+     prepare_ssr,
+     decode_phase_bias_sparse,
+     1265,
+     0,
+     0},
+    {"decode/1265/sats20_sigs3_dispatch",
+     prepare_ssr,
+     decode_frame,
+     1265,
+     0,
+     0},
+    {"decode/1077/cells24_dispatch", prepare_msm, decode_frame, 1077, 12, 2},
+    {"decode/1077/cells24_counted",
+     prepare_msm,
+     decode_frame_counted,
+     1077,
+     12,
+     2},
+    {"encode/1077/cells24_counted",
+     prepare_msm,
+     encode_msm7_counted,
+     1077,
+     12,
+     2},
+    {"encode/epoch/msm7_cells48", prepare_epoch, encode_msm_epoch, 0, 12, 2},
+    {"stream/synthetic", prepare_stream, run_stream, 0, 0, 0},
+};
+
+#define NUM_BENCHES (sizeof(benches) / sizeof(benches[0]))
+
+/* Measurement and output */
+
+static bool first_result = true;
+
+/* Writes `s` as the contents of a JSON string */
+static void print_json_string(const char *s) {
+  for (; '\0' != *s; s++) {
+    unsigned char c = (unsigned char)*s;
+    if ('"' == c || '\\' == c) {
+      printf("\\%c", c);
+    } else if (c < 0x20) {
+      printf("\\u%04x", c);
+    } else {
+      putchar(c);
+    }
+  }
+}
+
+static void report(const char *name,
+                   uint64_t iterations,
+                   uint64_t elapsed_ns,
+                   size_t bytes_per_op) {
+  double ns_per_op = (double)elapsed_ns / (double)iterations;
+  printf("%s\n    {\"name\": \"", first_result ? "" : ",");
+  print_json_string(name);
+  printf("\", \"iterations\": %llu, "
+         "\"ns_per_op\": %.3f, \"ops_per_sec\": %.1f, "
+         "\"bytes_per_op\": %zu, \"items_per_op\": %u, "
+         "\"ns_per_item\": %.3f}",
+         (unsigned long long)iterations,
+         ns_per_op,
+         ns_per_op > 0 ? 1e9 / ns_per_op : 0.0,
+         bytes_per_op,
+         items_per_op,
+         items_per_op > 0 ? ns_per_op / items_per_op : 0.0);
+  first_result = false;
+}
+
+static void measure(const char *name,
+                    void (*run)(void),
+                    size_t bytes_per_op,
+                    uint64_t min_time_ns) {
+  uint64_t iterations = 1;
+  for (;;) {
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < iterations; i++) {
+      run();
+    }
+    uint64_t elapsed = now_ns() - start;
+    if (elapsed >= min_time_ns || iterations >= (UINT64_C(1) << 40)) {
+      report(name, iterations, elapsed, bytes_per_op);
+      return;
+    }
+    iterations *= 2;
+  }
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "usage: librtcm_bench [--min-time-ms N] [--filter TEXT] "
+          "[capture.rtcm ...]\n");
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv) {
+  uint64_t min_time_ms = DEFAULT_MIN_TIME_MS;
+  const char *filter = NULL;
+  int first_capture = argc;
+  for (int i = 1; i < argc; i++) {
+    if (0 == strcmp(argv[i], "--min-time-ms") && i + 1 < argc) {
+      min_time_ms = strtoull(argv[++i], NULL, 10);
+    } else if (0 == strcmp(argv[i], "--filter") && i + 1 < argc) {
+      filter = argv[++i];
+    } else if ('-' == argv[i][0]) {
+      usage();
+    } else {
+      first_capture = i;
+      break;
+    }
+  }
+
+  printf("{\n  \"library\": \"librtcm\",\n  \"min_time_ms\": %llu,\n"
+         "  \"crc24q_accelerated\": %s,\n  \"benchmarks\": [",
+         (unsigned long long)min_time_ms,
+         rtcm3_crc24q_accelerated() ? "true" : "false");
+  rtcm3_arena_init(&arena, arena_storage, sizeof(arena_storage));
+  rtcm3_stats_init(&stats, NULL, 0);
+  for (size_t i = 0; i < NUM_BENCHES; i++) {
+    const bench_case *bench = &benches[i];
+    if (NULL != filter && NULL == strstr(bench->name, filter)) {
+      continue;
+    }
+    items_per_op = 1;
+    size_t bytes_per_op = 0;
+    if (NULL != bench->prepare) {
+      bench->prepare(bench);
+      if (bench->prepare == prepare_stream) {
+        bytes_per_op = stream_len;
+      } else if (bench->prepare == prepare_epoch) {
+        bytes_per_op = epoch_len;
+      } else {
+        bytes_per_op = payload_len;
+      }
+    }
+    run_failed = false;
+    measure(bench->name, bench->run, bytes_per_op, min_time_ms * 1000000u);
+    if (run_failed) {
+      fprintf(stderr, "librtcm_bench: %s failed\n", bench->name);
+      return EXIT_FAILURE;
+    }
+  }
+  for (int i = first_capture; i < argc; i++) {
+    char name[256];
+    snprintf(name, sizeof(name), "stream/capture/%s", argv[i]);
+    if (NULL != filter && NULL == strstr(name, filter)) {
+      continue;
+    }
+    if (!load_capture(argv[i])) {
+      fprintf(stderr, "librtcm_bench: cannot read %s\n", argv[i]);
+      return EXIT_FAILURE;
+    }
+    run_failed = false;
+    measure(name, run_stream, stream_len, min_time_ms * 1000000u);
+    if (run_failed) {
+      fprintf(stderr, "librtcm_bench: %s failed\n", name);
+      return EXIT_FAILURE;
+    }
+  }
+  printf("\n  ]\n}\n");
+  free(stream);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_ARCHIVE_H
+#define SWIFTNAV_RTCM3_ARCHIVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rtcm3/constants.h"
+#include "rtcm3/decode_frame.h"
+#include "rtcm3/framer.h"
+#include "rtcm3/passthrough.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define RTCM3_ARCHIVE_HAVE_MAP 1 /* rtcm3_archive_map() is available */
+#endif
+
+#define RTCM3_ARCHIVE_HAS_STN_ID 0x01 /* stn_id holds DF003 */
+#define RTCM3_ARCHIVE_HAS_TIME 0x02   /* time_ms holds the epoch time */
+
+/** Time scale of an entry or record epoch */
+typedef enum rtcm3_timescale_e {
+  RTCM3_TIMESCALE_NONE = 0, /* Message without an epoch time */
+  RTCM3_TIMESCALE_GPS,      /* GPS time, also for Galileo, BeiDou, QZSS */
+  RTCM3_TIMESCALE_GLO,      /* GLONASS time of day */
+} rtcm3_timescale;
+
+/** One frame of an archive, see rtcm3_archive_index() */
+typedef struct {
+  uint64_t offset;    /* Offset of the preamble from the start of the data */
+  uint16_t frame_len; /* Length of the frame including header and CRC */
+  uint16_t msg_num;   /* DF002 */
+  uint16_t stn_id;    /* Reference station ID, if RTCM3_ARCHIVE_HAS_STN_ID */
+  uint8_t flags;      /* RTCM3_ARCHIVE_HAS_* */
+  /* Epoch time in ms in the time system of the message: GPS, Galileo and
+   * BeiDou time of week or GLONASS time of day, if RTCM3_ARCHIVE_HAS_TIME */
+  uint32_t time_ms;
+} rtcm3_archive_entry;
+
+/** Frame index over a buffer holding a recorded stream, see
+ * rtcm3_archive_init() */
+typedef struct {
+  const uint8_t *data; /* Indexed data, e.g. a mapped file */
+  size_t len;
+  size_t scanned; /* Bytes of data covered by the index */
+  rtcm3_archive_entry *entries; /* Frames in file order */
+  size_t capacity;
+  size_t count;
+  rtcm3_framer_stats stats; /* CRC errors and bytes outside any frame */
+} rtcm3_archive;
+
+/** Selects entries of an archive, see rtcm3_archive_next() */
+typedef struct {
+  const rtcm3_msg_filter *types; /* Message types to return, NULL for all */
+  bool by_time; /* Only return entries with a time in the range below */
+  /* rtcm3_timescale of the range, BeiDou times are moved to GPS time, see
+   * rtcm3_archive_entry_time() */
+  uint8_t timescale;
+  uint32_t time_min_ms; /* Inclusive */
+  uint32_t time_max_ms; /* Inclusive */
+} rtcm3_archive_query;
+
+void rtcm3_archive_read_entry(const rtcm3_frame *frame,
+                              uint64_t offset,
+                              rtcm3_archive_entry *entry);
+bool rtcm3_archive_entry_time(const rtcm3_archive_entry *entry,
+                              uint8_t *timescale,
+                              uint32_t *time_ms);
+void rtcm3_archive_init(rtcm3_archive *archive,
+                        rtcm3_archive_entry entries[],
+                        size_t capacity);
+size_t rtcm3_archive_index(rtcm3_archive *archive,
+                           const uint8_t *data,
+                           size_t len);
+const rtcm3_archive_entry *rtcm3_archive_next(
+    const rtcm3_archive *archive,
+    const rtcm3_archive_query *query,
+    size_t *pos);
+bool rtcm3_archive_frame(const rtcm3_archive *archive,
+                         const rtcm3_archive_entry *entry,
+                         rtcm3_frame *frame);
+rtcm3_rc rtcm3_archive_decode(const rtcm3_archive *archive,
+                              const rtcm3_archive_entry *entry,
+                              rtcm3_any_msg *msg);
+
+#ifdef RTCM3_ARCHIVE_HAVE_MAP
+bool rtcm3_archive_map(const char *path, const uint8_t **data, size_t *len);
+void rtcm3_archive_unmap(const uint8_t *data, size_t len);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_ARCHIVE_H */
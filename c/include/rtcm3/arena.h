@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_ARENA_H
+#define SWIFTNAV_RTCM3_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#include <rtcm3/messages.h>
+#include <rtcm3/msm_compact.h>
+
+/* Every allocation is rounded up to a multiple of this */
+#define RTCM3_ARENA_ALIGN 8
+
+/** Bump allocator over a caller-owned buffer. The arena decoders place the
+ * message and its variable-size fields in it, sized to the message; nothing
+ * is freed individually, call rtcm3_arena_reset() once the decoded messages
+ * are no longer needed (typically once per epoch). */
+typedef struct {
+  uint8_t *buff;
+  size_t size;
+  size_t used;
+  size_t high_water; /* Largest `used` since rtcm3_arena_init() */
+} rtcm3_arena;
+
+/* Message 1029 with the text stored in the arena */
+typedef struct {
+  uint16_t stn_id;
+  uint16_t mjd_num;
+  uint32_t utc_sec_of_day;
+  uint8_t unicode_chars;
+  uint8_t utf8_code_units_n;
+  const uint8_t *utf8_code_units;
+} rtcm_msg_1029_arena;
+
+/* Message 1033 with the strings stored in the arena, each followed by a
+ * terminating NUL */
+typedef struct {
+  uint16_t stn_id;
+  uint8_t ant_descriptor_counter;
+  const char *ant_descriptor;
+  uint8_t ant_setup_id;
+  uint8_t ant_serial_num_counter;
+  const char *ant_serial_num;
+  uint8_t rcv_descriptor_counter;
+  const char *rcv_descriptor;
+  uint8_t rcv_fw_version_counter;
+  const char *rcv_fw_version;
+  uint8_t rcv_serial_num_counter;
+  const char *rcv_serial_num;
+} rtcm_msg_1033_arena;
+
+/* Message 4062 with the SBP payload stored in the arena */
+typedef struct {
+  uint16_t msg_type;
+  uint16_t sender_id;
+  uint8_t len;
+  const uint8_t *data;
+} rtcm_msg_swift_proprietary_arena;
+
+/* SSR corrections with header.num_sats entries per array */
+typedef struct {
+  rtcm_msg_ssr_header header;
+  rtcm_msg_ssr_orbit_corr *orbit;
+} rtcm_msg_orbit_arena;
+
+typedef struct {
+  rtcm_msg_ssr_header header;
+  rtcm_msg_ssr_clock_corr *clock;
+} rtcm_msg_clock_arena;
+
+typedef struct {
+  rtcm_msg_ssr_header header;
+  rtcm_msg_ssr_orbit_corr *orbit;
+  rtcm_msg_ssr_clock_corr *clock;
+} rtcm_msg_orbit_clock_arena;
+
+typedef struct {
+  uint8_t sat_id;
+  uint8_t num_code_biases;
+  rtcm_msg_ssr_code_bias_sig *signals;
+} rtcm_msg_ssr_code_bias_sat_arena;
+
+typedef struct {
+  rtcm_msg_ssr_header header;
+  rtcm_msg_ssr_code_bias_sat_arena *sats;
+} rtcm_msg_code_bias_arena;
+
+typedef struct {
+  uint8_t sat_id;
+  uint8_t num_phase_biases;
+  uint16_t yaw_angle;
+  int8_t yaw_rate;
+  rtcm_msg_ssr_phase_bias_sig *signals;
+} rtcm_msg_ssr_phase_bias_sat_arena;
+
+typedef struct {
+  rtcm_msg_ssr_header header;
+  rtcm_msg_ssr_phase_bias_sat_arena *sats;
+} rtcm_msg_phase_bias_arena;
+
+void rtcm3_arena_init(rtcm3_arena *arena, void *buff, size_t size);
+void rtcm3_arena_reset(rtcm3_arena *arena);
+void *rtcm3_arena_alloc(rtcm3_arena *arena, size_t size);
+
+rtcm3_rc rtcm3_decode_1029_arena(const uint8_t buff[],
+                                 uint16_t len,
+                                 rtcm3_arena *arena,
+                                 rtcm_msg_1029_arena **msg);
+rtcm3_rc rtcm3_decode_1033_arena(const uint8_t buff[],
+                                 uint16_t len,
+                                 rtcm3_arena *arena,
+                                 rtcm_msg_1033_arena **msg);
+rtcm3_rc rtcm3_decode_4062_arena(const uint8_t buff[],
+                                 uint16_t len,
+                                 rtcm3_arena *arena,
+                                 rtcm_msg_swift_proprietary_arena **msg);
+rtcm3_rc rtcm3_decode_orbit_arena(const uint8_t buff[],
+                                  uint16_t len,
+                                  rtcm3_arena *arena,
+                                  rtcm_msg_orbit_arena **msg);
+rtcm3_rc rtcm3_decode_clock_arena(const uint8_t buff[],
+                                  uint16_t len,
+                                  rtcm3_arena *arena,
+                                  rtcm_msg_clock_arena **msg);
+rtcm3_rc rtcm3_decode_orbit_clock_arena(const uint8_t buff[],
+                                        uint16_t len,
+                                        rtcm3_arena *arena,
+                                        rtcm_msg_orbit_clock_arena **msg);
+rtcm3_rc rtcm3_decode_code_bias_arena(const uint8_t buff[],
+                                      uint16_t len,
+                                      rtcm3_arena *arena,
+                                      rtcm_msg_code_bias_arena **msg);
+rtcm3_rc rtcm3_decode_phase_bias_arena(const uint8_t buff[],
+                                       uint16_t len,
+                                       rtcm3_arena *arena,
+                                       rtcm_msg_phase_bias_arena **msg);
+rtcm3_rc rtcm3_decode_msm_arena(const uint8_t buff[],
+                                uint16_t len,
+                                rtcm3_arena *arena,
+                                rtcm_msm_compact **msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_ARENA_H */
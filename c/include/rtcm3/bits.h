@@ -17,8 +17,27 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 
+/** Cursor over a bit stream, see rtcm_bitreader_init() */
+typedef struct {
+  const uint8_t *buff;
+  uint32_t len; /* Length of the buffer in bits */
+  uint32_t pos; /* Current read position in bits */
+  bool overrun; /* Set once a read has gone past the end of the buffer */
+} rtcm_bitreader;
+
+/** Accumulating bit stream writer, see rtcm_bitwriter_init() */
+typedef struct {
+  uint8_t *buff;
+  uint32_t len;     /* Length of the buffer in bits */
+  uint32_t pos;     /* Position of the next bit to write */
+  uint64_t acc;     /* Bits not yet stored in the buffer, right aligned */
+  uint8_t acc_bits; /* Number of valid bits in acc */
+  bool overrun;     /* Set once a write did not fit in the buffer */
+} rtcm_bitwriter;
+
 uint32_t rtcm_getbitu(const uint8_t *buff, uint32_t pos, uint8_t len);
 uint64_t rtcm_getbitul(const uint8_t *buff, uint32_t pos, uint8_t len);
 int32_t rtcm_getbits(const uint8_t *buff, uint32_t pos, uint8_t len);
@@ -34,6 +53,31 @@ void rtcm_set_sign_magnitude_bit(uint8_t *buff,
                                     uint32_t pos,
                                     uint8_t len,
                                     int64_t data);
+
+void rtcm_bitreader_init(rtcm_bitreader *reader,
+                         const uint8_t *buff,
+                         uint32_t len_bytes);
+uint32_t rtcm_bitreader_remaining(const rtcm_bitreader *reader);
+void rtcm_read_skip(rtcm_bitreader *reader, uint32_t len);
+uint32_t rtcm_read_bitu(rtcm_bitreader *reader, uint8_t len);
+uint64_t rtcm_read_bitul(rtcm_bitreader *reader, uint8_t len);
+int32_t rtcm_read_bits(rtcm_bitreader *reader, uint8_t len);
+int64_t rtcm_read_bitsl(rtcm_bitreader *reader, uint8_t len);
+int32_t rtcm_read_sign_magnitude_bit(rtcm_bitreader *reader, uint8_t len);
+
+void rtcm_bitwriter_init(rtcm_bitwriter *writer,
+                         uint8_t *buff,
+                         uint32_t len_bytes,
+                         uint32_t pos);
+void rtcm_write_bitu(rtcm_bitwriter *writer, uint8_t len, uint32_t data);
+void rtcm_write_bitul(rtcm_bitwriter *writer, uint8_t len, uint64_t data);
+void rtcm_write_bits(rtcm_bitwriter *writer, uint8_t len, int32_t data);
+void rtcm_write_bitsl(rtcm_bitwriter *writer, uint8_t len, int64_t data);
+void rtcm_write_sign_magnitude_bit(rtcm_bitwriter *writer,
+                                   uint8_t len,
+                                   int64_t data);
+uint32_t rtcm_bitwriter_flush(rtcm_bitwriter *writer);
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,6 +16,7 @@
 #define PRUNIT_GPS 299792.458 /**< RTCM v3 Unit of GPS Pseudorange (m) */
 #define PRUNIT_GLO 599584.916 /**< RTCM v3 Unit of GLO Pseudorange (m) */
 #define RTCM_MAX_SATS 32
+#define RTCM3_MAX_MSG_LEN 1023 /* Maximum RTCM v3 message payload (bytes) */
 #define CP_INVALID 0xFFF80000      /* Unsigned bit pattern 0x80000 */
 #define PR_L1_INVALID 0xFFF80000   /* Unsigned bit pattern 0x80000 */
 #define PR_L2_INVALID 0xFFFFE000   /* Unsigned bit pattern 0x20000 */
@@ -25,7 +26,7 @@
 #define MSM_ROUGH_RANGE_INVALID 0xFF  /* Unsigned bit pattern 0xFF */
 #define MSM_ROUGH_RATE_INVALID 0x2000 /* Unsigned bit pattern 0x2000 */
 #define MSM_PR_INVALID (-16384)       /* Signed bit pattern 0x4000 */
-#define MSM_PR_EXT_INVALID (-8388608) /* Signed bit pattern 0x800000 */
+#define MSM_PR_EXT_INVALID (-524288)  /* Signed bit pattern 0x80000 */
 #define MSM_CP_INVALID (-2097152)     /* Signed bit pattern 0x200000 */
 #define MSM_CP_EXT_INVALID (-8388608) /* Signed bit pattern 0x800000 */
 #define MSM_DOP_INVALID (-16384)      /* Signed bit pattern 0x4000 */
@@ -69,6 +70,11 @@
 /** Constant difference of Beidou time from GPS time */
 #define BDS_SECOND_TO_GPS_SECOND 14
 
+/** Beidou GEO satellites are C01 to C05 and C59 to C63 */
+#define BEIDOU_GEOS_MAX_PRN 5
+#define BEIDOU_GEOS_EXT_MIN_PRN 59
+#define BEIDOU_GEOS_EXT_MAX_PRN 63
+
 /** The official GPS value of the speed of light in m / s.
  * \note This is the exact value of the speed of light in vacuum (by the
  * definition of meters). */
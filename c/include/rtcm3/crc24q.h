@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_CRC24Q_H
+#define SWIFTNAV_RTCM3_CRC24Q_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RTCM3_CRC24Q_INIT 0 /* Initial CRC value for an RTCM v3 frame */
+
+uint32_t rtcm3_crc24q(const uint8_t *buff, size_t len, uint32_t crc);
+uint32_t rtcm3_crc24q_table(const uint8_t *buff, size_t len, uint32_t crc);
+bool rtcm3_crc24q_accelerated(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_CRC24Q_H */
@@ -27,8 +27,11 @@ rtcm3_rc rtcm3_decode_1005(const uint8_t buff[], rtcm_msg_1005 *msg_1005);
 rtcm3_rc rtcm3_decode_1006(const uint8_t buff[], rtcm_msg_1006 *msg_1006);
 rtcm3_rc rtcm3_decode_1007(const uint8_t buff[], rtcm_msg_1007 *msg_1007);
 rtcm3_rc rtcm3_decode_1008(const uint8_t buff[], rtcm_msg_1008 *msg_1008);
+rtcm3_rc rtcm3_decode_1009(const uint8_t buff[], rtcm_obs_message *msg_1009);
 rtcm3_rc rtcm3_decode_1010(const uint8_t buff[], rtcm_obs_message *msg_1010);
+rtcm3_rc rtcm3_decode_1011(const uint8_t buff[], rtcm_obs_message *msg_1011);
 rtcm3_rc rtcm3_decode_1012(const uint8_t buff[], rtcm_obs_message *msg_1012);
+rtcm3_rc rtcm3_decode_1013(const uint8_t buff[], rtcm_msg_1013 *msg_1013);
 rtcm3_rc rtcm3_decode_1029(const uint8_t buff[], rtcm_msg_1029 *msg_1029);
 rtcm3_rc rtcm3_decode_1033(const uint8_t buff[], rtcm_msg_1033 *msg_1033);
 rtcm3_rc rtcm3_decode_1230(const uint8_t buff[], rtcm_msg_1230 *msg_1230);
@@ -38,6 +41,75 @@ rtcm3_rc rtcm3_decode_msm6(const uint8_t buff[], rtcm_msm_message *msg);
 rtcm3_rc rtcm3_decode_msm7(const uint8_t buff[], rtcm_msm_message *msg);
 rtcm3_rc rtcm3_decode_4062(const uint8_t buff[],
                            rtcm_msg_swift_proprietary *msg);
+rtcm3_rc rtcm3_decode_msm_columns(const uint8_t buff[],
+                                  uint16_t len,
+                                  rtcm_msm_header *header,
+                                  rtcm_msm_sat_data sats[],
+                                  rtcm_msm_signal_columns *cells);
+
+rtcm3_rc rtcm3_decode_1001_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1001);
+rtcm3_rc rtcm3_decode_1002_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1002);
+rtcm3_rc rtcm3_decode_1003_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1003);
+rtcm3_rc rtcm3_decode_1004_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1004);
+rtcm3_rc rtcm3_decode_1005_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1005 *msg_1005);
+rtcm3_rc rtcm3_decode_1006_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1006 *msg_1006);
+rtcm3_rc rtcm3_decode_1007_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1007 *msg_1007);
+rtcm3_rc rtcm3_decode_1008_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1008 *msg_1008);
+rtcm3_rc rtcm3_decode_1009_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1009);
+rtcm3_rc rtcm3_decode_1010_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1010);
+rtcm3_rc rtcm3_decode_1011_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1011);
+rtcm3_rc rtcm3_decode_1012_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1012);
+rtcm3_rc rtcm3_decode_1013_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1013 *msg_1013);
+rtcm3_rc rtcm3_decode_1029_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1029 *msg_1029);
+rtcm3_rc rtcm3_decode_1033_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1033 *msg_1033);
+rtcm3_rc rtcm3_decode_1230_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1230 *msg_1230);
+rtcm3_rc rtcm3_decode_msm4_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msm_message *msg);
+rtcm3_rc rtcm3_decode_msm5_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msm_message *msg);
+rtcm3_rc rtcm3_decode_msm6_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msm_message *msg);
+rtcm3_rc rtcm3_decode_msm7_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msm_message *msg);
+rtcm3_rc rtcm3_decode_4062_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_swift_proprietary *msg);
 
 double rtcm3_decode_lock_time(uint8_t lock);
 
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_DECODE_FRAME_H
+#define SWIFTNAV_RTCM3_DECODE_FRAME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rtcm3/constants.h>
+#include <rtcm3/messages.h>
+#include <rtcm3/sta_decode.h>
+
+/** Which member of rtcm3_any_msg holds the decoded message */
+typedef enum rtcm3_msg_kind_e {
+  RTCM3_MSG_NONE = 0,
+  RTCM3_MSG_OBS,         /* 1001-1004, 1009-1012 */
+  RTCM3_MSG_1005,
+  RTCM3_MSG_1006,
+  RTCM3_MSG_1007,
+  RTCM3_MSG_1008,
+  RTCM3_MSG_1029,
+  RTCM3_MSG_1033,
+  RTCM3_MSG_1230,
+  RTCM3_MSG_MSM,         /* MSM4-7 of all constellations */
+  RTCM3_MSG_EPH,         /* 1019, 1020, 1042, 1044, 1045, 1046 */
+  RTCM3_MSG_SSR_ORBIT,
+  RTCM3_MSG_SSR_CLOCK,
+  RTCM3_MSG_SSR_ORBIT_CLOCK,
+  RTCM3_MSG_SSR_CODE_BIAS,
+  RTCM3_MSG_SSR_PHASE_BIAS,
+  RTCM3_MSG_SWIFT_PROPRIETARY, /* 4062 */
+  RTCM3_MSG_STA_FW_VERSION,    /* 999 subtype 25 */
+  RTCM3_MSG_STA_RF_STATUS,     /* 999 subtype 24 */
+  RTCM3_MSG_1013,
+} rtcm3_msg_kind;
+
+/** Any decoded message, see rtcm3_decode_frame() */
+typedef struct {
+  uint16_t msg_num;    /* DF002 */
+  rtcm3_msg_kind kind; /* Selects the member of msg */
+  union {
+    rtcm_obs_message obs;
+    rtcm_msg_1005 msg_1005;
+    rtcm_msg_1006 msg_1006;
+    rtcm_msg_1007 msg_1007;
+    rtcm_msg_1008 msg_1008;
+    rtcm_msg_1013 msg_1013;
+    rtcm_msg_1029 msg_1029;
+    rtcm_msg_1033 msg_1033;
+    rtcm_msg_1230 msg_1230;
+    rtcm_msm_message msm;
+    rtcm_msg_eph eph;
+    rtcm_msg_orbit orbit;
+    rtcm_msg_clock clock;
+    rtcm_msg_orbit_clock orbit_clock;
+    rtcm_msg_code_bias code_bias;
+    rtcm_msg_phase_bias phase_bias;
+    rtcm_msg_swift_proprietary swift;
+    sta_rf_status rf_status;
+    char fw_version[RTCM_MAX_STRING_LEN];
+  } msg;
+} rtcm3_any_msg;
+
+#define RTCM3_PEEK_HAS_STN_ID 0x01   /* stn_id holds DF003 */
+#define RTCM3_PEEK_HAS_TIME 0x02     /* tow_ms holds the epoch time */
+#define RTCM3_PEEK_HAS_MULTIPLE 0x04 /* multiple holds DF005/DF393/DF388 */
+#define RTCM3_PEEK_HAS_SAT_ID 0x08   /* sat_id holds the ephemeris satellite */
+
+/** Fixed-offset header fields of a message, see rtcm3_peek_header() */
+typedef struct {
+  uint16_t msg_num;    /* DF002 */
+  rtcm3_msg_kind kind; /* What rtcm3_decode_frame() decodes it to */
+  rtcm_constellation_t cons; /* RTCM_CONSTELLATION_INVALID if not specific */
+  msm_enum msm_type;         /* MSM_UNKNOWN for non-MSM messages */
+  uint8_t flags;             /* RTCM3_PEEK_HAS_* */
+  uint16_t stn_id;           /* Reference station ID */
+  /* Epoch time in ms in the time system of the message: GPS, Galileo and
+   * BeiDou time of week or GLONASS time of day. SSR epochs are whole
+   * seconds. */
+  uint32_t tow_ms;
+  bool multiple;  /* More messages of the same epoch follow */
+  uint8_t sat_id; /* Satellite of an ephemeris message */
+} rtcm3_msg_peek;
+
+rtcm3_rc rtcm3_decode_frame(const uint8_t payload[],
+                            uint16_t len,
+                            rtcm3_any_msg *msg);
+rtcm3_rc rtcm3_peek_header(const uint8_t payload[],
+                           uint16_t len,
+                           rtcm3_msg_peek *peek);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_DECODE_FRAME_H */
@@ -23,6 +23,31 @@ extern "C" {
 #endif
 
 #include "rtcm3/messages.h"
+#include "rtcm3/msm_utils.h"
+
+/** Bit layout of an MSM4-7 message, it only depends on the message number
+ * and the masks. See rtcm3_msm_layout_init(). */
+typedef struct {
+  uint16_t msg_num;
+  msm_enum msm_type;
+  rtcm_constellation_t cons;
+  rtcm_msm_masks masks;
+  uint8_t num_sats;
+  uint8_t num_sigs;
+  uint8_t num_cells;
+  uint8_t cell_sat[MSM_MAX_CELLS]; /* Satellite index of each cell */
+  /* Bit offsets from the start of the message */
+  uint16_t sat_data_bit;
+  uint16_t signal_data_bit;
+  uint16_t pr_bit;   /* DF400/DF405 */
+  uint16_t cp_bit;   /* DF401/DF406 */
+  uint16_t lock_bit; /* DF402/DF407 */
+  uint16_t hca_bit;  /* DF420 */
+  uint16_t cnr_bit;  /* DF403/DF408 */
+  uint16_t dop_bit;  /* DF404, MSM5/7 only */
+  uint16_t num_bits;
+  uint16_t length; /* Message length in bytes */
+} rtcm_msm_layout;
 
 uint16_t rtcm3_encode_1001(const rtcm_obs_message *msg_1001, uint8_t buff[]);
 uint16_t rtcm3_encode_1002(const rtcm_obs_message *msg_1002, uint8_t buff[]);
@@ -32,18 +57,33 @@ uint16_t rtcm3_encode_1005(const rtcm_msg_1005 *msg_1005, uint8_t buff[]);
 uint16_t rtcm3_encode_1006(const rtcm_msg_1006 *msg_1006, uint8_t buff[]);
 uint16_t rtcm3_encode_1007(const rtcm_msg_1007 *msg_1007, uint8_t buff[]);
 uint16_t rtcm3_encode_1008(const rtcm_msg_1008 *msg_1008, uint8_t buff[]);
+uint16_t rtcm3_encode_1009(const rtcm_obs_message *msg_1009, uint8_t buff[]);
 uint16_t rtcm3_encode_1010(const rtcm_obs_message *msg_1010, uint8_t buff[]);
+uint16_t rtcm3_encode_1011(const rtcm_obs_message *msg_1011, uint8_t buff[]);
 uint16_t rtcm3_encode_1012(const rtcm_obs_message *msg_1012, uint8_t buff[]);
+uint16_t rtcm3_encode_1013(const rtcm_msg_1013 *msg_1013, uint8_t buff[]);
 uint16_t rtcm3_encode_1029(const rtcm_msg_1029 *msg_1029, uint8_t buff[]);
 uint16_t rtcm3_encode_1033(const rtcm_msg_1033 *msg_1033, uint8_t buff[]);
 uint16_t rtcm3_encode_1230(const rtcm_msg_1230 *msg_1230, uint8_t buff[]);
 uint16_t rtcm3_encode_msm4(const rtcm_msm_message *msg_msm4, uint8_t buff[]);
 uint16_t rtcm3_encode_msm5(const rtcm_msm_message *msg_msm5, uint8_t buff[]);
+uint16_t rtcm3_encode_msm6(const rtcm_msm_message *msg_msm6, uint8_t buff[]);
+uint16_t rtcm3_encode_msm7(const rtcm_msm_message *msg_msm7, uint8_t buff[]);
 uint16_t rtcm3_encode_4062(const rtcm_msg_swift_proprietary *msg,
                            uint8_t buff[]);
 
 uint8_t rtcm3_encode_lock_time(double time);
 
+bool rtcm3_msm_layout_init(uint16_t msg_num,
+                           const rtcm_msm_masks *masks,
+                           rtcm_msm_layout *layout);
+bool rtcm3_msm_layout_matches(const rtcm_msm_layout *layout,
+                              uint16_t msg_num,
+                              const rtcm_msm_masks *masks);
+uint16_t rtcm3_encode_msm_layout(const rtcm_msm_layout *layout,
+                                 const rtcm_msm_message *msg,
+                                 uint8_t buff[]);
+
 #ifdef __cplusplus
 }
 #endif
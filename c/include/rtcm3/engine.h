@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_ENGINE_H
+#define SWIFTNAV_RTCM3_ENGINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rtcm3/decode_frame.h"
+#include "rtcm3/framer.h"
+
+/* The engine is shared between threads and needs the GCC atomics */
+#if defined(__GNUC__) || defined(__clang__)
+#define RTCM3_ENGINE_AVAILABLE 1
+#endif
+
+#define RTCM3_ENGINE_DEFAULT_BUDGET 16 /* Frames per stream per turn */
+
+/** A decoded frame, see rtcm3_engine_peek() */
+typedef struct {
+  uint16_t msg_num; /* DF002 of the frame, also when decoding failed */
+  rtcm3_rc rc;      /* Result of rtcm3_decode_frame() */
+  rtcm3_any_msg msg;
+} rtcm3_engine_result;
+
+/** One input stream, decoded in order by one worker at a time.
+ *
+ * Input bytes and results each go through a single producer, single
+ * consumer ring: the feeding thread writes input_head, the worker holding
+ * the stream writes input_tail and results_head, the consuming thread
+ * writes results_tail. */
+typedef struct {
+  uint8_t *input;
+  uint32_t input_size; /* Bytes, a power of two */
+  uint32_t input_head;
+  uint32_t input_tail;
+  uint32_t chunk_len; /* Input handed to the framer and not yet released */
+  rtcm3_engine_result *results;
+  uint32_t results_size; /* Results, a power of two */
+  uint32_t results_head;
+  uint32_t results_tail;
+  uint32_t state; /* Whether the stream is queued or being decoded */
+  rtcm3_framer framer;
+} rtcm3_engine_stream;
+
+/** Work-stealing deque of stream numbers, pushed and popped at the bottom
+ * by its worker and stolen from the top by the others */
+typedef struct {
+  uint32_t *slots;
+  uint32_t size; /* A power of two, at least the number of streams */
+  int64_t top;
+  int64_t bottom;
+} rtcm3_engine_deque;
+
+/** Per worker thread state */
+typedef struct {
+  rtcm3_engine_deque deque;
+  uint32_t next_victim; /* Worker to try stealing from first */
+  uint64_t turns;       /* Streams decoded, pick ups and steals included */
+  uint64_t steals;      /* Streams taken from another worker */
+} rtcm3_engine_worker;
+
+/** Cell of the queue of streams made ready from outside the workers */
+typedef struct {
+  uint32_t seq;
+  uint32_t stream;
+} rtcm3_engine_cell;
+
+/** Bounded multi-producer, multi-consumer queue */
+typedef struct {
+  rtcm3_engine_cell *cells;
+  uint32_t size; /* A power of two, at least the number of streams */
+  uint32_t head;
+  uint32_t tail;
+} rtcm3_engine_queue;
+
+/** Decoder of many streams on a pool of worker threads, see
+ * rtcm3_engine_init() */
+typedef struct {
+  rtcm3_engine_stream *streams;
+  uint32_t num_streams;
+  rtcm3_engine_worker *workers;
+  uint32_t num_workers;
+  rtcm3_engine_queue ready; /* Streams made ready by feeds and consumers */
+  uint32_t budget; /* Frames decoded per turn before a stream is requeued */
+} rtcm3_engine;
+
+#ifdef RTCM3_ENGINE_AVAILABLE
+void rtcm3_engine_stream_init(rtcm3_engine_stream *stream,
+                              uint8_t input[],
+                              uint32_t input_size,
+                              rtcm3_engine_result results[],
+                              uint32_t results_size);
+void rtcm3_engine_worker_init(rtcm3_engine_worker *worker,
+                              uint32_t slots[],
+                              uint32_t size);
+void rtcm3_engine_init(rtcm3_engine *engine,
+                       rtcm3_engine_stream streams[],
+                       uint32_t num_streams,
+                       rtcm3_engine_worker workers[],
+                       uint32_t num_workers,
+                       rtcm3_engine_cell cells[],
+                       uint32_t num_cells);
+size_t rtcm3_engine_feed(rtcm3_engine *engine,
+                         uint32_t stream,
+                         const uint8_t *data,
+                         size_t len);
+uint32_t rtcm3_engine_work(rtcm3_engine *engine, uint32_t worker);
+const rtcm3_engine_result *rtcm3_engine_peek(rtcm3_engine *engine,
+                                             uint32_t stream);
+void rtcm3_engine_release(rtcm3_engine *engine, uint32_t stream);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_ENGINE_H */
@@ -14,7 +14,6 @@
 #define SWIFTNAV_RTCM3_EPH_DECODE_H
 
 #include <rtcm3/messages.h>
-#define BEIDOU_GEOS_MAX_PRN 5
 
 rtcm3_rc rtcm3_decode_gps_eph(const uint8_t buff[], rtcm_msg_eph *msg_eph);
 rtcm3_rc rtcm3_decode_glo_eph(const uint8_t buff[], rtcm_msg_eph *msg_eph);
@@ -23,4 +22,23 @@ rtcm3_rc rtcm3_decode_gal_eph_fnav(const uint8_t buff[], rtcm_msg_eph *msg_eph);
 rtcm3_rc rtcm3_decode_bds_eph(const uint8_t buff[], rtcm_msg_eph *msg_eph);
 rtcm3_rc rtcm3_decode_qzss_eph(const uint8_t buff[], rtcm_msg_eph *msg_eph);
 
+rtcm3_rc rtcm3_decode_gps_eph_bounded(const uint8_t buff[],
+                                      uint16_t len,
+                                      rtcm_msg_eph *msg_eph);
+rtcm3_rc rtcm3_decode_glo_eph_bounded(const uint8_t buff[],
+                                      uint16_t len,
+                                      rtcm_msg_eph *msg_eph);
+rtcm3_rc rtcm3_decode_gal_eph_inav_bounded(const uint8_t buff[],
+                                           uint16_t len,
+                                           rtcm_msg_eph *msg_eph);
+rtcm3_rc rtcm3_decode_gal_eph_fnav_bounded(const uint8_t buff[],
+                                           uint16_t len,
+                                           rtcm_msg_eph *msg_eph);
+rtcm3_rc rtcm3_decode_bds_eph_bounded(const uint8_t buff[],
+                                      uint16_t len,
+                                      rtcm_msg_eph *msg_eph);
+rtcm3_rc rtcm3_decode_qzss_eph_bounded(const uint8_t buff[],
+                                       uint16_t len,
+                                       rtcm_msg_eph *msg_eph);
+
 #endif /* SWIFTNAV_RTCM3_EPH_DECODE_H */
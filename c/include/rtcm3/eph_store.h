@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_EPH_STORE_H
+#define SWIFTNAV_RTCM3_EPH_STORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rtcm3/messages.h"
+
+/* Satellite IDs are at most 6 bits, 4 bits in QZSS 1044 */
+#define RTCM3_EPH_MAX_SATS 64
+/* Longest ephemeris message, BDS 1042, in bytes */
+#define RTCM3_EPH_MAX_BYTES 64
+
+/* Ephemeris messages. Each is stored apart, as the Galileo F/NAV and I/NAV
+ * ephemerides of one issue carry clock and group delay parameters for
+ * different frequency pairs (E5a and E5b). */
+typedef enum {
+  RTCM3_EPH_GPS = 0,  /* 1019 */
+  RTCM3_EPH_GLO,      /* 1020 */
+  RTCM3_EPH_BDS,      /* 1042 */
+  RTCM3_EPH_QZSS,     /* 1044 */
+  RTCM3_EPH_GAL_FNAV, /* 1045 */
+  RTCM3_EPH_GAL_INAV, /* 1046 */
+  RTCM3_EPH_MSG_COUNT
+} rtcm3_eph_msg;
+
+/** Ephemeris of one satellite from one message type */
+typedef struct {
+  bool valid;
+  uint32_t generation; /* Store generation of the last update */
+  uint16_t glo_day;    /* GLONASS day N_t (DF129) of the ephemeris */
+  rtcm_msg_eph eph;
+} rtcm3_eph_entry;
+
+typedef struct {
+  uint64_t repeats;   /* Messages identical to the last one, not decoded */
+  uint64_t unchanged; /* Decoded messages with a known issue of data */
+  uint64_t updates;   /* Decoded messages with a new issue of data */
+} rtcm3_eph_store_stats;
+
+/** Called for each new ephemeris with the message it came from, see
+ * rtcm3_eph_store_update() */
+typedef void (*rtcm3_eph_callback)(const rtcm_msg_eph *eph,
+                                   rtcm3_eph_msg source,
+                                   void *context);
+
+/** Ephemeris store keyed by message type and satellite ID, see
+ * rtcm3_eph_store_init() */
+typedef struct {
+  rtcm3_eph_entry sats[RTCM3_EPH_MSG_COUNT][RTCM3_EPH_MAX_SATS];
+  /* Last payload received per message and satellite, padding cleared */
+  uint8_t raw[RTCM3_EPH_MSG_COUNT][RTCM3_EPH_MAX_SATS][RTCM3_EPH_MAX_BYTES];
+  bool raw_valid[RTCM3_EPH_MSG_COUNT][RTCM3_EPH_MAX_SATS];
+  uint32_t generation; /* Incremented by every update */
+  rtcm3_eph_callback callback;
+  void *context;
+  rtcm3_eph_store_stats stats;
+} rtcm3_eph_store;
+
+void rtcm3_eph_store_init(rtcm3_eph_store *store,
+                          rtcm3_eph_callback callback,
+                          void *context);
+rtcm3_rc rtcm3_eph_store_update(rtcm3_eph_store *store,
+                                const uint8_t buff[],
+                                uint16_t len);
+const rtcm_msg_eph *rtcm3_eph_store_get(const rtcm3_eph_store *store,
+                                        rtcm_constellation_t constellation,
+                                        uint8_t sat_id);
+const rtcm_msg_eph *rtcm3_eph_store_get_msg(const rtcm3_eph_store *store,
+                                            rtcm3_eph_msg source,
+                                            uint8_t sat_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_EPH_STORE_H */
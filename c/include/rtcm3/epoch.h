@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_EPOCH_H
+#define SWIFTNAV_RTCM3_EPOCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rtcm3/decode_frame.h"
+#include "rtcm3/epoch_encode.h"
+#include "rtcm3/messages.h"
+
+/* Observations kept per station and epoch, further ones are dropped */
+#define RTCM3_EPOCH_MAX_OBS 256
+/* GPS - UTC in seconds, used to place GLONASS epochs in GPS time */
+#define RTCM3_EPOCH_DEFAULT_LEAP_SECONDS 18
+/* Messages up to this much older than the last epoch of a station are
+ * late, anything older is taken as a restart of the station's clock */
+#define RTCM3_EPOCH_LATE_WINDOW_MS 60000
+
+/** Why an epoch was passed to the callback */
+typedef enum rtcm3_epoch_end_e {
+  RTCM3_EPOCH_COMPLETE = 0, /* Message without DF393/DF005 set received */
+  RTCM3_EPOCH_TIMEOUT,      /* No final message within the timeout */
+  RTCM3_EPOCH_SUPERSEDED,   /* A message of a later epoch received first */
+  RTCM3_EPOCH_EVICTED,      /* Slot taken over by another station */
+  RTCM3_EPOCH_FLUSHED,      /* rtcm3_epoch_flush() called */
+  RTCM3_EPOCH_END_COUNT
+} rtcm3_epoch_end;
+
+/** Observations of one station at one epoch, see rtcm3_epoch_add() */
+typedef struct {
+  /* MSM type is that of the last MSM message, MSM_UNKNOWN if there was
+   * none. The observations belong to the slot and are only valid during
+   * the callback. */
+  rtcm_msm_epoch msm;
+  uint32_t gps_tod_ms;    /* Epoch time as GPS time of day */
+  uint8_t constellations; /* Bit i set if rtcm_constellation_t i was seen */
+  uint8_t num_msgs;       /* Messages that made up the epoch */
+  bool truncated;         /* Observations past RTCM3_EPOCH_MAX_OBS dropped */
+  rtcm3_epoch_end end;
+} rtcm3_epoch;
+
+/** Called once for each epoch */
+typedef void (*rtcm3_epoch_callback)(const rtcm3_epoch *epoch,
+                                     void *context);
+
+/** Epoch of one station, owned by the caller of rtcm3_epoch_init() */
+typedef struct {
+  bool in_use;
+  bool open;            /* `epoch` is being assembled */
+  bool have_last;       /* `last_tod_ms` is set */
+  uint16_t stn_id;
+  uint32_t last_tod_ms; /* GPS time of day of the last epoch passed on */
+  uint32_t opened_ms;   /* Caller time of the first message of `epoch` */
+  uint32_t used_ms;     /* Caller time of the last message */
+  rtcm3_epoch epoch;
+  rtcm_msm_obs obs[RTCM3_EPOCH_MAX_OBS];
+} rtcm3_epoch_slot;
+
+typedef struct {
+  uint64_t msgs; /* Messages added to an epoch */
+  uint64_t late; /* Messages of an epoch already passed on, dropped */
+  uint64_t epochs[RTCM3_EPOCH_END_COUNT]; /* Epochs passed on, per end */
+} rtcm3_epoch_stats;
+
+/** Groups observation messages into epochs, see rtcm3_epoch_init() */
+typedef struct {
+  rtcm3_epoch_slot *slots;
+  uint16_t num_slots;
+  uint32_t timeout_ms; /* 0 if epochs never time out */
+  int8_t leap_seconds; /* Defaults to RTCM3_EPOCH_DEFAULT_LEAP_SECONDS */
+  rtcm3_epoch_callback callback;
+  void *context;
+  rtcm3_epoch_stats stats;
+} rtcm3_epoch_assembler;
+
+void rtcm3_epoch_init(rtcm3_epoch_assembler *assembler,
+                      rtcm3_epoch_slot slots[],
+                      uint16_t num_slots,
+                      uint32_t timeout_ms,
+                      rtcm3_epoch_callback callback,
+                      void *context);
+rtcm3_rc rtcm3_epoch_add(rtcm3_epoch_assembler *assembler,
+                         const rtcm3_any_msg *msg,
+                         uint32_t now_ms);
+rtcm3_rc rtcm3_epoch_add_msm(rtcm3_epoch_assembler *assembler,
+                             const rtcm_msm_message *msg,
+                             uint32_t now_ms);
+rtcm3_rc rtcm3_epoch_add_obs(rtcm3_epoch_assembler *assembler,
+                             const rtcm_obs_message *msg,
+                             uint32_t now_ms);
+void rtcm3_epoch_tick(rtcm3_epoch_assembler *assembler, uint32_t now_ms);
+void rtcm3_epoch_flush(rtcm3_epoch_assembler *assembler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_EPOCH_H */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_EPOCH_ENCODE_H
+#define SWIFTNAV_RTCM3_EPOCH_ENCODE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rtcm3/messages.h"
+
+/** One signal observation, see rtcm3_encode_msm_epoch() */
+typedef struct {
+  rtcm_constellation_t cons;
+  uint8_t sat;     /* Satellite mask index, e.g. PRN - 1 for GPS */
+  uint8_t sig;     /* Signal mask index, i.e. signal id - 1 */
+  uint8_t glo_fcn; /* GLO frequency channel number + 7, MSM5/7 only */
+  rtcm_msm_signal_data data;
+} rtcm_msm_obs;
+
+/** Observations of all constellations at one epoch */
+typedef struct {
+  msm_enum msm_type; /* MSM4-7, used for every constellation */
+  uint16_t stn_id;
+  /* Constellation specific epoch time, as in rtcm_msm_header */
+  uint32_t tow_ms[RTCM_CONSTELLATION_COUNT];
+  uint8_t iods;
+  uint8_t steering;
+  uint8_t ext_clock;
+  uint8_t div_free;
+  uint8_t smooth;
+  uint16_t num_obs;
+  const rtcm_msm_obs *obs;
+} rtcm_msm_epoch;
+
+size_t rtcm3_encode_msm_epoch(const rtcm_msm_epoch *epoch,
+                              uint8_t buff[],
+                              size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_EPOCH_ENCODE_H */
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_FANOUT_H
+#define SWIFTNAV_RTCM3_FANOUT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rtcm3/framer.h"
+
+/** Identifies one encoded frame */
+typedef struct {
+  uint16_t stn_id;  /* Reference station ID DF003 */
+  uint32_t tow_ms;  /* Epoch time in the time system of msg_num */
+  uint16_t msg_num; /* Message number DF002 */
+  uint32_t options; /* Output options, defined by the caller */
+} rtcm3_fanout_key;
+
+/** Cache entry holding one complete frame */
+typedef struct {
+  rtcm3_fanout_key key;
+  uint32_t refs;      /* Number of holders of the frame */
+  uint16_t frame_len; /* 0 if the entry is free */
+  uint8_t frame[RTCM3_MAX_FRAME_LEN];
+} rtcm3_fanout_entry;
+
+typedef struct {
+  uint64_t hits;      /* Lookups served from the cache */
+  uint64_t misses;    /* Lookups that encoded a new frame */
+  uint64_t evictions; /* Frames dropped to make room or by age */
+  uint64_t failures;  /* Lookups that could not be served */
+} rtcm3_fanout_stats;
+
+/** Encode a message payload into `buff`, returning its length or 0 on
+ * failure. Typically a thin wrapper around one of the rtcm3_encode_*()
+ * functions. */
+typedef uint16_t (*rtcm3_fanout_encoder)(const void *msg, uint8_t buff[]);
+
+/** Cache of encoded frames shared between clients, see
+ * rtcm3_fanout_init() */
+typedef struct {
+  rtcm3_fanout_entry *entries;
+  uint16_t num_entries;
+  uint32_t max_age_ms; /* Age after which unheld frames are evicted */
+  int8_t leap_seconds; /* GPS-UTC, for the epochs of GLO keys */
+  rtcm3_fanout_stats stats;
+} rtcm3_fanout_cache;
+
+void rtcm3_fanout_init(rtcm3_fanout_cache *cache,
+                       rtcm3_fanout_entry entries[],
+                       uint16_t num_entries,
+                       uint32_t max_age_ms);
+const rtcm3_fanout_entry *rtcm3_fanout_get(rtcm3_fanout_cache *cache,
+                                           const rtcm3_fanout_key *key,
+                                           rtcm3_fanout_encoder encode,
+                                           const void *msg);
+void rtcm3_fanout_release(rtcm3_fanout_cache *cache,
+                          const rtcm3_fanout_entry *entry);
+uint16_t rtcm3_fanout_evict(rtcm3_fanout_cache *cache, uint32_t tow_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_FANOUT_H */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_FRAMER_H
+#define SWIFTNAV_RTCM3_FRAMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rtcm3/constants.h"
+#include "rtcm3/logging.h"
+
+#define RTCM3_PREAMBLE 0xD3
+#define RTCM3_FRAME_HEADER_LEN 3 /* Preamble, reserved bits and length */
+#define RTCM3_FRAME_CRC_LEN 3
+#define RTCM3_FRAME_OVERHEAD (RTCM3_FRAME_HEADER_LEN + RTCM3_FRAME_CRC_LEN)
+#define RTCM3_MAX_FRAME_LEN (RTCM3_MAX_MSG_LEN + RTCM3_FRAME_OVERHEAD)
+
+/** View of a complete, CRC validated frame.
+ *
+ * The pointers refer either to the chunk passed to rtcm3_framer_feed() or to
+ * the framer's internal buffer, and stay valid until the next call to
+ * rtcm3_framer_feed() or rtcm3_framer_next().
+ */
+typedef struct {
+  const uint8_t *frame;   /* Start of the frame, i.e. the preamble */
+  uint16_t frame_len;     /* Length of the frame including header and CRC */
+  const uint8_t *payload; /* Message payload, starting at DF002 */
+  uint16_t payload_len;   /* Length of the payload in bytes */
+  uint16_t msg_num;       /* DF002, or 0 if the payload is too short */
+} rtcm3_frame;
+
+typedef struct {
+  uint64_t frames;        /* Number of frames emitted */
+  uint64_t crc_errors;    /* Number of candidate frames failing the CRC */
+  uint64_t dropped_bytes; /* Number of input bytes not part of any frame */
+} rtcm3_framer_stats;
+
+/** Incremental RTCM v3 framer, see rtcm3_framer_init() */
+typedef struct {
+  const uint8_t *chunk; /* Data passed to the last rtcm3_framer_feed() */
+  size_t chunk_len;
+  size_t chunk_pos; /* Number of bytes of chunk consumed so far */
+  uint16_t partial_len;      /* Number of valid bytes in partial */
+  uint16_t partial_emitted; /* Leading bytes of partial returned as a frame */
+  uint8_t partial[RTCM3_MAX_FRAME_LEN]; /* Frame straddling chunks */
+  rtcm3_framer_stats stats;
+  const rtcm3_logger *logger; /* Gets the CRC errors of this stream, or NULL */
+} rtcm3_framer;
+
+void rtcm3_framer_init(rtcm3_framer *framer);
+void rtcm3_framer_feed(rtcm3_framer *framer, const uint8_t *data, size_t len);
+bool rtcm3_framer_next(rtcm3_framer *framer, rtcm3_frame *frame);
+uint16_t rtcm3_frame_finalize(uint8_t frame[], uint16_t payload_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_FRAMER_H */
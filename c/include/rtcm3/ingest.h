@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_INGEST_H
+#define SWIFTNAV_RTCM3_INGEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rtcm3/decode_frame.h"
+#include "rtcm3/framer.h"
+
+/* Linux only, built as the separate rtcm_ingest library */
+
+#define RTCM3_INGEST_NO_URING 0x01 /* Use epoll even if io_uring works */
+#define RTCM3_INGEST_NO_DECODE 0x02 /* Only frame, msg is always NULL */
+
+#define RTCM3_INGEST_MAX_DATAGRAMS 16 /* Datagrams per recvmmsg() */
+
+typedef enum rtcm3_ingest_backend_e {
+  RTCM3_INGEST_IO_URING = 0, /* Reads into registered buffers */
+  RTCM3_INGEST_EPOLL,        /* epoll, recvmmsg() for datagram sockets */
+} rtcm3_ingest_backend;
+
+/** Called for every frame received, and once with frame NULL when a
+ * stream ends. msg is the decoded frame, or NULL with
+ * RTCM3_INGEST_NO_DECODE. The frame and message are only valid during the
+ * call. */
+typedef void (*rtcm3_ingest_callback)(void *context,
+                                      uint32_t stream,
+                                      const rtcm3_frame *frame,
+                                      const rtcm3_any_msg *msg,
+                                      rtcm3_rc rc);
+
+/** A socket feeding one framer */
+typedef struct {
+  int fd;
+  bool active;     /* Between rtcm3_ingest_add() and the end or removal */
+  bool datagram;   /* SOCK_DGRAM, read with recvmmsg() by the epoll path */
+  bool pending;    /* An io_uring read is in flight */
+  int error;       /* errno of the read that ended the stream, 0 for EOF */
+  uint8_t *buff;   /* This stream's part of the ingest buffers */
+  uint64_t bytes;  /* Bytes received */
+  rtcm3_framer framer;
+} rtcm3_ingest_stream;
+
+/** io_uring rings as mapped from the kernel */
+typedef struct {
+  int fd;
+  bool fixed; /* Buffers are registered, reads use IORING_OP_READ_FIXED */
+  void *sq_ring;
+  size_t sq_ring_len;
+  void *cq_ring;
+  size_t cq_ring_len;
+  void *sqes;
+  size_t sqes_len;
+  uint32_t *sq_head;
+  uint32_t *sq_tail;
+  uint32_t *sq_mask;
+  uint32_t *sq_array;
+  uint32_t *cq_head;
+  uint32_t *cq_tail;
+  uint32_t *cq_mask;
+  void *cqes;
+  uint32_t entries;
+  uint32_t to_submit;
+  int64_t timeout[2]; /* Timespec of the timeout of a poll */
+} rtcm3_ingest_uring;
+
+/** Batched socket reader for many streams, see rtcm3_ingest_init() */
+typedef struct {
+  rtcm3_ingest_backend backend;
+  rtcm3_ingest_stream *streams;
+  uint32_t num_streams;
+  uint32_t buff_len; /* Bytes of buffer per stream */
+  uint32_t flags;    /* RTCM3_INGEST_* */
+  rtcm3_ingest_callback callback;
+  void *context;
+  rtcm3_ingest_uring uring;
+  int epoll_fd;
+  uint64_t syscalls; /* Reads, waits and submits made */
+  rtcm3_any_msg msg;
+} rtcm3_ingest;
+
+bool rtcm3_ingest_init(rtcm3_ingest *ingest,
+                       rtcm3_ingest_stream streams[],
+                       uint32_t num_streams,
+                       uint8_t buffers[],
+                       uint32_t buff_len,
+                       uint32_t flags,
+                       rtcm3_ingest_callback callback,
+                       void *context);
+void rtcm3_ingest_deinit(rtcm3_ingest *ingest);
+bool rtcm3_ingest_add(rtcm3_ingest *ingest, uint32_t stream, int fd);
+void rtcm3_ingest_remove(rtcm3_ingest *ingest, uint32_t stream);
+int rtcm3_ingest_poll(rtcm3_ingest *ingest, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_INGEST_H */
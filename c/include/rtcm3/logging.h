@@ -17,23 +17,9 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 
-#ifdef LIBRTCM_LOG_INTERNAL
-/*
- * from syslog.h
- */
-#define LOG_EMERG 0   /* system is unusable */
-#define LOG_ALERT 1   /* action must be taken immediately */
-#define LOG_CRIT 2    /* critical conditions */
-#define LOG_ERR 3     /* error conditions */
-#define LOG_WARNING 4 /* warning conditions */
-#define LOG_NOTICE 5  /* normal but significant condition */
-#define LOG_INFO 6    /* informational */
-#define LOG_DEBUG 7   /* debug-level messages */
-
-#endif /* RCTM_LOG_INTERNAL */
-
 typedef void (*rtcm_log_callback)(uint8_t level,
                                   uint8_t *msg,
                                   uint16_t len,
@@ -42,8 +28,88 @@ typedef void (*rtcm_log_callback)(uint8_t level,
 void rtcm_init_logging(rtcm_log_callback callback, void *context);
 void rtcm_log(uint8_t level, uint8_t *msg, uint16_t len);
 
+/* Highest level compiled in by RTCM3_LOG(), records above it cost nothing */
+#ifndef LIBRTCM_LOG_LEVEL
+#define LIBRTCM_LOG_LEVEL 7
+#endif
+
+/* Longer messages are truncated when queued in a ring */
+#define RTCM3_LOG_RECORD_LEN 120
+
+typedef struct {
+  uint16_t source; /* rtcm3_logger.source of the logger that queued it */
+  uint8_t level;
+  uint8_t len;
+  uint8_t msg[RTCM3_LOG_RECORD_LEN];
+} rtcm3_log_record;
+
+/** Single producer, single consumer queue of log records. One thread logs
+ * into it, another drains it with rtcm3_log_ring_drain(); neither takes a
+ * lock. Records logged while the ring is full are counted and dropped. */
+typedef struct {
+  rtcm3_log_record *records;
+  uint32_t size;    /* Number of records, a power of two */
+  uint32_t head;    /* Records queued, written by the producer */
+  uint32_t tail;    /* Records drained, written by the consumer */
+  uint32_t dropped; /* Written by the producer */
+} rtcm3_log_ring;
+
+/** Logger of one decoding context, e.g. one stream. Records go to the ring
+ * if there is one, otherwise to the callback. */
+typedef struct {
+  rtcm_log_callback callback;
+  void *context;
+  rtcm3_log_ring *ring;
+  uint16_t source;   /* Tag of the records queued in the ring */
+  uint8_t max_level; /* Records above this level are discarded */
+} rtcm3_logger;
+
+typedef void (*rtcm3_log_record_callback)(const rtcm3_log_record *record,
+                                          void *context);
+
+void rtcm3_logger_init(rtcm3_logger *logger,
+                       rtcm_log_callback callback,
+                       void *context);
+void rtcm3_log(const rtcm3_logger *logger,
+               uint8_t level,
+               const uint8_t *msg,
+               uint16_t len);
+void rtcm3_log_ring_init(rtcm3_log_ring *ring,
+                         rtcm3_log_record records[],
+                         uint32_t size);
+uint32_t rtcm3_log_ring_drain(rtcm3_log_ring *ring,
+                              rtcm3_log_record_callback callback,
+                              void *context,
+                              uint32_t max_records);
+
+/* Log through rtcm3_log() unless level is compiled out */
+#define RTCM3_LOG(logger, level, msg, len)        \
+  do {                                            \
+    if ((level) <= LIBRTCM_LOG_LEVEL) {           \
+      rtcm3_log((logger), (level), (msg), (len)); \
+    }                                             \
+  } while (false)
+
 #ifdef __cplusplus
 }
 #endif
 
 #endif /* SWIFTNAV_RTCM3_LOGGING_H */
+
+/* The level names are outside the include guard so that a source defining
+ * LIBRTCM_LOG_INTERNAL gets them even if another header included this one
+ * first */
+#if defined(LIBRTCM_LOG_INTERNAL) && !defined(LOG_EMERG)
+/*
+ * from syslog.h
+ */
+#define LOG_EMERG 0   /* system is unusable */
+#define LOG_ALERT 1   /* action must be taken immediately */
+#define LOG_CRIT 2    /* critical conditions */
+#define LOG_ERR 3     /* error conditions */
+#define LOG_WARNING 4 /* warning conditions */
+#define LOG_NOTICE 5  /* normal but significant condition */
+#define LOG_INFO 6    /* informational */
+#define LOG_DEBUG 7   /* debug-level messages */
+
+#endif /* RCTM_LOG_INTERNAL */
@@ -121,6 +121,26 @@ typedef struct {
   double range_rate_m_s;
 } rtcm_msm_signal_data;
 
+/* MSM signal data as columns, one entry per cell in cell mask order. The
+ * arrays are owned by the caller and hold MSM_MAX_CELLS entries each, the
+ * validity flags of cell i are bit i of the masks. */
+typedef struct {
+  uint8_t num_cells;
+  uint8_t *sat_index; /* Index of the cell's satellite in the sat data */
+  uint8_t *sig_index; /* Index of the cell's signal in the signal mask */
+  double *pseudorange_ms;
+  double *carrier_phase_ms;
+  double *range_rate_m_s;
+  double *cnr;
+  double *lock_time_s;
+  uint64_t valid_pr;
+  uint64_t valid_cp;
+  uint64_t valid_cnr;
+  uint64_t valid_lock;
+  uint64_t valid_dop;
+  uint64_t hca_indicator;
+} rtcm_msm_signal_columns;
+
 typedef struct {
   rtcm_obs_header header;
   rtcm_sat_data sats[RTCM_MAX_SATS];
@@ -167,6 +187,23 @@ typedef struct {
                                                char8(M) 8*M M <= 31*/
 } rtcm_msg_1008;
 
+/* Message entries of 1013, DF053 is 5 bits */
+#define RTCM_1013_MAX_MSGS 31
+typedef struct {
+  uint16_t msg_num;  /* Message ID DF055 uint12 12 */
+  uint8_t sync;      /* Message Sync Flag DF056 bit(1) 1 */
+  double interval_s; /* Message Transmission Interval DF057 uint16 16 */
+} rtcm_1013_msg_info;
+
+typedef struct {
+  uint16_t stn_id;         /* Reference Station ID DF003 uint12 12 */
+  uint16_t mjd_num;        /* Modified Julian Day Number DF051 uint16 16 */
+  uint32_t utc_sec_of_day; /* Seconds of Day (UTC) DF052 uint17 17 */
+  uint8_t n_msgs;          /* Number of Message Types DF053 uint5 5 */
+  uint8_t leap_seconds;    /* Leap Seconds, GPS-UTC DF054 uint8 8 */
+  rtcm_1013_msg_info msgs[RTCM_1013_MAX_MSGS];
+} rtcm_msg_1013;
+
 #define RTCM_1029_MAX_CODE_UNITS (255u)
 typedef struct {
   uint16_t stn_id;
@@ -366,6 +403,27 @@ typedef struct {
   rtcm_msg_ssr_phase_bias_sat sats[MAX_SSR_SATELLITES];
 } rtcm_msg_phase_bias;
 
+/* Sparse bias messages: the kept signals of satellite i are packed in
+ * signals[offsets[i]] to signals[offsets[i + 1] - 1]. The signal array is
+ * owned by the caller, see rtcm3_decode_code_bias_sparse(). */
+typedef struct {
+  rtcm_msg_ssr_header header;
+  uint8_t sat_id[MAX_SSR_SATELLITES];
+  uint16_t offsets[MAX_SSR_SATELLITES + 1];
+  rtcm_msg_ssr_code_bias_sig *signals;
+  uint16_t max_signals; /* Number of elements in signals */
+} rtcm_msg_code_bias_sparse;
+
+typedef struct {
+  rtcm_msg_ssr_header header;
+  uint8_t sat_id[MAX_SSR_SATELLITES];
+  uint16_t yaw_angle[MAX_SSR_SATELLITES];
+  int8_t yaw_rate[MAX_SSR_SATELLITES];
+  uint16_t offsets[MAX_SSR_SATELLITES + 1];
+  rtcm_msg_ssr_phase_bias_sig *signals;
+  uint16_t max_signals; /* Number of elements in signals */
+} rtcm_msg_phase_bias_sparse;
+
 /* Encodes a SBP message */
 typedef struct {
   uint16_t msg_type;
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_MSM_COMPACT_H
+#define SWIFTNAV_RTCM3_MSM_COMPACT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rtcm3/messages.h>
+#include <rtcm3/msm_utils.h>
+
+/* Alignment of rtcm_msm_compact, sizes are rounded up to a multiple of it so
+ * that messages can be stored back to back */
+#define RTCM_MSM_COMPACT_ALIGN 8
+
+/** MSM4-7 message holding the raw integer fields as sent, sized to the number
+ * of satellites and cells. The satellite and signal fields are stored after
+ * the struct, use rtcm3_msm_compact_size() for the number of bytes to
+ * reserve and rtcm3_msm_compact_expand() to get an rtcm_msm_message. */
+typedef struct {
+  uint16_t msg_num;  /* Msg Num DF002 uint16 12*/
+  uint16_t stn_id;   /* Station Id DF003 uint16 12*/
+  uint32_t tow_ms;   /* System-specific epoch time uint32 30 */
+  uint8_t multiple;  /* Multiple Message Bit DF393 bit(1) 1 */
+  uint8_t iods;      /* Issue of Data Station DF409 uint8 3 */
+  uint8_t reserved;  /* Reserved DF001 bit(7) 7 */
+  uint8_t steering;  /* Clock Steering Indicator DF411 uint2 2 */
+  uint8_t ext_clock; /* External Clock Indicator DF412 uint2 2 */
+  uint8_t div_free;  /* Divergance free flag DF417 bit(1) 1 */
+  uint8_t smooth;    /* GPS Smoothing Interval DF418 bit(3) 3 */
+  uint8_t num_sats;
+  uint8_t num_sigs;
+  uint8_t num_cells;
+  uint16_t size;          /* Bytes used, including the raw fields */
+  uint64_t hca_indicator; /* Half-cycle ambiguity DF420, one bit per cell */
+  rtcm_msm_masks masks;
+  int32_t data[]; /* Raw satellite and signal fields */
+} rtcm_msm_compact;
+
+uint16_t rtcm3_msm_compact_size(const uint8_t buff[], uint16_t len);
+rtcm3_rc rtcm3_decode_msm_compact(const uint8_t buff[],
+                                  uint16_t len,
+                                  rtcm_msm_compact *msg,
+                                  uint16_t size);
+rtcm3_rc rtcm3_msm_compact_expand(const rtcm_msm_compact *msg,
+                                  rtcm_msm_message *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_MSM_COMPACT_H */
@@ -19,10 +19,24 @@ extern "C" {
 
 #include <rtcm3/messages.h>
 
+/* MSM header masks packed one bit per entry, bit i of each mask is entry i
+ * of the corresponding rtcm_msm_header array */
+typedef struct {
+  uint64_t sats;  /* Satellite mask, bit 0 is the first satellite */
+  uint32_t sigs;  /* Signal mask, bit 0 is signal id 1 */
+  uint64_t cells; /* Cell mask, bit 0 is the first cell */
+} rtcm_msm_masks;
+
 msm_enum to_msm_type(uint16_t msg_num);
 rtcm_constellation_t to_constellation(uint16_t msg_num);
 uint8_t count_mask_values(uint8_t mask_size, const bool mask[]);
 uint8_t find_nth_mask_value(uint8_t mask_size, const bool mask[], uint8_t n);
+uint8_t count_mask_bits(uint64_t mask);
+uint8_t pop_first_mask_bit(uint64_t *mask);
+uint8_t find_nth_mask_bit(uint64_t mask, uint8_t n);
+uint64_t reverse_mask_bits(uint64_t mask, uint8_t mask_size);
+void msm_pack_masks(const rtcm_msm_header *header, rtcm_msm_masks *masks);
+void msm_unpack_masks(const rtcm_msm_masks *masks, rtcm_msm_header *header);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_OBS_CONVERT_H
+#define SWIFTNAV_RTCM3_OBS_CONVERT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rtcm3/messages.h"
+
+rtcm3_rc rtcm3_obs_to_msm(const rtcm_obs_message *obs,
+                          msm_enum msm_type,
+                          rtcm_msm_header *header,
+                          rtcm_msm_sat_data sats[],
+                          rtcm_msm_signal_columns *cells);
+rtcm3_rc rtcm3_msm_to_obs(const rtcm_msm_header *header,
+                          const rtcm_msm_sat_data sats[],
+                          const rtcm_msm_signal_columns *cells,
+                          rtcm_obs_message *obs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_OBS_CONVERT_H */
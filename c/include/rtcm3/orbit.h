@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_ORBIT_H
+#define SWIFTNAV_RTCM3_ORBIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "rtcm3/messages.h"
+
+/* Satellites held by a cache, enough for all the Keplerian constellations */
+#define RTCM3_ORBIT_MAX_SATS 192
+/* Newton iterations solving Kepler's equation, fixed so that the batched
+ * evaluation has no data dependent branches */
+#define RTCM3_ORBIT_KEPLER_ITERATIONS 8
+
+/** Scaled Keplerian orbit and clock parameters of a set of satellites,
+ * stored as one array per parameter. Converted once per satellite and
+ * issue of data by rtcm3_orbit_cache_add(). */
+typedef struct {
+  uint16_t num_sats;
+  uint32_t generation; /* Incremented by every conversion */
+
+  /* identification of each slot */
+  uint8_t constellation[RTCM3_ORBIT_MAX_SATS];
+  uint8_t sat_id[RTCM3_ORBIT_MAX_SATS];
+  uint16_t iode[RTCM3_ORBIT_MAX_SATS];
+  uint16_t iodc[RTCM3_ORBIT_MAX_SATS];
+  uint16_t wn[RTCM3_ORBIT_MAX_SATS];
+
+  /* times in GPS seconds of week, not wrapped */
+  double toe_s[RTCM3_ORBIT_MAX_SATS];
+  double toc_s[RTCM3_ORBIT_MAX_SATS];
+
+  /* orbit, angles in radians */
+  double a_m[RTCM3_ORBIT_MAX_SATS];         /* Semi-major axis */
+  double n_rad_s[RTCM3_ORBIT_MAX_SATS];     /* Corrected mean motion */
+  double ecc[RTCM3_ORBIT_MAX_SATS];
+  double sqrt_1_e2[RTCM3_ORBIT_MAX_SATS];   /* sqrt(1 - ecc^2) */
+  double m0[RTCM3_ORBIT_MAX_SATS];
+  double w[RTCM3_ORBIT_MAX_SATS];
+  double omega0_toe[RTCM3_ORBIT_MAX_SATS];  /* omega0 - OMEGA_E * toe */
+  double omega_dot_e[RTCM3_ORBIT_MAX_SATS]; /* omegadot - OMEGA_E, or
+                                             * omegadot for BDS GEO */
+  double inc[RTCM3_ORBIT_MAX_SATS];
+  double inc_dot[RTCM3_ORBIT_MAX_SATS];
+  double cuc[RTCM3_ORBIT_MAX_SATS];
+  double cus[RTCM3_ORBIT_MAX_SATS];
+  double crc_m[RTCM3_ORBIT_MAX_SATS];
+  double crs_m[RTCM3_ORBIT_MAX_SATS];
+  double cic[RTCM3_ORBIT_MAX_SATS];
+  double cis[RTCM3_ORBIT_MAX_SATS];
+  /* BDS GEO orbits are computed in an inertial frame tilted by -5 degrees
+   * about x, then turned by OMEGA_E * tk about z. Other slots have a rate
+   * of 0 and no tilt. */
+  double geo_rate[RTCM3_ORBIT_MAX_SATS];     /* OMEGA_E, or 0 */
+  double geo_cos_tilt[RTCM3_ORBIT_MAX_SATS]; /* cos(-5 degrees), or 1 */
+  double geo_sin_tilt[RTCM3_ORBIT_MAX_SATS]; /* sin(-5 degrees), or 0 */
+
+  /* clock in seconds */
+  double af0[RTCM3_ORBIT_MAX_SATS];
+  double af1[RTCM3_ORBIT_MAX_SATS];
+  double af2[RTCM3_ORBIT_MAX_SATS];
+  double rel_f[RTCM3_ORBIT_MAX_SATS]; /* F * ecc * sqrt(a), s / sin(E) */
+} rtcm3_orbit_cache;
+
+/** Earth-centered, Earth-fixed positions and clock offsets of all the
+ * satellites of a cache, by slot */
+typedef struct {
+  double x_m[RTCM3_ORBIT_MAX_SATS];
+  double y_m[RTCM3_ORBIT_MAX_SATS];
+  double z_m[RTCM3_ORBIT_MAX_SATS];
+  double clock_s[RTCM3_ORBIT_MAX_SATS]; /* Including the relativistic term */
+} rtcm3_orbit_states;
+
+void rtcm3_orbit_cache_init(rtcm3_orbit_cache *cache);
+rtcm3_rc rtcm3_orbit_cache_add(rtcm3_orbit_cache *cache,
+                               const rtcm_msg_eph *eph,
+                               uint16_t *slot);
+int32_t rtcm3_orbit_cache_find(const rtcm3_orbit_cache *cache,
+                               rtcm_constellation_t constellation,
+                               uint8_t sat_id);
+void rtcm3_orbit_cache_eval(const rtcm3_orbit_cache *cache,
+                            double gps_tow_s,
+                            rtcm3_orbit_states *states);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_ORBIT_H */
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_PASSTHROUGH_H
+#define SWIFTNAV_RTCM3_PASSTHROUGH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rtcm3/framer.h"
+
+#define RTCM3_MAX_MSG_NUM 4095
+
+/** Set of message numbers to forward, see rtcm3_msg_filter_init() */
+typedef struct {
+  uint8_t pass[(RTCM3_MAX_MSG_NUM + 8) / 8]; /* Bit per message number */
+  uint64_t forwarded; /* Frames forwarded by rtcm3_msg_filter_forward() */
+  uint64_t dropped;   /* Frames dropped by rtcm3_msg_filter_forward() */
+} rtcm3_msg_filter;
+
+bool rtcm3_msg_has_station_id(uint16_t msg_num);
+bool rtcm3_frame_set_station_id(uint8_t frame[],
+                                uint16_t frame_len,
+                                uint16_t stn_id);
+bool rtcm3_frame_set_msm_multiple(uint8_t frame[],
+                                  uint16_t frame_len,
+                                  bool multiple);
+
+void rtcm3_msg_filter_init(rtcm3_msg_filter *filter, bool pass_all);
+void rtcm3_msg_filter_set(rtcm3_msg_filter *filter,
+                          uint16_t msg_num,
+                          bool pass);
+bool rtcm3_msg_filter_passes(const rtcm3_msg_filter *filter,
+                             uint16_t msg_num);
+size_t rtcm3_msg_filter_forward(rtcm3_msg_filter *filter,
+                                rtcm3_framer *framer,
+                                uint8_t out[],
+                                size_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_PASSTHROUGH_H */
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_SIDECAR_H
+#define SWIFTNAV_RTCM3_SIDECAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rtcm3/archive.h"
+#include "rtcm3/passthrough.h"
+
+/* Sidecar index file, little endian throughout:
+ *
+ *   header   RTCM3_SIDECAR_HEADER_LEN bytes, see below
+ *   records  record_count * RTCM3_SIDECAR_RECORD_LEN bytes
+ *   stations n_stations * RTCM3_SIDECAR_GROUP_LEN byte directory, then the
+ *            station postings, 4 bytes each
+ *   types    n_types * RTCM3_SIDECAR_GROUP_LEN byte directory, then the
+ *            message type postings, 4 bytes each
+ *
+ * A journal, written while a stream is recorded, is the header and the
+ * records in file order. rtcm3_sidecar_build() turns it into a sorted index:
+ * records ordered by time scale, epoch and offset, with a posting list of
+ * record numbers for every station and message type. The directories are
+ * ordered by station ID or message number.
+ *
+ * Header: magic (8), version (2), flags (2), record_count (4),
+ * archive_len (8), records_offset (8), n_stations (4), n_types (4),
+ * stations_offset (8), types_offset (8), reserved (8).
+ *
+ * Record: archive offset (8), epoch_ms (8, signed), frame_len (2),
+ * msg_num (2), stn_id (2), flags (1), time scale (1).
+ *
+ * Group: key (2), reserved (2), first posting (4), posting count (4).
+ */
+#define RTCM3_SIDECAR_MAGIC "RTCM3IDX"
+#define RTCM3_SIDECAR_MAGIC_LEN 8
+#define RTCM3_SIDECAR_VERSION 1
+#define RTCM3_SIDECAR_HEADER_LEN 64
+#define RTCM3_SIDECAR_RECORD_LEN 24
+#define RTCM3_SIDECAR_GROUP_LEN 12
+#define RTCM3_SIDECAR_POSTING_LEN 4
+
+#define RTCM3_SIDECAR_SORTED 0x0001 /* Header flag of a built index */
+
+/** A sidecar record, see rtcm3_sidecar_record_at() */
+typedef struct {
+  uint64_t offset;    /* Offset of the frame in the archive */
+  int64_t epoch_ms;   /* Epoch with the rollovers unwrapped, see below */
+  uint16_t frame_len;
+  uint16_t msg_num;
+  uint16_t stn_id;    /* Valid if flags has RTCM3_ARCHIVE_HAS_STN_ID */
+  uint8_t flags;      /* RTCM3_ARCHIVE_HAS_* of the archive entry */
+  uint8_t timescale;  /* rtcm3_timescale */
+} rtcm3_sidecar_record;
+
+/* Epochs count from the start of the first week (GPS) or day (GLONASS) seen
+ * in the stream, so epoch_ms = rollovers * period + time of week or day.
+ * BeiDou times are moved to GPS time. */
+
+/** Writes the journal of a stream being recorded, see
+ * rtcm3_sidecar_writer_init() */
+typedef struct {
+  int64_t base_ms[3];  /* Epoch of the current week or day, per time scale */
+  int64_t last_ms[3];  /* Latest epoch, per time scale */
+  bool seen[3];        /* Whether base_ms and last_ms are set */
+  uint32_t record_count;
+  uint64_t archive_len; /* End of the last frame indexed */
+} rtcm3_sidecar_writer;
+
+/** A sidecar index or journal in memory, e.g. mapped with
+ * rtcm3_archive_map(), see rtcm3_sidecar_open() */
+typedef struct {
+  const uint8_t *data;
+  size_t len;
+  bool sorted;
+  uint32_t record_count;
+  uint64_t archive_len;
+  const uint8_t *records;
+  const uint8_t *stations; /* Directory, NULL for a journal */
+  uint32_t n_stations;
+  const uint8_t *station_postings;
+  uint32_t n_station_postings;
+  const uint8_t *types; /* Directory, NULL for a journal */
+  uint32_t n_types;
+  const uint8_t *type_postings;
+  uint32_t n_type_postings;
+} rtcm3_sidecar;
+
+/** Records to look up, see rtcm3_sidecar_find() */
+typedef struct {
+  uint16_t msg_num;     /* Message number, 0 for all */
+  bool by_station;      /* Only return records with stn_id */
+  uint16_t stn_id;
+  uint8_t timescale;    /* rtcm3_timescale, NONE for records of all times */
+  int64_t epoch_min_ms; /* Inclusive, unless timescale is NONE */
+  int64_t epoch_max_ms; /* Inclusive, unless timescale is NONE */
+} rtcm3_sidecar_query;
+
+/** Position of a lookup, see rtcm3_sidecar_find() */
+typedef struct {
+  rtcm3_sidecar_query query;
+  const uint8_t *postings; /* Posting list walked, NULL for the records */
+  uint32_t pos;
+  uint32_t end;
+} rtcm3_sidecar_cursor;
+
+/** Scratch space for rtcm3_sidecar_build() */
+typedef struct {
+  uint32_t stn_counts[RTCM3_MAX_MSG_NUM + 1];
+  uint32_t type_counts[RTCM3_MAX_MSG_NUM + 1];
+} rtcm3_sidecar_builder;
+
+void rtcm3_sidecar_writer_init(rtcm3_sidecar_writer *writer);
+bool rtcm3_sidecar_writer_resume(rtcm3_sidecar_writer *writer,
+                                 const rtcm3_sidecar *journal);
+uint16_t rtcm3_sidecar_write_header(const rtcm3_sidecar_writer *writer,
+                                    uint8_t buff[]);
+uint16_t rtcm3_sidecar_append(rtcm3_sidecar_writer *writer,
+                              const rtcm3_archive_entry *entry,
+                              uint8_t buff[]);
+
+size_t rtcm3_sidecar_max_len(uint32_t record_count);
+size_t rtcm3_sidecar_build(rtcm3_sidecar_builder *builder,
+                           rtcm3_sidecar_record records[],
+                           uint32_t record_count,
+                           uint64_t archive_len,
+                           uint8_t out[],
+                           size_t out_len);
+
+bool rtcm3_sidecar_open(rtcm3_sidecar *sidecar,
+                        const uint8_t *data,
+                        size_t len);
+bool rtcm3_sidecar_record_at(const rtcm3_sidecar *sidecar,
+                             uint32_t index,
+                             rtcm3_sidecar_record *record);
+void rtcm3_sidecar_find(const rtcm3_sidecar *sidecar,
+                        const rtcm3_sidecar_query *query,
+                        rtcm3_sidecar_cursor *cursor);
+bool rtcm3_sidecar_next(const rtcm3_sidecar *sidecar,
+                        rtcm3_sidecar_cursor *cursor,
+                        rtcm3_sidecar_record *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_SIDECAR_H */
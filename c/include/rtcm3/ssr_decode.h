@@ -24,4 +24,28 @@ rtcm3_rc rtcm3_decode_code_bias(const uint8_t buff[],
 rtcm3_rc rtcm3_decode_phase_bias(const uint8_t buff[],
                                  rtcm_msg_phase_bias *msg_phase_bias);
 
+rtcm3_rc rtcm3_decode_orbit_bounded(const uint8_t buff[],
+                                    uint16_t len,
+                                    rtcm_msg_orbit *msg_orbit);
+rtcm3_rc rtcm3_decode_clock_bounded(const uint8_t buff[],
+                                    uint16_t len,
+                                    rtcm_msg_clock *msg_clock);
+rtcm3_rc rtcm3_decode_orbit_clock_bounded(
+    const uint8_t buff[], uint16_t len, rtcm_msg_orbit_clock *msg_orbit_clock);
+rtcm3_rc rtcm3_decode_code_bias_bounded(const uint8_t buff[],
+                                        uint16_t len,
+                                        rtcm_msg_code_bias *msg_code_bias);
+rtcm3_rc rtcm3_decode_phase_bias_bounded(const uint8_t buff[],
+                                         uint16_t len,
+                                         rtcm_msg_phase_bias *msg_phase_bias);
+
+rtcm3_rc rtcm3_decode_code_bias_sparse(const uint8_t buff[],
+                                       uint16_t len,
+                                       uint32_t signal_mask,
+                                       rtcm_msg_code_bias_sparse *msg);
+rtcm3_rc rtcm3_decode_phase_bias_sparse(const uint8_t buff[],
+                                        uint16_t len,
+                                        uint32_t signal_mask,
+                                        rtcm_msg_phase_bias_sparse *msg);
+
 #endif /* SWIFTNAV_RTCM3_SSR_DECODE_H */
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_SSR_STATE_H
+#define SWIFTNAV_RTCM3_SSR_STATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rtcm3/messages.h"
+
+/* Corrections tracked per satellite */
+typedef enum {
+  RTCM_SSR_ORBIT = 0,
+  RTCM_SSR_CLOCK,
+  RTCM_SSR_CODE_BIAS,
+  RTCM_SSR_PHASE_BIAS,
+  RTCM_SSR_TYPE_COUNT
+} rtcm_ssr_type;
+
+/** Latest message sequence of one correction type */
+typedef struct {
+  bool valid;              /* At least one message has been received */
+  bool complete;           /* Last message of the epoch has been received */
+  uint32_t epoch_time;     /* Epoch time of the sequence DF385/DF386 */
+  uint8_t update_interval; /* SSR update interval DF391 */
+  uint8_t iod_ssr;         /* Records from another IOD SSR are dropped */
+} rtcm_ssr_type_state;
+
+/** Corrections of one satellite */
+typedef struct {
+  uint32_t generation; /* Store generation of the last change, 0 if unset */
+  uint8_t valid;       /* Bit 1 << rtcm_ssr_type per stored record */
+  uint32_t epoch_time[RTCM_SSR_TYPE_COUNT]; /* Epoch of each stored record */
+  rtcm_msg_ssr_orbit_corr orbit;
+  rtcm_msg_ssr_clock_corr clock;
+  rtcm_msg_ssr_code_bias_sat code_bias;
+  rtcm_msg_ssr_phase_bias_sat phase_bias;
+} rtcm_ssr_sat_state;
+
+/** Corrections of one constellation from one provider solution */
+typedef struct {
+  bool used;
+  uint8_t constellation;
+  uint16_t ssr_provider_id;
+  uint16_t ssr_solution_id;
+  uint32_t generation; /* Store generation of the last change */
+  rtcm_ssr_type_state types[RTCM_SSR_TYPE_COUNT];
+  rtcm_ssr_sat_state sats[MAX_SSR_SATELLITES]; /* Indexed by satellite ID */
+} rtcm_ssr_solution;
+
+/** SSR correction store, see rtcm3_ssr_state_init() */
+typedef struct {
+  rtcm_ssr_solution *solutions;
+  uint16_t num_solutions;
+  uint32_t generation; /* Incremented by every update that changes a record */
+} rtcm3_ssr_state;
+
+void rtcm3_ssr_state_init(rtcm3_ssr_state *state,
+                          rtcm_ssr_solution *solutions,
+                          uint16_t num_solutions);
+rtcm3_rc rtcm3_ssr_state_update(rtcm3_ssr_state *state,
+                                const uint8_t buff[],
+                                uint16_t len);
+const rtcm_ssr_solution *rtcm3_ssr_state_find(const rtcm3_ssr_state *state,
+                                              uint8_t constellation,
+                                              uint16_t ssr_provider_id,
+                                              uint16_t ssr_solution_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_SSR_STATE_H */
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef SWIFTNAV_RTCM3_STATS_H
+#define SWIFTNAV_RTCM3_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include <rtcm3/decode_frame.h>
+#include <rtcm3/messages.h>
+
+/* Message numbers with their own counters, the others share one slot */
+#define RTCM3_STATS_FIRST_MSG 1001
+#define RTCM3_STATS_LAST_MSG 1270
+#define RTCM3_STATS_SLOT_999 (RTCM3_STATS_LAST_MSG - RTCM3_STATS_FIRST_MSG + 1)
+#define RTCM3_STATS_SLOT_4062 (RTCM3_STATS_SLOT_999 + 1)
+#define RTCM3_STATS_SLOT_OTHER (RTCM3_STATS_SLOT_4062 + 1)
+#define RTCM3_STATS_NUM_SLOTS (RTCM3_STATS_SLOT_OTHER + 1)
+
+/* Latency histogram buckets: bucket i counts calls of 2^i to 2^(i+1) - 1
+ * ticks, the first one also counts 0 ticks and the last one everything
+ * above */
+#define RTCM3_STATS_HIST_BUCKETS 24
+
+typedef struct {
+  uint64_t messages;   /* Calls */
+  uint64_t bytes;      /* Payload bytes decoded or encoded */
+  uint64_t mismatches; /* RC_MESSAGE_TYPE_MISMATCH, or failed encodes */
+  uint64_t invalid;    /* RC_INVALID_MESSAGE */
+  uint64_t samples;    /* Timed calls */
+  uint64_t ticks;      /* Total time of the timed calls */
+  uint32_t hist[RTCM3_STATS_HIST_BUCKETS];
+} rtcm3_msg_counters;
+
+/** Time source for the latency samples, in any unit: rdtsc cycles,
+ * clock_gettime() nanoseconds, a hardware timer... */
+typedef uint64_t (*rtcm3_stats_clock)(void);
+
+/** Encode a message payload into `buff`, returning its length or 0 on
+ * failure, see rtcm3_encode_counted() */
+typedef uint16_t (*rtcm3_stats_encoder)(const void *msg, uint8_t buff[]);
+
+/** Decode and encode counters of one thread, see rtcm3_stats_init(). They
+ * are updated without atomics, so only the owning thread may touch them
+ * while it runs. */
+typedef struct {
+  rtcm3_msg_counters decode[RTCM3_STATS_NUM_SLOTS];
+  rtcm3_msg_counters encode[RTCM3_STATS_NUM_SLOTS];
+  rtcm3_stats_clock clock;  /* NULL when not timing */
+  uint32_t sample_interval; /* Time one call in this many, 0 for none */
+  uint32_t until_sample;    /* Calls left until the next timed one */
+} rtcm3_stats;
+
+void rtcm3_stats_init(rtcm3_stats *stats,
+                      rtcm3_stats_clock clock,
+                      uint32_t sample_interval);
+uint16_t rtcm3_stats_slot(uint16_t msg_num);
+uint16_t rtcm3_stats_slot_msg_num(uint16_t slot);
+rtcm3_rc rtcm3_decode_frame_counted(rtcm3_stats *stats,
+                                    const uint8_t payload[],
+                                    uint16_t len,
+                                    rtcm3_any_msg *msg);
+uint16_t rtcm3_encode_counted(rtcm3_stats *stats,
+                              uint16_t msg_num,
+                              rtcm3_stats_encoder encode,
+                              const void *msg,
+                              uint8_t buff[]);
+void rtcm3_stats_merge(rtcm3_stats *total, const rtcm3_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWIFTNAV_RTCM3_STATS_H */
@@ -0,0 +1,491 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* recvmmsg() */
+#define _GNU_SOURCE
+
+#include "rtcm3/ingest.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/* user_data of the requests that are not stream reads */
+#define TIMEOUT_DATA UINT64_MAX
+#define CANCEL_DATA (UINT64_MAX - 1)
+
+#define MAX_URING_ENTRIES 32768
+#define EPOLL_BATCH 64
+
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/* Frame and dispatch a chunk read from a stream, in place */
+static int deliver(rtcm3_ingest *ingest,
+                   uint32_t stream,
+                   const uint8_t *data,
+                   size_t len) {
+  rtcm3_ingest_stream *s = &ingest->streams[stream];
+  s->bytes += len;
+  rtcm3_framer_feed(&s->framer, data, len);
+  rtcm3_frame frame;
+  int frames = 0;
+  while (rtcm3_framer_next(&s->framer, &frame)) {
+    if (0 != (ingest->flags & RTCM3_INGEST_NO_DECODE)) {
+      ingest->callback(ingest->context, stream, &frame, NULL, RC_OK);
+    } else {
+      rtcm3_rc rc =
+          rtcm3_decode_frame(frame.payload, frame.payload_len, &ingest->msg);
+      ingest->callback(ingest->context, stream, &frame, &ingest->msg, rc);
+    }
+    frames++;
+  }
+  return frames;
+}
+
+/* A stream has reached EOF or failed */
+static void end_stream(rtcm3_ingest *ingest, uint32_t stream, int error) {
+  rtcm3_ingest_stream *s = &ingest->streams[stream];
+  if (RTCM3_INGEST_EPOLL == ingest->backend) {
+    epoll_ctl(ingest->epoll_fd, EPOLL_CTL_DEL, s->fd, NULL);
+  }
+  s->active = false;
+  s->error = error;
+  ingest->callback(ingest->context, stream, NULL, NULL, RC_OK);
+}
+
+/* io_uring, through the raw system calls */
+
+static int uring_enter(rtcm3_ingest *ingest,
+                       uint32_t to_submit,
+                       uint32_t min_complete) {
+  ingest->syscalls++;
+  return (int)syscall(__NR_io_uring_enter,
+                      ingest->uring.fd,
+                      to_submit,
+                      min_complete,
+                      min_complete > 0 ? IORING_ENTER_GETEVENTS : 0,
+                      NULL,
+                      0);
+}
+
+static void uring_unmap(rtcm3_ingest_uring *u) {
+  if (NULL != u->sqes) {
+    munmap(u->sqes, u->sqes_len);
+  }
+  if (NULL != u->cq_ring && u->cq_ring != u->sq_ring) {
+    munmap(u->cq_ring, u->cq_ring_len);
+  }
+  if (NULL != u->sq_ring) {
+    munmap(u->sq_ring, u->sq_ring_len);
+  }
+  if (u->fd >= 0) {
+    close(u->fd);
+  }
+  memset(u, 0, sizeof(*u));
+  u->fd = -1;
+}
+
+static void *map_ring(int fd, size_t len, off_t offset) {
+  void *ring =
+      mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+           offset);
+  return MAP_FAILED == ring ? NULL : ring;
+}
+
+static bool uring_init(rtcm3_ingest *ingest, uint8_t buffers[], size_t len) {
+  rtcm3_ingest_uring *u = &ingest->uring;
+  /* a read per stream, a cancel and a timeout */
+  uint32_t entries = 1;
+  while (entries < ingest->num_streams + 2) {
+    entries *= 2;
+  }
+  if (entries > MAX_URING_ENTRIES) {
+    return false;
+  }
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  u->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (u->fd < 0) {
+    return false;
+  }
+  u->entries = params.sq_entries;
+  u->sq_ring_len = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  u->cq_ring_len =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single = 0 != (params.features & IORING_FEAT_SINGLE_MMAP);
+  if (single && u->cq_ring_len > u->sq_ring_len) {
+    u->sq_ring_len = u->cq_ring_len;
+  }
+  u->sq_ring = map_ring(u->fd, u->sq_ring_len, IORING_OFF_SQ_RING);
+  u->cq_ring = single ? u->sq_ring
+                      : map_ring(u->fd, u->cq_ring_len, IORING_OFF_CQ_RING);
+  u->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+  u->sqes = map_ring(u->fd, u->sqes_len, IORING_OFF_SQES);
+  if (NULL == u->sq_ring || NULL == u->cq_ring || NULL == u->sqes) {
+    uring_unmap(u);
+    return false;
+  }
+  uint8_t *sq = u->sq_ring;
+  uint8_t *cq = u->cq_ring;
+  u->sq_head = (uint32_t *)(void *)(sq + params.sq_off.head);
+  u->sq_tail = (uint32_t *)(void *)(sq + params.sq_off.tail);
+  u->sq_mask = (uint32_t *)(void *)(sq + params.sq_off.ring_mask);
+  u->sq_array = (uint32_t *)(void *)(sq + params.sq_off.array);
+  u->cq_head = (uint32_t *)(void *)(cq + params.cq_off.head);
+  u->cq_tail = (uint32_t *)(void *)(cq + params.cq_off.tail);
+  u->cq_mask = (uint32_t *)(void *)(cq + params.cq_off.ring_mask);
+  u->cqes = cq + params.cq_off.cqes;
+
+  /* one registered buffer covering every stream, reads pick their part of
+   * it by address */
+  struct iovec iov = {buffers, len};
+  u->fixed = 0 == syscall(__NR_io_uring_register,
+                          u->fd,
+                          IORING_REGISTER_BUFFERS,
+                          &iov,
+                          1);
+  return true;
+}
+
+/* Next free submission entry, submitting the queue first if it is full */
+static struct io_uring_sqe *uring_sqe(rtcm3_ingest *ingest) {
+  rtcm3_ingest_uring *u = &ingest->uring;
+  uint32_t tail = *u->sq_tail;
+  while (tail - LOAD_ACQUIRE(u->sq_head) >= u->entries) {
+    int ret = uring_enter(ingest, u->to_submit, 0);
+    if (ret < 0 && EINTR != errno) {
+      return NULL;
+    }
+    u->to_submit -= ret > 0 ? (uint32_t)ret : 0;
+  }
+  uint32_t index = tail & *u->sq_mask;
+  struct io_uring_sqe *sqe = &((struct io_uring_sqe *)u->sqes)[index];
+  memset(sqe, 0, sizeof(*sqe));
+  u->sq_array[index] = index;
+  STORE_RELEASE(u->sq_tail, tail + 1);
+  u->to_submit++;
+  return sqe;
+}
+
+/* Queue a read into the stream's buffer, submitted by the next poll */
+static bool uring_read(rtcm3_ingest *ingest, uint32_t stream) {
+  rtcm3_ingest_stream *s = &ingest->streams[stream];
+  struct io_uring_sqe *sqe = uring_sqe(ingest);
+  if (NULL == sqe) {
+    return false;
+  }
+  sqe->opcode = ingest->uring.fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+  sqe->fd = s->fd;
+  sqe->addr = (uint64_t)(uintptr_t)s->buff;
+  sqe->len = ingest->buff_len;
+  sqe->buf_index = 0;
+  sqe->user_data = stream;
+  s->pending = true;
+  return true;
+}
+
+static void uring_complete(rtcm3_ingest *ingest,
+                           uint64_t user_data,
+                           int32_t res,
+                           int *frames) {
+  if (user_data >= ingest->num_streams) {
+    /* timeouts and cancels */
+    return;
+  }
+  uint32_t stream = (uint32_t)user_data;
+  rtcm3_ingest_stream *s = &ingest->streams[stream];
+  s->pending = false;
+  if (!s->active) {
+    return;
+  }
+  if (res > 0) {
+    *frames += deliver(ingest, stream, s->buff, (size_t)res);
+  } else if (0 == res) {
+    end_stream(ingest, stream, 0);
+  } else if (-EINTR != res && -EAGAIN != res) {
+    end_stream(ingest, stream, -res);
+  }
+  /* the callback may have removed the stream */
+  if (s->active && !uring_read(ingest, stream)) {
+    end_stream(ingest, stream, errno);
+  }
+}
+
+static int uring_poll(rtcm3_ingest *ingest, int timeout_ms) {
+  rtcm3_ingest_uring *u = &ingest->uring;
+  if (timeout_ms > 0) {
+    struct io_uring_sqe *sqe = uring_sqe(ingest);
+    if (NULL == sqe) {
+      return -1;
+    }
+    u->timeout[0] = timeout_ms / 1000;
+    u->timeout[1] = (int64_t)(timeout_ms % 1000) * 1000000;
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = (uint64_t)(uintptr_t)u->timeout;
+    sqe->len = 1;
+    sqe->off = 1; /* or after the first completion */
+    sqe->user_data = TIMEOUT_DATA;
+  }
+  uint32_t head = *u->cq_head;
+  uint32_t min_complete =
+      0 != timeout_ms && head == LOAD_ACQUIRE(u->cq_tail) ? 1 : 0;
+  if (u->to_submit > 0 || min_complete > 0) {
+    int ret = uring_enter(ingest, u->to_submit, min_complete);
+    if (ret < 0 && EINTR != errno && ETIME != errno) {
+      return -1;
+    }
+    u->to_submit -= ret > 0 ? (uint32_t)ret : 0;
+  }
+
+  /* one pass over everything that completed, reads are requeued and go
+   * out together with the next poll */
+  int frames = 0;
+  uint32_t tail = LOAD_ACQUIRE(u->cq_tail);
+  const struct io_uring_cqe *cqes = u->cqes;
+  for (; head != tail; head++) {
+    const struct io_uring_cqe *cqe = &cqes[head & *u->cq_mask];
+    uint64_t user_data = cqe->user_data;
+    int32_t res = cqe->res;
+    STORE_RELEASE(u->cq_head, head + 1);
+    uring_complete(ingest, user_data, res, &frames);
+  }
+  return frames;
+}
+
+/* epoll, a read per ready socket */
+
+static int epoll_read(rtcm3_ingest *ingest, uint32_t stream) {
+  rtcm3_ingest_stream *s = &ingest->streams[stream];
+  if (!s->datagram) {
+    ingest->syscalls++;
+    ssize_t n = recv(s->fd, s->buff, ingest->buff_len, MSG_DONTWAIT);
+    if (n > 0) {
+      return deliver(ingest, stream, s->buff, (size_t)n);
+    }
+    if (0 == n) {
+      end_stream(ingest, stream, 0);
+    } else if (EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno) {
+      end_stream(ingest, stream, errno);
+    }
+    return 0;
+  }
+
+  /* datagrams go into equal slices of the stream buffer */
+  uint32_t slice = ingest->buff_len / RTCM3_INGEST_MAX_DATAGRAMS;
+  struct mmsghdr msgs[RTCM3_INGEST_MAX_DATAGRAMS];
+  struct iovec iovs[RTCM3_INGEST_MAX_DATAGRAMS];
+  memset(msgs, 0, sizeof(msgs));
+  for (uint32_t i = 0; i < RTCM3_INGEST_MAX_DATAGRAMS; i++) {
+    iovs[i].iov_base = s->buff + i * slice;
+    iovs[i].iov_len = slice;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  ingest->syscalls++;
+  int n = recvmmsg(s->fd, msgs, RTCM3_INGEST_MAX_DATAGRAMS, MSG_DONTWAIT, NULL);
+  if (n < 0) {
+    if (EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno) {
+      end_stream(ingest, stream, errno);
+    }
+    return 0;
+  }
+  int frames = 0;
+  for (int i = 0; i < n && s->active; i++) {
+    frames += deliver(ingest, stream, iovs[i].iov_base, msgs[i].msg_len);
+  }
+  return frames;
+}
+
+static int epoll_poll(rtcm3_ingest *ingest, int timeout_ms) {
+  struct epoll_event events[EPOLL_BATCH];
+  ingest->syscalls++;
+  int n = epoll_wait(ingest->epoll_fd, events, EPOLL_BATCH, timeout_ms);
+  if (n < 0) {
+    return EINTR == errno ? 0 : -1;
+  }
+  int frames = 0;
+  for (int i = 0; i < n; i++) {
+    uint32_t stream = events[i].data.u32;
+    if (stream < ingest->num_streams && ingest->streams[stream].active) {
+      frames += epoll_read(ingest, stream);
+    }
+  }
+  return frames;
+}
+
+/** Set up batched reading of many sockets.
+ *
+ * io_uring is used when the kernel allows it, with the buffers registered
+ * if the memory lock limit allows, otherwise epoll. Each stream reads into
+ * its own buff_len bytes of buffers, and frames are handed to the callback
+ * as views into them, decoded with rtcm3_decode_frame() unless
+ * RTCM3_INGEST_NO_DECODE is set.
+ *
+ * \param ingest Ingest to initialize
+ * \param streams Stream slots
+ * \param num_streams Number of stream slots
+ * \param buffers num_streams * buff_len bytes of read buffers
+ * \param buff_len Buffer size per stream
+ * \param flags RTCM3_INGEST_* flags
+ * \param callback Called with every frame received
+ * \param context Passed to the callback
+ * \return true on success, false with errno set if neither io_uring nor
+ *         epoll could be set up
+ */
+bool rtcm3_ingest_init(rtcm3_ingest *ingest,
+                       rtcm3_ingest_stream streams[],
+                       uint32_t num_streams,
+                       uint8_t buffers[],
+                       uint32_t buff_len,
+                       uint32_t flags,
+                       rtcm3_ingest_callback callback,
+                       void *context) {
+  assert(ingest);
+  assert(streams && num_streams > 0);
+  assert(buffers && buff_len >= RTCM3_INGEST_MAX_DATAGRAMS);
+  assert(callback);
+  memset(ingest, 0, sizeof(*ingest));
+  ingest->streams = streams;
+  ingest->num_streams = num_streams;
+  ingest->buff_len = buff_len;
+  ingest->flags = flags;
+  ingest->callback = callback;
+  ingest->context = context;
+  ingest->uring.fd = -1;
+  ingest->epoll_fd = -1;
+  for (uint32_t i = 0; i < num_streams; i++) {
+    memset(&streams[i], 0, sizeof(streams[i]));
+    streams[i].fd = -1;
+    streams[i].buff = buffers + (size_t)i * buff_len;
+    rtcm3_framer_init(&streams[i].framer);
+  }
+
+  if (0 == (flags & RTCM3_INGEST_NO_URING) &&
+      uring_init(ingest, buffers, (size_t)num_streams * buff_len)) {
+    ingest->backend = RTCM3_INGEST_IO_URING;
+    return true;
+  }
+  ingest->backend = RTCM3_INGEST_EPOLL;
+  ingest->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  return ingest->epoll_fd >= 0;
+}
+
+/** Release the kernel resources of an ingest. The sockets are not closed.
+ *
+ * \param ingest Ingest
+ */
+void rtcm3_ingest_deinit(rtcm3_ingest *ingest) {
+  assert(ingest);
+  if (RTCM3_INGEST_IO_URING == ingest->backend) {
+    uring_unmap(&ingest->uring);
+  } else if (ingest->epoll_fd >= 0) {
+    close(ingest->epoll_fd);
+    ingest->epoll_fd = -1;
+  }
+}
+
+/** Start reading a socket into a stream slot.
+ *
+ * The framer of the slot starts afresh.
+ *
+ * \param ingest Ingest
+ * \param stream Slot number
+ * \param fd Connected stream or datagram socket
+ * \return true on success, false with errno set, EBUSY if the slot is in
+ *         use or a cancelled read has not completed yet
+ */
+bool rtcm3_ingest_add(rtcm3_ingest *ingest, uint32_t stream, int fd) {
+  assert(ingest);
+  assert(stream < ingest->num_streams);
+  rtcm3_ingest_stream *s = &ingest->streams[stream];
+  if (s->active || s->pending) {
+    errno = EBUSY;
+    return false;
+  }
+  int type = 0;
+  socklen_t type_len = sizeof(type);
+  s->datagram =
+      0 == getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &type_len) &&
+      SOCK_DGRAM == type;
+  s->fd = fd;
+  s->error = 0;
+  s->bytes = 0;
+  rtcm3_framer_init(&s->framer);
+  if (RTCM3_INGEST_IO_URING == ingest->backend) {
+    if (!uring_read(ingest, stream)) {
+      return false;
+    }
+  } else {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = stream;
+    if (0 != epoll_ctl(ingest->epoll_fd, EPOLL_CTL_ADD, fd, &event)) {
+      return false;
+    }
+  }
+  s->active = true;
+  return true;
+}
+
+/** Stop reading a stream. No more frames of it are delivered, and the
+ * socket may be closed right away.
+ *
+ * \param ingest Ingest
+ * \param stream Slot number
+ */
+void rtcm3_ingest_remove(rtcm3_ingest *ingest, uint32_t stream) {
+  assert(ingest);
+  assert(stream < ingest->num_streams);
+  rtcm3_ingest_stream *s = &ingest->streams[stream];
+  if (!s->active) {
+    return;
+  }
+  s->active = false;
+  if (RTCM3_INGEST_EPOLL == ingest->backend) {
+    epoll_ctl(ingest->epoll_fd, EPOLL_CTL_DEL, s->fd, NULL);
+  } else if (s->pending) {
+    struct io_uring_sqe *sqe = uring_sqe(ingest);
+    if (NULL != sqe) {
+      sqe->opcode = IORING_OP_ASYNC_CANCEL;
+      sqe->addr = stream;
+      sqe->user_data = CANCEL_DATA;
+    }
+  }
+}
+
+/** Read whatever the sockets have and dispatch the frames.
+ *
+ * With io_uring the reads of all streams are submitted and reaped with
+ * one system call per poll. With epoll there is a wait, then one read,
+ * or one recvmmsg() of datagrams, per ready socket.
+ *
+ * \param ingest Ingest
+ * \param timeout_ms Longest wait for data, 0 to not wait, -1 to wait
+ *                   until there is some
+ * \return Number of frames delivered, or -1 with errno set on failure
+ */
+int rtcm3_ingest_poll(rtcm3_ingest *ingest, int timeout_ms) {
+  assert(ingest);
+  if (RTCM3_INGEST_IO_URING == ingest->backend) {
+    return uring_poll(ingest, timeout_ms);
+  }
+  return epoll_poll(ingest, timeout_ms);
+}
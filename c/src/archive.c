@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/archive.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "rtcm3/msm_utils.h"
+
+/** Fill in an archive entry for a frame.
+ *
+ * The station ID and epoch time are read from the message header by
+ * rtcm3_peek_header() where the message type has them. This is what
+ * rtcm3_archive_index() stores for each frame, and lets a live recorder
+ * index frames as it writes them.
+ *
+ * \param frame Complete frame, e.g. from rtcm3_framer_next()
+ * \param offset Offset of the frame in the recorded stream
+ * \param entry Set to the entry of the frame
+ */
+void rtcm3_archive_read_entry(const rtcm3_frame *frame,
+                              uint64_t offset,
+                              rtcm3_archive_entry *entry) {
+  assert(frame);
+  assert(entry);
+  memset(entry, 0, sizeof(*entry));
+  entry->offset = offset;
+  entry->frame_len = frame->frame_len;
+  entry->msg_num = frame->msg_num;
+  rtcm3_msg_peek peek;
+  rtcm3_peek_header(frame->payload, frame->payload_len, &peek);
+  if (peek.flags & RTCM3_PEEK_HAS_STN_ID) {
+    entry->stn_id = peek.stn_id;
+    entry->flags |= RTCM3_ARCHIVE_HAS_STN_ID;
+  }
+  if (peek.flags & RTCM3_PEEK_HAS_TIME) {
+    entry->time_ms = peek.tow_ms;
+    entry->flags |= RTCM3_ARCHIVE_HAS_TIME;
+  }
+}
+
+/* Time scale of the epoch of a message, and whether it is BeiDou time */
+static rtcm3_timescale timescale_of(uint16_t msg_num, bool *bds) {
+  *bds = false;
+  if ((msg_num >= 1009 && msg_num <= 1012) ||
+      (msg_num >= 1063 && msg_num <= 1068) || 1266 == msg_num) {
+    return RTCM3_TIMESCALE_GLO;
+  }
+  if (MSM_UNKNOWN != to_msm_type(msg_num)) {
+    rtcm_constellation_t cons = to_constellation(msg_num);
+    if (RTCM_CONSTELLATION_GLO == cons) {
+      return RTCM3_TIMESCALE_GLO;
+    }
+    *bds = RTCM_CONSTELLATION_BDS == cons;
+  } else {
+    *bds = (msg_num >= 1258 && msg_num <= 1263) || 1270 == msg_num;
+  }
+  return RTCM3_TIMESCALE_GPS;
+}
+
+/** Get the epoch time of an entry in its time scale.
+ *
+ * GLONASS messages are in GLONASS time of day, all others in GPS time of
+ * week, with BeiDou times moved to GPS time. Times from different time
+ * scales are not comparable.
+ *
+ * \param entry Archive entry
+ * \param timescale Set to the rtcm3_timescale of the entry
+ * \param time_ms Set to the time of week or day in ms
+ * \return true on success, false if the entry has no time or the time is
+ *         past the end of the week or day
+ */
+bool rtcm3_archive_entry_time(const rtcm3_archive_entry *entry,
+                              uint8_t *timescale,
+                              uint32_t *time_ms) {
+  assert(entry);
+  assert(timescale);
+  assert(time_ms);
+  if (0 == (entry->flags & RTCM3_ARCHIVE_HAS_TIME)) {
+    return false;
+  }
+  bool bds;
+  rtcm3_timescale ts = timescale_of(entry->msg_num, &bds);
+  uint32_t period = RTCM3_TIMESCALE_GLO == ts ? RTCM_GLO_MAX_TOW_MS + 1
+                                              : RTCM_MAX_TOW_MS + 1;
+  if (entry->time_ms >= period) {
+    return false;
+  }
+  *timescale = (uint8_t)ts;
+  *time_ms = entry->time_ms;
+  if (bds) {
+    *time_ms = (*time_ms + BDS_SECOND_TO_GPS_SECOND * 1000) % period;
+  }
+  return true;
+}
+
+/** Initialize an archive index.
+ *
+ * \param archive Archive to initialize
+ * \param entries Storage for the index, one entry per frame
+ * \param capacity Number of entries
+ */
+void rtcm3_archive_init(rtcm3_archive *archive,
+                        rtcm3_archive_entry entries[],
+                        size_t capacity) {
+  assert(archive);
+  assert(entries || 0 == capacity);
+  memset(archive, 0, sizeof(*archive));
+  archive->entries = entries;
+  archive->capacity = capacity;
+}
+
+/** Scan a recorded stream for frames and index them.
+ *
+ * The data is framed in a single pass and is not copied, so it must stay
+ * valid, and unchanged, for as long as the archive is used. Any previous
+ * index is replaced.
+ *
+ * If the index fills up, scanning stops at the first frame that did not
+ * fit and `scanned` is its offset, so the rest of the data can be indexed
+ * by another call on `data + scanned`.
+ *
+ * \param archive Archive to fill
+ * \param data Recorded stream, e.g. from rtcm3_archive_map()
+ * \param len Length of the data in bytes
+ * \return The number of frames indexed
+ */
+size_t rtcm3_archive_index(rtcm3_archive *archive,
+                           const uint8_t *data,
+                           size_t len) {
+  assert(archive);
+  assert(data || 0 == len);
+  archive->data = data;
+  archive->len = len;
+  archive->scanned = len;
+  archive->count = 0;
+
+  /* with a single chunk every frame is a view into data */
+  rtcm3_framer framer;
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, data, len);
+  rtcm3_frame frame;
+  while (rtcm3_framer_next(&framer, &frame)) {
+    size_t offset = (size_t)(frame.frame - data);
+    if (archive->count == archive->capacity) {
+      archive->scanned = offset;
+      break;
+    }
+    rtcm3_archive_read_entry(
+        &frame, offset, &archive->entries[archive->count++]);
+  }
+  archive->stats = framer.stats;
+  archive->stats.frames = archive->count;
+  return archive->count;
+}
+
+/* Check an entry against a query */
+static bool matches(const rtcm3_archive_entry *entry,
+                    const rtcm3_archive_query *query) {
+  if (NULL != query->types &&
+      !rtcm3_msg_filter_passes(query->types, entry->msg_num)) {
+    return false;
+  }
+  if (query->by_time) {
+    uint8_t timescale;
+    uint32_t time_ms;
+    return rtcm3_archive_entry_time(entry, &timescale, &time_ms) &&
+           timescale == query->timescale && time_ms >= query->time_min_ms &&
+           time_ms <= query->time_max_ms;
+  }
+  return true;
+}
+
+/** Find the next entry of an archive matching a query.
+ *
+ * Entries are returned in file order. Start with `*pos` at 0 and call
+ * again with the updated position until NULL is returned.
+ *
+ * \param archive Indexed archive
+ * \param query Entries to return, NULL for all
+ * \param pos Index of the first entry to check, set past the entry
+ *            returned
+ * \return The next matching entry, or NULL if there is none
+ */
+const rtcm3_archive_entry *rtcm3_archive_next(
+    const rtcm3_archive *archive,
+    const rtcm3_archive_query *query,
+    size_t *pos) {
+  assert(archive);
+  assert(pos);
+  while (*pos < archive->count) {
+    const rtcm3_archive_entry *entry = &archive->entries[(*pos)++];
+    if (NULL == query || matches(entry, query)) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/** Get the frame of an entry as a view into the archive data.
+ *
+ * \param archive Indexed archive
+ * \param entry Entry of the archive
+ * \param frame Set to the frame, valid as long as the archive data
+ * \return true on success, false if the entry is not inside the data
+ */
+bool rtcm3_archive_frame(const rtcm3_archive *archive,
+                         const rtcm3_archive_entry *entry,
+                         rtcm3_frame *frame) {
+  assert(archive);
+  assert(entry);
+  assert(frame);
+  if (entry->frame_len < RTCM3_FRAME_OVERHEAD ||
+      entry->offset > archive->len ||
+      archive->len - entry->offset < entry->frame_len) {
+    return false;
+  }
+  frame->frame = archive->data + entry->offset;
+  frame->frame_len = entry->frame_len;
+  frame->payload = frame->frame + RTCM3_FRAME_HEADER_LEN;
+  frame->payload_len = (uint16_t)(entry->frame_len - RTCM3_FRAME_OVERHEAD);
+  frame->msg_num = entry->msg_num;
+  return true;
+}
+
+/** Decode the message of an entry straight from the archive data.
+ *
+ * \param archive Indexed archive
+ * \param entry Entry of the archive
+ * \param msg Decoded message
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Message type is not decoded
+ *          - RC_INVALID_MESSAGE : Entry or message is malformed
+ */
+rtcm3_rc rtcm3_archive_decode(const rtcm3_archive *archive,
+                              const rtcm3_archive_entry *entry,
+                              rtcm3_any_msg *msg) {
+  assert(msg);
+  rtcm3_frame frame;
+  if (!rtcm3_archive_frame(archive, entry, &frame)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_frame(frame.payload, frame.payload_len, msg);
+}
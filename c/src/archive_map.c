@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/archive.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Map a recorded stream read-only into memory, for rtcm3_archive_index().
+ *
+ * The mapping is advised for sequential access, which suits the indexing
+ * pass; decoding selected frames afterwards only touches their pages.
+ *
+ * \param path File to map
+ * \param data Set to the start of the mapping, NULL for an empty file
+ * \param len Set to the length of the file
+ * \return true on success, false if the file cannot be opened or mapped,
+ *         with errno set
+ */
+bool rtcm3_archive_map(const char *path, const uint8_t **data, size_t *len) {
+  assert(path);
+  assert(data);
+  assert(len);
+  *data = NULL;
+  *len = 0;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (0 != fstat(fd, &st)) {
+    close(fd);
+    return false;
+  }
+  if (0 == st.st_size) {
+    close(fd);
+    return true;
+  }
+  void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  /* the mapping holds its own reference to the file */
+  close(fd);
+  if (MAP_FAILED == map) {
+    return false;
+  }
+  madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+  *data = map;
+  *len = (size_t)st.st_size;
+  return true;
+}
+
+/** Release a mapping made by rtcm3_archive_map().
+ *
+ * \param data Start of the mapping, may be NULL for an empty file
+ * \param len Length of the mapping
+ */
+void rtcm3_archive_unmap(const uint8_t *data, size_t len) {
+  if (NULL != data) {
+    munmap((void *)data, len);
+  }
+}
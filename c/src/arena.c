@@ -0,0 +1,570 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/arena.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "rtcm3/bits.h"
+
+#include "decode_internal.h"
+
+/** Set up an arena over a caller-owned buffer.
+ *
+ * \param arena The arena
+ * \param buff Storage, aligned to RTCM3_ARENA_ALIGN
+ * \param size Number of bytes at buff
+ */
+void rtcm3_arena_init(rtcm3_arena *arena, void *buff, size_t size) {
+  assert(arena);
+  assert(buff || size == 0);
+  assert((uintptr_t)buff % RTCM3_ARENA_ALIGN == 0);
+  arena->buff = buff;
+  arena->size = size;
+  arena->used = 0;
+  arena->high_water = 0;
+}
+
+/** Release everything allocated from the arena. Pointers returned by the
+ * arena decoders are invalid afterwards.
+ *
+ * \param arena The arena
+ */
+void rtcm3_arena_reset(rtcm3_arena *arena) {
+  assert(arena);
+  arena->used = 0;
+}
+
+/** Allocate from the arena.
+ *
+ * \param arena The arena
+ * \param size Number of bytes, rounded up to RTCM3_ARENA_ALIGN
+ * \return The allocation, or NULL if the arena is full. A zero size
+ *         allocation succeeds.
+ */
+void *rtcm3_arena_alloc(rtcm3_arena *arena, size_t size) {
+  assert(arena);
+  size_t aligned =
+      (size + RTCM3_ARENA_ALIGN - 1) & ~(size_t)(RTCM3_ARENA_ALIGN - 1);
+  if (aligned < size || aligned > arena->size - arena->used) {
+    return NULL;
+  }
+  void *ptr = arena->buff + arena->used;
+  arena->used += aligned;
+  if (arena->used > arena->high_water) {
+    arena->high_water = arena->used;
+  }
+  return ptr;
+}
+
+/** Give back whatever a failed decode allocated */
+static rtcm3_rc arena_fail(rtcm3_arena *arena, size_t mark, rtcm3_rc ret) {
+  arena->used = mark;
+  return ret;
+}
+
+/** Copy a string (DF029 and similar, 8 bit count followed by the characters)
+ * into the arena with a terminating NUL. The count has been checked against
+ * the payload length by the caller. */
+static const char *read_str(const uint8_t buff[],
+                            uint32_t *bit,
+                            rtcm3_arena *arena,
+                            uint8_t *count) {
+  *count = rtcm_getbitu(buff, *bit, 8);
+  *bit += 8;
+  char *str = rtcm3_arena_alloc(arena, (size_t)*count + 1);
+  if (NULL == str) {
+    return NULL;
+  }
+  for (uint8_t i = 0; i < *count; i++) {
+    str[i] = (char)rtcm_getbitu(buff, *bit, 8);
+    *bit += 8;
+  }
+  str[*count] = '\0';
+  return str;
+}
+
+/** Decode an RTCMv3 message type 1029 (Unicode Text String Message) into an
+ * arena.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param arena Arena holding the message and its text
+ * \param msg Set to the decoded message, NULL on failure
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Message type mismatch
+ *          - RC_INVALID_MESSAGE : Message longer than the payload or arena
+ *            full
+ */
+rtcm3_rc rtcm3_decode_1029_arena(const uint8_t buff[],
+                                 uint16_t len,
+                                 rtcm3_arena *arena,
+                                 rtcm_msg_1029_arena **msg) {
+  assert(arena);
+  assert(msg);
+  *msg = NULL;
+  uint32_t len_bits = (uint32_t)len * 8u;
+  if (len_bits < 12) {
+    return RC_INVALID_MESSAGE;
+  }
+  if (rtcm_getbitu(buff, 0, 12) != 1029) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  uint32_t bit = 64;
+  if (!rtcm3_skip_str(buff, len_bits, &bit)) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  size_t mark = arena->used;
+  rtcm_msg_1029_arena *out = rtcm3_arena_alloc(arena, sizeof(*out));
+  if (NULL == out) {
+    return RC_INVALID_MESSAGE;
+  }
+  out->stn_id = rtcm_getbitu(buff, 12, 12);
+  out->mjd_num = rtcm_getbitu(buff, 24, 16);
+  out->utc_sec_of_day = rtcm_getbitu(buff, 40, 17);
+  out->unicode_chars = rtcm_getbitu(buff, 57, 7);
+  out->utf8_code_units_n = rtcm_getbitu(buff, 64, 8);
+  uint8_t *units = rtcm3_arena_alloc(arena, out->utf8_code_units_n);
+  if (NULL == units) {
+    return arena_fail(arena, mark, RC_INVALID_MESSAGE);
+  }
+  for (uint8_t i = 0; i < out->utf8_code_units_n; i++) {
+    units[i] = rtcm_getbitu(buff, 72 + 8u * i, 8);
+  }
+  out->utf8_code_units = units;
+  *msg = out;
+  return RC_OK;
+}
+
+/** Decode an RTCMv3 message type 1033 (Rcv and Ant descriptor) into an
+ * arena. Unlike rtcm3_decode_1033() the strings are not limited to
+ * RTCM_MAX_STRING_LEN characters.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param arena Arena holding the message and its strings
+ * \param msg Set to the decoded message, NULL on failure
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Message type mismatch
+ *          - RC_INVALID_MESSAGE : Message longer than the payload or arena
+ *            full
+ */
+rtcm3_rc rtcm3_decode_1033_arena(const uint8_t buff[],
+                                 uint16_t len,
+                                 rtcm3_arena *arena,
+                                 rtcm_msg_1033_arena **msg) {
+  assert(arena);
+  assert(msg);
+  *msg = NULL;
+  uint32_t len_bits = (uint32_t)len * 8u;
+  if (len_bits < 12) {
+    return RC_INVALID_MESSAGE;
+  }
+  if (rtcm_getbitu(buff, 0, 12) != 1033) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  uint32_t bit = 24;
+  if (!rtcm3_skip_str(buff, len_bits, &bit)) {
+    return RC_INVALID_MESSAGE;
+  }
+  /* antenna setup id */
+  bit += 8;
+  for (uint8_t i = 0; i < 4; i++) {
+    if (!rtcm3_skip_str(buff, len_bits, &bit)) {
+      return RC_INVALID_MESSAGE;
+    }
+  }
+
+  size_t mark = arena->used;
+  rtcm_msg_1033_arena *out = rtcm3_arena_alloc(arena, sizeof(*out));
+  if (NULL == out) {
+    return RC_INVALID_MESSAGE;
+  }
+  bit = 12;
+  out->stn_id = rtcm_getbitu(buff, bit, 12);
+  bit += 12;
+  out->ant_descriptor =
+      read_str(buff, &bit, arena, &out->ant_descriptor_counter);
+  out->ant_setup_id = rtcm_getbitu(buff, bit, 8);
+  bit += 8;
+  out->ant_serial_num =
+      read_str(buff, &bit, arena, &out->ant_serial_num_counter);
+  out->rcv_descriptor =
+      read_str(buff, &bit, arena, &out->rcv_descriptor_counter);
+  out->rcv_fw_version =
+      read_str(buff, &bit, arena, &out->rcv_fw_version_counter);
+  out->rcv_serial_num =
+      read_str(buff, &bit, arena, &out->rcv_serial_num_counter);
+  if (NULL == out->ant_descriptor || NULL == out->ant_serial_num ||
+      NULL == out->rcv_descriptor || NULL == out->rcv_fw_version ||
+      NULL == out->rcv_serial_num) {
+    return arena_fail(arena, mark, RC_INVALID_MESSAGE);
+  }
+  *msg = out;
+  return RC_OK;
+}
+
+/** Decode Swift Proprietary Message into an arena.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param arena Arena holding the message and its payload
+ * \param msg Set to the decoded message, NULL on failure
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Message type mismatch
+ *          - RC_INVALID_MESSAGE : Nonzero reserved bits, message longer than
+ *            the payload or arena full
+ */
+rtcm3_rc rtcm3_decode_4062_arena(const uint8_t buff[],
+                                 uint16_t len,
+                                 rtcm3_arena *arena,
+                                 rtcm_msg_swift_proprietary_arena **msg) {
+  assert(arena);
+  assert(msg);
+  *msg = NULL;
+  uint32_t len_bits = (uint32_t)len * 8u;
+  if (len_bits < 12) {
+    return RC_INVALID_MESSAGE;
+  }
+  if (rtcm_getbitu(buff, 0, 12) != 4062) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  uint32_t bit = 48;
+  if (!rtcm3_skip_str(buff, len_bits, &bit) || rtcm_getbitu(buff, 12, 4) != 0) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  size_t mark = arena->used;
+  rtcm_msg_swift_proprietary_arena *out =
+      rtcm3_arena_alloc(arena, sizeof(*out));
+  if (NULL == out) {
+    return RC_INVALID_MESSAGE;
+  }
+  out->msg_type = rtcm_getbitu(buff, 16, 16);
+  out->sender_id = rtcm_getbitu(buff, 32, 16);
+  out->len = rtcm_getbitu(buff, 48, 8);
+  uint8_t *data = rtcm3_arena_alloc(arena, out->len);
+  if (NULL == data) {
+    return arena_fail(arena, mark, RC_INVALID_MESSAGE);
+  }
+  for (uint8_t i = 0; i < out->len; i++) {
+    data[i] = rtcm_getbitu(buff, 56 + 8u * i, 8);
+  }
+  out->data = data;
+  *msg = out;
+  return RC_OK;
+}
+
+/** Shared part of the SSR orbit and clock arena decoders: validate the
+ * length, decode the header and allocate the message and its arrays */
+static rtcm3_rc decode_orbit_clock_arena(const uint8_t buff[],
+                                         uint16_t len,
+                                         rtcm3_arena *arena,
+                                         bool orbit,
+                                         bool clock,
+                                         rtcm_msg_orbit_clock_arena *out,
+                                         uint16_t *bit) {
+  if (!rtcm3_ssr_orbit_clock_fits(buff, len, orbit, clock)) {
+    return RC_INVALID_MESSAGE;
+  }
+  if (!(RC_OK == decode_ssr_header(buff, bit, &out->header))) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint16_t message_num = out->header.message_num;
+  if ((orbit && clock && !is_ssr_orbit_clock_message(message_num)) ||
+      (orbit && !clock && !is_ssr_orbit_message(message_num)) ||
+      (!orbit && clock && !is_ssr_clock_message(message_num))) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  uint8_t num_sats = out->header.num_sats;
+  out->orbit = NULL;
+  out->clock = NULL;
+  if (orbit) {
+    out->orbit = rtcm3_arena_alloc(arena, num_sats * sizeof(*out->orbit));
+  }
+  if (clock) {
+    out->clock = rtcm3_arena_alloc(arena, num_sats * sizeof(*out->clock));
+  }
+  if ((orbit && NULL == out->orbit) || (clock && NULL == out->clock)) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  for (uint8_t i = 0; i < num_sats; i++) {
+    uint8_t sat_id;
+    if (!(RC_OK == rtcm3_decode_ssr_satellite_id(
+                       buff, bit, out->header.constellation, &sat_id))) {
+      return RC_INVALID_MESSAGE;
+    }
+    if (orbit) {
+      out->orbit[i].sat_id = sat_id;
+      if (!(RC_OK == rtcm3_decode_ssr_orbit(buff,
+                                            bit,
+                                            out->header.constellation,
+                                            &out->orbit[i]))) {
+        return RC_INVALID_MESSAGE;
+      }
+    }
+    if (clock) {
+      out->clock[i].sat_id = sat_id;
+      rtcm3_decode_ssr_clock(buff, bit, &out->clock[i]);
+    }
+  }
+  return RC_OK;
+}
+
+/** Decode an RTCMv3 SSR orbit correction message into an arena, with one
+ * correction per satellite of the message.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param arena Arena holding the message and its corrections
+ * \param msg Set to the decoded message, NULL on failure
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Message type mismatch
+ *          - RC_INVALID_MESSAGE : Unknown constellation, message longer than
+ *            the payload or arena full
+ */
+rtcm3_rc rtcm3_decode_orbit_arena(const uint8_t buff[],
+                                  uint16_t len,
+                                  rtcm3_arena *arena,
+                                  rtcm_msg_orbit_arena **msg) {
+  assert(arena);
+  assert(msg);
+  *msg = NULL;
+  size_t mark = arena->used;
+  rtcm_msg_orbit_arena *out = rtcm3_arena_alloc(arena, sizeof(*out));
+  if (NULL == out) {
+    return RC_INVALID_MESSAGE;
+  }
+  rtcm_msg_orbit_clock_arena tmp;
+  uint16_t bit = 0;
+  rtcm3_rc ret =
+      decode_orbit_clock_arena(buff, len, arena, true, false, &tmp, &bit);
+  if (RC_OK != ret) {
+    return arena_fail(arena, mark, ret);
+  }
+  out->header = tmp.header;
+  out->orbit = tmp.orbit;
+  *msg = out;
+  return RC_OK;
+}
+
+/** Decode an RTCMv3 SSR clock correction message into an arena, see
+ * rtcm3_decode_orbit_arena() */
+rtcm3_rc rtcm3_decode_clock_arena(const uint8_t buff[],
+                                  uint16_t len,
+                                  rtcm3_arena *arena,
+                                  rtcm_msg_clock_arena **msg) {
+  assert(arena);
+  assert(msg);
+  *msg = NULL;
+  size_t mark = arena->used;
+  rtcm_msg_clock_arena *out = rtcm3_arena_alloc(arena, sizeof(*out));
+  if (NULL == out) {
+    return RC_INVALID_MESSAGE;
+  }
+  rtcm_msg_orbit_clock_arena tmp;
+  uint16_t bit = 0;
+  rtcm3_rc ret =
+      decode_orbit_clock_arena(buff, len, arena, false, true, &tmp, &bit);
+  if (RC_OK != ret) {
+    return arena_fail(arena, mark, ret);
+  }
+  out->header = tmp.header;
+  out->clock = tmp.clock;
+  *msg = out;
+  return RC_OK;
+}
+
+/** Decode an RTCMv3 Combined SSR Orbit and Clock message into an arena, see
+ * rtcm3_decode_orbit_arena() */
+rtcm3_rc rtcm3_decode_orbit_clock_arena(const uint8_t buff[],
+                                        uint16_t len,
+                                        rtcm3_arena *arena,
+                                        rtcm_msg_orbit_clock_arena **msg) {
+  assert(arena);
+  assert(msg);
+  *msg = NULL;
+  size_t mark = arena->used;
+  rtcm_msg_orbit_clock_arena *out = rtcm3_arena_alloc(arena, sizeof(*out));
+  if (NULL == out) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint16_t bit = 0;
+  rtcm3_rc ret =
+      decode_orbit_clock_arena(buff, len, arena, true, true, out, &bit);
+  if (RC_OK != ret) {
+    return arena_fail(arena, mark, ret);
+  }
+  *msg = out;
+  return RC_OK;
+}
+
+/** Decode an RTCMv3 Code bias message into an arena, with exactly as many
+ * signals per satellite as the message carries.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param arena Arena holding the message and its biases
+ * \param msg Set to the decoded message, NULL on failure
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Message type mismatch
+ *          - RC_INVALID_MESSAGE : Unknown constellation, message longer than
+ *            the payload or arena full
+ */
+rtcm3_rc rtcm3_decode_code_bias_arena(const uint8_t buff[],
+                                      uint16_t len,
+                                      rtcm3_arena *arena,
+                                      rtcm_msg_code_bias_arena **msg) {
+  assert(arena);
+  assert(msg);
+  *msg = NULL;
+  if (!rtcm3_ssr_bias_fits(
+          buff, len, SSR_CODE_BIAS_SAT_BITS, SSR_CODE_BIAS_SIGNAL_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  rtcm_msg_ssr_header header;
+  uint16_t bit = 0;
+  if (!(RC_OK == decode_ssr_header(buff, &bit, &header))) {
+    return RC_INVALID_MESSAGE;
+  }
+  if (!is_ssr_code_biases_message(header.message_num)) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+
+  size_t mark = arena->used;
+  rtcm_msg_code_bias_arena *out = rtcm3_arena_alloc(arena, sizeof(*out));
+  if (NULL == out) {
+    return RC_INVALID_MESSAGE;
+  }
+  out->header = header;
+  out->sats = rtcm3_arena_alloc(arena, header.num_sats * sizeof(*out->sats));
+  if (NULL == out->sats) {
+    return arena_fail(arena, mark, RC_INVALID_MESSAGE);
+  }
+  for (uint8_t i = 0; i < header.num_sats; i++) {
+    rtcm_msg_ssr_code_bias_sat_arena *sat = &out->sats[i];
+    if (!(RC_OK ==
+          rtcm3_decode_ssr_code_bias_sat_header(buff,
+                                                &bit,
+                                                header.constellation,
+                                                &sat->sat_id,
+                                                &sat->num_code_biases))) {
+      return arena_fail(arena, mark, RC_INVALID_MESSAGE);
+    }
+    sat->signals = rtcm3_arena_alloc(
+        arena, sat->num_code_biases * sizeof(*sat->signals));
+    if (NULL == sat->signals) {
+      return arena_fail(arena, mark, RC_INVALID_MESSAGE);
+    }
+    rtcm3_decode_ssr_code_bias_signals(
+        buff, &bit, sat->num_code_biases, sat->signals);
+  }
+  *msg = out;
+  return RC_OK;
+}
+
+/** Decode an RTCMv3 Phase bias message into an arena, see
+ * rtcm3_decode_code_bias_arena() */
+rtcm3_rc rtcm3_decode_phase_bias_arena(const uint8_t buff[],
+                                       uint16_t len,
+                                       rtcm3_arena *arena,
+                                       rtcm_msg_phase_bias_arena **msg) {
+  assert(arena);
+  assert(msg);
+  *msg = NULL;
+  if (!rtcm3_ssr_bias_fits(
+          buff, len, SSR_PHASE_BIAS_SAT_BITS, SSR_PHASE_BIAS_SIGNAL_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  rtcm_msg_ssr_header header;
+  uint16_t bit = 0;
+  if (!(RC_OK == decode_ssr_header(buff, &bit, &header))) {
+    return RC_INVALID_MESSAGE;
+  }
+  if (!is_ssr_phase_biases_message(header.message_num)) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+
+  size_t mark = arena->used;
+  rtcm_msg_phase_bias_arena *out = rtcm3_arena_alloc(arena, sizeof(*out));
+  if (NULL == out) {
+    return RC_INVALID_MESSAGE;
+  }
+  out->header = header;
+  out->sats = rtcm3_arena_alloc(arena, header.num_sats * sizeof(*out->sats));
+  if (NULL == out->sats) {
+    return arena_fail(arena, mark, RC_INVALID_MESSAGE);
+  }
+  for (uint8_t i = 0; i < header.num_sats; i++) {
+    rtcm_msg_ssr_phase_bias_sat_arena *sat = &out->sats[i];
+    if (!(RC_OK ==
+          rtcm3_decode_ssr_phase_bias_sat_header(buff,
+                                                 &bit,
+                                                 header.constellation,
+                                                 &sat->sat_id,
+                                                 &sat->num_phase_biases,
+                                                 &sat->yaw_angle,
+                                                 &sat->yaw_rate))) {
+      return arena_fail(arena, mark, RC_INVALID_MESSAGE);
+    }
+    sat->signals = rtcm3_arena_alloc(
+        arena, sat->num_phase_biases * sizeof(*sat->signals));
+    if (NULL == sat->signals) {
+      return arena_fail(arena, mark, RC_INVALID_MESSAGE);
+    }
+    rtcm3_decode_ssr_phase_bias_signals(
+        buff, &bit, sat->num_phase_biases, sat->signals);
+  }
+  *msg = out;
+  return RC_OK;
+}
+
+/** Decode an RTCMv3 Multi System Message 4-7 into an arena in compact form,
+ * see rtcm3_decode_msm_compact().
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param arena Arena holding the message
+ * \param msg Set to the decoded message, NULL on failure
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not an MSM4-7 message
+ *          - RC_INVALID_MESSAGE : Cell mask too large, invalid TOW, message
+ *            longer than the payload or arena full
+ */
+rtcm3_rc rtcm3_decode_msm_arena(const uint8_t buff[],
+                                uint16_t len,
+                                rtcm3_arena *arena,
+                                rtcm_msm_compact **msg) {
+  assert(arena);
+  assert(msg);
+  *msg = NULL;
+  uint16_t size = rtcm3_msm_compact_size(buff, len);
+  if (0 == size) {
+    /* let the decoder tell a mismatch from a malformed message */
+    rtcm_msm_compact empty;
+    return rtcm3_decode_msm_compact(buff, len, &empty, sizeof(empty));
+  }
+  size_t mark = arena->used;
+  rtcm_msm_compact *out = rtcm3_arena_alloc(arena, size);
+  if (NULL == out) {
+    return RC_INVALID_MESSAGE;
+  }
+  rtcm3_rc ret = rtcm3_decode_msm_compact(buff, len, out, size);
+  if (RC_OK != ret) {
+    return arena_fail(arena, mark, ret);
+  }
+  *msg = out;
+  return RC_OK;
+}
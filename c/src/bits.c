@@ -12,42 +12,54 @@
 
 #include <rtcm3/bits.h>
 
+#include "bits_internal.h"
+
 /** Get bit field from buffer as an unsigned integer.
  * Unpacks `len` bits at bit position `pos` from the start of the buffer.
  * Maximum bit field length is 32 bits, i.e. `len <= 32`.
  *
+ * Only the bytes which contain the bit field are accessed.
+ *
  * \param buff
  * \param pos Position in buffer of start of bit field in bits.
  * \param len Length of bit field in bits.
  * \return Bit field as an unsigned value.
  */
 uint32_t rtcm_getbitu(const uint8_t *buff, uint32_t pos, uint8_t len) {
-  uint32_t bits = 0;
-
-  for (uint32_t i = pos; i < pos + len; i++) {
-    bits = (bits << 1) + ((buff[i / 8] >> (7 - i % 8)) & 1u);
+  if (len == 0) {
+    return 0;
   }
-
-  return bits;
+  uint32_t shift = pos % 8;
+  /* at most 5 bytes for a 32 bit field */
+  uint64_t word = rtcm_load_be_bytes(&buff[pos / 8], (shift + len + 7) / 8);
+  return (uint32_t)((word << shift) >> (64 - len));
 }
 
 /** Get bit field from buffer as an unsigned long integer.
  * Unpacks `len` bits at bit position `pos` from the start of the buffer.
  * Maximum bit field length is 64 bits, i.e. `len <= 64`.
  *
+ * Only the bytes which contain the bit field are accessed.
+ *
  * \param buff
  * \param pos Position in buffer of start of bit field in bits.
  * \param len Length of bit field in bits.
  * \return Bit field as an unsigned value.
  */
 uint64_t rtcm_getbitul(const uint8_t *buff, uint32_t pos, uint8_t len) {
-  uint64_t bits = 0;
-
-  for (uint32_t i = pos; i < pos + len; i++) {
-    bits = (bits << 1) + ((buff[i / 8] >> (7 - i % 8)) & 1u);
+  if (len == 0) {
+    return 0;
   }
-
-  return bits;
+  const uint8_t *p = &buff[pos / 8];
+  uint32_t shift = pos % 8;
+  uint32_t num_bytes = (shift + len + 7) / 8;
+  uint64_t word = rtcm_load_be_bytes(p, num_bytes > 8 ? 8 : num_bytes)
+                  << shift;
+  if (num_bytes > 8) {
+    /* a field longer than 57 bits can straddle a ninth byte */
+    word |= p[8] >> (8 - shift);
+  }
+  return word >> (64 - len);
 }
 
 /** Get bit field from buffer as a signed integer.
@@ -62,13 +74,14 @@ uint64_t rtcm_getbitul(const uint8_t *buff, uint32_t pos, uint8_t len) {
  * \return Bit field as a signed value.
  */
 int32_t rtcm_getbits(const uint8_t *buff, uint32_t pos, uint8_t len) {
-  int32_t bits = (int32_t)rtcm_getbitu(buff, pos, len);
+  uint32_t bits = rtcm_getbitu(buff, pos, len);
 
   /* Sign extend, taken from:
    * http://graphics.stanford.edu/~seander/bithacks.html#VariableSignExtend
+   * Done in unsigned arithmetic so that `len == 32` does not overflow.
    */
-  int32_t m = 1u << (len - 1);
-  return (bits ^ m) - m;
+  uint32_t m = 1u << (len - 1);
+  return (int32_t)((bits ^ m) - m);
 }
 
 /** Get bit field from buffer as a signed integer.
@@ -83,13 +96,14 @@ int32_t rtcm_getbits(const uint8_t *buff, uint32_t pos, uint8_t len) {
  * \return Bit field as a signed value.
  */
 int64_t rtcm_getbitsl(const uint8_t *buff, uint32_t pos, uint8_t len) {
-  int64_t bits = (int64_t)rtcm_getbitul(buff, pos, len);
+  uint64_t bits = rtcm_getbitul(buff, pos, len);
 
   /* Sign extend, taken from:
    * http://graphics.stanford.edu/~seander/bithacks.html#VariableSignExtend
+   * Done in unsigned arithmetic so that `len == 64` does not overflow.
    */
-  int64_t m = ((uint64_t)1) << (len - 1);
-  return (bits ^ m) - m;
+  uint64_t m = ((uint64_t)1) << (len - 1);
+  return (int64_t)((bits ^ m) - m);
 }
 
 /** Set bit field in buffer from an unsigned integer.
@@ -102,43 +116,42 @@ int64_t rtcm_getbitsl(const uint8_t *buff, uint32_t pos, uint8_t len) {
  * \param data Unsigned integer to be packed into bit field.
  */
 void rtcm_setbitu(uint8_t *buff, uint32_t pos, uint32_t len, uint32_t data) {
-  uint32_t mask = 1u << (len - 1);
-
   if (len <= 0 || 32 < len) {
     return;
   }
 
-  for (uint32_t i = pos; i < pos + len; i++, mask >>= 1) {
-    if (data & mask) {
-      buff[i / 8] |= 1u << (7 - i % 8);
-    } else {
-      buff[i / 8] &= ~(1u << (7 - i % 8));
-    }
-  }
+  rtcm_setbitul(buff, pos, len, data);
 }
 
 /** Set bit field in buffer from an unsigned integer.
  * Packs `len` bits into bit position `pos` from the start of the buffer.
  * Maximum bit field length is 64 bits, i.e. `len <= 64`.
  *
+ * The field is written one masked byte at a time, bits of the buffer outside
+ * of the field are left untouched.
+ *
  * \param buff
  * \param pos Position in buffer of start of bit field in bits.
  * \param len Length of bit field in bits.
  * \param data Unsigned integer to be packed into bit field.
  */
 void rtcm_setbitul(uint8_t *buff, uint32_t pos, uint32_t len, uint64_t data) {
-  uint64_t mask = ((uint64_t)1) << (len - 1);
-
   if (len <= 0 || 64 < len) {
     return;
   }
 
-  for (uint32_t i = pos; i < pos + len; i++, mask >>= 1) {
-    if (data & mask) {
-      buff[i / 8] |= ((uint64_t)1) << (7 - i % 8);
-    } else {
-      buff[i / 8] &= ~(((uint64_t)1) << (7 - i % 8));
+  while (len > 0) {
+    uint32_t shift = pos % 8;
+    uint32_t n = 8 - shift;
+    if (n > len) {
+      n = len;
     }
+    uint32_t low = 8 - shift - n;
+    uint32_t mask = ((1u << n) - 1) << low;
+    uint32_t bits = (uint32_t)(data >> (len - n)) << low;
+    buff[pos / 8] = (uint8_t)((buff[pos / 8] & ~mask) | (bits & mask));
+    pos += n;
+    len -= n;
   }
 }
 
@@ -177,8 +190,9 @@ void rtcm_setbitsl(uint8_t *buff, uint32_t pos, uint32_t len, int64_t data) {
 int32_t rtcm_get_sign_magnitude_bit(const uint8_t *buff,
                                     uint32_t pos,
                                     uint8_t len) {
-  int32_t value = rtcm_getbitu(buff, pos + 1, len - 1);
-  return rtcm_getbitu(buff, pos, 1) ? -value : value;
+  uint32_t bits = rtcm_getbitu(buff, pos, len);
+  int32_t value = (int32_t)(bits & ~(1u << (len - 1)));
+  return (bits >> (len - 1)) ? -value : value;
 }
 
 /* Set sign-magnitude bits, See Note 1, Table 3.3-1, RTCM 3.3
@@ -194,3 +208,275 @@ void rtcm_set_sign_magnitude_bit(uint8_t *buff,
   rtcm_setbitu(buff, pos, 1, (data < 0) ? 1 : 0);
   rtcm_setbitu(buff, pos + 1, len - 1, ((data < 0) ? -data : data));
 }
+
+/** Initialize a bit reader over a buffer.
+ * The reader never accesses memory outside of `buff[0..len_bytes)`.
+ *
+ * \param reader Reader to initialize
+ * \param buff Buffer to read from
+ * \param len_bytes Length of the buffer in bytes
+ */
+void rtcm_bitreader_init(rtcm_bitreader *reader,
+                         const uint8_t *buff,
+                         uint32_t len_bytes) {
+  reader->buff = buff;
+  reader->len = len_bytes * 8;
+  reader->pos = 0;
+  reader->overrun = false;
+}
+
+/** Get the number of bits left to read.
+ *
+ * \param reader
+ * \return Number of unread bits, 0 if the reader has overrun the buffer
+ */
+uint32_t rtcm_bitreader_remaining(const rtcm_bitreader *reader) {
+  return reader->pos < reader->len ? reader->len - reader->pos : 0;
+}
+
+/** Advance the reader by `len` bits without decoding them.
+ *
+ * \param reader
+ * \param len Number of bits to skip
+ */
+void rtcm_read_skip(rtcm_bitreader *reader, uint32_t len) {
+  if (len > rtcm_bitreader_remaining(reader)) {
+    reader->overrun = true;
+  }
+  reader->pos += len;
+}
+
+/** Read an unsigned bit field and advance the reader.
+ * Maximum bit field length is 64 bits, i.e. `len <= 64`.
+ *
+ * Whenever 8 bytes are available from the current byte the field is
+ * extracted from a single big-endian word load, otherwise the byte-exact path
+ * of `rtcm_getbitul` is used so the end of the buffer is never crossed.
+ *
+ * \param reader
+ * \param len Length of bit field in bits.
+ * \return Bit field as an unsigned value, 0 if the field runs past the end
+ *         of the buffer (in which case `reader->overrun` is set)
+ */
+uint64_t rtcm_read_bitul(rtcm_bitreader *reader, uint8_t len) {
+  uint32_t pos = reader->pos;
+  if (len == 0) {
+    return 0;
+  }
+  if (reader->overrun || len > rtcm_bitreader_remaining(reader)) {
+    reader->overrun = true;
+    reader->pos += len;
+    return 0;
+  }
+  reader->pos += len;
+
+  uint32_t byte = pos / 8;
+  uint32_t shift = pos % 8;
+  if (byte + 8 <= reader->len / 8 && shift + len <= 64) {
+    uint64_t word = rtcm_load_be64(&reader->buff[byte]);
+    return (word << shift) >> (64 - len);
+  }
+  return rtcm_getbitul(reader->buff, pos, len);
+}
+
+/** Read an unsigned bit field and advance the reader.
+ * Maximum bit field length is 32 bits, i.e. `len <= 32`.
+ *
+ * \param reader
+ * \param len Length of bit field in bits.
+ * \return Bit field as an unsigned value.
+ */
+uint32_t rtcm_read_bitu(rtcm_bitreader *reader, uint8_t len) {
+  return (uint32_t)rtcm_read_bitul(reader, len);
+}
+
+/** Read a signed bit field and advance the reader.
+ * Maximum bit field length is 32 bits, i.e. `len <= 32`.
+ *
+ * \param reader
+ * \param len Length of bit field in bits.
+ * \return Bit field sign extended to a signed 32 bit integer.
+ */
+int32_t rtcm_read_bits(rtcm_bitreader *reader, uint8_t len) {
+  return (int32_t)rtcm_read_bitsl(reader, len);
+}
+
+/** Read a signed bit field and advance the reader.
+ * Maximum bit field length is 64 bits, i.e. `len <= 64`.
+ *
+ * \param reader
+ * \param len Length of bit field in bits.
+ * \return Bit field sign extended to a signed 64 bit integer.
+ */
+int64_t rtcm_read_bitsl(rtcm_bitreader *reader, uint8_t len) {
+  if (len == 0) {
+    return 0;
+  }
+  /* Sign extend in unsigned arithmetic so that `len == 64` does not
+   * overflow. */
+  uint64_t bits = rtcm_read_bitul(reader, len);
+  uint64_t m = ((uint64_t)1) << (len - 1);
+  return (int64_t)((bits ^ m) - m);
+}
+
+/** Read a sign-magnitude bit field and advance the reader.
+ * See Note 1, Table 3.3-1, RTCM 3.3
+ *
+ * \param reader
+ * \param len Length of bit field in bits, including the sign bit.
+ * \return Bit field as a signed value.
+ */
+int32_t rtcm_read_sign_magnitude_bit(rtcm_bitreader *reader, uint8_t len) {
+  uint32_t bits = rtcm_read_bitu(reader, len);
+  int32_t value = (int32_t)(bits & ~(1u << (len - 1)));
+  return (bits >> (len - 1)) ? -value : value;
+}
+
+/* Store the oldest 32 pending bits of the writer as 4 whole bytes. */
+static void bitwriter_store_word(rtcm_bitwriter *writer) {
+  uint32_t word = (uint32_t)(writer->acc >> (writer->acc_bits - 32));
+  uint8_t *p = &writer->buff[(writer->pos - writer->acc_bits) / 8];
+  p[0] = (uint8_t)(word >> 24);
+  p[1] = (uint8_t)(word >> 16);
+  p[2] = (uint8_t)(word >> 8);
+  p[3] = (uint8_t)word;
+  writer->acc_bits -= 32;
+}
+
+/** Initialize a bit writer over a buffer.
+ * Writing starts at bit position `pos`, the bits of the buffer before `pos`
+ * and after the last written bit are preserved, so the output is identical
+ * to a sequence of `rtcm_setbitu` calls. The writer never accesses memory
+ * outside of `buff[0..len_bytes)`.
+ *
+ * \param writer Writer to initialize
+ * \param buff Buffer to write into
+ * \param len_bytes Length of the buffer in bytes
+ * \param pos Bit position of the first field to write
+ */
+void rtcm_bitwriter_init(rtcm_bitwriter *writer,
+                         uint8_t *buff,
+                         uint32_t len_bytes,
+                         uint32_t pos) {
+  writer->buff = buff;
+  writer->len = len_bytes * 8;
+  writer->pos = pos;
+  writer->overrun = pos > writer->len;
+  /* pending bits always start on a byte boundary, so pick up the leading
+   * bits of a partially written first byte */
+  writer->acc_bits = pos % 8;
+  writer->acc = 0;
+  if (writer->acc_bits > 0 && !writer->overrun) {
+    writer->acc = buff[pos / 8] >> (8 - writer->acc_bits);
+  }
+}
+
+/** Write an unsigned bit field and advance the writer.
+ * Maximum bit field length is 32 bits, i.e. `len <= 32`.
+ *
+ * The field is shifted into a 64 bit accumulator, which is stored into the
+ * buffer 32 bits at a time.
+ *
+ * \param writer
+ * \param len Length of bit field in bits.
+ * \param data Unsigned integer to be packed into bit field.
+ */
+void rtcm_write_bitu(rtcm_bitwriter *writer, uint8_t len, uint32_t data) {
+  if (len == 0 || 32 < len) {
+    return;
+  }
+  if (writer->overrun || writer->pos + len > writer->len) {
+    writer->overrun = true;
+    return;
+  }
+  uint64_t mask = (((uint64_t)1) << len) - 1;
+  writer->acc = (writer->acc << len) | (data & mask);
+  writer->acc_bits += len;
+  writer->pos += len;
+  if (writer->acc_bits >= 32) {
+    bitwriter_store_word(writer);
+  }
+}
+
+/** Write an unsigned bit field and advance the writer.
+ * Maximum bit field length is 64 bits, i.e. `len <= 64`.
+ *
+ * \param writer
+ * \param len Length of bit field in bits.
+ * \param data Unsigned integer to be packed into bit field.
+ */
+void rtcm_write_bitul(rtcm_bitwriter *writer, uint8_t len, uint64_t data) {
+  if (64 < len) {
+    return;
+  }
+  if (len > 32) {
+    rtcm_write_bitu(writer, len - 32, (uint32_t)(data >> 32));
+    len = 32;
+  }
+  rtcm_write_bitu(writer, len, (uint32_t)data);
+}
+
+/** Write a signed bit field and advance the writer.
+ * Maximum bit field length is 32 bits, i.e. `len <= 32`.
+ *
+ * \param writer
+ * \param len Length of bit field in bits.
+ * \param data Signed integer to be packed into bit field.
+ */
+void rtcm_write_bits(rtcm_bitwriter *writer, uint8_t len, int32_t data) {
+  rtcm_write_bitu(writer, len, (uint32_t)data);
+}
+
+/** Write a signed bit field and advance the writer.
+ * Maximum bit field length is 64 bits, i.e. `len <= 64`.
+ *
+ * \param writer
+ * \param len Length of bit field in bits.
+ * \param data Signed integer to be packed into bit field.
+ */
+void rtcm_write_bitsl(rtcm_bitwriter *writer, uint8_t len, int64_t data) {
+  rtcm_write_bitul(writer, len, (uint64_t)data);
+}
+
+/** Write a sign-magnitude bit field and advance the writer.
+ * See Note 1, Table 3.3-1, RTCM 3.3
+ *
+ * \param writer
+ * \param len Length of bit field in bits, including the sign bit.
+ * \param data Signed integer to be packed into bit field.
+ */
+void rtcm_write_sign_magnitude_bit(rtcm_bitwriter *writer,
+                                   uint8_t len,
+                                   int64_t data) {
+  uint32_t magnitude = (uint32_t)((data < 0) ? -data : data);
+  uint32_t sign = (data < 0) ? 1 : 0;
+  magnitude &= (1u << (len - 1)) - 1;
+  rtcm_write_bitu(writer, len, (sign << (len - 1)) | magnitude);
+}
+
+/** Write all pending bits into the buffer.
+ * The final partial byte is merged with the bits already in the buffer.
+ * Writing can continue after a flush.
+ *
+ * \param writer
+ * \return Number of bytes from the start of the buffer up to and including
+ *         the last written bit, or 0 if a write did not fit in the buffer
+ */
+uint32_t rtcm_bitwriter_flush(rtcm_bitwriter *writer) {
+  if (writer->overrun) {
+    return 0;
+  }
+  while (writer->acc_bits >= 8) {
+    uint32_t byte = (writer->pos - writer->acc_bits) / 8;
+    writer->acc_bits -= 8;
+    writer->buff[byte] = (uint8_t)(writer->acc >> writer->acc_bits);
+  }
+  if (writer->acc_bits > 0) {
+    uint32_t byte = writer->pos / 8;
+    uint32_t low = 8 - writer->acc_bits;
+    uint8_t keep = (uint8_t)((1u << low) - 1);
+    uint8_t bits = (uint8_t)(writer->acc << low);
+    writer->buff[byte] = (uint8_t)((writer->buff[byte] & keep) | (bits & ~keep));
+  }
+  return (writer->pos + 7) / 8;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* Big-endian word loads shared by the bit readers, not installed */
+
+#ifndef SWIFTNAV_RTCM3_BITS_INTERNAL_H
+#define SWIFTNAV_RTCM3_BITS_INTERNAL_H
+
+#include <stdint.h>
+
+/* Load `n` (at most 8) bytes from `p` as a big-endian word, left aligned so
+ * the first byte ends up in the most significant bits of the result. */
+static inline uint64_t rtcm_load_be_bytes(const uint8_t *p, uint32_t n) {
+  uint64_t word = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    word = (word << 8) | p[i];
+  }
+  return word << (8 * (8 - n));
+}
+
+/* Load 8 bytes from `p` as a big-endian word. Written out so that the
+ * compiler can turn it into a single unaligned load and byte swap. */
+static inline uint64_t rtcm_load_be64(const uint8_t *p) {
+  return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+         ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+         ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+         ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+}
+
+#endif /* SWIFTNAV_RTCM3_BITS_INTERNAL_H */
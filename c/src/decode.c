@@ -22,6 +22,39 @@
 #include "rtcm3/eph_decode.h"
 #include "rtcm3/msm_utils.h"
 
+#include "decode_internal.h"
+#include "msg_layout.h"
+#include "msm_unpack.h"
+
+/* Bit budgets of the messages, see RTCM 10403.3 */
+#define PAYLOAD_BITS(len) ((uint32_t)(len)*8u)
+#define OBS_HEADER_BITS LAYOUT_BITS(GPS_OBS_HEADER_FIELDS)
+#define OBS_GLO_HEADER_BITS LAYOUT_BITS(GLO_OBS_HEADER_FIELDS)
+#define OBS_N_SAT_BIT 55     /* position of DF006 in the GPS header */
+#define OBS_GLO_N_SAT_BIT 52 /* position of DF035 in the GLO header */
+#define OBS_SAT_ID_BITS 6       /* DF009, DF038 */
+#define OBS_AMB_CNR_BITS 16     /* DF014 and DF015 */
+#define OBS_GLO_AMB_CNR_BITS 15 /* DF044 and DF045 */
+#define OBS_CNR_BITS 8          /* DF020, DF050 */
+#define MSG_1001_SAT_BITS (OBS_SAT_ID_BITS + LAYOUT_BITS(GPS_L1_OBS_FIELDS))
+#define MSG_1002_SAT_BITS (MSG_1001_SAT_BITS + OBS_AMB_CNR_BITS)
+#define MSG_1003_SAT_BITS (MSG_1001_SAT_BITS + LAYOUT_BITS(L2_OBS_FIELDS))
+#define MSG_1004_SAT_BITS \
+  (MSG_1002_SAT_BITS + LAYOUT_BITS(L2_OBS_FIELDS) + OBS_CNR_BITS)
+#define MSG_1009_SAT_BITS (OBS_SAT_ID_BITS + LAYOUT_BITS(GLO_L1_OBS_FIELDS))
+#define MSG_1010_SAT_BITS (MSG_1009_SAT_BITS + OBS_GLO_AMB_CNR_BITS)
+#define MSG_1011_SAT_BITS (MSG_1009_SAT_BITS + LAYOUT_BITS(L2_OBS_FIELDS))
+#define MSG_1012_SAT_BITS \
+  (MSG_1010_SAT_BITS + LAYOUT_BITS(L2_OBS_FIELDS) + OBS_CNR_BITS)
+#define MSG_1005_BITS (12 + LAYOUT_BITS(MSG_1005_FIELDS))
+#define MSG_1006_BITS (MSG_1005_BITS + LAYOUT_BITS(MSG_1006_FIELDS))
+#define MSG_1013_BITS (12 + LAYOUT_BITS(MSG_1013_FIELDS))
+#define MSG_1013_ENTRY_BITS LAYOUT_BITS(MSG_1013_ENTRY_FIELDS)
+#define MSG_1013_N_MSGS_BIT 57 /* position of DF053 */
+#define MSM_SAT_MASK_BIT 73
+#define MSM_SIG_MASK_BIT (MSM_SAT_MASK_BIT + MSM_SATELLITE_MASK_SIZE)
+#define MSM_CELL_MASK_BIT (MSM_SIG_MASK_BIT + MSM_SIGNAL_MASK_SIZE)
+
 static void init_sat_data(rtcm_sat_data *sat_data) {
   for (uint8_t freq = 0; freq < NUM_FREQS; ++freq) {
     sat_data->obs[freq].flags.data = 0;
@@ -67,7 +100,7 @@ double rtcm3_decode_lock_time(uint8_t lock) {
 
 /* Convert the Extended Lock Time Indicator DF407 into milliseconds. */
 /* RTCM 10403.3 Table 3.5-75 */
-static uint32_t from_msm_lock_ind_ext(uint16_t lock) {
+uint32_t rtcm3_from_msm_lock_ind_ext(uint16_t lock) {
   if (lock < 64) {
     return lock;
   }
@@ -135,97 +168,63 @@ static uint32_t from_msm_lock_ind_ext(uint16_t lock) {
 }
 
 static void decode_basic_gps_l1_freq_data(const uint8_t buff[],
+                                          uint32_t len,
                                           uint16_t *bit,
                                           rtcm_freq_data *freq_data,
                                           uint32_t *pr,
                                           int32_t *phr_pr_diff) {
-  freq_data->code = rtcm_getbitu(buff, *bit, 1);
-  *bit += 1;
-  *pr = rtcm_getbitu(buff, *bit, 24);
-  *bit += 24;
-  *phr_pr_diff = rtcm_getbits(buff, *bit, 20);
-  *bit += 20;
-
-  freq_data->lock = from_lock_ind(rtcm_getbitu(buff, *bit, 7));
-  *bit += 7;
+  obs_freq_fields fields;
+  *bit = gps_l1_obs_layout_decode(buff, len, *bit, &fields);
+  freq_data->code = fields.code;
+  *pr = (uint32_t)fields.pr;
+  *phr_pr_diff = fields.phr_pr_diff;
+  freq_data->lock = from_lock_ind(fields.lock_ind);
 }
 
 static void decode_basic_glo_l1_freq_data(const uint8_t buff[],
+                                          uint32_t len,
                                           uint16_t *bit,
                                           rtcm_freq_data *freq_data,
                                           uint32_t *pr,
                                           int32_t *phr_pr_diff,
                                           uint8_t *fcn) {
-  freq_data->code = rtcm_getbitu(buff, *bit, 1);
-  *bit += 1;
-  *fcn = rtcm_getbitu(buff, *bit, 5);
-  *bit += 5;
-  *pr = rtcm_getbitu(buff, *bit, 25);
-  *bit += 25;
-  *phr_pr_diff = rtcm_getbits(buff, *bit, 20);
-  *bit += 20;
-  freq_data->lock = from_lock_ind(rtcm_getbitu(buff, *bit, 7));
-  *bit += 7;
+  obs_freq_fields fields;
+  *bit = glo_l1_obs_layout_decode(buff, len, *bit, &fields);
+  freq_data->code = fields.code;
+  *fcn = fields.fcn;
+  *pr = (uint32_t)fields.pr;
+  *phr_pr_diff = fields.phr_pr_diff;
+  freq_data->lock = from_lock_ind(fields.lock_ind);
 }
 
 static void decode_basic_l2_freq_data(const uint8_t buff[],
+                                      uint32_t len,
                                       uint16_t *bit,
                                       rtcm_freq_data *freq_data,
                                       int32_t *pr,
                                       int32_t *phr_pr_diff) {
-  freq_data->code = rtcm_getbitu(buff, *bit, 2);
-  *bit += 2;
-  *pr = rtcm_getbits(buff, *bit, 14);
-  *bit += 14;
-  *phr_pr_diff = rtcm_getbits(buff, *bit, 20);
-  *bit += 20;
-
-  freq_data->lock = from_lock_ind(rtcm_getbitu(buff, *bit, 7));
-  *bit += 7;
+  obs_freq_fields fields;
+  *bit = l2_obs_layout_decode(buff, len, *bit, &fields);
+  freq_data->code = fields.code;
+  *pr = fields.pr;
+  *phr_pr_diff = fields.phr_pr_diff;
+  freq_data->lock = from_lock_ind(fields.lock_ind);
 }
 
 static uint16_t rtcm3_read_header(const uint8_t buff[],
                                   rtcm_obs_header *header) {
-  uint16_t bit = 0;
-  header->msg_num = rtcm_getbitu(buff, bit, 12);
-  bit += 12;
-  header->stn_id = rtcm_getbitu(buff, bit, 12);
-  bit += 12;
-  header->tow_ms = rtcm_getbitu(buff, bit, 30);
-  bit += 30;
-  header->sync = rtcm_getbitu(buff, bit, 1);
-  bit += 1;
-  header->n_sat = rtcm_getbitu(buff, bit, 5);
-  bit += 5;
-  header->div_free = rtcm_getbitu(buff, bit, 1);
-  bit += 1;
-  header->smooth = rtcm_getbitu(buff, bit, 3);
-  bit += 3;
-  return bit;
+  return gps_obs_header_decode(
+      buff, PAYLOAD_BYTES(OBS_HEADER_BITS), 0, header);
 }
 
 static uint16_t rtcm3_read_glo_header(const uint8_t buff[],
                                       rtcm_obs_header *header) {
-  uint16_t bit = 0;
-  header->msg_num = rtcm_getbitu(buff, bit, 12);
-  bit += 12;
-  header->stn_id = rtcm_getbitu(buff, bit, 12);
-  bit += 12;
-  header->tow_ms = rtcm_getbitu(buff, bit, 27);
-  bit += 27;
-  header->sync = rtcm_getbitu(buff, bit, 1);
-  bit += 1;
-  header->n_sat = rtcm_getbitu(buff, bit, 5);
-  bit += 5;
-  header->div_free = rtcm_getbitu(buff, bit, 1);
-  bit += 1;
-  header->smooth = rtcm_getbitu(buff, bit, 3);
-  bit += 3;
-  return bit;
+  return glo_obs_header_decode(
+      buff, PAYLOAD_BYTES(OBS_GLO_HEADER_BITS), 0, header);
 }
 
 /* unwrap underflowed uint30 value to a wrapped tow_ms value */
-static uint32_t normalize_bds2_tow(const uint32_t tow_ms) {
+uint32_t rtcm3_normalize_bds2_tow(const uint32_t tow_ms) {
   if (tow_ms >= C_2P30 - BDS_SECOND_TO_GPS_SECOND * 1000) {
     uint32_t negative_tow_ms = C_2P30 - tow_ms;
     return RTCM_MAX_TOW_MS + 1 - negative_tow_ms;
@@ -233,9 +232,18 @@ static uint32_t normalize_bds2_tow(const uint32_t tow_ms) {
   return tow_ms;
 }
 
-static uint16_t rtcm3_read_msm_header(const uint8_t buff[],
-                                      const rtcm_constellation_t cons,
-                                      rtcm_msm_header *header) {
+/** Read the header of an MSM message.
+ *
+ * \param buff The input data buffer
+ * \param cons Constellation matching the message number
+ * \param header The parsed header
+ * \param masks The header masks, packed
+ * \return Number of header bits
+ */
+uint16_t rtcm3_read_msm_header(const uint8_t buff[],
+                               const rtcm_constellation_t cons,
+                               rtcm_msm_header *header,
+                               rtcm_msm_masks *masks) {
   uint16_t bit = 0;
   header->msg_num = rtcm_getbitu(buff, bit, 12);
   bit += 12;
@@ -250,7 +258,7 @@ static uint16_t rtcm3_read_msm_header(const uint8_t buff[],
   } else if (RTCM_CONSTELLATION_BDS == cons) {
     /* Beidou time can be negative (at least for some Septentrio base stations),
      * so normalize it first */
-    header->tow_ms = normalize_bds2_tow(rtcm_getbitu(buff, bit, 30));
+    header->tow_ms = rtcm3_normalize_bds2_tow(rtcm_getbitu(buff, bit, 30));
     bit += 30;
   } else {
     /* for other systems, epoch time is the time of week in ms */
@@ -272,25 +280,39 @@ static uint16_t rtcm3_read_msm_header(const uint8_t buff[],
   header->smooth = rtcm_getbitu(buff, bit, 3);
   bit += 3;
 
-  for (uint8_t i = 0; i < MSM_SATELLITE_MASK_SIZE; i++) {
-    header->satellite_mask[i] = rtcm_getbitu(buff, bit, 1);
-    bit++;
-  }
-  for (uint8_t i = 0; i < MSM_SIGNAL_MASK_SIZE; i++) {
-    header->signal_mask[i] = rtcm_getbitu(buff, bit, 1);
-    bit++;
-  }
-  uint8_t num_sats =
-      count_mask_values(MSM_SATELLITE_MASK_SIZE, header->satellite_mask);
-  uint8_t num_sigs =
-      count_mask_values(MSM_SIGNAL_MASK_SIZE, header->signal_mask);
-  uint8_t cell_mask_size = num_sats * num_sigs;
+  masks->sats = reverse_mask_bits(
+      rtcm_getbitul(buff, bit, MSM_SATELLITE_MASK_SIZE),
+      MSM_SATELLITE_MASK_SIZE);
+  bit += MSM_SATELLITE_MASK_SIZE;
+  masks->sigs = (uint32_t)reverse_mask_bits(
+      rtcm_getbitu(buff, bit, MSM_SIGNAL_MASK_SIZE), MSM_SIGNAL_MASK_SIZE);
+  bit += MSM_SIGNAL_MASK_SIZE;
+  uint16_t cell_mask_size =
+      count_mask_bits(masks->sats) * count_mask_bits(masks->sigs);
+
+  /* an oversized cell mask is left empty, the caller rejects the message */
+  masks->cells = 0;
+  if (cell_mask_size > 0 && cell_mask_size <= MSM_MAX_CELLS) {
+    masks->cells = reverse_mask_bits(
+        rtcm_getbitul(buff, bit, (uint8_t)cell_mask_size),
+        (uint8_t)cell_mask_size);
+  }
+  bit += cell_mask_size;
+  msm_unpack_masks(masks, header);
+  return bit;
+}
 
-  for (uint8_t i = 0; i < cell_mask_size; i++) {
-    header->cell_mask[i] = rtcm_getbitu(buff, bit, 1);
-    bit++;
+/** Check the epoch time of an MSM message.
+ *
+ * \param cons Constellation of the message
+ * \param tow_ms Epoch time, time of day for GLO and time of week otherwise
+ * \return true if the epoch time is in range
+ */
+bool rtcm3_msm_tow_valid(const rtcm_constellation_t cons, uint32_t tow_ms) {
+  if (RTCM_CONSTELLATION_GLO == cons) {
+    return tow_ms <= RTCM_GLO_MAX_TOW_MS;
   }
-  return bit;
+  return tow_ms <= RTCM_MAX_TOW_MS;
 }
 
 static uint8_t construct_L1_code(rtcm_freq_data *l1_freq_data,
@@ -369,6 +391,10 @@ rtcm3_rc rtcm3_decode_1001(const uint8_t buff[], rtcm_obs_message *msg_1001) {
     return RC_INVALID_MESSAGE;
   }
 
+  /* Extent of the message implied by the header */
+  uint32_t len =
+      PAYLOAD_BYTES(bit + msg_1001->header.n_sat * MSG_1001_SAT_BITS);
+
   for (uint8_t i = 0; i < msg_1001->header.n_sat; i++) {
     init_sat_data(&msg_1001->sats[i]);
 
@@ -380,7 +406,7 @@ rtcm3_rc rtcm3_decode_1001(const uint8_t buff[], rtcm_obs_message *msg_1001) {
     uint32_t l1_pr;
     int32_t phr_pr_diff;
     decode_basic_gps_l1_freq_data(
-        buff, &bit, l1_freq_data, &l1_pr, &phr_pr_diff);
+        buff, len, &bit, l1_freq_data, &l1_pr, &phr_pr_diff);
 
     l1_freq_data->flags.valid_pr = construct_L1_code(l1_freq_data, l1_pr, 0);
     l1_freq_data->flags.valid_cp =
@@ -412,6 +438,10 @@ rtcm3_rc rtcm3_decode_1002(const uint8_t buff[], rtcm_obs_message *msg_1002) {
     return RC_INVALID_MESSAGE;
   }
 
+  /* Extent of the message implied by the header */
+  uint32_t len =
+      PAYLOAD_BYTES(bit + msg_1002->header.n_sat * MSG_1002_SAT_BITS);
+
   for (uint8_t i = 0; i < msg_1002->header.n_sat; i++) {
     init_sat_data(&msg_1002->sats[i]);
 
@@ -423,7 +453,7 @@ rtcm3_rc rtcm3_decode_1002(const uint8_t buff[], rtcm_obs_message *msg_1002) {
     uint32_t l1_pr;
     int32_t phr_pr_diff;
     decode_basic_gps_l1_freq_data(
-        buff, &bit, l1_freq_data, &l1_pr, &phr_pr_diff);
+        buff, len, &bit, l1_freq_data, &l1_pr, &phr_pr_diff);
 
     uint8_t amb = rtcm_getbitu(buff, bit, 8);
     bit += 8;
@@ -459,6 +489,10 @@ rtcm3_rc rtcm3_decode_1003(const uint8_t buff[], rtcm_obs_message *msg_1003) {
     return RC_INVALID_MESSAGE;
   }
 
+  /* Extent of the message implied by the header */
+  uint32_t len =
+      PAYLOAD_BYTES(bit + msg_1003->header.n_sat * MSG_1003_SAT_BITS);
+
   for (uint8_t i = 0; i < msg_1003->header.n_sat; i++) {
     init_sat_data(&msg_1003->sats[i]);
 
@@ -471,7 +505,7 @@ rtcm3_rc rtcm3_decode_1003(const uint8_t buff[], rtcm_obs_message *msg_1003) {
     int32_t l2_pr;
     int32_t phr_pr_diff;
     decode_basic_gps_l1_freq_data(
-        buff, &bit, l1_freq_data, &l1_pr, &phr_pr_diff);
+        buff, len, &bit, l1_freq_data, &l1_pr, &phr_pr_diff);
 
     l1_freq_data->flags.valid_pr = construct_L1_code(l1_freq_data, l1_pr, 0);
     l1_freq_data->flags.valid_cp =
@@ -480,7 +514,8 @@ rtcm3_rc rtcm3_decode_1003(const uint8_t buff[], rtcm_obs_message *msg_1003) {
 
     rtcm_freq_data *l2_freq_data = &msg_1003->sats[i].obs[L2_FREQ];
 
-    decode_basic_l2_freq_data(buff, &bit, l2_freq_data, &l2_pr, &phr_pr_diff);
+    decode_basic_l2_freq_data(
+        buff, len, &bit, l2_freq_data, &l2_pr, &phr_pr_diff);
 
     l2_freq_data->flags.valid_pr =
         construct_L2_code(l2_freq_data, l1_freq_data, l2_pr);
@@ -513,6 +548,10 @@ rtcm3_rc rtcm3_decode_1004(const uint8_t buff[], rtcm_obs_message *msg_1004) {
     return RC_INVALID_MESSAGE;
   }
 
+  /* Extent of the message implied by the header */
+  uint32_t len =
+      PAYLOAD_BYTES(bit + msg_1004->header.n_sat * MSG_1004_SAT_BITS);
+
   for (uint8_t i = 0; i < msg_1004->header.n_sat; i++) {
     init_sat_data(&msg_1004->sats[i]);
 
@@ -525,7 +564,7 @@ rtcm3_rc rtcm3_decode_1004(const uint8_t buff[], rtcm_obs_message *msg_1004) {
     int32_t l2_pr;
     int32_t phr_pr_diff;
     decode_basic_gps_l1_freq_data(
-        buff, &bit, l1_freq_data, &l1_pr, &phr_pr_diff);
+        buff, len, &bit, l1_freq_data, &l1_pr, &phr_pr_diff);
 
     uint8_t amb = rtcm_getbitu(buff, bit, 8);
     bit += 8;
@@ -539,7 +578,8 @@ rtcm3_rc rtcm3_decode_1004(const uint8_t buff[], rtcm_obs_message *msg_1004) {
 
     rtcm_freq_data *l2_freq_data = &msg_1004->sats[i].obs[L2_FREQ];
 
-    decode_basic_l2_freq_data(buff, &bit, l2_freq_data, &l2_pr, &phr_pr_diff);
+    decode_basic_l2_freq_data(
+        buff, len, &bit, l2_freq_data, &l2_pr, &phr_pr_diff);
 
     l2_freq_data->flags.valid_cnr = get_cnr(l2_freq_data, buff, &bit);
     l2_freq_data->flags.valid_pr =
@@ -555,31 +595,8 @@ rtcm3_rc rtcm3_decode_1004(const uint8_t buff[], rtcm_obs_message *msg_1004) {
 static rtcm3_rc rtcm3_decode_1005_base(const uint8_t buff[],
                                        rtcm_msg_1005 *msg_1005,
                                        uint16_t *bit) {
-  msg_1005->stn_id = rtcm_getbitu(buff, *bit, 12);
-  *bit += 12;
-  msg_1005->ITRF = rtcm_getbitu(buff, *bit, 6);
-  *bit += 6;
-  msg_1005->GPS_ind = rtcm_getbitu(buff, *bit, 1);
-  *bit += 1;
-  msg_1005->GLO_ind = rtcm_getbitu(buff, *bit, 1);
-  *bit += 1;
-  msg_1005->GAL_ind = rtcm_getbitu(buff, *bit, 1);
-  *bit += 1;
-  msg_1005->ref_stn_ind = rtcm_getbitu(buff, *bit, 1);
-  *bit += 1;
-  msg_1005->arp_x = (double)(rtcm_getbitsl(buff, *bit, 38)) / 10000.0;
-  *bit += 38;
-  msg_1005->osc_ind = rtcm_getbitu(buff, *bit, 1);
-  *bit += 1;
-  rtcm_getbitu(buff, *bit, 1);
-  *bit += 1;
-  msg_1005->arp_y = (double)(rtcm_getbitsl(buff, *bit, 38)) / 10000.0;
-  *bit += 38;
-  msg_1005->quart_cycle_ind = rtcm_getbitu(buff, *bit, 2);
-  *bit += 2;
-  msg_1005->arp_z = (double)(rtcm_getbitsl(buff, *bit, 38)) / 10000.0;
-  *bit += 38;
-
+  *bit = msg_1005_layout_decode(
+      buff, PAYLOAD_BYTES(MSG_1005_BITS), *bit, msg_1005);
   return RC_OK;
 }
 
@@ -622,8 +639,8 @@ rtcm3_rc rtcm3_decode_1006(const uint8_t buff[], rtcm_msg_1006 *msg_1006) {
   }
 
   rtcm3_decode_1005_base(buff, &msg_1006->msg_1005, &bit);
-  msg_1006->ant_height = (double)(rtcm_getbitu(buff, bit, 16)) / 10000.0;
-  bit += 16;
+  msg_1006_layout_decode(
+      buff, PAYLOAD_BYTES(MSG_1006_BITS), bit, msg_1006);
   return RC_OK;
 }
 
@@ -693,6 +710,62 @@ rtcm3_rc rtcm3_decode_1008(const uint8_t buff[], rtcm_msg_1008 *msg_1008) {
   return RC_OK;
 }
 
+/** Decode an RTCMv3 message type 1009 (L1-Only GLO RTK Observables)
+ *
+ * \param buff The input data buffer
+ * \param RTCM message struct
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Message type mismatch
+ *          - RC_INVALID_MESSAGE : TOW sanity check fail
+ */
+rtcm3_rc rtcm3_decode_1009(const uint8_t buff[], rtcm_obs_message *msg_1009) {
+  assert(msg_1009);
+  uint16_t bit = 0;
+  bit += rtcm3_read_glo_header(buff, &msg_1009->header);
+
+  if (msg_1009->header.msg_num != 1009) { /* Unexpected message type. */
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+
+  if (msg_1009->header.tow_ms > RTCM_GLO_MAX_TOW_MS) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  /* Extent of the message implied by the header */
+  uint32_t len =
+      PAYLOAD_BYTES(bit + msg_1009->header.n_sat * MSG_1009_SAT_BITS);
+
+  for (uint8_t i = 0; i < msg_1009->header.n_sat; i++) {
+    init_sat_data(&msg_1009->sats[i]);
+
+    msg_1009->sats[i].svId = rtcm_getbitu(buff, bit, 6);
+    bit += 6;
+
+    rtcm_freq_data *l1_freq_data = &msg_1009->sats[i].obs[L1_FREQ];
+
+    uint32_t l1_pr;
+    int32_t phr_pr_diff;
+    decode_basic_glo_l1_freq_data(buff,
+                                  len,
+                                  &bit,
+                                  l1_freq_data,
+                                  &l1_pr,
+                                  &phr_pr_diff,
+                                  &msg_1009->sats[i].fcn);
+
+    /* Without DF044 the pseudorange is only known modulo 1 light-ms */
+    int8_t glo_fcn = msg_1009->sats[i].fcn - MT1012_GLO_FCN_OFFSET;
+    l1_freq_data->flags.valid_pr = construct_L1_code(l1_freq_data, l1_pr, 0);
+    l1_freq_data->flags.valid_cp =
+        (msg_1009->sats[i].fcn <= MT1012_GLO_MAX_FCN) &&
+        construct_L1_phase(
+            l1_freq_data, phr_pr_diff, GLO_L1_HZ + glo_fcn * GLO_L1_DELTA_HZ);
+    l1_freq_data->flags.valid_lock = l1_freq_data->flags.valid_cp;
+  }
+
+  return RC_OK;
+}
+
 /** Decode an RTCMv3 message type 1010 (Extended L1-Only GLO RTK Observables)
  *
  * \param buff The input data buffer
@@ -714,6 +787,10 @@ rtcm3_rc rtcm3_decode_1010(const uint8_t buff[], rtcm_obs_message *msg_1010) {
     return RC_INVALID_MESSAGE;
   }
 
+  /* Extent of the message implied by the header */
+  uint32_t len =
+      PAYLOAD_BYTES(bit + msg_1010->header.n_sat * MSG_1010_SAT_BITS);
+
   for (uint8_t i = 0; i < msg_1010->header.n_sat; i++) {
     init_sat_data(&msg_1010->sats[i]);
 
@@ -724,8 +801,13 @@ rtcm3_rc rtcm3_decode_1010(const uint8_t buff[], rtcm_obs_message *msg_1010) {
 
     uint32_t l1_pr;
     int32_t phr_pr_diff;
-    decode_basic_glo_l1_freq_data(
-        buff, &bit, l1_freq_data, &l1_pr, &phr_pr_diff, &msg_1010->sats[i].fcn);
+    decode_basic_glo_l1_freq_data(buff,
+                                  len,
+                                  &bit,
+                                  l1_freq_data,
+                                  &l1_pr,
+                                  &phr_pr_diff,
+                                  &msg_1010->sats[i].fcn);
 
     uint8_t amb = rtcm_getbitu(buff, bit, 7);
     bit += 7;
@@ -745,6 +827,76 @@ rtcm3_rc rtcm3_decode_1010(const uint8_t buff[], rtcm_obs_message *msg_1010) {
   return RC_OK;
 }
 
+/** Decode an RTCMv3 message type 1011 (L1/L2 GLO RTK Observables)
+ *
+ * \param buff The input data buffer
+ * \param RTCM message struct
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Message type mismatch
+ *          - RC_INVALID_MESSAGE : TOW sanity check fail
+ */
+rtcm3_rc rtcm3_decode_1011(const uint8_t buff[], rtcm_obs_message *msg_1011) {
+  assert(msg_1011);
+  uint16_t bit = 0;
+  bit += rtcm3_read_glo_header(buff, &msg_1011->header);
+
+  if (msg_1011->header.msg_num != 1011) { /* Unexpected message type. */
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+
+  if (msg_1011->header.tow_ms > RTCM_GLO_MAX_TOW_MS) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  /* Extent of the message implied by the header */
+  uint32_t len =
+      PAYLOAD_BYTES(bit + msg_1011->header.n_sat * MSG_1011_SAT_BITS);
+
+  for (uint8_t i = 0; i < msg_1011->header.n_sat; i++) {
+    init_sat_data(&msg_1011->sats[i]);
+
+    msg_1011->sats[i].svId = rtcm_getbitu(buff, bit, 6);
+    bit += 6;
+
+    rtcm_freq_data *l1_freq_data = &msg_1011->sats[i].obs[L1_FREQ];
+
+    uint32_t l1_pr;
+    int32_t l2_pr;
+    int32_t phr_pr_diff;
+    decode_basic_glo_l1_freq_data(buff,
+                                  len,
+                                  &bit,
+                                  l1_freq_data,
+                                  &l1_pr,
+                                  &phr_pr_diff,
+                                  &msg_1011->sats[i].fcn);
+
+    int8_t glo_fcn = msg_1011->sats[i].fcn - MT1012_GLO_FCN_OFFSET;
+    l1_freq_data->flags.valid_pr = construct_L1_code(l1_freq_data, l1_pr, 0);
+    l1_freq_data->flags.valid_cp =
+        (msg_1011->sats[i].fcn <= MT1012_GLO_MAX_FCN) &&
+        construct_L1_phase(
+            l1_freq_data, phr_pr_diff, GLO_L1_HZ + glo_fcn * GLO_L1_DELTA_HZ);
+    l1_freq_data->flags.valid_lock = l1_freq_data->flags.valid_cp;
+
+    rtcm_freq_data *l2_freq_data = &msg_1011->sats[i].obs[L2_FREQ];
+
+    decode_basic_l2_freq_data(
+        buff, len, &bit, l2_freq_data, &l2_pr, &phr_pr_diff);
+
+    l2_freq_data->flags.valid_pr =
+        construct_L2_code(l2_freq_data, l1_freq_data, l2_pr);
+    l2_freq_data->flags.valid_cp =
+        construct_L2_phase(l2_freq_data,
+                           l1_freq_data,
+                           phr_pr_diff,
+                           GLO_L2_HZ + glo_fcn * GLO_L2_DELTA_HZ);
+    l2_freq_data->flags.valid_lock = l2_freq_data->flags.valid_cp;
+  }
+
+  return RC_OK;
+}
+
 /** Decode an RTCMv3 message type 1012 (Extended L1/L2 GLO RTK Observables)
  *
  * \param buff The input data buffer
@@ -766,6 +918,10 @@ rtcm3_rc rtcm3_decode_1012(const uint8_t buff[], rtcm_obs_message *msg_1012) {
     return RC_INVALID_MESSAGE;
   }
 
+  /* Extent of the message implied by the header */
+  uint32_t len =
+      PAYLOAD_BYTES(bit + msg_1012->header.n_sat * MSG_1012_SAT_BITS);
+
   for (uint8_t i = 0; i < msg_1012->header.n_sat; i++) {
     init_sat_data(&msg_1012->sats[i]);
 
@@ -777,8 +933,13 @@ rtcm3_rc rtcm3_decode_1012(const uint8_t buff[], rtcm_obs_message *msg_1012) {
     uint32_t l1_pr;
     int32_t l2_pr;
     int32_t phr_pr_diff;
-    decode_basic_glo_l1_freq_data(
-        buff, &bit, l1_freq_data, &l1_pr, &phr_pr_diff, &msg_1012->sats[i].fcn);
+    decode_basic_glo_l1_freq_data(buff,
+                                  len,
+                                  &bit,
+                                  l1_freq_data,
+                                  &l1_pr,
+                                  &phr_pr_diff,
+                                  &msg_1012->sats[i].fcn);
 
     uint8_t amb = rtcm_getbitu(buff, bit, 7);
     bit += 7;
@@ -795,7 +956,8 @@ rtcm3_rc rtcm3_decode_1012(const uint8_t buff[], rtcm_obs_message *msg_1012) {
 
     rtcm_freq_data *l2_freq_data = &msg_1012->sats[i].obs[L2_FREQ];
 
-    decode_basic_l2_freq_data(buff, &bit, l2_freq_data, &l2_pr, &phr_pr_diff);
+    decode_basic_l2_freq_data(
+        buff, len, &bit, l2_freq_data, &l2_pr, &phr_pr_diff);
 
     l2_freq_data->flags.valid_cnr = get_cnr(l2_freq_data, buff, &bit);
     l2_freq_data->flags.valid_pr =
@@ -811,6 +973,29 @@ rtcm3_rc rtcm3_decode_1012(const uint8_t buff[], rtcm_obs_message *msg_1012) {
   return RC_OK;
 }
 
+/** Decode an RTCMv3 message type 1013 (System Parameters)
+ *
+ * \param buff The input data buffer
+ * \param RTCM message struct
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Message type mismatch
+ */
+rtcm3_rc rtcm3_decode_1013(const uint8_t buff[], rtcm_msg_1013 *msg_1013) {
+  assert(msg_1013);
+  if (1013 != rtcm_getbitu(buff, 0, 12)) { /* Unexpected message type. */
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+
+  uint32_t bit =
+      msg_1013_layout_decode(buff, PAYLOAD_BYTES(MSG_1013_BITS), 12, msg_1013);
+  uint32_t len =
+      PAYLOAD_BYTES(MSG_1013_BITS + msg_1013->n_msgs * MSG_1013_ENTRY_BITS);
+  for (uint8_t i = 0; i < msg_1013->n_msgs; i++) {
+    bit = msg_1013_entry_layout_decode(buff, len, bit, &msg_1013->msgs[i]);
+  }
+  return RC_OK;
+}
+
 /** Decode an RTCMv3 message type 1029 (Unicode Text String Message)
  *
  * \param buff The input data buffer
@@ -1010,138 +1195,134 @@ static void decode_msm_sat_data(const uint8_t buff[],
 static void decode_msm_fine_pseudoranges(const uint8_t buff[],
                                          const uint8_t num_cells,
                                          double fine_pr_ms[],
-                                         flag_bf flags[],
+                                         uint64_t *valid,
                                          uint16_t *bit) {
   /* DF400 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    int16_t decoded = (int16_t)rtcm_getbits(buff, *bit, 15);
-    *bit += 15;
-    flags[i].valid_pr = (decoded != MSM_PR_INVALID);
-    fine_pr_ms[i] = (double)decoded * C_1_2P24;
-  }
+  *valid |= rtcm3_unpack_scaled(
+      buff, *bit, 15, true, num_cells, MSM_PR_INVALID, C_1_2P24, fine_pr_ms);
+  *bit += 15 * num_cells;
 }
 
 static void decode_msm_fine_pseudoranges_extended(const uint8_t buff[],
                                                   const uint8_t num_cells,
                                                   double fine_pr_ms[],
-                                                  flag_bf flags[],
+                                                  uint64_t *valid,
                                                   uint16_t *bit) {
   /* DF405 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    int32_t decoded = (int32_t)rtcm_getbitsl(buff, *bit, 20);
-    *bit += 20;
-    flags[i].valid_pr = (decoded != MSM_PR_EXT_INVALID);
-    fine_pr_ms[i] = (double)decoded * C_1_2P29;
-  }
+  *valid |= rtcm3_unpack_scaled(buff,
+                                *bit,
+                                20,
+                                true,
+                                num_cells,
+                                MSM_PR_EXT_INVALID,
+                                C_1_2P29,
+                                fine_pr_ms);
+  *bit += 20 * num_cells;
 }
 
 static void decode_msm_fine_phaseranges(const uint8_t buff[],
                                         const uint8_t num_cells,
                                         double fine_cp_ms[],
-                                        flag_bf flags[],
+                                        uint64_t *valid,
                                         uint16_t *bit) {
   /* DF401 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    int32_t decoded = rtcm_getbits(buff, *bit, 22);
-    *bit += 22;
-    flags[i].valid_cp = (decoded != MSM_CP_INVALID);
-    fine_cp_ms[i] = (double)decoded * C_1_2P29;
-  }
+  *valid |= rtcm3_unpack_scaled(
+      buff, *bit, 22, true, num_cells, MSM_CP_INVALID, C_1_2P29, fine_cp_ms);
+  *bit += 22 * num_cells;
 }
 
 static void decode_msm_fine_phaseranges_extended(const uint8_t buff[],
                                                  const uint8_t num_cells,
                                                  double fine_cp_ms[],
-                                                 flag_bf flags[],
+                                                 uint64_t *valid,
                                                  uint16_t *bit) {
   /* DF406 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    int32_t decoded = rtcm_getbits(buff, *bit, 24);
-    *bit += 24;
-    flags[i].valid_cp = (decoded != MSM_CP_EXT_INVALID);
-    fine_cp_ms[i] = (double)decoded * C_1_2P31;
-  }
+  *valid |= rtcm3_unpack_scaled(buff,
+                                *bit,
+                                24,
+                                true,
+                                num_cells,
+                                MSM_CP_EXT_INVALID,
+                                C_1_2P31,
+                                fine_cp_ms);
+  *bit += 24 * num_cells;
 }
 
 static void decode_msm_lock_times(const uint8_t buff[],
                                   const uint8_t num_cells,
                                   double lock_time[],
-                                  flag_bf flags[],
                                   uint16_t *bit) {
   /* DF402 */
+  int32_t lock_ind[MSM_MAX_CELLS];
+  rtcm3_unpack_fields(
+      buff, *bit, 4, false, num_cells, MSM_UNPACK_NO_SENTINEL, lock_ind);
+  *bit += 4 * num_cells;
   for (uint16_t i = 0; i < num_cells; i++) {
-    uint32_t lock_ind = rtcm_getbitu(buff, *bit, 4);
-    *bit += 4;
-    lock_time[i] = rtcm3_decode_lock_time(lock_ind);
-    flags[i].valid_lock = 1;
+    lock_time[i] = rtcm3_decode_lock_time((uint8_t)lock_ind[i]);
   }
 }
 
 static void decode_msm_lock_times_extended(const uint8_t buff[],
                                            const uint8_t num_cells,
                                            double lock_time[],
-                                           flag_bf flags[],
                                            uint16_t *bit) {
   /* DF407 */
+  int32_t lock_ind[MSM_MAX_CELLS];
+  rtcm3_unpack_fields(
+      buff, *bit, 10, false, num_cells, MSM_UNPACK_NO_SENTINEL, lock_ind);
+  *bit += 10 * num_cells;
   for (uint16_t i = 0; i < num_cells; i++) {
-    uint16_t lock_ind = rtcm_getbitu(buff, *bit, 10);
-    *bit += 10;
-    lock_time[i] = (double)from_msm_lock_ind_ext(lock_ind) / 1000;
-    flags[i].valid_lock = 1;
+    lock_time[i] =
+        (double)rtcm3_from_msm_lock_ind_ext((uint16_t)lock_ind[i]) / 1000;
   }
 }
 
 static void decode_msm_hca_indicators(const uint8_t buff[],
                                       const uint8_t num_cells,
-                                      bool hca_indicator[],
+                                      uint64_t *hca_indicator,
                                       uint16_t *bit) {
-  /* DF420 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    hca_indicator[i] = (bool)rtcm_getbitu(buff, *bit, 1);
-    *bit += 1;
-  }
+  /* DF420, the indicators are the cells that are not 0 */
+  *hca_indicator |=
+      rtcm3_unpack_fields(buff, *bit, 1, false, num_cells, 0, NULL);
+  *bit += num_cells;
 }
 
 static void decode_msm_cnrs(const uint8_t buff[],
                             const uint8_t num_cells,
                             double cnr[],
-                            flag_bf flags[],
+                            uint64_t *valid,
                             uint16_t *bit) {
   /* DF403 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    uint32_t decoded = rtcm_getbitu(buff, *bit, 6);
-    *bit += 6;
-    flags[i].valid_cnr = (decoded != 0);
-    cnr[i] = (double)decoded;
-  }
+  *valid |= rtcm3_unpack_scaled(buff, *bit, 6, false, num_cells, 0, 1.0, cnr);
+  *bit += 6 * num_cells;
 }
 
 static void decode_msm_cnrs_extended(const uint8_t buff[],
                                      const uint8_t num_cells,
                                      double cnr[],
-                                     flag_bf flags[],
+                                     uint64_t *valid,
                                      uint16_t *bit) {
   /* DF408 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    uint32_t decoded = rtcm_getbitu(buff, *bit, 10);
-    *bit += 10;
-    flags[i].valid_cnr = (decoded != 0);
-    cnr[i] = (double)decoded * C_1_2P4;
-  }
+  *valid |=
+      rtcm3_unpack_scaled(buff, *bit, 10, false, num_cells, 0, C_1_2P4, cnr);
+  *bit += 10 * num_cells;
 }
 
 static void decode_msm_fine_phaserangerates(const uint8_t buff[],
                                             const uint8_t num_cells,
                                             double *fine_range_rate_m_s,
-                                            flag_bf *flags,
+                                            uint64_t *valid,
                                             uint16_t *bit) {
   /* DF404 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    int32_t decoded = rtcm_getbits(buff, *bit, 15);
-    *bit += 15;
-    fine_range_rate_m_s[i] = (double)decoded * 0.0001;
-    flags[i].valid_dop = (decoded != MSM_DOP_INVALID);
-  }
+  *valid |= rtcm3_unpack_scaled(buff,
+                                *bit,
+                                15,
+                                true,
+                                num_cells,
+                                MSM_DOP_INVALID,
+                                0.0001,
+                                fine_range_rate_m_s);
+  *bit += 15 * num_cells;
 }
 
 /** Decode an RTCMv3 Multi System Messages 4-7
@@ -1175,29 +1356,47 @@ static rtcm3_rc rtcm3_decode_msm_internal(const uint8_t buff[],
     return RC_MESSAGE_TYPE_MISMATCH;
   }
 
+  return rtcm3_decode_msm_unchecked(buff, msm_type, cons, msg);
+}
+
+/** Decode the header, satellite data and signal data of an RTCMv3 Multi
+ * System Message 4-7 into columns.
+ *
+ * The fine values are decoded straight into the caller's columns and the
+ * rough values of each cell's satellite are then added in place.
+ *
+ * \param buff The input data buffer
+ * \param msm_type MSM4, MSM5, MSM6 or MSM7, matching the message number
+ * \param cons Constellation matching the message number
+ * \param header The parsed message header
+ * \param sats The parsed satellite data, RTCM_MAX_SATS entries
+ * \param cells The parsed signal data
+ * \return  - RC_OK : Success
+ *          - RC_INVALID_MESSAGE : Cell mask too large or invalid TOW
+ */
+static rtcm3_rc decode_msm_columns(const uint8_t buff[],
+                                   const msm_enum msm_type,
+                                   const rtcm_constellation_t cons,
+                                   rtcm_msm_header *header,
+                                   rtcm_msm_sat_data sats[],
+                                   rtcm_msm_signal_columns *cells) {
+  rtcm_msm_masks masks;
   uint16_t bit = 0;
-  bit += rtcm3_read_msm_header(buff, cons, &msg->header);
+  bit += rtcm3_read_msm_header(buff, cons, header, &masks);
 
-  if (RTCM_CONSTELLATION_GLO != cons) {
-    if (msg->header.tow_ms > RTCM_MAX_TOW_MS) {
-      return RC_INVALID_MESSAGE;
-    }
-  } else if (msg->header.tow_ms > RTCM_GLO_MAX_TOW_MS) { /* GLO */
+  if (!rtcm3_msm_tow_valid(cons, header->tow_ms)) {
     return RC_INVALID_MESSAGE;
   }
 
-  uint8_t num_sats =
-      count_mask_values(MSM_SATELLITE_MASK_SIZE, msg->header.satellite_mask);
-  uint8_t num_sigs =
-      count_mask_values(MSM_SIGNAL_MASK_SIZE, msg->header.signal_mask);
+  uint8_t num_sats = count_mask_bits(masks.sats);
+  uint8_t num_sigs = count_mask_bits(masks.sigs);
 
-  if (num_sats * num_sigs > MSM_MAX_CELLS) {
+  if (num_sats * num_sigs > MSM_MAX_CELLS || num_sats > RTCM_MAX_SATS) {
     /* Too large cell mask, most probably a parsing error */
     return RC_INVALID_MESSAGE;
   }
 
-  uint8_t cell_mask_size = num_sats * num_sigs;
-  uint8_t num_cells = count_mask_values(cell_mask_size, msg->header.cell_mask);
+  uint8_t num_cells = count_mask_bits(masks.cells);
 
   /* Satellite Data */
 
@@ -1221,96 +1420,187 @@ static rtcm3_rc rtcm3_decode_msm_internal(const uint8_t buff[],
 
   /* Signal Data */
 
-  double fine_pr_ms[num_cells];
-  double fine_cp_ms[num_cells];
-  double lock_time[num_cells];
-  bool hca_indicator[num_cells];
-  double cnr[num_cells];
-  double fine_range_rate_m_s[num_cells];
-  flag_bf flags[num_cells];
-
-  for (uint8_t i = 0; i < num_cells; i++) {
-    flags[i].data = 0;
-  }
+  cells->num_cells = num_cells;
+  cells->valid_pr = 0;
+  cells->valid_cp = 0;
+  cells->valid_cnr = 0;
+  cells->valid_dop = 0;
+  cells->hca_indicator = 0;
+  /* lock time has no invalid value */
+  cells->valid_lock = (num_cells < 64) ? (((uint64_t)1 << num_cells) - 1)
+                                       : UINT64_MAX;
 
   if (MSM4 == msm_type || MSM5 == msm_type) {
-    decode_msm_fine_pseudoranges(buff, num_cells, fine_pr_ms, flags, &bit);
-    decode_msm_fine_phaseranges(buff, num_cells, fine_cp_ms, flags, &bit);
-    decode_msm_lock_times(buff, num_cells, lock_time, flags, &bit);
+    decode_msm_fine_pseudoranges(
+        buff, num_cells, cells->pseudorange_ms, &cells->valid_pr, &bit);
+    decode_msm_fine_phaseranges(
+        buff, num_cells, cells->carrier_phase_ms, &cells->valid_cp, &bit);
+    decode_msm_lock_times(buff, num_cells, cells->lock_time_s, &bit);
   } else if (MSM6 == msm_type || MSM7 == msm_type) {
     decode_msm_fine_pseudoranges_extended(
-        buff, num_cells, fine_pr_ms, flags, &bit);
+        buff, num_cells, cells->pseudorange_ms, &cells->valid_pr, &bit);
     decode_msm_fine_phaseranges_extended(
-        buff, num_cells, fine_cp_ms, flags, &bit);
-    decode_msm_lock_times_extended(buff, num_cells, lock_time, flags, &bit);
+        buff, num_cells, cells->carrier_phase_ms, &cells->valid_cp, &bit);
+    decode_msm_lock_times_extended(
+        buff, num_cells, cells->lock_time_s, &bit);
   } else {
     return RC_MESSAGE_TYPE_MISMATCH;
   }
 
-  decode_msm_hca_indicators(buff, num_cells, hca_indicator, &bit);
+  decode_msm_hca_indicators(buff, num_cells, &cells->hca_indicator, &bit);
 
   if (MSM4 == msm_type || MSM5 == msm_type) {
-    decode_msm_cnrs(buff, num_cells, cnr, flags, &bit);
+    decode_msm_cnrs(buff, num_cells, cells->cnr, &cells->valid_cnr, &bit);
   } else if (MSM6 == msm_type || MSM7 == msm_type) {
-    decode_msm_cnrs_extended(buff, num_cells, cnr, flags, &bit);
+    decode_msm_cnrs_extended(
+        buff, num_cells, cells->cnr, &cells->valid_cnr, &bit);
   } else {
     return RC_MESSAGE_TYPE_MISMATCH;
   }
 
   if (MSM5 == msm_type || MSM7 == msm_type) {
     decode_msm_fine_phaserangerates(
-        buff, num_cells, fine_range_rate_m_s, flags, &bit);
+        buff, num_cells, cells->range_rate_m_s, &cells->valid_dop, &bit);
   }
 
-  uint8_t i = 0;
   for (uint8_t sat = 0; sat < num_sats; sat++) {
-    msg->sats[sat].rough_range_ms = rough_range_ms[sat];
-    msg->sats[sat].rough_range_rate_m_s = rough_rate_m_s[sat];
+    sats[sat].rough_range_ms = rough_range_ms[sat];
+    sats[sat].rough_range_rate_m_s = rough_rate_m_s[sat];
     if (RTCM_CONSTELLATION_GLO == cons && !sat_info_valid[sat]) {
-      msg->sats[sat].glo_fcn = MSM_GLO_FCN_UNKNOWN;
+      sats[sat].glo_fcn = MSM_GLO_FCN_UNKNOWN;
     } else {
-      msg->sats[sat].glo_fcn = sat_info[sat];
+      sats[sat].glo_fcn = sat_info[sat];
     }
+  }
 
-    for (uint8_t sig = 0; sig < num_sigs; sig++) {
-      if (msg->header.cell_mask[sat * num_sigs + sig]) {
-        if (rough_range_valid[sat] && flags[i].valid_pr) {
-          msg->signals[i].pseudorange_ms = rough_range_ms[sat] + fine_pr_ms[i];
-        } else {
-          msg->signals[i].pseudorange_ms = 0;
-          flags[i].valid_pr = false;
-        }
-        if (rough_range_valid[sat] && flags[i].valid_cp) {
-          msg->signals[i].carrier_phase_ms =
-              rough_range_ms[sat] + fine_cp_ms[i];
-        } else {
-          msg->signals[i].carrier_phase_ms = 0;
-          flags[i].valid_cp = false;
-        }
-        msg->signals[i].lock_time_s = lock_time[i];
-        msg->signals[i].hca_indicator = hca_indicator[i];
-        if (flags[i].valid_cnr) {
-          msg->signals[i].cnr = cnr[i];
-        } else {
-          msg->signals[i].cnr = 0;
-        }
-        if (rough_rate_valid[sat] && flags[i].valid_dop) {
-          /* convert Doppler into Hz */
-          msg->signals[i].range_rate_m_s =
-              rough_rate_m_s[sat] + fine_range_rate_m_s[i];
-        } else {
-          msg->signals[i].range_rate_m_s = 0;
-          flags[i].valid_dop = 0;
-        }
-        msg->signals[i].flags = flags[i];
-        i++;
-      }
+  uint64_t cell_mask = masks.cells;
+  for (uint8_t i = 0; i < num_cells; i++) {
+    uint8_t pos = pop_first_mask_bit(&cell_mask);
+    uint8_t sat = pos / num_sigs;
+    uint64_t cell = (uint64_t)1 << i;
+    cells->sat_index[i] = sat;
+    cells->sig_index[i] = pos % num_sigs;
+    if (rough_range_valid[sat] && (cells->valid_pr & cell)) {
+      cells->pseudorange_ms[i] += rough_range_ms[sat];
+    } else {
+      cells->pseudorange_ms[i] = 0;
+      cells->valid_pr &= ~cell;
+    }
+    if (rough_range_valid[sat] && (cells->valid_cp & cell)) {
+      cells->carrier_phase_ms[i] += rough_range_ms[sat];
+    } else {
+      cells->carrier_phase_ms[i] = 0;
+      cells->valid_cp &= ~cell;
+    }
+    if (!(cells->valid_cnr & cell)) {
+      cells->cnr[i] = 0;
+    }
+    if (rough_rate_valid[sat] && (cells->valid_dop & cell)) {
+      cells->range_rate_m_s[i] += rough_rate_m_s[sat];
+    } else {
+      cells->range_rate_m_s[i] = 0;
+      cells->valid_dop &= ~cell;
     }
   }
 
   return RC_OK;
 }
 
+/** Decode an RTCMv3 Multi System Message 4-7 whose type and constellation
+ * have already been derived from the message number by the caller.
+ *
+ * \param buff The input data buffer
+ * \param msm_type MSM4, MSM5, MSM6 or MSM7, matching the message number
+ * \param cons Constellation matching the message number
+ * \param msg The parsed RTCM message struct
+ * \return  - RC_OK : Success
+ *          - RC_INVALID_MESSAGE : Cell mask too large or invalid TOW
+ */
+rtcm3_rc rtcm3_decode_msm_unchecked(const uint8_t buff[],
+                                    const msm_enum msm_type,
+                                    const rtcm_constellation_t cons,
+                                    rtcm_msm_message *msg) {
+  uint8_t sat_index[MSM_MAX_CELLS];
+  uint8_t sig_index[MSM_MAX_CELLS];
+  double pseudorange_ms[MSM_MAX_CELLS];
+  double carrier_phase_ms[MSM_MAX_CELLS];
+  double range_rate_m_s[MSM_MAX_CELLS];
+  double cnr[MSM_MAX_CELLS];
+  double lock_time_s[MSM_MAX_CELLS];
+  rtcm_msm_signal_columns cells = {.sat_index = sat_index,
+                                   .sig_index = sig_index,
+                                   .pseudorange_ms = pseudorange_ms,
+                                   .carrier_phase_ms = carrier_phase_ms,
+                                   .range_rate_m_s = range_rate_m_s,
+                                   .cnr = cnr,
+                                   .lock_time_s = lock_time_s};
+
+  rtcm3_rc ret = decode_msm_columns(
+      buff, msm_type, cons, &msg->header, msg->sats, &cells);
+  if (RC_OK != ret) {
+    return ret;
+  }
+
+  for (uint8_t i = 0; i < cells.num_cells; i++) {
+    rtcm_msm_signal_data *signal = &msg->signals[i];
+    signal->pseudorange_ms = pseudorange_ms[i];
+    signal->carrier_phase_ms = carrier_phase_ms[i];
+    signal->lock_time_s = lock_time_s[i];
+    signal->hca_indicator = (cells.hca_indicator >> i) & 1;
+    signal->cnr = cnr[i];
+    signal->range_rate_m_s = range_rate_m_s[i];
+    signal->flags.data = 0;
+    signal->flags.valid_pr = (cells.valid_pr >> i) & 1;
+    signal->flags.valid_cp = (cells.valid_cp >> i) & 1;
+    signal->flags.valid_cnr = (cells.valid_cnr >> i) & 1;
+    signal->flags.valid_lock = (cells.valid_lock >> i) & 1;
+    signal->flags.valid_dop = (cells.valid_dop >> i) & 1;
+  }
+
+  return RC_OK;
+}
+
+/** Decode an RTCMv3 Multi System Message 4-7 into caller-owned columns.
+ *
+ * The signal data is written straight into the arrays of `cells`, which
+ * must each hold MSM_MAX_CELLS entries, with the validity flags packed into
+ * one bit per cell. Nothing past `len` bytes of the payload is read.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param header The parsed message header
+ * \param sats The parsed satellite data, RTCM_MAX_SATS entries
+ * \param cells The parsed signal data
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not an MSM4-7 message
+ *          - RC_INVALID_MESSAGE : Cell mask too large, invalid TOW or
+ *            message longer than the payload
+ */
+rtcm3_rc rtcm3_decode_msm_columns(const uint8_t buff[],
+                                  uint16_t len,
+                                  rtcm_msm_header *header,
+                                  rtcm_msm_sat_data sats[],
+                                  rtcm_msm_signal_columns *cells) {
+  assert(header);
+  assert(sats);
+  assert(cells);
+  if (len < 2) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint16_t msg_num = rtcm_getbitu(buff, 0, 12);
+  msm_enum msm_type = to_msm_type(msg_num);
+  rtcm_constellation_t cons = to_constellation(msg_num);
+  if ((MSM4 != msm_type && MSM5 != msm_type && MSM6 != msm_type &&
+       MSM7 != msm_type) ||
+      RTCM_CONSTELLATION_INVALID == cons) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  if (!rtcm3_msm_payload_fits(buff, len, msm_type)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return decode_msm_columns(buff, msm_type, cons, header, sats, cells);
+}
+
 /** Decode an RTCMv3 Multi System Message 4
  *
  * \param buff The input data buffer
@@ -1405,3 +1695,356 @@ rtcm3_rc rtcm3_decode_4062(const uint8_t buff[],
 
   return RC_OK;
 }
+
+/** Check that an observation message 1001-1012 fits in the payload, given
+ * the number of bits per satellite. */
+static bool obs_message_fits(const uint8_t buff[],
+                             uint16_t len,
+                             bool glo,
+                             uint32_t sat_bits) {
+  uint32_t header_bits = glo ? OBS_GLO_HEADER_BITS : OBS_HEADER_BITS;
+  if (PAYLOAD_BITS(len) < header_bits) {
+    return false;
+  }
+  uint8_t n_sat =
+      rtcm_getbitu(buff, glo ? OBS_GLO_N_SAT_BIT : OBS_N_SAT_BIT, 5);
+  return header_bits + n_sat * sat_bits <= PAYLOAD_BITS(len);
+}
+
+/** Advance over a string (DF029 and similar, 8 bit count followed by the
+ * characters) if its count fits in the payload. */
+bool rtcm3_skip_str(const uint8_t buff[], uint32_t len_bits, uint32_t *bit) {
+  if (*bit + 8 > len_bits) {
+    return false;
+  }
+  *bit += 8 + 8u * rtcm_getbitu(buff, *bit, 8);
+  return *bit <= len_bits;
+}
+
+/** Check that an MSM4-7 message fits in the payload.
+ *
+ * The masks are read straight from the header, so the cell mask size is
+ * validated before anything depends on it.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param msm_type MSM4, MSM5, MSM6 or MSM7
+ * \return true if the satellite and signal data end inside the payload
+ */
+bool rtcm3_msm_payload_fits(const uint8_t buff[],
+                            uint16_t len,
+                            const msm_enum msm_type) {
+  uint32_t sat_bits;
+  uint32_t cell_bits;
+  switch (msm_type) {
+    case MSM4:
+      sat_bits = 18;
+      cell_bits = 48;
+      break;
+    case MSM5:
+      sat_bits = 36;
+      cell_bits = 63;
+      break;
+    case MSM6:
+      sat_bits = 18;
+      cell_bits = 65;
+      break;
+    case MSM7:
+      sat_bits = 36;
+      cell_bits = 80;
+      break;
+    case MSM_UNKNOWN:
+    case MSM1:
+    case MSM2:
+    case MSM3:
+    default:
+      return false;
+  }
+
+  uint32_t len_bits = PAYLOAD_BITS(len);
+  if (len_bits < MSM_CELL_MASK_BIT) {
+    return false;
+  }
+  uint8_t num_sats = count_mask_bits(
+      rtcm_getbitul(buff, MSM_SAT_MASK_BIT, MSM_SATELLITE_MASK_SIZE));
+  uint8_t num_sigs = count_mask_bits(
+      rtcm_getbitu(buff, MSM_SIG_MASK_BIT, MSM_SIGNAL_MASK_SIZE));
+  uint32_t cell_mask_size = (uint32_t)num_sats * num_sigs;
+  if (cell_mask_size > MSM_MAX_CELLS ||
+      MSM_CELL_MASK_BIT + cell_mask_size > len_bits) {
+    return false;
+  }
+  uint8_t num_cells = 0;
+  if (cell_mask_size > 0) {
+    num_cells = count_mask_bits(
+        rtcm_getbitul(buff, MSM_CELL_MASK_BIT, (uint8_t)cell_mask_size));
+  }
+  return MSM_CELL_MASK_BIT + cell_mask_size + num_sats * sat_bits +
+             num_cells * cell_bits <=
+         len_bits;
+}
+
+/** Length-bounded variant of rtcm3_decode_1001().
+ *
+ * The message length implied by the header is checked against the payload
+ * length once, before decoding, so that nothing past `len` bytes is read.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param msg_1001 RTCM message struct
+ * \return As rtcm3_decode_1001(), or RC_INVALID_MESSAGE if the message does
+ *         not fit in the payload
+ */
+rtcm3_rc rtcm3_decode_1001_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1001) {
+  if (!obs_message_fits(buff, len, false, MSG_1001_SAT_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1001(buff, msg_1001);
+}
+
+/** Length-bounded variant of rtcm3_decode_1002(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1002_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1002) {
+  if (!obs_message_fits(buff, len, false, MSG_1002_SAT_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1002(buff, msg_1002);
+}
+
+/** Length-bounded variant of rtcm3_decode_1003(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1003_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1003) {
+  if (!obs_message_fits(buff, len, false, MSG_1003_SAT_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1003(buff, msg_1003);
+}
+
+/** Length-bounded variant of rtcm3_decode_1004(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1004_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1004) {
+  if (!obs_message_fits(buff, len, false, MSG_1004_SAT_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1004(buff, msg_1004);
+}
+
+/** Length-bounded variant of rtcm3_decode_1009(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1009_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1009) {
+  if (!obs_message_fits(buff, len, true, MSG_1009_SAT_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1009(buff, msg_1009);
+}
+
+/** Length-bounded variant of rtcm3_decode_1010(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1010_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1010) {
+  if (!obs_message_fits(buff, len, true, MSG_1010_SAT_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1010(buff, msg_1010);
+}
+
+/** Length-bounded variant of rtcm3_decode_1011(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1011_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1011) {
+  if (!obs_message_fits(buff, len, true, MSG_1011_SAT_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1011(buff, msg_1011);
+}
+
+/** Length-bounded variant of rtcm3_decode_1012(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1012_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_obs_message *msg_1012) {
+  if (!obs_message_fits(buff, len, true, MSG_1012_SAT_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1012(buff, msg_1012);
+}
+
+/** Length-bounded variant of rtcm3_decode_1005(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1005_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1005 *msg_1005) {
+  if (PAYLOAD_BITS(len) < MSG_1005_BITS) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1005(buff, msg_1005);
+}
+
+/** Length-bounded variant of rtcm3_decode_1006(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1006_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1006 *msg_1006) {
+  if (PAYLOAD_BITS(len) < MSG_1006_BITS) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1006(buff, msg_1006);
+}
+
+/** Length-bounded variant of rtcm3_decode_1013(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1013_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1013 *msg_1013) {
+  if (PAYLOAD_BITS(len) < MSG_1013_BITS) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint32_t n_msgs = rtcm_getbitu(buff, MSG_1013_N_MSGS_BIT, 5);
+  if (PAYLOAD_BITS(len) < MSG_1013_BITS + n_msgs * MSG_1013_ENTRY_BITS) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1013(buff, msg_1013);
+}
+
+/** Length-bounded variant of rtcm3_decode_1007(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1007_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1007 *msg_1007) {
+  uint32_t bit = 24;
+  if (!rtcm3_skip_str(buff, PAYLOAD_BITS(len), &bit) ||
+      bit + 8 > PAYLOAD_BITS(len)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1007(buff, msg_1007);
+}
+
+/** Length-bounded variant of rtcm3_decode_1008(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1008_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1008 *msg_1008) {
+  uint32_t bit = 24;
+  if (!rtcm3_skip_str(buff, PAYLOAD_BITS(len), &bit)) {
+    return RC_INVALID_MESSAGE;
+  }
+  bit += 8;
+  if (!rtcm3_skip_str(buff, PAYLOAD_BITS(len), &bit)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1008(buff, msg_1008);
+}
+
+/** Length-bounded variant of rtcm3_decode_1029(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1029_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1029 *msg_1029) {
+  uint32_t bit = 64;
+  if (!rtcm3_skip_str(buff, PAYLOAD_BITS(len), &bit)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1029(buff, msg_1029);
+}
+
+/** Length-bounded variant of rtcm3_decode_1033(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1033_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1033 *msg_1033) {
+  uint32_t bit = 24;
+  if (!rtcm3_skip_str(buff, PAYLOAD_BITS(len), &bit)) {
+    return RC_INVALID_MESSAGE;
+  }
+  /* antenna setup id */
+  bit += 8;
+  for (uint8_t i = 0; i < 4; i++) {
+    if (!rtcm3_skip_str(buff, PAYLOAD_BITS(len), &bit)) {
+      return RC_INVALID_MESSAGE;
+    }
+  }
+  return rtcm3_decode_1033(buff, msg_1033);
+}
+
+/** Length-bounded variant of rtcm3_decode_1230(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_1230_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_1230 *msg_1230) {
+  if (PAYLOAD_BITS(len) < 32) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint8_t fdma_signal_mask = rtcm_getbitu(buff, 28, 4);
+  if (32 + 16u * count_mask_bits(fdma_signal_mask) > PAYLOAD_BITS(len)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_1230(buff, msg_1230);
+}
+
+/** Length-bounded variant of rtcm3_decode_msm4(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_msm4_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msm_message *msg) {
+  if (!rtcm3_msm_payload_fits(buff, len, MSM4)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_msm4(buff, msg);
+}
+
+/** Length-bounded variant of rtcm3_decode_msm5(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_msm5_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msm_message *msg) {
+  if (!rtcm3_msm_payload_fits(buff, len, MSM5)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_msm5(buff, msg);
+}
+
+/** Length-bounded variant of rtcm3_decode_msm6(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_msm6_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msm_message *msg) {
+  if (!rtcm3_msm_payload_fits(buff, len, MSM6)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_msm6(buff, msg);
+}
+
+/** Length-bounded variant of rtcm3_decode_msm7(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_msm7_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msm_message *msg) {
+  if (!rtcm3_msm_payload_fits(buff, len, MSM7)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_msm7(buff, msg);
+}
+
+/** Length-bounded variant of rtcm3_decode_4062(), see
+ * rtcm3_decode_1001_bounded() */
+rtcm3_rc rtcm3_decode_4062_bounded(const uint8_t buff[],
+                                   uint16_t len,
+                                   rtcm_msg_swift_proprietary *msg) {
+  uint32_t bit = 48;
+  if (!rtcm3_skip_str(buff, PAYLOAD_BITS(len), &bit)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_4062(buff, msg);
+}
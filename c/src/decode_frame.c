@@ -0,0 +1,382 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/decode_frame.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "rtcm3/bits.h"
+#include "rtcm3/decode.h"
+#include "rtcm3/eph_decode.h"
+#include "rtcm3/msm_utils.h"
+#include "rtcm3/passthrough.h"
+#include "rtcm3/ssr_decode.h"
+
+#include "decode_internal.h"
+#include "msg_layout.h"
+
+/* Message numbers covered by the dispatch table */
+#define DECODE_TABLE_FIRST 1001
+#define DECODE_TABLE_LAST 1270
+
+#define STA_MSG_NUM 999
+#define STA_SUBTYPE_RF_STATUS 24
+#define STA_SUBTYPE_FW_VERSION 25
+
+struct decode_entry;
+
+typedef rtcm3_rc (*decode_fn)(const uint8_t payload[],
+                              uint16_t len,
+                              const struct decode_entry *entry,
+                              rtcm3_any_msg *msg);
+
+typedef struct decode_entry {
+  decode_fn decode;    /* NULL for unsupported message numbers */
+  rtcm3_msg_kind kind; /* Member of rtcm3_any_msg written by decode */
+  msm_enum msm_type;   /* MSM only, resolved once when building the table */
+  rtcm_constellation_t cons; /* MSM only */
+} decode_entry;
+
+/* Wrap a length-bounded decoder taking (buff, len, msg) into the table
+ * signature */
+#define DECODE_WRAPPER(Name, Decoder, Member)       \
+  static rtcm3_rc Name(const uint8_t payload[],     \
+                       uint16_t len,                \
+                       const decode_entry *entry,   \
+                       rtcm3_any_msg *msg) {        \
+    (void)entry;                                    \
+    return Decoder(payload, len, &msg->msg.Member); \
+  }
+
+DECODE_WRAPPER(decode_1001, rtcm3_decode_1001_bounded, obs)
+DECODE_WRAPPER(decode_1002, rtcm3_decode_1002_bounded, obs)
+DECODE_WRAPPER(decode_1003, rtcm3_decode_1003_bounded, obs)
+DECODE_WRAPPER(decode_1004, rtcm3_decode_1004_bounded, obs)
+DECODE_WRAPPER(decode_1005, rtcm3_decode_1005_bounded, msg_1005)
+DECODE_WRAPPER(decode_1006, rtcm3_decode_1006_bounded, msg_1006)
+DECODE_WRAPPER(decode_1007, rtcm3_decode_1007_bounded, msg_1007)
+DECODE_WRAPPER(decode_1008, rtcm3_decode_1008_bounded, msg_1008)
+DECODE_WRAPPER(decode_1009, rtcm3_decode_1009_bounded, obs)
+DECODE_WRAPPER(decode_1010, rtcm3_decode_1010_bounded, obs)
+DECODE_WRAPPER(decode_1011, rtcm3_decode_1011_bounded, obs)
+DECODE_WRAPPER(decode_1012, rtcm3_decode_1012_bounded, obs)
+DECODE_WRAPPER(decode_1013, rtcm3_decode_1013_bounded, msg_1013)
+DECODE_WRAPPER(decode_1029, rtcm3_decode_1029_bounded, msg_1029)
+DECODE_WRAPPER(decode_1033, rtcm3_decode_1033_bounded, msg_1033)
+DECODE_WRAPPER(decode_1230, rtcm3_decode_1230_bounded, msg_1230)
+DECODE_WRAPPER(decode_gps_eph, rtcm3_decode_gps_eph_bounded, eph)
+DECODE_WRAPPER(decode_glo_eph, rtcm3_decode_glo_eph_bounded, eph)
+DECODE_WRAPPER(decode_bds_eph, rtcm3_decode_bds_eph_bounded, eph)
+DECODE_WRAPPER(decode_qzss_eph, rtcm3_decode_qzss_eph_bounded, eph)
+DECODE_WRAPPER(decode_gal_eph_fnav, rtcm3_decode_gal_eph_fnav_bounded, eph)
+DECODE_WRAPPER(decode_gal_eph_inav, rtcm3_decode_gal_eph_inav_bounded, eph)
+DECODE_WRAPPER(decode_orbit, rtcm3_decode_orbit_bounded, orbit)
+DECODE_WRAPPER(decode_clock, rtcm3_decode_clock_bounded, clock)
+DECODE_WRAPPER(decode_orbit_clock,
+               rtcm3_decode_orbit_clock_bounded,
+               orbit_clock)
+DECODE_WRAPPER(decode_code_bias, rtcm3_decode_code_bias_bounded, code_bias)
+DECODE_WRAPPER(decode_phase_bias, rtcm3_decode_phase_bias_bounded, phase_bias)
+
+/* The table entry already carries the MSM type and constellation, so the
+ * message number checks of rtcm3_decode_msm4() etc. are skipped. */
+static rtcm3_rc decode_msm(const uint8_t payload[],
+                           uint16_t len,
+                           const decode_entry *entry,
+                           rtcm3_any_msg *msg) {
+  if (!rtcm3_msm_payload_fits(payload, len, entry->msm_type)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_msm_unchecked(
+      payload, entry->msm_type, entry->cons, &msg->msg.msm);
+}
+
+#define ENTRY(Num, Decoder, Kind)                                 \
+  [(Num)-DECODE_TABLE_FIRST] = {                                  \
+      (Decoder), (Kind), MSM_UNKNOWN, RTCM_CONSTELLATION_INVALID}
+
+#define MSM_ENTRY(Num, Type, Cons)                                         \
+  [(Num)-DECODE_TABLE_FIRST] = {decode_msm, RTCM3_MSG_MSM, (Type), (Cons)}
+
+/* MSM4 to MSM7 of one constellation, Base is the MSM1 message number */
+#define MSM_ENTRIES(Base, Cons)            \
+  MSM_ENTRY((Base) + 3, MSM4, (Cons)),     \
+      MSM_ENTRY((Base) + 4, MSM5, (Cons)), \
+      MSM_ENTRY((Base) + 5, MSM6, (Cons)), \
+      MSM_ENTRY((Base) + 6, MSM7, (Cons))
+
+/* SSR orbit, clock, code bias and orbit/clock of one constellation, Base is
+ * the orbit message number */
+#define SSR_ENTRIES(Base)                                              \
+  ENTRY((Base), decode_orbit, RTCM3_MSG_SSR_ORBIT),                    \
+      ENTRY((Base) + 1, decode_clock, RTCM3_MSG_SSR_CLOCK),            \
+      ENTRY((Base) + 2, decode_code_bias, RTCM3_MSG_SSR_CODE_BIAS),    \
+      ENTRY((Base) + 3, decode_orbit_clock, RTCM3_MSG_SSR_ORBIT_CLOCK)
+
+static const decode_entry decode_table[DECODE_TABLE_LAST -
+                                       DECODE_TABLE_FIRST + 1] = {
+    ENTRY(1001, decode_1001, RTCM3_MSG_OBS),
+    ENTRY(1002, decode_1002, RTCM3_MSG_OBS),
+    ENTRY(1003, decode_1003, RTCM3_MSG_OBS),
+    ENTRY(1004, decode_1004, RTCM3_MSG_OBS),
+    ENTRY(1005, decode_1005, RTCM3_MSG_1005),
+    ENTRY(1006, decode_1006, RTCM3_MSG_1006),
+    ENTRY(1007, decode_1007, RTCM3_MSG_1007),
+    ENTRY(1008, decode_1008, RTCM3_MSG_1008),
+    ENTRY(1009, decode_1009, RTCM3_MSG_OBS),
+    ENTRY(1010, decode_1010, RTCM3_MSG_OBS),
+    ENTRY(1011, decode_1011, RTCM3_MSG_OBS),
+    ENTRY(1012, decode_1012, RTCM3_MSG_OBS),
+    ENTRY(1013, decode_1013, RTCM3_MSG_1013),
+    ENTRY(1019, decode_gps_eph, RTCM3_MSG_EPH),
+    ENTRY(1020, decode_glo_eph, RTCM3_MSG_EPH),
+    ENTRY(1029, decode_1029, RTCM3_MSG_1029),
+    ENTRY(1033, decode_1033, RTCM3_MSG_1033),
+    ENTRY(1042, decode_bds_eph, RTCM3_MSG_EPH),
+    ENTRY(1044, decode_qzss_eph, RTCM3_MSG_EPH),
+    ENTRY(1045, decode_gal_eph_fnav, RTCM3_MSG_EPH),
+    ENTRY(1046, decode_gal_eph_inav, RTCM3_MSG_EPH),
+    SSR_ENTRIES(1057), /* GPS */
+    SSR_ENTRIES(1063), /* GLO */
+    MSM_ENTRIES(1071, RTCM_CONSTELLATION_GPS),
+    MSM_ENTRIES(1081, RTCM_CONSTELLATION_GLO),
+    MSM_ENTRIES(1091, RTCM_CONSTELLATION_GAL),
+    MSM_ENTRIES(1101, RTCM_CONSTELLATION_SBAS),
+    MSM_ENTRIES(1111, RTCM_CONSTELLATION_QZS),
+    MSM_ENTRIES(1121, RTCM_CONSTELLATION_BDS),
+    ENTRY(1230, decode_1230, RTCM3_MSG_1230),
+    SSR_ENTRIES(1240), /* GAL */
+    SSR_ENTRIES(1246), /* QZS */
+    SSR_ENTRIES(1258), /* BDS */
+    ENTRY(1265, decode_phase_bias, RTCM3_MSG_SSR_PHASE_BIAS),
+    ENTRY(1266, decode_phase_bias, RTCM3_MSG_SSR_PHASE_BIAS),
+    ENTRY(1267, decode_phase_bias, RTCM3_MSG_SSR_PHASE_BIAS),
+    ENTRY(1268, decode_phase_bias, RTCM3_MSG_SSR_PHASE_BIAS),
+    ENTRY(1269, decode_phase_bias, RTCM3_MSG_SSR_PHASE_BIAS),
+    ENTRY(1270, decode_phase_bias, RTCM3_MSG_SSR_PHASE_BIAS),
+};
+
+static rtcm3_rc decode_sta(const uint8_t payload[],
+                           uint16_t len,
+                           rtcm3_any_msg *msg) {
+  if (len < 3) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint8_t subtype_id = rtcm_getbitu(payload, 12, 8);
+  if (STA_SUBTYPE_RF_STATUS == subtype_id) {
+    msg->kind = RTCM3_MSG_STA_RF_STATUS;
+    return sta_decode_rfstatus(payload, &msg->msg.rf_status, len * 8u);
+  }
+  if (STA_SUBTYPE_FW_VERSION == subtype_id) {
+    /* string length follows the subtype, then the characters */
+    if (len < 4 || 28u + 8u * rtcm_getbitu(payload, 20, 8) > len * 8u) {
+      return RC_INVALID_MESSAGE;
+    }
+    msg->kind = RTCM3_MSG_STA_FW_VERSION;
+    return sta_decode_fwver(
+        payload, msg->msg.fw_version, sizeof(msg->msg.fw_version));
+  }
+  return RC_MESSAGE_TYPE_MISMATCH;
+}
+
+/** Decode any supported RTCMv3 message.
+ *
+ * The decoder is selected by looking up the message number in a table, and
+ * the result is stored in the member of msg->msg given by msg->kind.
+ *
+ * \param payload The message payload starting at DF002, e.g. the payload of
+ *                a frame returned by rtcm3_framer_next()
+ * \param len Length of the payload in bytes
+ * \param msg The decoded message
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Unsupported message number, in which
+ *            case msg->kind is RTCM3_MSG_NONE
+ *          - RC_INVALID_MESSAGE : Payload too short or rejected by the
+ *            message decoder
+ */
+rtcm3_rc rtcm3_decode_frame(const uint8_t payload[],
+                            uint16_t len,
+                            rtcm3_any_msg *msg) {
+  assert(payload);
+  assert(msg);
+  msg->kind = RTCM3_MSG_NONE;
+  msg->msg_num = 0;
+  if (len < 2) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  uint16_t msg_num = rtcm_getbitu(payload, 0, 12);
+  msg->msg_num = msg_num;
+
+  if (msg_num >= DECODE_TABLE_FIRST && msg_num <= DECODE_TABLE_LAST) {
+    const decode_entry *entry = &decode_table[msg_num - DECODE_TABLE_FIRST];
+    if (NULL == entry->decode) {
+      return RC_MESSAGE_TYPE_MISMATCH;
+    }
+    msg->kind = entry->kind;
+    return entry->decode(payload, len, entry, msg);
+  }
+
+  switch (msg_num) {
+    case STA_MSG_NUM:
+      return decode_sta(payload, len, msg);
+    case 4062:
+      msg->kind = RTCM3_MSG_SWIFT_PROPRIETARY;
+      return rtcm3_decode_4062_bounded(payload, len, &msg->msg.swift);
+    default:
+      return RC_MESSAGE_TYPE_MISMATCH;
+  }
+}
+
+/* SSR messages of all constellations, which start with the epoch time in
+ * seconds instead of a station ID */
+static bool is_ssr(uint16_t msg_num) {
+  return (msg_num >= 1057 && msg_num <= 1068) ||
+         (msg_num >= 1240 && msg_num <= 1263) ||
+         (msg_num >= 1265 && msg_num <= 1270);
+}
+
+static bool is_glo_ssr(uint16_t msg_num) {
+  return (msg_num >= 1063 && msg_num <= 1068) || 1266 == msg_num;
+}
+
+/* Read the header field at bit `pos` if the payload holds it */
+static bool peek_field(const uint8_t payload[],
+                       uint16_t len,
+                       uint32_t pos,
+                       uint8_t bits,
+                       uint32_t *value) {
+  if ((uint32_t)len * 8u < pos + bits) {
+    return false;
+  }
+  *value = (uint32_t)msg_layout_get(payload, len, pos, bits);
+  return true;
+}
+
+/** Read the routing fields of a message header without decoding it.
+ *
+ * Only fields at a fixed offset from the start of the payload are read:
+ * the station ID, the epoch time and the multiple message flag of the
+ * observation, MSM and SSR messages, and the satellite of an ephemeris.
+ * The cost does not depend on the length of the message. A field the
+ * payload is too short for is left out of peek->flags, so a truncated
+ * payload can still be routed by message number.
+ *
+ * GLONASS epochs are the time of day, and BeiDou MSM epochs are
+ * normalized as by rtcm3_decode_msm7() etc.
+ *
+ * \param payload The message payload starting at DF002
+ * \param len Length of the payload in bytes
+ * \param peek The header fields
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Neither the header layout nor a
+ *            decoder is known for the message number, which is still set
+ *          - RC_INVALID_MESSAGE : Payload shorter than the message number
+ */
+rtcm3_rc rtcm3_peek_header(const uint8_t payload[],
+                           uint16_t len,
+                           rtcm3_msg_peek *peek) {
+  assert(payload);
+  assert(peek);
+  memset(peek, 0, sizeof(*peek));
+  peek->kind = RTCM3_MSG_NONE;
+  peek->cons = RTCM_CONSTELLATION_INVALID;
+  peek->msm_type = MSM_UNKNOWN;
+  if (len < 2) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  uint16_t msg_num = (uint16_t)msg_layout_get(payload, len, 0, 12);
+  peek->msg_num = msg_num;
+  if (msg_num >= DECODE_TABLE_FIRST && msg_num <= DECODE_TABLE_LAST) {
+    peek->kind = decode_table[msg_num - DECODE_TABLE_FIRST].kind;
+  } else if (4062 == msg_num) {
+    peek->kind = RTCM3_MSG_SWIFT_PROPRIETARY;
+  } else if (STA_MSG_NUM == msg_num && len >= 3) {
+    uint32_t subtype_id = msg_layout_get(payload, len, 12, 8);
+    if (STA_SUBTYPE_RF_STATUS == subtype_id) {
+      peek->kind = RTCM3_MSG_STA_RF_STATUS;
+    } else if (STA_SUBTYPE_FW_VERSION == subtype_id) {
+      peek->kind = RTCM3_MSG_STA_FW_VERSION;
+    }
+  }
+  bool known = RTCM3_MSG_NONE != peek->kind;
+
+  uint32_t value;
+  if (rtcm3_msg_has_station_id(msg_num)) {
+    known = true;
+    if (peek_field(payload, len, 12, 12, &value)) {
+      peek->stn_id = (uint16_t)value;
+      peek->flags |= RTCM3_PEEK_HAS_STN_ID;
+    }
+  }
+
+  /* Epoch time and the following DF005, DF393 or DF388 */
+  uint32_t time_pos = 0;
+  uint8_t time_bits = 0;
+  uint32_t multiple_pos = 0;
+  rtcm_constellation_t cons = to_constellation(msg_num);
+  msm_enum msm_type = to_msm_type(msg_num);
+  bool ssr = is_ssr(msg_num);
+  uint8_t sat_bits;
+  if (msg_num >= 1001 && msg_num <= 1004) {
+    cons = RTCM_CONSTELLATION_GPS;
+    time_pos = 24;
+    time_bits = 30;
+    multiple_pos = 54;
+  } else if (msg_num >= 1009 && msg_num <= 1012) {
+    cons = RTCM_CONSTELLATION_GLO;
+    time_pos = 24;
+    time_bits = 27;
+    multiple_pos = 51;
+  } else if (MSM_UNKNOWN != msm_type &&
+             RTCM_CONSTELLATION_INVALID != cons) {
+    /* GLONASS MSM epochs are a 3 bit day of week and the time of day */
+    bool glo = RTCM_CONSTELLATION_GLO == cons;
+    peek->msm_type = msm_type;
+    time_pos = glo ? 27 : 24;
+    time_bits = glo ? 27 : 30;
+    multiple_pos = 54;
+  } else if (ssr) {
+    /* the update interval DF391 comes between the two */
+    time_pos = 12;
+    time_bits = is_glo_ssr(msg_num) ? 17 : 20;
+    multiple_pos = time_pos + time_bits + 4;
+  } else if (rtcm3_eph_sat_field(msg_num, &cons, &sat_bits)) {
+    if (peek_field(payload, len, 12, sat_bits, &value)) {
+      peek->sat_id = (uint8_t)value;
+      peek->flags |= RTCM3_PEEK_HAS_SAT_ID;
+    }
+  }
+  peek->cons = cons;
+
+  if (time_bits > 0) {
+    known = true;
+    if (peek_field(payload, len, time_pos, time_bits, &value)) {
+      if (ssr) {
+        value *= 1000u;
+      } else if (MSM_UNKNOWN != peek->msm_type &&
+                 RTCM_CONSTELLATION_BDS == cons) {
+        value = rtcm3_normalize_bds2_tow(value);
+      }
+      peek->tow_ms = value;
+      peek->flags |= RTCM3_PEEK_HAS_TIME;
+    }
+    if (peek_field(payload, len, multiple_pos, 1, &value)) {
+      peek->multiple = 0 != value;
+      peek->flags |= RTCM3_PEEK_HAS_MULTIPLE;
+    }
+  }
+  return known ? RC_OK : RC_MESSAGE_TYPE_MISMATCH;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* Decoder entry points shared between the library sources, not installed */
+
+#ifndef SWIFTNAV_RTCM3_DECODE_INTERNAL_H
+#define SWIFTNAV_RTCM3_DECODE_INTERNAL_H
+
+#include <rtcm3/messages.h>
+#include <rtcm3/msm_utils.h>
+
+rtcm3_rc rtcm3_decode_msm_unchecked(const uint8_t buff[],
+                                    const msm_enum msm_type,
+                                    const rtcm_constellation_t cons,
+                                    rtcm_msm_message *msg);
+
+uint16_t rtcm3_read_msm_header(const uint8_t buff[],
+                               const rtcm_constellation_t cons,
+                               rtcm_msm_header *header,
+                               rtcm_msm_masks *masks);
+
+bool rtcm3_msm_tow_valid(const rtcm_constellation_t cons, uint32_t tow_ms);
+
+uint32_t rtcm3_normalize_bds2_tow(const uint32_t tow_ms);
+
+uint32_t rtcm3_from_msm_lock_ind_ext(uint16_t lock);
+
+bool rtcm3_msm_payload_fits(const uint8_t buff[],
+                            uint16_t len,
+                            const msm_enum msm_type);
+
+bool rtcm3_skip_str(const uint8_t buff[], uint32_t len_bits, uint32_t *bit);
+
+bool is_ssr_orbit_clock_message(const uint16_t message_num);
+bool is_ssr_orbit_message(const uint16_t message_num);
+bool is_ssr_clock_message(const uint16_t message_num);
+bool is_ssr_code_biases_message(const uint16_t message_num);
+bool is_ssr_phase_biases_message(const uint16_t message_num);
+
+rtcm3_rc decode_ssr_header(const uint8_t buff[],
+                           uint16_t *bit,
+                           rtcm_msg_ssr_header *msg_header);
+rtcm3_rc rtcm3_decode_ssr_satellite_id(const uint8_t buff[],
+                                       uint16_t *bit,
+                                       uint8_t constellation,
+                                       uint8_t *sat_id);
+rtcm3_rc rtcm3_decode_ssr_orbit(const uint8_t buff[],
+                                uint16_t *bit,
+                                uint8_t constellation,
+                                rtcm_msg_ssr_orbit_corr *orbit);
+void rtcm3_decode_ssr_clock(const uint8_t buff[],
+                            uint16_t *bit,
+                            rtcm_msg_ssr_clock_corr *clock);
+rtcm3_rc rtcm3_decode_ssr_code_bias_sat_header(const uint8_t buff[],
+                                               uint16_t *bit,
+                                               uint8_t constellation,
+                                               uint8_t *sat_id,
+                                               uint8_t *num_code_biases);
+void rtcm3_decode_ssr_code_bias_signals(const uint8_t buff[],
+                                        uint16_t *bit,
+                                        uint8_t num_code_biases,
+                                        rtcm_msg_ssr_code_bias_sig signals[]);
+rtcm3_rc rtcm3_decode_ssr_code_bias_sat(const uint8_t buff[],
+                                        uint16_t *bit,
+                                        uint8_t constellation,
+                                        rtcm_msg_ssr_code_bias_sat *sat);
+rtcm3_rc rtcm3_decode_ssr_phase_bias_sat_header(const uint8_t buff[],
+                                                uint16_t *bit,
+                                                uint8_t constellation,
+                                                uint8_t *sat_id,
+                                                uint8_t *num_phase_biases,
+                                                uint16_t *yaw_angle,
+                                                int8_t *yaw_rate);
+void rtcm3_decode_ssr_phase_bias_signals(
+    const uint8_t buff[],
+    uint16_t *bit,
+    uint8_t num_phase_biases,
+    rtcm_msg_ssr_phase_bias_sig signals[]);
+rtcm3_rc rtcm3_decode_ssr_phase_bias_sat(const uint8_t buff[],
+                                         uint16_t *bit,
+                                         uint8_t constellation,
+                                         rtcm_msg_ssr_phase_bias_sat *sat);
+
+/* Code bias satellite block: number of biases, then signal ID and bias for
+ * each */
+#define SSR_CODE_BIAS_SAT_BITS 5
+#define SSR_CODE_BIAS_SIGNAL_BITS (5 + 14)
+/* Phase bias satellite block: number of biases, yaw angle and rate, then the
+ * signal blocks */
+#define SSR_PHASE_BIAS_SAT_BITS (5 + 9 + 8)
+#define SSR_PHASE_BIAS_SIGNAL_BITS (5 + 1 + 2 + 4 + 20)
+
+bool rtcm3_ssr_orbit_clock_fits(const uint8_t buff[],
+                                uint16_t len,
+                                bool orbit,
+                                bool clock);
+bool rtcm3_ssr_bias_fits(const uint8_t buff[],
+                         uint16_t len,
+                         uint32_t sat_fixed_bits,
+                         uint32_t signal_bits);
+
+/* Number of bytes holding a message of `bits` bits */
+#define PAYLOAD_BYTES(bits) (((uint32_t)(bits) + 7u) / 8u)
+
+/* Fixed ephemeris message lengths in bits, see RTCM 10403.3 */
+#define GPS_EPH_BITS 488
+#define GLO_EPH_BITS 360
+#define BDS_EPH_BITS 511
+#define QZSS_EPH_BITS 485
+#define GAL_EPH_FNAV_BITS 496
+#define GAL_EPH_INAV_BITS 504
+
+bool rtcm3_eph_sat_field(uint16_t msg_num,
+                         rtcm_constellation_t *cons,
+                         uint8_t *bits);
+
+uint32_t rtcm3_gps_tod_ms(rtcm_constellation_t cons,
+                          uint32_t tow_ms,
+                          int8_t leap_seconds);
+int32_t rtcm3_tod_diff_ms(uint32_t a, uint32_t b);
+
+#endif /* SWIFTNAV_RTCM3_DECODE_INTERNAL_H */
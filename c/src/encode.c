@@ -22,6 +22,8 @@
 #include "rtcm3/constants.h"
 #include "rtcm3/msm_utils.h"
 
+#include "msg_layout.h"
+
 /** Convert a lock time in seconds into 7-bit RTCMv3 Lock Time Indicator value.
  * See RTCM 10403.1, Table 3.4-2.
  *
@@ -146,24 +148,17 @@ static void encode_basic_freq_data(const rtcm_freq_data *freq_data,
 
   double l1_prc = calc_l1_pr * 0.02 + amb * PRUNIT_GPS;
 
+  obs_freq_fields fields;
   double freq = 0;
+  fields.code = 0;
   if (L1_FREQ == freq_enum) {
     freq = GPS_L1_HZ;
-    rtcm_setbitu(buff, *bit, 1, 0);
-    *bit += 1;
-    rtcm_setbitu(
-        buff, *bit, 24, freq_data->flags.valid_pr ? pr : PR_L1_INVALID);
-    *bit += 24;
+    fields.pr =
+        freq_data->flags.valid_pr ? (int32_t)pr : (int32_t)PR_L1_INVALID;
   } else {
     freq = GPS_L2_HZ;
-    rtcm_setbitu(buff, *bit, 2, 0);
-    *bit += 2;
-    rtcm_setbits(buff,
-                 *bit,
-                 14,
-                 freq_data->flags.valid_pr ? (int32_t)pr - (int32_t)calc_l1_pr
-                                           : (int32_t)PR_L2_INVALID);
-    *bit += 14;
+    fields.pr = freq_data->flags.valid_pr ? (int32_t)pr - (int32_t)calc_l1_pr
+                                          : (int32_t)PR_L2_INVALID;
   }
 
   if (freq_data->flags.valid_cp) {
@@ -171,17 +166,18 @@ static void encode_basic_freq_data(const rtcm_freq_data *freq_data,
     double cp_pr = freq_data->carrier_phase - l1_prc / (GPS_C / freq);
     /* encode PhaseRange – L1 Pseudorange (DF012/DF018) and roll over if
      * necessary */
-    int32_t ppr = encode_diff_phaserange(cp_pr, freq);
-    rtcm_setbits(buff, *bit, 20, ppr);
+    fields.phr_pr_diff = encode_diff_phaserange(cp_pr, freq);
   } else {
-    rtcm_setbits(buff, *bit, 20, CP_INVALID);
-  }
-  *bit += 20;
-  rtcm_setbitu(buff,
-               *bit,
-               7,
-               freq_data->flags.valid_lock ? to_lock_ind(freq_data->lock) : 0);
-  *bit += 7;
+    fields.phr_pr_diff = (int32_t)CP_INVALID;
+  }
+  fields.lock_ind =
+      freq_data->flags.valid_lock ? to_lock_ind(freq_data->lock) : 0;
+
+  if (L1_FREQ == freq_enum) {
+    *bit = gps_l1_obs_layout_encode(&fields, buff, *bit);
+  } else {
+    *bit = l2_obs_layout_encode(&fields, buff, *bit);
+  }
 }
 
 static void encode_basic_glo_freq_data(const rtcm_freq_data *freq_data,
@@ -202,28 +198,18 @@ static void encode_basic_glo_freq_data(const rtcm_freq_data *freq_data,
 
   double l1_prc = calc_l1_pr * 0.02 + amb * PRUNIT_GLO;
 
+  obs_freq_fields fields;
   double glo_freq = 0.0;
+  fields.code = 0;
+  fields.fcn = fcn;
   if (L1_FREQ == freq_enum) {
     glo_freq = GLO_L1_HZ + (fcn - MT1012_GLO_FCN_OFFSET) * GLO_L1_DELTA_HZ;
-
-    rtcm_setbitu(buff, *bit, 1, 0);
-    *bit += 1;
-    rtcm_setbitu(buff, *bit, 5, fcn);
-    *bit += 5;
-    rtcm_setbitu(
-        buff, *bit, 25, freq_data->flags.valid_pr ? pr : PR_L1_INVALID);
-    *bit += 25;
+    fields.pr =
+        freq_data->flags.valid_pr ? (int32_t)pr : (int32_t)PR_L1_INVALID;
   } else {
     glo_freq = GLO_L2_HZ + (fcn - MT1012_GLO_FCN_OFFSET) * GLO_L2_DELTA_HZ;
-
-    rtcm_setbitu(buff, *bit, 2, 0);
-    *bit += 2;
-    rtcm_setbits(buff,
-                 *bit,
-                 14,
-                 freq_data->flags.valid_pr ? (int32_t)pr - (int32_t)calc_l1_pr
-                                           : (int32_t)PR_L2_INVALID);
-    *bit += 14;
+    fields.pr = freq_data->flags.valid_pr ? (int32_t)pr - (int32_t)calc_l1_pr
+                                          : (int32_t)PR_L2_INVALID;
   }
 
   if (freq_data->flags.valid_cp) {
@@ -232,17 +218,18 @@ static void encode_basic_glo_freq_data(const rtcm_freq_data *freq_data,
 
     /* Calculate PhaseRange – L1 Pseudorange (DF042/DF048) and roll over if
      * necessary */
-    int32_t ppr = encode_diff_phaserange(cp_pr, glo_freq);
-    rtcm_setbits(buff, *bit, 20, ppr);
+    fields.phr_pr_diff = encode_diff_phaserange(cp_pr, glo_freq);
   } else {
-    rtcm_setbits(buff, *bit, 20, CP_INVALID);
-  }
-  *bit += 20;
-  rtcm_setbitu(buff,
-               *bit,
-               7,
-               freq_data->flags.valid_lock ? to_lock_ind(freq_data->lock) : 0);
-  *bit += 7;
+    fields.phr_pr_diff = (int32_t)CP_INVALID;
+  }
+  fields.lock_ind =
+      freq_data->flags.valid_lock ? to_lock_ind(freq_data->lock) : 0;
+
+  if (L1_FREQ == freq_enum) {
+    *bit = glo_l1_obs_layout_encode(&fields, buff, *bit);
+  } else {
+    *bit = l2_obs_layout_encode(&fields, buff, *bit);
+  }
 }
 
 /** Write RTCM header for observation message types 1001..1004.
@@ -287,22 +274,9 @@ static void encode_basic_glo_freq_data(const rtcm_freq_data *freq_data,
 static uint16_t rtcm3_write_header(const rtcm_obs_header *header,
                                    uint8_t num_sats,
                                    uint8_t buff[]) {
-  uint16_t bit = 0;
-  rtcm_setbitu(buff, bit, 12, header->msg_num);
-  bit += 12;
-  rtcm_setbitu(buff, bit, 12, header->stn_id);
-  bit += 12;
-  rtcm_setbitu(buff, bit, 30, (uint32_t)round(header->tow_ms));
-  bit += 30;
-  rtcm_setbitu(buff, bit, 1, header->sync);
-  bit += 1;
-  rtcm_setbitu(buff, bit, 5, num_sats);
-  bit += 5;
-  rtcm_setbitu(buff, bit, 1, header->div_free);
-  bit += 1;
-  rtcm_setbitu(buff, bit, 3, header->smooth);
-  bit += 3;
-  return bit;
+  rtcm_obs_header written = *header;
+  written.n_sat = num_sats;
+  return gps_obs_header_encode(&written, buff, 0);
 }
 
 /** Write RTCM header for observation message types 1009..1012.
@@ -347,22 +321,9 @@ static uint16_t rtcm3_write_header(const rtcm_obs_header *header,
 static uint16_t rtcm3_write_glo_header(const rtcm_obs_header *header,
                                        uint8_t num_sats,
                                        uint8_t buff[]) {
-  uint16_t bit = 0;
-  rtcm_setbitu(buff, bit, 12, header->msg_num);
-  bit += 12;
-  rtcm_setbitu(buff, bit, 12, header->stn_id);
-  bit += 12;
-  rtcm_setbitu(buff, bit, 27, (uint32_t)round(header->tow_ms));
-  bit += 27;
-  rtcm_setbitu(buff, bit, 1, header->sync);
-  bit += 1;
-  rtcm_setbitu(buff, bit, 5, num_sats);
-  bit += 5;
-  rtcm_setbitu(buff, bit, 1, header->div_free);
-  bit += 1;
-  rtcm_setbitu(buff, bit, 3, header->smooth);
-  bit += 3;
-  return bit;
+  rtcm_obs_header written = *header;
+  written.n_sat = num_sats;
+  return glo_obs_header_encode(&written, buff, 0);
 }
 
 uint16_t rtcm3_encode_1001(const rtcm_obs_message *msg_1001, uint8_t buff[]) {
@@ -539,30 +500,7 @@ uint16_t rtcm3_encode_1004(const rtcm_obs_message *msg_1004, uint8_t buff[]) {
 static uint16_t rtcm3_encode_1005_base(const rtcm_msg_1005 *msg_1005,
                                        uint8_t buff[],
                                        uint16_t *bit) {
-  rtcm_setbitu(buff, *bit, 12, msg_1005->stn_id);
-  *bit += 12;
-  rtcm_setbitu(buff, *bit, 6, msg_1005->ITRF);
-  *bit += 6;
-  rtcm_setbitu(buff, *bit, 1, msg_1005->GPS_ind);
-  *bit += 1;
-  rtcm_setbitu(buff, *bit, 1, msg_1005->GLO_ind);
-  *bit += 1;
-  rtcm_setbitu(buff, *bit, 1, msg_1005->GAL_ind);
-  *bit += 1;
-  rtcm_setbitu(buff, *bit, 1, msg_1005->ref_stn_ind);
-  *bit += 1;
-  rtcm_setbitsl(buff, *bit, 38, (int64_t)round(msg_1005->arp_x * 10000.0));
-  *bit += 38;
-  rtcm_setbitu(buff, *bit, 1, msg_1005->osc_ind);
-  *bit += 1;
-  rtcm_setbitu(buff, *bit, 1, 0);
-  *bit += 1;
-  rtcm_setbitsl(buff, *bit, 38, (int64_t)round(msg_1005->arp_y * 10000.0));
-  *bit += 38;
-  rtcm_setbitu(buff, *bit, 2, msg_1005->quart_cycle_ind);
-  *bit += 2;
-  rtcm_setbitsl(buff, *bit, 38, (int64_t)round(msg_1005->arp_z * 10000.0));
-  *bit += 38;
+  *bit = msg_1005_layout_encode(msg_1005, buff, *bit);
 
   /* Round number of bits up to nearest whole byte. */
   return (*bit + 7) / 8;
@@ -582,14 +520,8 @@ uint16_t rtcm3_encode_1006(const rtcm_msg_1006 *msg_1006, uint8_t buff[]) {
   rtcm_setbitu(buff, bit, 12, 1006);
   bit += 12;
   rtcm3_encode_1005_base(&msg_1006->msg_1005, buff, &bit);
-  double ant_height = msg_1006->ant_height;
-  if (ant_height < 0.0) {
-    ant_height = 0.0;
-  } else if (ant_height > RTCM_1006_MAX_ANTENNA_HEIGHT_M) {
-    ant_height = RTCM_1006_MAX_ANTENNA_HEIGHT_M;
-  }
-  rtcm_setbitu(buff, bit, 16, (uint16_t)round(ant_height * 10000.0));
-  bit += 16;
+  /* the antenna height is clamped to 0 - RTCM_1006_MAX_ANTENNA_HEIGHT_M */
+  bit = msg_1006_layout_encode(msg_1006, buff, bit);
 
   /* Round number of bits up to nearest whole byte. */
   return (bit + 7) / 8;
@@ -638,6 +570,37 @@ uint16_t rtcm3_encode_1008(const rtcm_msg_1008 *msg_1008, uint8_t buff[]) {
   return (bit + 7) / 8;
 }
 
+uint16_t rtcm3_encode_1009(const rtcm_obs_message *msg_1009, uint8_t buff[]) {
+  assert(msg_1009);
+  uint16_t bit = 61; /* Start at end of header. */
+
+  uint8_t num_sats = 0;
+  for (uint8_t i = 0; i < msg_1009->header.n_sat; i++) {
+    if (msg_1009->sats[i].obs[L1_FREQ].flags.valid_pr &&
+        msg_1009->sats[i].obs[L1_FREQ].flags.valid_cp) {
+      const rtcm_sat_data *sat_obs = &msg_1009->sats[i];
+      rtcm_setbitu(buff, bit, 6, sat_obs->svId);
+      bit += 6;
+      encode_basic_glo_freq_data(&sat_obs->obs[L1_FREQ],
+                                 L1_FREQ,
+                                 &sat_obs->obs[L1_FREQ].pseudorange,
+                                 sat_obs->fcn,
+                                 buff,
+                                 &bit);
+      ++num_sats;
+      if (num_sats >= RTCM_MAX_SATS) {
+        /* sanity */
+        break;
+      }
+    }
+  }
+
+  rtcm3_write_glo_header(&msg_1009->header, num_sats, buff);
+
+  /* Round number of bits up to nearest whole byte. */
+  return (bit + 7) / 8;
+}
+
 uint16_t rtcm3_encode_1010(const rtcm_obs_message *msg_1010, uint8_t buff[]) {
   assert(msg_1010);
   uint16_t bit = 61; /* Start at end of header. */
@@ -678,6 +641,43 @@ uint16_t rtcm3_encode_1010(const rtcm_obs_message *msg_1010, uint8_t buff[]) {
   return (bit + 7) / 8;
 }
 
+uint16_t rtcm3_encode_1011(const rtcm_obs_message *msg_1011, uint8_t buff[]) {
+  assert(msg_1011);
+  uint16_t bit = 61; /* Start at end of header. */
+
+  uint8_t num_sats = 0;
+  for (uint8_t i = 0; i < msg_1011->header.n_sat; i++) {
+    flag_bf l1_flags = msg_1011->sats[i].obs[L1_FREQ].flags;
+    if (l1_flags.valid_pr && l1_flags.valid_cp) {
+      const rtcm_sat_data *sat_obs = &msg_1011->sats[i];
+      rtcm_setbitu(buff, bit, 6, sat_obs->svId);
+      bit += 6;
+      encode_basic_glo_freq_data(&sat_obs->obs[L1_FREQ],
+                                 L1_FREQ,
+                                 &sat_obs->obs[L1_FREQ].pseudorange,
+                                 sat_obs->fcn,
+                                 buff,
+                                 &bit);
+      encode_basic_glo_freq_data(&sat_obs->obs[L2_FREQ],
+                                 L2_FREQ,
+                                 &sat_obs->obs[L1_FREQ].pseudorange,
+                                 sat_obs->fcn,
+                                 buff,
+                                 &bit);
+      ++num_sats;
+      if (num_sats >= RTCM_MAX_SATS) {
+        /* sanity */
+        break;
+      }
+    }
+  }
+
+  rtcm3_write_glo_header(&msg_1011->header, num_sats, buff);
+
+  /* Round number of bits up to nearest whole byte. */
+  return (bit + 7) / 8;
+}
+
 uint16_t rtcm3_encode_1012(const rtcm_obs_message *msg_1012, uint8_t buff[]) {
   assert(msg_1012);
   uint16_t bit = 61; /* Start at end of header. */
@@ -728,6 +728,19 @@ uint16_t rtcm3_encode_1012(const rtcm_obs_message *msg_1012, uint8_t buff[]) {
   return (bit + 7) / 8;
 }
 
+uint16_t rtcm3_encode_1013(const rtcm_msg_1013 *msg_1013, uint8_t buff[]) {
+  assert(msg_1013);
+  assert(msg_1013->n_msgs <= RTCM_1013_MAX_MSGS);
+  rtcm_setbitu(buff, 0, 12, 1013);
+  uint32_t bit = msg_1013_layout_encode(msg_1013, buff, 12);
+  for (uint8_t i = 0; i < msg_1013->n_msgs; i++) {
+    bit = msg_1013_entry_layout_encode(&msg_1013->msgs[i], buff, bit);
+  }
+
+  /* Round number of bits up to nearest whole byte. */
+  return (uint16_t)((bit + 7) / 8);
+}
+
 uint16_t rtcm3_encode_1029(const rtcm_msg_1029 *msg_1029, uint8_t buff[]) {
   assert(msg_1029);
   uint16_t bit = 0;
@@ -847,83 +860,85 @@ uint16_t rtcm3_encode_1230(const rtcm_msg_1230 *msg_1230, uint8_t buff[]) {
   return (bit + 7) / 8;
 }
 
-static uint16_t rtcm3_encode_msm_header(const rtcm_msm_header *header,
-                                        const rtcm_constellation_t cons,
-                                        uint8_t buff[]) {
-  uint16_t bit = 0;
-  rtcm_setbitu(buff, bit, 12, header->msg_num);
-  bit += 12;
-  rtcm_setbitu(buff, bit, 12, header->stn_id);
-  bit += 12;
-  if (RTCM_CONSTELLATION_GLO == cons) {
+/** Convert a lock time in seconds into the 10-bit Extended Lock Time
+ * Indicator DF407.
+ * See RTCM 10403.3, Table 3.5-75.
+ *
+ * \param time Lock time in seconds.
+ * \return Extended Lock Time Indicator value 0-704.
+ */
+static uint16_t to_msm_lock_ind_ext(double time) {
+  if (time * 1000 >= 67108864) {
+    return 704;
+  }
+  uint32_t time_ms = (uint32_t)round(time * 1000);
+  if (time_ms < 64) {
+    return (uint16_t)time_ms;
+  }
+  /* indicators 64 + 32 * (n - 1) onwards have a resolution of 2^n ms */
+  for (uint8_t n = 1; n <= 20; n++) {
+    if (time_ms < ((uint32_t)1 << (n + 6))) {
+      return (uint16_t)((time_ms + ((uint32_t)n << (n + 5))) >> n);
+    }
+  }
+  return 704;
+}
+
+static void rtcm3_encode_msm_header(const rtcm_msm_header *header,
+                                    const rtcm_msm_layout *layout,
+                                    rtcm_bitwriter *writer) {
+  rtcm_write_bitu(writer, 12, layout->msg_num);
+  rtcm_write_bitu(writer, 12, header->stn_id);
+  if (RTCM_CONSTELLATION_GLO == layout->cons) {
     /* day of the week */
     uint8_t dow = (uint16_t)(header->tow_ms / (24 * 3600 * 1000));
-    rtcm_setbitu(buff, bit, 3, dow);
-    bit += 3;
+    rtcm_write_bitu(writer, 3, dow);
     /* time of the day */
     uint32_t tod_ms = header->tow_ms - dow * 24 * 3600 * 1000;
-    rtcm_setbitu(buff, bit, 27, tod_ms);
-    bit += 27;
+    rtcm_write_bitu(writer, 27, tod_ms);
   } else {
     /* for other systems, epoch time is the time of week in ms */
-    rtcm_setbitu(buff, bit, 30, header->tow_ms);
-    bit += 30;
-  }
-  rtcm_setbitu(buff, bit, 1, header->multiple);
-  bit += 1;
-  rtcm_setbitu(buff, bit, 3, header->iods);
-  bit += 3;
-  rtcm_setbitu(buff, bit, 7, header->reserved);
-  bit += 7;
-  rtcm_setbitu(buff, bit, 2, header->steering);
-  bit += 2;
-  rtcm_setbitu(buff, bit, 2, header->ext_clock);
-  bit += 2;
-  rtcm_setbitu(buff, bit, 1, header->div_free);
-  bit += 1;
-  rtcm_setbitu(buff, bit, 3, header->smooth);
-  bit += 3;
-
-  for (uint8_t i = 0; i < MSM_SATELLITE_MASK_SIZE; i++) {
-    rtcm_setbitu(buff, bit, 1, header->satellite_mask[i]);
-    bit++;
-  }
-  for (uint8_t i = 0; i < MSM_SIGNAL_MASK_SIZE; i++) {
-    rtcm_setbitu(buff, bit, 1, header->signal_mask[i]);
-    bit++;
-  }
-  uint8_t num_sats =
-      count_mask_values(MSM_SATELLITE_MASK_SIZE, header->satellite_mask);
-  uint8_t num_sigs =
-      count_mask_values(MSM_SIGNAL_MASK_SIZE, header->signal_mask);
-  uint8_t cell_mask_size = num_sats * num_sigs;
-
-  for (uint8_t i = 0; i < cell_mask_size; i++) {
-    rtcm_setbitu(buff, bit, 1, header->cell_mask[i]);
-    bit++;
-  }
-
-  return bit;
+    rtcm_write_bitu(writer, 30, header->tow_ms);
+  }
+  rtcm_write_bitu(writer, 1, header->multiple);
+  rtcm_write_bitu(writer, 3, header->iods);
+  rtcm_write_bitu(writer, 7, header->reserved);
+  rtcm_write_bitu(writer, 2, header->steering);
+  rtcm_write_bitu(writer, 2, header->ext_clock);
+  rtcm_write_bitu(writer, 1, header->div_free);
+  rtcm_write_bitu(writer, 3, header->smooth);
+
+  /* each mask goes out as a single field, first entry in the MSB */
+  const rtcm_msm_masks *masks = &layout->masks;
+  rtcm_write_bitul(writer,
+                   MSM_SATELLITE_MASK_SIZE,
+                   reverse_mask_bits(masks->sats, MSM_SATELLITE_MASK_SIZE));
+  rtcm_write_bitu(
+      writer,
+      MSM_SIGNAL_MASK_SIZE,
+      (uint32_t)reverse_mask_bits(masks->sigs, MSM_SIGNAL_MASK_SIZE));
+  uint8_t cell_mask_size = layout->num_sats * layout->num_sigs;
+  rtcm_write_bitul(
+      writer, cell_mask_size, reverse_mask_bits(masks->cells, cell_mask_size));
 }
 
-static void encode_msm_sat_data(const rtcm_msm_message *msg,
-                                const uint8_t num_sats,
-                                const msm_enum msm_type,
-                                double rough_range_ms[num_sats],
-                                double rough_rate_m_s[num_sats],
-                                uint8_t buff[],
-                                uint16_t *bit) {
+static void encode_msm_sat_data(const rtcm_msm_layout *layout,
+                                const rtcm_msm_message *msg,
+                                double rough_range_ms[],
+                                double rough_rate_m_s[],
+                                rtcm_bitwriter *writer) {
+  uint8_t num_sats = layout->num_sats;
+  bool full = (MSM5 == layout->msm_type || MSM7 == layout->msm_type);
+
   /* number of integer milliseconds, DF397 */
-  uint8_t integer_ms[num_sats];
+  uint8_t integer_ms[RTCM_MAX_SATS];
   for (uint8_t i = 0; i < num_sats; i++) {
     integer_ms[i] = (uint8_t)floor(msg->sats[i].rough_range_ms);
-    rtcm_setbitu(buff, *bit, 8, integer_ms[i]);
-    *bit += 8;
+    rtcm_write_bitu(writer, 8, integer_ms[i]);
   }
-  if (MSM5 == msm_type) {
+  if (full) {
     for (uint8_t i = 0; i < num_sats; i++) {
-      rtcm_setbitu(buff, *bit, 4, msg->sats[i].glo_fcn);
-      *bit += 4;
+      rtcm_write_bitu(writer, 4, msg->sats[i].glo_fcn);
     }
   }
 
@@ -933,216 +948,370 @@ static void encode_msm_sat_data(const rtcm_msm_message *msg,
     /* remove integer ms part */
     double range_modulo_ms = pr - integer_ms[i];
     uint16_t range_modulo_encoded = (uint16_t)round(1024 * range_modulo_ms);
-    rtcm_setbitu(buff, *bit, 10, range_modulo_encoded);
-    *bit += 10;
+    rtcm_write_bitu(writer, 10, range_modulo_encoded);
     rough_range_ms[i] = integer_ms[i] + (double)range_modulo_encoded / 1024;
   }
 
   /* range rate, m/s, DF399*/
-  if (MSM5 == msm_type) {
-    for (uint8_t i = 0; i < num_sats; i++) {
+  for (uint8_t i = 0; i < num_sats; i++) {
+    rough_rate_m_s[i] = 0;
+    if (full) {
       int16_t range_rate = (int16_t)msg->sats[i].rough_range_rate_m_s;
-      rtcm_setbits(buff, *bit, 14, range_rate);
-      *bit += 14;
+      rtcm_write_bits(writer, 14, range_rate);
       rough_rate_m_s[i] = range_rate;
     }
   }
 }
 
-static void encode_msm_fine_pseudoranges(const uint8_t num_cells,
-                                         const double fine_pr_ms[],
-                                         const flag_bf flags[],
-                                         uint8_t buff[],
-                                         uint16_t *bit) {
+static void encode_msm_fine_pseudoranges(const rtcm_msm_layout *layout,
+                                         const rtcm_msm_message *msg,
+                                         const double rough_range_ms[],
+                                         rtcm_bitwriter *writer) {
   /* DF400 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    if (flags[i].valid_pr && fabs(fine_pr_ms[i]) < C_1_2P10) {
-      rtcm_setbits(buff, *bit, 15, (int16_t)round(fine_pr_ms[i] / C_1_2P24));
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg->signals[i];
+    double fine_pr_ms =
+        signal->pseudorange_ms - rough_range_ms[layout->cell_sat[i]];
+    if (signal->flags.valid_pr && fabs(fine_pr_ms) < C_1_2P10) {
+      rtcm_write_bits(writer, 15, (int16_t)round(fine_pr_ms / C_1_2P24));
+    } else {
+      rtcm_write_bits(writer, 15, MSM_PR_INVALID);
+    }
+  }
+}
+
+static void encode_msm_fine_pseudoranges_extended(
+    const rtcm_msm_layout *layout,
+    const rtcm_msm_message *msg,
+    const double rough_range_ms[],
+    rtcm_bitwriter *writer) {
+  /* DF405 */
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg->signals[i];
+    double fine_pr_ms =
+        signal->pseudorange_ms - rough_range_ms[layout->cell_sat[i]];
+    if (signal->flags.valid_pr && fabs(fine_pr_ms) < C_1_2P10) {
+      rtcm_write_bits(writer, 20, (int32_t)round(fine_pr_ms / C_1_2P29));
     } else {
-      rtcm_setbits(buff, *bit, 15, MSM_PR_INVALID);
+      rtcm_write_bits(writer, 20, MSM_PR_EXT_INVALID);
     }
-    *bit += 15;
   }
 }
 
-static void encode_msm_fine_phaseranges(const uint8_t num_cells,
-                                        const double fine_cp_ms[],
-                                        const flag_bf flags[],
-                                        uint8_t buff[],
-                                        uint16_t *bit) {
+static void encode_msm_fine_phaseranges(const rtcm_msm_layout *layout,
+                                        const rtcm_msm_message *msg,
+                                        const double rough_range_ms[],
+                                        rtcm_bitwriter *writer) {
   /* DF401 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    if (flags[i].valid_cp && fabs(fine_cp_ms[i]) < C_1_2P8) {
-      rtcm_setbits(buff, *bit, 22, (int32_t)round(fine_cp_ms[i] / C_1_2P29));
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg->signals[i];
+    double fine_cp_ms =
+        signal->carrier_phase_ms - rough_range_ms[layout->cell_sat[i]];
+    if (signal->flags.valid_cp && fabs(fine_cp_ms) < C_1_2P8) {
+      rtcm_write_bits(writer, 22, (int32_t)round(fine_cp_ms / C_1_2P29));
     } else {
-      rtcm_setbits(buff, *bit, 22, MSM_CP_INVALID);
+      rtcm_write_bits(writer, 22, MSM_CP_INVALID);
     }
-    *bit += 22;
   }
 }
 
-static void encode_msm_lock_times(const uint8_t num_cells,
-                                  const double lock_time[],
-                                  const flag_bf flags[],
-                                  uint8_t buff[],
-                                  uint16_t *bit) {
+static void encode_msm_fine_phaseranges_extended(
+    const rtcm_msm_layout *layout,
+    const rtcm_msm_message *msg,
+    const double rough_range_ms[],
+    rtcm_bitwriter *writer) {
+  /* DF406 */
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg->signals[i];
+    double fine_cp_ms =
+        signal->carrier_phase_ms - rough_range_ms[layout->cell_sat[i]];
+    if (signal->flags.valid_cp && fabs(fine_cp_ms) < C_1_2P8) {
+      rtcm_write_bits(writer, 24, (int32_t)round(fine_cp_ms / C_1_2P31));
+    } else {
+      rtcm_write_bits(writer, 24, MSM_CP_EXT_INVALID);
+    }
+  }
+}
+
+static void encode_msm_lock_times(const rtcm_msm_layout *layout,
+                                  const rtcm_msm_message *msg,
+                                  rtcm_bitwriter *writer) {
   /* DF402 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    if (flags[i].valid_lock) {
-      rtcm_setbitu(buff, *bit, 4, rtcm3_encode_lock_time(lock_time[i]));
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg->signals[i];
+    if (signal->flags.valid_lock) {
+      rtcm_write_bitu(writer, 4, rtcm3_encode_lock_time(signal->lock_time_s));
     } else {
-      rtcm_setbitu(buff, *bit, 4, 0);
+      rtcm_write_bitu(writer, 4, 0);
     }
-    *bit += 4;
   }
 }
 
-static void encode_msm_hca_indicators(const uint8_t num_cells,
-                                      const bool hca_indicator[],
-                                      uint8_t buff[],
-                                      uint16_t *bit) {
+static void encode_msm_lock_times_extended(const rtcm_msm_layout *layout,
+                                           const rtcm_msm_message *msg,
+                                           rtcm_bitwriter *writer) {
+  /* DF407 */
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg->signals[i];
+    if (signal->flags.valid_lock) {
+      rtcm_write_bitu(writer, 10, to_msm_lock_ind_ext(signal->lock_time_s));
+    } else {
+      rtcm_write_bitu(writer, 10, 0);
+    }
+  }
+}
+
+static void encode_msm_hca_indicators(const rtcm_msm_layout *layout,
+                                      const rtcm_msm_message *msg,
+                                      rtcm_bitwriter *writer) {
   /* DF420 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    rtcm_setbitu(buff, *bit, 1, hca_indicator[i]);
-    *bit += 1;
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    rtcm_write_bitu(writer, 1, msg->signals[i].hca_indicator);
   }
 }
 
-static void encode_msm_cnrs(const uint8_t num_cells,
-                            const double cnr[],
-                            const flag_bf flags[],
-                            uint8_t buff[],
-                            uint16_t *bit) {
+static void encode_msm_cnrs(const rtcm_msm_layout *layout,
+                            const rtcm_msm_message *msg,
+                            rtcm_bitwriter *writer) {
   /* DF403 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    if (flags[i].valid_cnr) {
-      rtcm_setbitu(buff, *bit, 6, (uint8_t)round(cnr[i]));
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg->signals[i];
+    if (signal->flags.valid_cnr) {
+      rtcm_write_bitu(writer, 6, (uint8_t)round(signal->cnr));
     } else {
-      rtcm_setbitu(buff, *bit, 6, 0);
+      rtcm_write_bitu(writer, 6, 0);
     }
-    *bit += 6;
   }
 }
 
-static void encode_msm_fine_phaserangerates(const uint8_t num_cells,
-                                            const double fine_range_rate_m_s[],
-                                            const flag_bf flags[],
-                                            uint8_t buff[],
-                                            uint16_t *bit) {
+static void encode_msm_cnrs_extended(const rtcm_msm_layout *layout,
+                                     const rtcm_msm_message *msg,
+                                     rtcm_bitwriter *writer) {
+  /* DF408 */
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg->signals[i];
+    if (signal->flags.valid_cnr) {
+      rtcm_write_bitu(writer, 10, (uint16_t)round(signal->cnr / C_1_2P4));
+    } else {
+      rtcm_write_bitu(writer, 10, 0);
+    }
+  }
+}
+
+static void encode_msm_fine_phaserangerates(const rtcm_msm_layout *layout,
+                                            const rtcm_msm_message *msg,
+                                            const double rough_rate_m_s[],
+                                            rtcm_bitwriter *writer) {
   /* DF404 */
-  for (uint16_t i = 0; i < num_cells; i++) {
-    if (flags[i].valid_dop && fabs(fine_range_rate_m_s[i]) < 0.0001 * C_2P14) {
-      rtcm_setbits(
-          buff, *bit, 15, (int16_t)round(fine_range_rate_m_s[i] / 0.0001));
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg->signals[i];
+    double fine_range_rate_m_s =
+        signal->range_rate_m_s - rough_rate_m_s[layout->cell_sat[i]];
+    if (signal->flags.valid_dop &&
+        fabs(fine_range_rate_m_s) < 0.0001 * C_2P14) {
+      rtcm_write_bits(
+          writer, 15, (int16_t)round(fine_range_rate_m_s / 0.0001));
     } else {
-      rtcm_setbits(buff, *bit, 15, MSM_DOP_INVALID);
+      rtcm_write_bits(writer, 15, MSM_DOP_INVALID);
     }
-    *bit += 15;
   }
 }
 
-/** MSM4/5 encoder
+/* Drop the cell mask bits beyond the num_sats * num_sigs used cells */
+static uint64_t msm_layout_cells(uint64_t cells, uint8_t cell_mask_size) {
+  if (cell_mask_size < 64) {
+    cells &= ((uint64_t)1 << cell_mask_size) - 1;
+  }
+  return cells;
+}
+
+/** Compute the layout of an MSM4-7 message.
  *
- * \param msg The input RTCM message struct
- * \param buff Data buffer large enough to hold the message (at worst 742 bytes)
- *             (see RTCM 10403.3 Table 3.5-71)
- * \return Number of bytes written or 0 on failure
+ * The layout only depends on the message number and the masks, so it can
+ * be computed once and reused for every epoch with the same masks.
+ *
+ * \param msg_num Message number
+ * \param masks Satellite, signal and cell masks of the message
+ * \param layout The computed layout
+ * \return true on success, false if the message number is not MSM4-7, the
+ *         constellation is unsupported or the masks are too large
  */
-
-static uint16_t rtcm3_encode_msm_internal(const rtcm_msm_message *msg,
-                                          uint8_t buff[]) {
-  const rtcm_msm_header *header = &msg->header;
-
-  msm_enum msm_type = to_msm_type(header->msg_num);
-  if (MSM4 != msm_type && MSM5 != msm_type) {
+bool rtcm3_msm_layout_init(uint16_t msg_num,
+                           const rtcm_msm_masks *masks,
+                           rtcm_msm_layout *layout) {
+  assert(masks);
+  assert(layout);
+  msm_enum msm_type = to_msm_type(msg_num);
+  if (MSM4 != msm_type && MSM5 != msm_type && MSM6 != msm_type &&
+      MSM7 != msm_type) {
     /* Unexpected message type. */
-    return 0;
+    return false;
   }
 
-  rtcm_constellation_t cons = to_constellation(header->msg_num);
-
+  rtcm_constellation_t cons = to_constellation(msg_num);
   if (RTCM_CONSTELLATION_INVALID == cons) {
     /* Invalid or unsupported constellation */
-    return 0;
+    return false;
   }
 
-  uint8_t num_sats =
-      count_mask_values(MSM_SATELLITE_MASK_SIZE, header->satellite_mask);
-  uint8_t num_sigs =
-      count_mask_values(MSM_SIGNAL_MASK_SIZE, header->signal_mask);
+  uint8_t num_sats = count_mask_bits(masks->sats);
+  uint8_t num_sigs = count_mask_bits(masks->sigs);
+  if (num_sats > RTCM_MAX_SATS || num_sats * num_sigs > MSM_MAX_CELLS) {
+    /* Too large cell mask, should already have been handled by caller */
+    return false;
+  }
   uint8_t cell_mask_size = num_sats * num_sigs;
-  uint8_t num_cells = count_mask_values(cell_mask_size, header->cell_mask);
+  uint64_t cells = msm_layout_cells(masks->cells, cell_mask_size);
+
+  layout->msg_num = msg_num;
+  layout->msm_type = msm_type;
+  layout->cons = cons;
+  layout->masks = *masks;
+  layout->masks.cells = cells;
+  layout->num_sats = num_sats;
+  layout->num_sigs = num_sigs;
+  layout->num_cells = count_mask_bits(cells);
+  for (uint8_t i = 0; i < layout->num_cells; i++) {
+    layout->cell_sat[i] = pop_first_mask_bit(&cells) / num_sigs;
+  }
+
+  bool extended = (MSM6 == msm_type || MSM7 == msm_type);
+  bool full = (MSM5 == msm_type || MSM7 == msm_type);
+  uint8_t num_cells = layout->num_cells;
+  uint16_t sat_bits = full ? 36 : 18;
+  uint16_t cell_bits = (extended ? 65 : 48) + (full ? 15 : 0);
+
+  layout->sat_data_bit = 169 + cell_mask_size;
+  layout->signal_data_bit = layout->sat_data_bit + sat_bits * num_sats;
+  layout->pr_bit = layout->signal_data_bit;
+  layout->cp_bit = layout->pr_bit + (extended ? 20 : 15) * num_cells;
+  layout->lock_bit = layout->cp_bit + (extended ? 24 : 22) * num_cells;
+  layout->hca_bit = layout->lock_bit + (extended ? 10 : 4) * num_cells;
+  layout->cnr_bit = layout->hca_bit + num_cells;
+  layout->dop_bit = layout->cnr_bit + (extended ? 10 : 6) * num_cells;
+  layout->num_bits = layout->signal_data_bit + cell_bits * num_cells;
+  layout->length = (layout->num_bits + 7) / 8;
+  return true;
+}
 
-  if (num_sats * num_sigs > MSM_MAX_CELLS) {
-    /* Too large cell mask, should already have been handled by caller */
+/** Check whether a layout can be reused for a message.
+ *
+ * \param layout Layout from rtcm3_msm_layout_init()
+ * \param msg_num Message number
+ * \param masks Satellite, signal and cell masks of the message
+ * \return true if the message has the same layout
+ */
+bool rtcm3_msm_layout_matches(const rtcm_msm_layout *layout,
+                              uint16_t msg_num,
+                              const rtcm_msm_masks *masks) {
+  assert(layout);
+  assert(masks);
+  /* compare the cells the way rtcm3_msm_layout_init() stored them */
+  uint64_t cells =
+      msm_layout_cells(masks->cells, layout->num_sats * layout->num_sigs);
+  return layout->msg_num == msg_num && layout->masks.sats == masks->sats &&
+         layout->masks.sigs == masks->sigs && layout->masks.cells == cells;
+}
+
+/** MSM4-7 encoder using a precomputed layout
+ *
+ * The masks of the message header are not used, the message is encoded with
+ * the masks of the layout. Each block of fields is written at its offset in
+ * the layout.
+ *
+ * \param layout Layout from rtcm3_msm_layout_init()
+ * \param msg The input RTCM message struct
+ * \param buff Data buffer of at least layout->length bytes
+ * \return Number of bytes written or 0 on failure
+ */
+uint16_t rtcm3_encode_msm_layout(const rtcm_msm_layout *layout,
+                                 const rtcm_msm_message *msg,
+                                 uint8_t buff[]) {
+  assert(layout);
+  assert(msg);
+  if (layout->msg_num != msg->header.msg_num) {
     return 0;
   }
+  bool extended = (MSM6 == layout->msm_type || MSM7 == layout->msm_type);
+  bool full = (MSM5 == layout->msm_type || MSM7 == layout->msm_type);
+
+  rtcm_bitwriter writer;
 
   /* Header */
-  uint16_t bit = rtcm3_encode_msm_header(header, cons, buff);
+  rtcm_bitwriter_init(&writer, buff, layout->length, 0);
+  rtcm3_encode_msm_header(&msg->header, layout, &writer);
 
   /* Satellite Data */
+  double rough_range_ms[RTCM_MAX_SATS];
+  double rough_rate_m_s[RTCM_MAX_SATS];
+  encode_msm_sat_data(layout, msg, rough_range_ms, rough_rate_m_s, &writer);
+  assert(writer.pos == layout->signal_data_bit);
+  rtcm_bitwriter_flush(&writer);
 
-  double rough_range_ms[num_sats];
-  double rough_rate_m_s[num_sats];
+  /* Signal Data */
+  rtcm_bitwriter_init(&writer, buff, layout->length, layout->pr_bit);
+  if (extended) {
+    encode_msm_fine_pseudoranges_extended(layout, msg, rough_range_ms, &writer);
+  } else {
+    encode_msm_fine_pseudoranges(layout, msg, rough_range_ms, &writer);
+  }
+  rtcm_bitwriter_flush(&writer);
 
-  /* Satellite data */
-  encode_msm_sat_data(
-      msg, num_sats, msm_type, rough_range_ms, rough_rate_m_s, buff, &bit);
+  rtcm_bitwriter_init(&writer, buff, layout->length, layout->cp_bit);
+  if (extended) {
+    encode_msm_fine_phaseranges_extended(layout, msg, rough_range_ms, &writer);
+  } else {
+    encode_msm_fine_phaseranges(layout, msg, rough_range_ms, &writer);
+  }
+  rtcm_bitwriter_flush(&writer);
 
-  /* Signal Data */
+  rtcm_bitwriter_init(&writer, buff, layout->length, layout->lock_bit);
+  if (extended) {
+    encode_msm_lock_times_extended(layout, msg, &writer);
+  } else {
+    encode_msm_lock_times(layout, msg, &writer);
+  }
+  rtcm_bitwriter_flush(&writer);
 
-  double fine_pr_ms[num_cells];
-  double fine_cp_ms[num_cells];
-  double lock_time[num_cells];
-  bool hca_indicator[num_cells];
-  double cnr[num_cells];
-  double fine_range_rate_m_s[num_cells];
-  flag_bf flags[num_cells];
-  memset(flags, 0, sizeof(flags));
-
-  uint8_t i = 0;
-  for (uint8_t sat = 0; sat < num_sats; sat++) {
-    for (uint8_t sig = 0; sig < num_sigs; sig++) {
-      if (header->cell_mask[sat * num_sigs + sig]) {
-        flags[i] = msg->signals[i].flags;
-        if (flags[i].valid_pr) {
-          fine_pr_ms[i] = msg->signals[i].pseudorange_ms - rough_range_ms[sat];
-        }
-        if (flags[i].valid_cp) {
-          fine_cp_ms[i] =
-              msg->signals[i].carrier_phase_ms - rough_range_ms[sat];
-        }
-        if (flags[i].valid_lock) {
-          lock_time[i] = msg->signals[i].lock_time_s;
-        }
-        hca_indicator[i] = msg->signals[i].hca_indicator;
-        if (flags[i].valid_cnr) {
-          cnr[i] = msg->signals[i].cnr;
-        } else {
-          cnr[i] = 0;
-        }
-        if (MSM5 == msm_type && flags[i].valid_dop) {
-          fine_range_rate_m_s[i] =
-              msg->signals[i].range_rate_m_s - rough_rate_m_s[sat];
-        }
-        i++;
-      }
-    }
+  rtcm_bitwriter_init(&writer, buff, layout->length, layout->hca_bit);
+  encode_msm_hca_indicators(layout, msg, &writer);
+  rtcm_bitwriter_flush(&writer);
+
+  rtcm_bitwriter_init(&writer, buff, layout->length, layout->cnr_bit);
+  if (extended) {
+    encode_msm_cnrs_extended(layout, msg, &writer);
+  } else {
+    encode_msm_cnrs(layout, msg, &writer);
   }
+  rtcm_bitwriter_flush(&writer);
 
-  encode_msm_fine_pseudoranges(num_cells, fine_pr_ms, flags, buff, &bit);
-  encode_msm_fine_phaseranges(num_cells, fine_cp_ms, flags, buff, &bit);
-  encode_msm_lock_times(num_cells, lock_time, flags, buff, &bit);
-  encode_msm_hca_indicators(num_cells, hca_indicator, buff, &bit);
-  encode_msm_cnrs(num_cells, cnr, flags, buff, &bit);
-  if (MSM5 == msm_type) {
-    encode_msm_fine_phaserangerates(
-        num_cells, fine_range_rate_m_s, flags, buff, &bit);
+  if (full) {
+    rtcm_bitwriter_init(&writer, buff, layout->length, layout->dop_bit);
+    encode_msm_fine_phaserangerates(layout, msg, rough_rate_m_s, &writer);
+    rtcm_bitwriter_flush(&writer);
   }
 
-  /* Round number of bits up to nearest whole byte. */
-  return (bit + 7) / 8;
+  return layout->length;
+}
+
+/** MSM4-7 encoder
+ *
+ * \param msg The input RTCM message struct
+ * \param buff Data buffer large enough to hold the message (at worst
+ *             RTCM3_MAX_MSG_LEN bytes)
+ * \return Number of bytes written or 0 on failure
+ */
+
+static uint16_t rtcm3_encode_msm_internal(const rtcm_msm_message *msg,
+                                          uint8_t buff[]) {
+  rtcm_msm_masks masks;
+  msm_pack_masks(&msg->header, &masks);
+  rtcm_msm_layout layout;
+  if (!rtcm3_msm_layout_init(msg->header.msg_num, &masks, &layout)) {
+    return 0;
+  }
+
+  return rtcm3_encode_msm_layout(&layout, msg, buff);
 }
 
 /** MSM4 encoder
@@ -1179,6 +1348,40 @@ uint16_t rtcm3_encode_msm5(const rtcm_msm_message *msg_msm5, uint8_t buff[]) {
   return rtcm3_encode_msm_internal(msg_msm5, buff);
 }
 
+/** MSM6 encoder
+ *
+ * \param msg The input RTCM message struct
+ * \param buff Data buffer large enough to hold the message (at worst
+ *             RTCM3_MAX_MSG_LEN bytes)
+ * \return Number of bytes written or 0 on failure
+ */
+
+uint16_t rtcm3_encode_msm6(const rtcm_msm_message *msg_msm6, uint8_t buff[]) {
+  assert(msg_msm6);
+  if (MSM6 != to_msm_type(msg_msm6->header.msg_num)) {
+    return 0;
+  }
+
+  return rtcm3_encode_msm_internal(msg_msm6, buff);
+}
+
+/** MSM7 encoder
+ *
+ * \param msg The input RTCM message struct
+ * \param buff Data buffer large enough to hold the message (at worst
+ *             RTCM3_MAX_MSG_LEN bytes)
+ * \return Number of bytes written or 0 on failure
+ */
+
+uint16_t rtcm3_encode_msm7(const rtcm_msm_message *msg_msm7, uint8_t buff[]) {
+  assert(msg_msm7);
+  if (MSM7 != to_msm_type(msg_msm7->header.msg_num)) {
+    return 0;
+  }
+
+  return rtcm3_encode_msm_internal(msg_msm7, buff);
+}
+
 /** Encode the Swift Proprietary Message
  *
  * \param msg The input RTCM message struct
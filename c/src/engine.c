@@ -0,0 +1,428 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/engine.h"
+
+#ifdef RTCM3_ENGINE_AVAILABLE
+
+#include <assert.h>
+#include <string.h>
+
+#define LOAD(x, order) __atomic_load_n(&(x), __ATOMIC_##order)
+#define STORE(x, v, order) __atomic_store_n(&(x), (v), __ATOMIC_##order)
+#define CAS(x, expected, desired)                 \
+  __atomic_compare_exchange_n(&(x),               \
+                              &(expected),        \
+                              (desired),          \
+                              false,              \
+                              __ATOMIC_SEQ_CST,   \
+                              __ATOMIC_RELAXED)
+
+#define STREAM_IDLE 0
+#define STREAM_QUEUED 1 /* In a deque or the ready queue, or being decoded */
+
+#define NO_STREAM UINT32_MAX
+
+static bool is_pow2(uint32_t x) { return x > 0 && 0 == (x & (x - 1)); }
+
+/* Deque, after Chase and Lev with the memory orders of Le et al., "Correct
+ * and Efficient Work-Stealing for Weak Memory Models", PPoPP 2013. It never
+ * fills up as a stream is in at most one deque at a time. */
+
+static void deque_push(rtcm3_engine_deque *deque, uint32_t stream) {
+  int64_t b = LOAD(deque->bottom, RELAXED);
+  assert(b - LOAD(deque->top, ACQUIRE) < (int64_t)deque->size);
+  STORE(deque->slots[b & (deque->size - 1)], stream, RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  STORE(deque->bottom, b + 1, RELAXED);
+}
+
+static uint32_t deque_pop(rtcm3_engine_deque *deque) {
+  int64_t b = LOAD(deque->bottom, RELAXED) - 1;
+  STORE(deque->bottom, b, RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  int64_t t = LOAD(deque->top, RELAXED);
+  if (t > b) {
+    STORE(deque->bottom, b + 1, RELAXED);
+    return NO_STREAM;
+  }
+  uint32_t stream = LOAD(deque->slots[b & (deque->size - 1)], RELAXED);
+  if (t == b) {
+    /* last one, race the thieves for it */
+    if (!CAS(deque->top, t, t + 1)) {
+      stream = NO_STREAM;
+    }
+    STORE(deque->bottom, b + 1, RELAXED);
+  }
+  return stream;
+}
+
+static uint32_t deque_steal(rtcm3_engine_deque *deque) {
+  int64_t t = LOAD(deque->top, ACQUIRE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  int64_t b = LOAD(deque->bottom, ACQUIRE);
+  if (t >= b) {
+    return NO_STREAM;
+  }
+  uint32_t stream = LOAD(deque->slots[t & (deque->size - 1)], RELAXED);
+  if (!CAS(deque->top, t, t + 1)) {
+    return NO_STREAM;
+  }
+  return stream;
+}
+
+/* Ready queue, after Vyukov's bounded MPMC queue. Like the deques it never
+ * fills up. */
+
+static void queue_init(rtcm3_engine_queue *queue,
+                       rtcm3_engine_cell cells[],
+                       uint32_t size) {
+  queue->cells = cells;
+  queue->size = size;
+  queue->head = 0;
+  queue->tail = 0;
+  for (uint32_t i = 0; i < size; i++) {
+    cells[i].seq = i;
+    cells[i].stream = NO_STREAM;
+  }
+}
+
+static void queue_push(rtcm3_engine_queue *queue, uint32_t stream) {
+  uint32_t pos = LOAD(queue->head, RELAXED);
+  for (;;) {
+    rtcm3_engine_cell *cell = &queue->cells[pos & (queue->size - 1)];
+    int32_t diff = (int32_t)(LOAD(cell->seq, ACQUIRE) - pos);
+    if (0 == diff) {
+      if (CAS(queue->head, pos, pos + 1)) {
+        STORE(cell->stream, stream, RELAXED);
+        STORE(cell->seq, pos + 1, RELEASE);
+        return;
+      }
+    } else {
+      assert(diff > 0);
+      pos = LOAD(queue->head, RELAXED);
+    }
+  }
+}
+
+static uint32_t queue_pop(rtcm3_engine_queue *queue) {
+  uint32_t pos = LOAD(queue->tail, RELAXED);
+  for (;;) {
+    rtcm3_engine_cell *cell = &queue->cells[pos & (queue->size - 1)];
+    int32_t diff = (int32_t)(LOAD(cell->seq, ACQUIRE) - (pos + 1));
+    if (0 == diff) {
+      if (CAS(queue->tail, pos, pos + 1)) {
+        uint32_t stream = LOAD(cell->stream, RELAXED);
+        STORE(cell->seq, pos + queue->size, RELEASE);
+        return stream;
+      }
+    } else if (diff < 0) {
+      return NO_STREAM;
+    } else {
+      pos = LOAD(queue->tail, RELAXED);
+    }
+  }
+}
+
+/* Whether a worker holding the stream could make progress on it. Input
+ * given to the framer is only released once drained, so this covers it,
+ * and any thread may ask. */
+static bool stream_runnable(rtcm3_engine_stream *stream) {
+  bool has_input =
+      LOAD(stream->input_head, ACQUIRE) != LOAD(stream->input_tail, ACQUIRE);
+  bool has_room = LOAD(stream->results_head, ACQUIRE) -
+                      LOAD(stream->results_tail, ACQUIRE) <
+                  stream->results_size;
+  return has_input && has_room;
+}
+
+/* Queue an idle stream, from a worker onto its deque, otherwise onto the
+ * ready queue */
+static void schedule(rtcm3_engine *engine,
+                     uint32_t stream,
+                     rtcm3_engine_worker *worker) {
+  uint32_t expected = STREAM_IDLE;
+  if (!CAS(engine->streams[stream].state, expected, STREAM_QUEUED)) {
+    return;
+  }
+  if (NULL != worker) {
+    deque_push(&worker->deque, stream);
+  } else {
+    queue_push(&engine->ready, stream);
+  }
+}
+
+/** Initialize a stream of an engine.
+ *
+ * \param stream Stream to initialize
+ * \param input Buffer for input waiting to be decoded
+ * \param input_size Size of input, a power of two of at least
+ *                   RTCM3_MAX_FRAME_LEN
+ * \param results Buffer for decoded frames waiting to be consumed
+ * \param results_size Number of results, a power of two
+ */
+void rtcm3_engine_stream_init(rtcm3_engine_stream *stream,
+                              uint8_t input[],
+                              uint32_t input_size,
+                              rtcm3_engine_result results[],
+                              uint32_t results_size) {
+  assert(stream);
+  assert(input && is_pow2(input_size) && input_size >= RTCM3_MAX_FRAME_LEN);
+  assert(results && is_pow2(results_size));
+  memset(stream, 0, sizeof(*stream));
+  stream->input = input;
+  stream->input_size = input_size;
+  stream->results = results;
+  stream->results_size = results_size;
+  stream->state = STREAM_IDLE;
+  rtcm3_framer_init(&stream->framer);
+}
+
+/** Initialize a worker of an engine.
+ *
+ * \param worker Worker to initialize
+ * \param slots Deque storage
+ * \param size Number of slots, a power of two of at least the number of
+ *             streams of the engine
+ */
+void rtcm3_engine_worker_init(rtcm3_engine_worker *worker,
+                              uint32_t slots[],
+                              uint32_t size) {
+  assert(worker);
+  assert(slots && is_pow2(size));
+  memset(worker, 0, sizeof(*worker));
+  worker->deque.slots = slots;
+  worker->deque.size = size;
+}
+
+/** Initialize an engine.
+ *
+ * The engine does not start threads. Each of the caller's worker threads
+ * calls rtcm3_engine_work() with its own worker number in a loop, and
+ * backs off when it returns 0. Streams are fed and consumed from any other
+ * thread, one producer and one consumer per stream.
+ *
+ * \param engine Engine to initialize
+ * \param streams Streams, see rtcm3_engine_stream_init()
+ * \param num_streams Number of streams
+ * \param workers Workers, see rtcm3_engine_worker_init()
+ * \param num_workers Number of workers
+ * \param cells Ready queue storage
+ * \param num_cells Number of cells, a power of two of at least
+ *                  num_streams
+ */
+void rtcm3_engine_init(rtcm3_engine *engine,
+                       rtcm3_engine_stream streams[],
+                       uint32_t num_streams,
+                       rtcm3_engine_worker workers[],
+                       uint32_t num_workers,
+                       rtcm3_engine_cell cells[],
+                       uint32_t num_cells) {
+  assert(engine);
+  assert(streams && num_streams > 0 && num_streams < NO_STREAM);
+  assert(workers && num_workers > 0);
+  assert(cells && is_pow2(num_cells) && num_cells >= num_streams);
+  engine->streams = streams;
+  engine->num_streams = num_streams;
+  engine->workers = workers;
+  engine->num_workers = num_workers;
+  engine->budget = RTCM3_ENGINE_DEFAULT_BUDGET;
+  queue_init(&engine->ready, cells, num_cells);
+  for (uint32_t i = 0; i < num_workers; i++) {
+    assert(workers[i].deque.size >= num_streams);
+    workers[i].next_victim = (i + 1) % num_workers;
+  }
+}
+
+/** Queue input of a stream for decoding.
+ *
+ * Only one thread may feed a given stream.
+ *
+ * \param engine Engine
+ * \param stream Stream number
+ * \param data Input, any chunking
+ * \param len Length of the input
+ * \return Number of bytes queued, less than len if the input buffer of the
+ *         stream is full
+ */
+size_t rtcm3_engine_feed(rtcm3_engine *engine,
+                         uint32_t stream,
+                         const uint8_t *data,
+                         size_t len) {
+  assert(engine);
+  assert(stream < engine->num_streams);
+  assert(data || 0 == len);
+  rtcm3_engine_stream *s = &engine->streams[stream];
+  uint32_t head = s->input_head;
+  uint32_t room = s->input_size - (head - LOAD(s->input_tail, ACQUIRE));
+  size_t n = len < room ? len : room;
+  for (size_t done = 0; done < n;) {
+    uint32_t pos = (head + (uint32_t)done) & (s->input_size - 1);
+    size_t run = s->input_size - pos;
+    if (run > n - done) {
+      run = n - done;
+    }
+    memcpy(&s->input[pos], data + done, run);
+    done += run;
+  }
+  STORE(s->input_head, head + (uint32_t)n, RELEASE);
+  if (n > 0) {
+    /* pairs with the fence of a worker that is finishing the stream */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    schedule(engine, stream, NULL);
+  }
+  return n;
+}
+
+/* Decode up to budget frames of a stream held by the worker */
+static uint32_t decode_stream(rtcm3_engine *engine, rtcm3_engine_stream *s) {
+  uint32_t decoded = 0;
+  while (decoded < engine->budget) {
+    uint32_t results_head = s->results_head;
+    if (results_head - LOAD(s->results_tail, ACQUIRE) >= s->results_size) {
+      break;
+    }
+    if (0 == s->chunk_len) {
+      uint32_t tail = s->input_tail;
+      uint32_t avail = LOAD(s->input_head, ACQUIRE) - tail;
+      if (0 == avail) {
+        break;
+      }
+      /* the framer keeps a view until it is drained, so the chunk is only
+       * released then */
+      uint32_t pos = tail & (s->input_size - 1);
+      uint32_t run = s->input_size - pos;
+      s->chunk_len = avail < run ? avail : run;
+      rtcm3_framer_feed(&s->framer, &s->input[pos], s->chunk_len);
+    }
+    rtcm3_frame frame;
+    if (!rtcm3_framer_next(&s->framer, &frame)) {
+      STORE(s->input_tail, s->input_tail + s->chunk_len, RELEASE);
+      s->chunk_len = 0;
+      continue;
+    }
+    rtcm3_engine_result *result =
+        &s->results[results_head & (s->results_size - 1)];
+    result->msg_num = frame.msg_num;
+    result->rc =
+        rtcm3_decode_frame(frame.payload, frame.payload_len, &result->msg);
+    STORE(s->results_head, results_head + 1, RELEASE);
+    decoded++;
+  }
+  return decoded;
+}
+
+/* Next stream for a worker: its own deque first, then the ready queue,
+ * then the other workers */
+static uint32_t find_stream(rtcm3_engine *engine, rtcm3_engine_worker *w) {
+  uint32_t stream = deque_pop(&w->deque);
+  if (NO_STREAM != stream) {
+    return stream;
+  }
+  stream = queue_pop(&engine->ready);
+  if (NO_STREAM != stream) {
+    return stream;
+  }
+  for (uint32_t i = 0; i + 1 < engine->num_workers; i++) {
+    uint32_t victim = w->next_victim;
+    w->next_victim = (victim + 1) % engine->num_workers;
+    if (&engine->workers[victim] == w) {
+      victim = w->next_victim;
+      w->next_victim = (victim + 1) % engine->num_workers;
+    }
+    stream = deque_steal(&engine->workers[victim].deque);
+    if (NO_STREAM != stream) {
+      w->steals++;
+      return stream;
+    }
+  }
+  return NO_STREAM;
+}
+
+/** Run one turn of a worker thread.
+ *
+ * The worker takes a ready stream, decodes up to the budget of frames of
+ * it in order, and puts it back on its own deque if there is more to do,
+ * where idle workers can steal it. A stream is held by a single worker at
+ * a time.
+ *
+ * \param engine Engine
+ * \param worker Worker number of the calling thread
+ * \return Number of frames decoded, 0 if no stream was ready
+ */
+uint32_t rtcm3_engine_work(rtcm3_engine *engine, uint32_t worker) {
+  assert(engine);
+  assert(worker < engine->num_workers);
+  rtcm3_engine_worker *w = &engine->workers[worker];
+  uint32_t stream = find_stream(engine, w);
+  if (NO_STREAM == stream) {
+    return 0;
+  }
+  w->turns++;
+  rtcm3_engine_stream *s = &engine->streams[stream];
+  uint32_t decoded = decode_stream(engine, s);
+  if (stream_runnable(s)) {
+    deque_push(&w->deque, stream);
+    return decoded;
+  }
+  STORE(s->state, STREAM_IDLE, SEQ_CST);
+  /* input or room may have arrived since the check, from a thread that
+   * still saw the stream queued */
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (stream_runnable(s)) {
+    schedule(engine, stream, w);
+  }
+  return decoded;
+}
+
+/** Get the oldest decoded frame of a stream.
+ *
+ * Only one thread may consume a given stream. The result stays valid until
+ * rtcm3_engine_release().
+ *
+ * \param engine Engine
+ * \param stream Stream number
+ * \return The oldest result, or NULL if there is none
+ */
+const rtcm3_engine_result *rtcm3_engine_peek(rtcm3_engine *engine,
+                                             uint32_t stream) {
+  assert(engine);
+  assert(stream < engine->num_streams);
+  rtcm3_engine_stream *s = &engine->streams[stream];
+  uint32_t tail = s->results_tail;
+  if (LOAD(s->results_head, ACQUIRE) == tail) {
+    return NULL;
+  }
+  return &s->results[tail & (s->results_size - 1)];
+}
+
+/** Drop the oldest decoded frame of a stream, after rtcm3_engine_peek().
+ *
+ * A stream whose results had filled up is rescheduled.
+ *
+ * \param engine Engine
+ * \param stream Stream number
+ */
+void rtcm3_engine_release(rtcm3_engine *engine, uint32_t stream) {
+  assert(engine);
+  assert(stream < engine->num_streams);
+  rtcm3_engine_stream *s = &engine->streams[stream];
+  uint32_t tail = s->results_tail;
+  assert(LOAD(s->results_head, ACQUIRE) != tail);
+  STORE(s->results_tail, tail + 1, RELEASE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (stream_runnable(s)) {
+    schedule(engine, stream, NULL);
+  }
+}
+
+#endif /* RTCM3_ENGINE_AVAILABLE */
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/eph_store.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "rtcm3/bits.h"
+#include "rtcm3/eph_decode.h"
+
+#include "decode_internal.h"
+
+typedef rtcm3_rc (*eph_decoder)(const uint8_t buff[],
+                                uint16_t len,
+                                rtcm_msg_eph *msg_eph);
+
+static const struct {
+  uint16_t msg_num;
+  uint16_t bits;
+  eph_decoder decode;
+} eph_msgs[RTCM3_EPH_MSG_COUNT] = {
+    [RTCM3_EPH_GPS] = {1019, GPS_EPH_BITS, rtcm3_decode_gps_eph_bounded},
+    [RTCM3_EPH_GLO] = {1020, GLO_EPH_BITS, rtcm3_decode_glo_eph_bounded},
+    [RTCM3_EPH_BDS] = {1042, BDS_EPH_BITS, rtcm3_decode_bds_eph_bounded},
+    [RTCM3_EPH_QZSS] = {1044, QZSS_EPH_BITS, rtcm3_decode_qzss_eph_bounded},
+    [RTCM3_EPH_GAL_FNAV] = {1045,
+                            GAL_EPH_FNAV_BITS,
+                            rtcm3_decode_gal_eph_fnav_bounded},
+    [RTCM3_EPH_GAL_INAV] = {1046,
+                            GAL_EPH_INAV_BITS,
+                            rtcm3_decode_gal_eph_inav_bounded},
+};
+
+/** Initialize an ephemeris store.
+ *
+ * \param store Store to initialize
+ * \param callback Called with each new ephemeris, may be NULL
+ * \param context Passed to `callback`
+ */
+void rtcm3_eph_store_init(rtcm3_eph_store *store,
+                          rtcm3_eph_callback callback,
+                          void *context) {
+  assert(store);
+  memset(store, 0, sizeof(*store));
+  store->callback = callback;
+  store->context = context;
+}
+
+/* Position of the GLONASS day N_t (DF129) in a 1020 message, the decoder
+ * does not keep it */
+#define GLO_EPH_DAY_BIT 268
+
+/* Whether a stored ephemeris has the same issue of data as a new one, for
+ * GLONASS the day and time of the ephemeris N_t and t_b identify it, as t_b
+ * alone repeats every day */
+static bool same_issue(const rtcm3_eph_entry *entry,
+                       const rtcm_msg_eph *eph,
+                       uint16_t glo_day) {
+  const rtcm_msg_eph *a = &entry->eph;
+  if (a->constellation == RTCM_CONSTELLATION_GLO) {
+    return entry->glo_day == glo_day && a->glo.t_b == eph->glo.t_b;
+  }
+  return a->wn == eph->wn && a->toe == eph->toe &&
+         a->kepler.iode == eph->kepler.iode &&
+         a->kepler.iodc == eph->kepler.iodc;
+}
+
+/** Merge an ephemeris message into the store.
+ *
+ * A message identical to the last one of the same type for the satellite is
+ * recognized from its raw bits and not decoded again. Other messages are
+ * decoded, and stored if their issue of data (IODE, IODC, week number and
+ * toe, or N_t and t_b for GLONASS) differs from the stored ephemeris of the
+ * same message type; only those are passed to the callback. Galileo F/NAV
+ * and I/NAV ephemerides are stored and notified separately.
+ *
+ * \param store Store to update
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \return  - RC_OK : Success, including repeated messages
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not an ephemeris message
+ *          - RC_INVALID_MESSAGE : The message does not fit in the payload or
+ *            is rejected by the decoder
+ */
+rtcm3_rc rtcm3_eph_store_update(rtcm3_eph_store *store,
+                                const uint8_t buff[],
+                                uint16_t len) {
+  assert(store);
+  assert(buff);
+  if (len < 3) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint16_t msg_num = rtcm_getbitu(buff, 0, 12);
+  uint8_t msg = 0;
+  while (msg < RTCM3_EPH_MSG_COUNT && eph_msgs[msg].msg_num != msg_num) {
+    msg++;
+  }
+  if (msg == RTCM3_EPH_MSG_COUNT) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  uint16_t bits = eph_msgs[msg].bits;
+  if ((uint32_t)len * 8u < bits) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  /* compare the message bits, the padding of the last byte excluded */
+  rtcm_constellation_t cons;
+  uint8_t sat_bits;
+  rtcm3_eph_sat_field(msg_num, &cons, &sat_bits);
+  uint8_t sat_id = rtcm_getbitu(buff, 12, sat_bits);
+  uint8_t raw[RTCM3_EPH_MAX_BYTES];
+  uint16_t num_bytes = (bits + 7) / 8;
+  memcpy(raw, buff, num_bytes);
+  if (bits % 8 != 0) {
+    raw[num_bytes - 1] &= (uint8_t)(0xFF << (8 - bits % 8));
+  }
+  uint8_t *last_raw = store->raw[msg][sat_id];
+  if (store->raw_valid[msg][sat_id] &&
+      memcmp(last_raw, raw, num_bytes) == 0) {
+    store->stats.repeats++;
+    return RC_OK;
+  }
+
+  rtcm_msg_eph eph;
+  rtcm3_rc ret = eph_msgs[msg].decode(buff, len, &eph);
+  if (ret != RC_OK) {
+    return ret;
+  }
+  memcpy(last_raw, raw, num_bytes);
+  store->raw_valid[msg][sat_id] = true;
+
+  assert(eph.sat_id < RTCM3_EPH_MAX_SATS);
+  uint16_t glo_day = 0;
+  if (msg == RTCM3_EPH_GLO) {
+    glo_day = rtcm_getbitu(buff, GLO_EPH_DAY_BIT, 11);
+  }
+  rtcm3_eph_entry *entry = &store->sats[msg][eph.sat_id];
+  if (entry->valid && same_issue(entry, &eph, glo_day)) {
+    store->stats.unchanged++;
+    return RC_OK;
+  }
+  entry->valid = true;
+  entry->glo_day = glo_day;
+  entry->eph = eph;
+  entry->generation = ++store->generation;
+  store->stats.updates++;
+  if (store->callback != NULL) {
+    store->callback(&entry->eph, (rtcm3_eph_msg)msg, store->context);
+  }
+  return RC_OK;
+}
+
+/** Look up the latest ephemeris of a satellite
+ *
+ * For Galileo this is the last updated of the F/NAV and I/NAV ephemerides,
+ * see rtcm3_eph_store_get_msg() to choose one.
+ *
+ * \param store Store to search
+ * \param constellation Constellation of the satellite
+ * \param sat_id Satellite ID as in the ephemeris message
+ * \return The ephemeris, or NULL if none has been received
+ */
+const rtcm_msg_eph *rtcm3_eph_store_get(const rtcm3_eph_store *store,
+                                        rtcm_constellation_t constellation,
+                                        uint8_t sat_id) {
+  assert(store);
+  if (sat_id >= RTCM3_EPH_MAX_SATS) {
+    return NULL;
+  }
+  const rtcm3_eph_entry *latest = NULL;
+  for (uint8_t msg = 0; msg < RTCM3_EPH_MSG_COUNT; msg++) {
+    const rtcm3_eph_entry *entry = &store->sats[msg][sat_id];
+    if (entry->valid && entry->eph.constellation == constellation &&
+        (NULL == latest || entry->generation > latest->generation)) {
+      latest = entry;
+    }
+  }
+  return (NULL != latest) ? &latest->eph : NULL;
+}
+
+/** Look up the ephemeris of a satellite from one message type
+ * \param store Store to search
+ * \param source Message type of the ephemeris
+ * \param sat_id Satellite ID as in the ephemeris message
+ * \return The ephemeris, or NULL if none has been received
+ */
+const rtcm_msg_eph *rtcm3_eph_store_get_msg(const rtcm3_eph_store *store,
+                                            rtcm3_eph_msg source,
+                                            uint8_t sat_id) {
+  assert(store);
+  if (source >= RTCM3_EPH_MSG_COUNT || sat_id >= RTCM3_EPH_MAX_SATS) {
+    return NULL;
+  }
+  const rtcm3_eph_entry *entry = &store->sats[source][sat_id];
+  return entry->valid ? &entry->eph : NULL;
+}
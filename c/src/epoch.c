@@ -0,0 +1,463 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/epoch.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "rtcm3/constants.h"
+#include "rtcm3/msm_utils.h"
+#include "rtcm3/obs_convert.h"
+
+#include "decode_internal.h"
+
+#define DAY_MS (24 * 3600 * 1000)
+/* GLONASS time is UTC(SU), three hours ahead of UTC */
+#define GLO_UTC_OFFSET_MS (3 * 3600 * 1000)
+
+/** Convert the epoch time of a message to GPS time of day.
+ *
+ * Days are enough to tell the epochs of a station apart, and unlike the
+ * week they are known for GLONASS too.
+ *
+ * \param cons Constellation of the message
+ * \param tow_ms Epoch time, time of day for GLO and time of week otherwise
+ * \param leap_seconds GPS-UTC leap seconds, for GLO
+ * \return GPS time of day in ms
+ */
+uint32_t rtcm3_gps_tod_ms(rtcm_constellation_t cons,
+                          uint32_t tow_ms,
+                          int8_t leap_seconds) {
+  if (RTCM_CONSTELLATION_GLO == cons) {
+    int64_t tod_ms = (int64_t)tow_ms - GLO_UTC_OFFSET_MS +
+                     (int64_t)leap_seconds * 1000;
+    tod_ms %= DAY_MS;
+    return (uint32_t)(tod_ms < 0 ? tod_ms + DAY_MS : tod_ms);
+  }
+  if (RTCM_CONSTELLATION_BDS == cons) {
+    return (tow_ms + BDS_SECOND_TO_GPS_SECOND * 1000) % DAY_MS;
+  }
+  return tow_ms % DAY_MS;
+}
+
+/** Difference of two times of day, wrapped into (-DAY_MS / 2, DAY_MS / 2]
+ *
+ * \param a Time of day in ms
+ * \param b Time of day in ms
+ * \return a - b in ms
+ */
+int32_t rtcm3_tod_diff_ms(uint32_t a, uint32_t b) {
+  int32_t diff = (int32_t)a - (int32_t)b;
+  if (diff > DAY_MS / 2) {
+    diff -= DAY_MS;
+  } else if (diff <= -DAY_MS / 2) {
+    diff += DAY_MS;
+  }
+  return diff;
+}
+
+/** Initialize an epoch assembler.
+ *
+ * Each slot holds the epoch of one station, so `num_slots` should cover
+ * the stations of the input. When a message of another station arrives
+ * the least recently used slot is taken over.
+ *
+ * \param assembler Assembler to initialize
+ * \param slots Caller owned slots, `num_slots` entries
+ * \param num_slots Number of slots, at least one
+ * \param timeout_ms Time from the first message of an epoch after which it
+ *                   is passed on without its final message, 0 to wait for
+ *                   the next epoch instead
+ * \param callback Called once for each epoch, may be NULL
+ * \param context Passed to `callback`
+ */
+void rtcm3_epoch_init(rtcm3_epoch_assembler *assembler,
+                      rtcm3_epoch_slot slots[],
+                      uint16_t num_slots,
+                      uint32_t timeout_ms,
+                      rtcm3_epoch_callback callback,
+                      void *context) {
+  assert(assembler);
+  assert(slots && num_slots > 0);
+  memset(assembler, 0, sizeof(*assembler));
+  for (uint16_t i = 0; i < num_slots; i++) {
+    slots[i].in_use = false;
+    slots[i].open = false;
+  }
+  assembler->slots = slots;
+  assembler->num_slots = num_slots;
+  assembler->timeout_ms = timeout_ms;
+  assembler->leap_seconds = RTCM3_EPOCH_DEFAULT_LEAP_SECONDS;
+  assembler->callback = callback;
+  assembler->context = context;
+}
+
+/* Pass the open epoch of a slot to the callback */
+static void end_epoch(rtcm3_epoch_assembler *assembler,
+                      rtcm3_epoch_slot *slot,
+                      rtcm3_epoch_end end) {
+  assert(slot->open);
+  slot->open = false;
+  slot->have_last = true;
+  slot->last_tod_ms = slot->epoch.gps_tod_ms;
+  slot->epoch.end = end;
+  slot->epoch.msm.obs = slot->obs;
+  assembler->stats.epochs[end]++;
+  if (NULL != assembler->callback) {
+    assembler->callback(&slot->epoch, assembler->context);
+  }
+}
+
+static bool timed_out(const rtcm3_epoch_assembler *assembler,
+                      const rtcm3_epoch_slot *slot,
+                      uint32_t now_ms) {
+  return slot->open && 0 != assembler->timeout_ms &&
+         (uint32_t)(now_ms - slot->opened_ms) >= assembler->timeout_ms;
+}
+
+/* Slot of a station, taking over a free or the least recently used slot
+ * for a new station */
+static rtcm3_epoch_slot *station_slot(rtcm3_epoch_assembler *assembler,
+                                      uint16_t stn_id,
+                                      uint32_t now_ms) {
+  rtcm3_epoch_slot *victim = NULL;
+  uint32_t victim_idle_ms = 0;
+  for (uint16_t i = 0; i < assembler->num_slots; i++) {
+    rtcm3_epoch_slot *slot = &assembler->slots[i];
+    if (!slot->in_use) {
+      if (NULL == victim || victim->in_use) {
+        victim = slot;
+      }
+      continue;
+    }
+    if (slot->stn_id == stn_id) {
+      return slot;
+    }
+    uint32_t idle_ms = now_ms - slot->used_ms;
+    if (NULL == victim || (victim->in_use && idle_ms >= victim_idle_ms)) {
+      victim = slot;
+      victim_idle_ms = idle_ms;
+    }
+  }
+
+  assert(victim);
+  if (victim->open) {
+    end_epoch(assembler, victim, RTCM3_EPOCH_EVICTED);
+  }
+  victim->in_use = true;
+  victim->have_last = false;
+  victim->stn_id = stn_id;
+  return victim;
+}
+
+/** Find the open epoch a message belongs to, starting a new one if needed.
+ *
+ * \param assembler Assembler
+ * \param stn_id Station of the message
+ * \param cons Constellation of the message
+ * \param tow_ms Epoch time of the message
+ * \param now_ms Caller time
+ * \return Slot of the epoch, NULL if the message is late
+ */
+static rtcm3_epoch_slot *begin_msg(rtcm3_epoch_assembler *assembler,
+                                   uint16_t stn_id,
+                                   rtcm_constellation_t cons,
+                                   uint32_t tow_ms,
+                                   uint32_t now_ms) {
+  rtcm3_epoch_slot *slot = station_slot(assembler, stn_id, now_ms);
+  slot->used_ms = now_ms;
+  if (timed_out(assembler, slot, now_ms)) {
+    end_epoch(assembler, slot, RTCM3_EPOCH_TIMEOUT);
+  }
+
+  uint32_t tod_ms = rtcm3_gps_tod_ms(cons, tow_ms, assembler->leap_seconds);
+  if (slot->open || slot->have_last) {
+    int32_t diff = rtcm3_tod_diff_ms(
+        tod_ms, slot->open ? slot->epoch.gps_tod_ms : slot->last_tod_ms);
+    bool older = diff > -RTCM3_EPOCH_LATE_WINDOW_MS && diff < 0;
+    if (older || (0 == diff && !slot->open)) {
+      assembler->stats.late++;
+      return NULL;
+    }
+    if (slot->open && 0 != diff) {
+      end_epoch(assembler, slot, RTCM3_EPOCH_SUPERSEDED);
+    }
+  }
+
+  rtcm3_epoch *epoch = &slot->epoch;
+  if (!slot->open) {
+    memset(epoch, 0, sizeof(*epoch));
+    epoch->msm.msm_type = MSM_UNKNOWN;
+    epoch->msm.stn_id = stn_id;
+    epoch->msm.obs = slot->obs;
+    epoch->gps_tod_ms = tod_ms;
+    slot->open = true;
+    slot->opened_ms = now_ms;
+  }
+  epoch->msm.tow_ms[cons] = tow_ms;
+  epoch->constellations |= (uint8_t)(1 << cons);
+  if (epoch->num_msgs < UINT8_MAX) {
+    epoch->num_msgs++;
+  }
+  assembler->stats.msgs++;
+  return slot;
+}
+
+static void add_obs(rtcm3_epoch_slot *slot,
+                    rtcm_constellation_t cons,
+                    uint8_t sat,
+                    uint8_t sig,
+                    uint8_t glo_fcn,
+                    const rtcm_msm_signal_data *data) {
+  rtcm3_epoch *epoch = &slot->epoch;
+  if (epoch->msm.num_obs >= RTCM3_EPOCH_MAX_OBS) {
+    epoch->truncated = true;
+    return;
+  }
+  rtcm_msm_obs *obs = &slot->obs[epoch->msm.num_obs++];
+  obs->cons = cons;
+  obs->sat = sat;
+  obs->sig = sig;
+  obs->glo_fcn = glo_fcn;
+  obs->data = *data;
+}
+
+/* Satellite and signal mask indices of the entries of the header masks */
+static void mask_indices(const rtcm_msm_masks *masks,
+                         uint8_t sat_ids[],
+                         uint8_t sig_ids[]) {
+  uint64_t sats = masks->sats;
+  for (uint8_t i = 0; 0 != sats; i++) {
+    sat_ids[i] = pop_first_mask_bit(&sats);
+  }
+  uint64_t sigs = masks->sigs;
+  for (uint8_t i = 0; 0 != sigs; i++) {
+    sig_ids[i] = pop_first_mask_bit(&sigs);
+  }
+}
+
+/** Add a decoded MSM4-7 message to the epoch of its station.
+ *
+ * The epoch is passed on once a message with the multiple message bit
+ * DF393 clear arrives. Messages of an epoch already passed on are
+ * dropped and counted as late.
+ *
+ * \param assembler Assembler
+ * \param msg Decoded message
+ * \param now_ms Caller time in ms, for the timeout
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not an MSM4-7 message
+ *          - RC_INVALID_MESSAGE : Invalid TOW or cell mask
+ */
+rtcm3_rc rtcm3_epoch_add_msm(rtcm3_epoch_assembler *assembler,
+                             const rtcm_msm_message *msg,
+                             uint32_t now_ms) {
+  assert(assembler && msg);
+  const rtcm_msm_header *header = &msg->header;
+  rtcm_constellation_t cons = to_constellation(header->msg_num);
+  msm_enum msm_type = to_msm_type(header->msg_num);
+  if (RTCM_CONSTELLATION_INVALID == cons ||
+      (MSM4 != msm_type && MSM5 != msm_type && MSM6 != msm_type &&
+       MSM7 != msm_type)) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  if (!rtcm3_msm_tow_valid(cons, header->tow_ms)) {
+    return RC_INVALID_MESSAGE;
+  }
+  rtcm_msm_masks masks;
+  msm_pack_masks(header, &masks);
+  uint8_t num_sigs = count_mask_bits(masks.sigs);
+  if (count_mask_bits(masks.sats) * num_sigs > MSM_MAX_CELLS) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  rtcm3_epoch_slot *slot =
+      begin_msg(assembler, header->stn_id, cons, header->tow_ms, now_ms);
+  if (NULL == slot) {
+    return RC_OK;
+  }
+  rtcm_msm_epoch *epoch = &slot->epoch.msm;
+  epoch->msm_type = msm_type;
+  epoch->iods = header->iods;
+  epoch->steering = header->steering;
+  epoch->ext_clock = header->ext_clock;
+  epoch->div_free = header->div_free;
+  epoch->smooth = header->smooth;
+
+  uint8_t sat_ids[MSM_SATELLITE_MASK_SIZE];
+  uint8_t sig_ids[MSM_SIGNAL_MASK_SIZE];
+  mask_indices(&masks, sat_ids, sig_ids);
+  uint64_t cells = masks.cells;
+  for (uint8_t i = 0; 0 != cells; i++) {
+    uint8_t cell = pop_first_mask_bit(&cells);
+    uint8_t sat = cell / num_sigs;
+    add_obs(slot,
+            cons,
+            sat_ids[sat],
+            sig_ids[cell % num_sigs],
+            msg->sats[sat].glo_fcn,
+            &msg->signals[i]);
+  }
+
+  if (0 == header->multiple) {
+    end_epoch(assembler, slot, RTCM3_EPOCH_COMPLETE);
+  }
+  return RC_OK;
+}
+
+/** Add a decoded 1001-1004 or 1009-1012 message to the epoch of its
+ * station.
+ *
+ * The observations are converted to MSM signals with rtcm3_obs_to_msm().
+ * The epoch is passed on once a message with the synchronous GNSS flag
+ * DF005 clear arrives.
+ *
+ * \param assembler Assembler
+ * \param msg Decoded message
+ * \param now_ms Caller time in ms, for the timeout
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not a legacy observation message
+ *          - RC_INVALID_MESSAGE : Invalid TOW or satellite ID, or more than
+ *            MSM_MAX_CELLS cells
+ */
+rtcm3_rc rtcm3_epoch_add_obs(rtcm3_epoch_assembler *assembler,
+                             const rtcm_obs_message *msg,
+                             uint32_t now_ms) {
+  assert(assembler && msg);
+  uint16_t msg_num = msg->header.msg_num;
+  rtcm_constellation_t cons;
+  if (msg_num >= 1001 && msg_num <= 1004) {
+    cons = RTCM_CONSTELLATION_GPS;
+  } else if (msg_num >= 1009 && msg_num <= 1012) {
+    cons = RTCM_CONSTELLATION_GLO;
+  } else {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  if (!rtcm3_msm_tow_valid(cons, msg->header.tow_ms)) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  rtcm_msm_header header;
+  rtcm_msm_sat_data sats[RTCM_MAX_SATS];
+  uint8_t sat_index[MSM_MAX_CELLS];
+  uint8_t sig_index[MSM_MAX_CELLS];
+  double pseudorange_ms[MSM_MAX_CELLS];
+  double carrier_phase_ms[MSM_MAX_CELLS];
+  double range_rate_m_s[MSM_MAX_CELLS];
+  double cnr[MSM_MAX_CELLS];
+  double lock_time_s[MSM_MAX_CELLS];
+  rtcm_msm_signal_columns cells = {.sat_index = sat_index,
+                                   .sig_index = sig_index,
+                                   .pseudorange_ms = pseudorange_ms,
+                                   .carrier_phase_ms = carrier_phase_ms,
+                                   .range_rate_m_s = range_rate_m_s,
+                                   .cnr = cnr,
+                                   .lock_time_s = lock_time_s};
+  rtcm3_rc ret = rtcm3_obs_to_msm(msg, MSM7, &header, sats, &cells);
+  if (RC_OK != ret) {
+    return ret;
+  }
+
+  rtcm3_epoch_slot *slot =
+      begin_msg(assembler, msg->header.stn_id, cons, msg->header.tow_ms,
+                now_ms);
+  if (NULL == slot) {
+    return RC_OK;
+  }
+  slot->epoch.msm.div_free = msg->header.div_free;
+  slot->epoch.msm.smooth = msg->header.smooth;
+
+  rtcm_msm_masks masks;
+  msm_pack_masks(&header, &masks);
+  uint8_t sat_ids[MSM_SATELLITE_MASK_SIZE];
+  uint8_t sig_ids[MSM_SIGNAL_MASK_SIZE];
+  mask_indices(&masks, sat_ids, sig_ids);
+  for (uint8_t i = 0; i < cells.num_cells; i++) {
+    uint64_t cell = (uint64_t)1 << i;
+    rtcm_msm_signal_data data;
+    data.pseudorange_ms = pseudorange_ms[i];
+    data.carrier_phase_ms = carrier_phase_ms[i];
+    data.lock_time_s = lock_time_s[i];
+    data.hca_indicator = 0 != (cells.hca_indicator & cell);
+    data.cnr = cnr[i];
+    data.range_rate_m_s = range_rate_m_s[i];
+    data.flags.data = 0;
+    data.flags.valid_pr = 0 != (cells.valid_pr & cell);
+    data.flags.valid_cp = 0 != (cells.valid_cp & cell);
+    data.flags.valid_cnr = 0 != (cells.valid_cnr & cell);
+    data.flags.valid_lock = 0 != (cells.valid_lock & cell);
+    data.flags.valid_dop = 0 != (cells.valid_dop & cell);
+    add_obs(slot,
+            cons,
+            sat_ids[sat_index[i]],
+            sig_ids[sig_index[i]],
+            sats[sat_index[i]].glo_fcn,
+            &data);
+  }
+
+  if (0 == msg->header.sync) {
+    end_epoch(assembler, slot, RTCM3_EPOCH_COMPLETE);
+  }
+  return RC_OK;
+}
+
+/** Add a decoded message to the epoch of its station.
+ *
+ * \param assembler Assembler
+ * \param msg Message from rtcm3_decode_frame()
+ * \param now_ms Caller time in ms, for the timeout
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not an observation message
+ *          - RC_INVALID_MESSAGE : Invalid observation message
+ */
+rtcm3_rc rtcm3_epoch_add(rtcm3_epoch_assembler *assembler,
+                         const rtcm3_any_msg *msg,
+                         uint32_t now_ms) {
+  assert(msg);
+  if (RTCM3_MSG_MSM == msg->kind) {
+    return rtcm3_epoch_add_msm(assembler, &msg->msg.msm, now_ms);
+  }
+  if (RTCM3_MSG_OBS == msg->kind) {
+    return rtcm3_epoch_add_obs(assembler, &msg->msg.obs, now_ms);
+  }
+  return RC_MESSAGE_TYPE_MISMATCH;
+}
+
+/** Pass on the epochs whose final message did not arrive in time.
+ *
+ * \param assembler Assembler
+ * \param now_ms Caller time in ms
+ */
+void rtcm3_epoch_tick(rtcm3_epoch_assembler *assembler, uint32_t now_ms) {
+  assert(assembler);
+  for (uint16_t i = 0; i < assembler->num_slots; i++) {
+    rtcm3_epoch_slot *slot = &assembler->slots[i];
+    if (slot->in_use && timed_out(assembler, slot, now_ms)) {
+      end_epoch(assembler, slot, RTCM3_EPOCH_TIMEOUT);
+    }
+  }
+}
+
+/** Pass on all the open epochs, e.g. at the end of the input.
+ *
+ * \param assembler Assembler
+ */
+void rtcm3_epoch_flush(rtcm3_epoch_assembler *assembler) {
+  assert(assembler);
+  for (uint16_t i = 0; i < assembler->num_slots; i++) {
+    rtcm3_epoch_slot *slot = &assembler->slots[i];
+    if (slot->in_use && slot->open) {
+      end_epoch(assembler, slot, RTCM3_EPOCH_FLUSHED);
+    }
+  }
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/epoch_encode.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include "rtcm3/encode.h"
+#include "rtcm3/framer.h"
+#include "rtcm3/msm_utils.h"
+
+/* Constellations in the order their messages are sent */
+static const rtcm_constellation_t epoch_constellations[] = {
+    RTCM_CONSTELLATION_GPS,
+    RTCM_CONSTELLATION_GLO,
+    RTCM_CONSTELLATION_GAL,
+    RTCM_CONSTELLATION_SBAS,
+    RTCM_CONSTELLATION_QZS,
+    RTCM_CONSTELLATION_BDS};
+
+#define NUM_EPOCH_CONSTELLATIONS \
+  (sizeof(epoch_constellations) / sizeof(epoch_constellations[0]))
+
+/* Signals of each satellite of one constellation */
+typedef struct {
+  uint64_t sats;
+  uint32_t sat_sigs[MSM_SATELLITE_MASK_SIZE];
+} constellation_obs;
+
+static uint16_t msm_msg_num(rtcm_constellation_t cons, msm_enum msm_type) {
+  switch (cons) {
+    case RTCM_CONSTELLATION_GPS:
+      return 1070 + msm_type;
+    case RTCM_CONSTELLATION_GLO:
+      return 1080 + msm_type;
+    case RTCM_CONSTELLATION_GAL:
+      return 1090 + msm_type;
+    case RTCM_CONSTELLATION_SBAS:
+      return 1100 + msm_type;
+    case RTCM_CONSTELLATION_QZS:
+      return 1110 + msm_type;
+    case RTCM_CONSTELLATION_BDS:
+      return 1120 + msm_type;
+    case RTCM_CONSTELLATION_INVALID:
+    case RTCM_CONSTELLATION_COUNT:
+    default:
+      return 0;
+  }
+}
+
+/** Take the next group of satellites that fits in one message.
+ *
+ * Satellites are added in mask order as long as the cell mask of the group
+ * stays within MSM_MAX_CELLS.
+ *
+ * \param obs Signals of each satellite
+ * \param sats_left Satellites not yet assigned to a message, updated
+ * \param masks Satellite and signal masks of the group
+ */
+static void next_sat_group(const constellation_obs *obs,
+                           uint64_t *sats_left,
+                           rtcm_msm_masks *masks) {
+  masks->sats = 0;
+  masks->sigs = 0;
+  masks->cells = 0;
+  uint8_t num_sats = 0;
+  while (0 != *sats_left && num_sats < RTCM_MAX_SATS) {
+    uint64_t left = *sats_left;
+    uint8_t sat = pop_first_mask_bit(&left);
+    uint32_t sigs = masks->sigs | obs->sat_sigs[sat];
+    if ((num_sats + 1) * count_mask_bits(sigs) > MSM_MAX_CELLS) {
+      break;
+    }
+    masks->sats |= (uint64_t)1 << sat;
+    masks->sigs = sigs;
+    *sats_left = left;
+    num_sats++;
+  }
+}
+
+static uint16_t count_messages(const constellation_obs *obs) {
+  uint16_t count = 0;
+  uint64_t sats_left = obs->sats;
+  while (0 != sats_left) {
+    rtcm_msm_masks masks;
+    next_sat_group(obs, &sats_left, &masks);
+    count++;
+  }
+  return count;
+}
+
+/* Bit position of a satellite or signal in a mask of the given entries */
+static uint8_t mask_rank(uint64_t mask, uint8_t bit) {
+  return count_mask_bits(mask & (((uint64_t)1 << bit) - 1));
+}
+
+/** Fill the satellite and signal data of one message from the epoch
+ * observations. The rough range of a satellite is taken from its first
+ * valid pseudorange or, failing that, carrier phase, and the rough range
+ * rate from its first valid range rate. */
+static void fill_message(const rtcm_msm_epoch *epoch,
+                         rtcm_constellation_t cons,
+                         rtcm_msm_masks *masks,
+                         rtcm_msm_message *msg) {
+  uint8_t num_sigs = count_mask_bits(masks->sigs);
+  bool has_range[RTCM_MAX_SATS];
+  bool has_rate[RTCM_MAX_SATS];
+  memset(has_range, 0, sizeof(has_range));
+  memset(has_rate, 0, sizeof(has_rate));
+  memset(msg->sats, 0, sizeof(msg->sats));
+
+  masks->cells = 0;
+  for (uint16_t i = 0; i < epoch->num_obs; i++) {
+    const rtcm_msm_obs *obs = &epoch->obs[i];
+    if (obs->cons != cons || !((masks->sats >> obs->sat) & 1)) {
+      continue;
+    }
+    uint8_t sat = mask_rank(masks->sats, obs->sat);
+    uint8_t cell = sat * num_sigs + mask_rank(masks->sigs, obs->sig);
+    masks->cells |= (uint64_t)1 << cell;
+
+    rtcm_msm_sat_data *sat_data = &msg->sats[sat];
+    sat_data->glo_fcn = obs->glo_fcn;
+    if (!has_range[sat] &&
+        (obs->data.flags.valid_pr || obs->data.flags.valid_cp)) {
+      double range_ms = obs->data.flags.valid_pr ? obs->data.pseudorange_ms
+                                                 : obs->data.carrier_phase_ms;
+      sat_data->rough_range_ms = round(range_ms * 1024) / 1024;
+      has_range[sat] = true;
+    }
+    if (!has_rate[sat] && obs->data.flags.valid_dop) {
+      sat_data->rough_range_rate_m_s = round(obs->data.range_rate_m_s);
+      has_rate[sat] = true;
+    }
+  }
+
+  /* the signals follow the cell mask order */
+  for (uint16_t i = 0; i < epoch->num_obs; i++) {
+    const rtcm_msm_obs *obs = &epoch->obs[i];
+    if (obs->cons != cons || !((masks->sats >> obs->sat) & 1)) {
+      continue;
+    }
+    uint8_t sat = mask_rank(masks->sats, obs->sat);
+    uint8_t cell = sat * num_sigs + mask_rank(masks->sigs, obs->sig);
+    msg->signals[mask_rank(masks->cells, cell)] = obs->data;
+  }
+}
+
+/** Encode the observations of one epoch into MSM frames.
+ *
+ * The observations of each constellation are split over as many messages as
+ * needed to keep every cell mask within MSM_MAX_CELLS. The frames, CRC
+ * included, are written back to back into `buff` with the Multiple Message
+ * Bit DF393 set on all but the last one.
+ *
+ * \param epoch The observations, at most one per satellite and signal
+ * \param buff Output buffer
+ * \param len Size of the output buffer in bytes
+ * \return Number of bytes written, or 0 if the epoch is invalid or the
+ *         frames do not fit in the buffer
+ */
+size_t rtcm3_encode_msm_epoch(const rtcm_msm_epoch *epoch,
+                              uint8_t buff[],
+                              size_t len) {
+  assert(epoch);
+  assert(buff);
+  if (MSM4 != epoch->msm_type && MSM5 != epoch->msm_type &&
+      MSM6 != epoch->msm_type && MSM7 != epoch->msm_type) {
+    return 0;
+  }
+
+  constellation_obs cons_obs[RTCM_CONSTELLATION_COUNT];
+  memset(cons_obs, 0, sizeof(cons_obs));
+  for (uint16_t i = 0; i < epoch->num_obs; i++) {
+    const rtcm_msm_obs *obs = &epoch->obs[i];
+    if (obs->cons <= RTCM_CONSTELLATION_INVALID ||
+        obs->cons >= RTCM_CONSTELLATION_COUNT ||
+        obs->sat >= MSM_SATELLITE_MASK_SIZE ||
+        obs->sig >= MSM_SIGNAL_MASK_SIZE) {
+      return 0;
+    }
+    constellation_obs *sats = &cons_obs[obs->cons];
+    uint32_t sig = (uint32_t)1 << obs->sig;
+    if (sats->sat_sigs[obs->sat] & sig) {
+      /* duplicate observation */
+      return 0;
+    }
+    sats->sat_sigs[obs->sat] |= sig;
+    sats->sats |= (uint64_t)1 << obs->sat;
+  }
+
+  uint16_t num_messages = 0;
+  for (uint8_t c = 0; c < NUM_EPOCH_CONSTELLATIONS; c++) {
+    num_messages += count_messages(&cons_obs[epoch_constellations[c]]);
+  }
+
+  rtcm_msm_message msg;
+  msg.header.stn_id = epoch->stn_id;
+  msg.header.iods = epoch->iods;
+  msg.header.reserved = 0;
+  msg.header.steering = epoch->steering;
+  msg.header.ext_clock = epoch->ext_clock;
+  msg.header.div_free = epoch->div_free;
+  msg.header.smooth = epoch->smooth;
+
+  size_t pos = 0;
+  uint16_t sent = 0;
+  for (uint8_t c = 0; c < NUM_EPOCH_CONSTELLATIONS; c++) {
+    rtcm_constellation_t cons = epoch_constellations[c];
+    const constellation_obs *obs = &cons_obs[cons];
+    msg.header.msg_num = msm_msg_num(cons, epoch->msm_type);
+    msg.header.tow_ms = epoch->tow_ms[cons];
+
+    uint64_t sats_left = obs->sats;
+    while (0 != sats_left) {
+      rtcm_msm_masks masks;
+      next_sat_group(obs, &sats_left, &masks);
+      fill_message(epoch, cons, &masks, &msg);
+      sent++;
+      msg.header.multiple = (sent < num_messages) ? 1 : 0;
+
+      rtcm_msm_layout layout;
+      if (!rtcm3_msm_layout_init(msg.header.msg_num, &masks, &layout) ||
+          len - pos < (size_t)layout.length + RTCM3_FRAME_OVERHEAD) {
+        return 0;
+      }
+      uint8_t *frame = &buff[pos];
+      memset(frame, 0, layout.length + RTCM3_FRAME_OVERHEAD);
+      uint16_t payload_len = rtcm3_encode_msm_layout(
+          &layout, &msg, frame + RTCM3_FRAME_HEADER_LEN);
+      uint16_t frame_len = rtcm3_frame_finalize(frame, payload_len);
+      if (0 == payload_len || 0 == frame_len) {
+        return 0;
+      }
+      pos += frame_len;
+    }
+  }
+
+  return pos;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/fanout.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "rtcm3/epoch.h"
+
+#include "decode_internal.h"
+
+static bool key_equal(const rtcm3_fanout_key *a, const rtcm3_fanout_key *b) {
+  return a->stn_id == b->stn_id && a->tow_ms == b->tow_ms &&
+         a->msg_num == b->msg_num && a->options == b->options;
+}
+
+/* Constellation whose time system the epoch of a key is in */
+static rtcm_constellation_t key_constellation(uint16_t msg_num) {
+  if (msg_num >= 1009 && msg_num <= 1012) {
+    return RTCM_CONSTELLATION_GLO;
+  }
+  return to_constellation(msg_num);
+}
+
+/* Epoch of a key as GPS time of day */
+static uint32_t key_gps_tod(const rtcm3_fanout_cache *cache,
+                            const rtcm3_fanout_key *key) {
+  return rtcm3_gps_tod_ms(
+      key_constellation(key->msg_num), key->tow_ms, cache->leap_seconds);
+}
+
+/* Age of an epoch at GPS time of day tod_ms. Epochs slightly ahead, by
+ * less than half a day, are of age 0. */
+static uint32_t epoch_age(uint32_t epoch_tod_ms, uint32_t tod_ms) {
+  int32_t diff = rtcm3_tod_diff_ms(tod_ms, epoch_tod_ms);
+  return diff > 0 ? (uint32_t)diff : 0;
+}
+
+/** Initialize a fan-out cache over caller owned entries.
+ *
+ * The cache is not thread safe, callers sharing it between threads must
+ * serialize the calls.
+ *
+ * \param cache Cache to initialize
+ * \param entries Storage for the cached frames
+ * \param num_entries Number of entries
+ * \param max_age_ms Age after which rtcm3_fanout_evict() drops unheld frames
+ *
+ * Epochs of GLO keys are converted to GPS time with `leap_seconds`, which
+ * starts at RTCM3_EPOCH_DEFAULT_LEAP_SECONDS.
+ */
+void rtcm3_fanout_init(rtcm3_fanout_cache *cache,
+                       rtcm3_fanout_entry entries[],
+                       uint16_t num_entries,
+                       uint32_t max_age_ms) {
+  assert(cache);
+  assert(entries || 0 == num_entries);
+  cache->entries = entries;
+  cache->num_entries = num_entries;
+  cache->max_age_ms = max_age_ms;
+  cache->leap_seconds = RTCM3_EPOCH_DEFAULT_LEAP_SECONDS;
+  memset(&cache->stats, 0, sizeof(cache->stats));
+  for (uint16_t i = 0; i < num_entries; i++) {
+    entries[i].refs = 0;
+    entries[i].frame_len = 0;
+  }
+}
+
+/** Get the frame for a key, encoding it on the first request.
+ *
+ * The returned entry is held until it is passed to rtcm3_fanout_release(),
+ * its frame stays valid and unchanged until then. On a miss the frame goes
+ * into a free entry or replaces the unheld entry with the oldest epoch,
+ * once the encoder has succeeded.
+ *
+ * \param cache The cache
+ * \param key Station, epoch, message number and options of the frame
+ * \param encode Encoder for the payload, called on a miss
+ * \param msg Message passed to the encoder
+ * \return The held entry, or NULL if the encoder failed or every entry is
+ *         held
+ */
+const rtcm3_fanout_entry *rtcm3_fanout_get(rtcm3_fanout_cache *cache,
+                                           const rtcm3_fanout_key *key,
+                                           rtcm3_fanout_encoder encode,
+                                           const void *msg) {
+  assert(cache);
+  assert(key);
+  assert(encode);
+  uint32_t tod_ms = key_gps_tod(cache, key);
+  rtcm3_fanout_entry *victim = NULL;
+  uint32_t victim_age = 0;
+  for (uint16_t i = 0; i < cache->num_entries; i++) {
+    rtcm3_fanout_entry *entry = &cache->entries[i];
+    if (0 == entry->frame_len) {
+      if (NULL == victim || 0 != victim->frame_len) {
+        victim = entry;
+      }
+      continue;
+    }
+    if (key_equal(&entry->key, key)) {
+      entry->refs++;
+      cache->stats.hits++;
+      return entry;
+    }
+    if (0 != entry->refs || (NULL != victim && 0 == victim->frame_len)) {
+      continue;
+    }
+    uint32_t age = epoch_age(key_gps_tod(cache, &entry->key), tod_ms);
+    if (NULL == victim || age > victim_age) {
+      victim = entry;
+      victim_age = age;
+    }
+  }
+
+  cache->stats.misses++;
+  if (NULL == victim) {
+    cache->stats.failures++;
+    return NULL;
+  }
+
+  /* Encode first, so that a failure leaves the victim in the cache */
+  uint8_t frame[RTCM3_MAX_FRAME_LEN];
+  memset(frame, 0, sizeof(frame));
+  uint16_t payload_len = encode(msg, frame + RTCM3_FRAME_HEADER_LEN);
+  uint16_t frame_len = 0;
+  if (payload_len > 0) {
+    frame_len = rtcm3_frame_finalize(frame, payload_len);
+  }
+  if (0 == frame_len) {
+    cache->stats.failures++;
+    return NULL;
+  }
+  if (0 != victim->frame_len) {
+    cache->stats.evictions++;
+  }
+  memcpy(victim->frame, frame, frame_len);
+  victim->key = *key;
+  victim->refs = 1;
+  victim->frame_len = frame_len;
+  return victim;
+}
+
+/** Release an entry returned by rtcm3_fanout_get().
+ *
+ * \param cache The cache
+ * \param entry The held entry
+ */
+void rtcm3_fanout_release(rtcm3_fanout_cache *cache,
+                          const rtcm3_fanout_entry *entry) {
+  assert(cache);
+  assert(entry >= cache->entries &&
+         entry < cache->entries + cache->num_entries);
+  rtcm3_fanout_entry *held = &cache->entries[entry - cache->entries];
+  assert(held->refs > 0);
+  held->refs--;
+}
+
+/** Drop the unheld frames whose epoch is older than the maximum age.
+ *
+ * Key epochs are compared as GPS time of day, so the maximum age should
+ * be well under half a day. Epochs ahead of `tow_ms` are never dropped.
+ *
+ * \param cache The cache
+ * \param tow_ms Current GPS time of week
+ * \return Number of frames dropped
+ */
+uint16_t rtcm3_fanout_evict(rtcm3_fanout_cache *cache, uint32_t tow_ms) {
+  assert(cache);
+  uint32_t tod_ms = rtcm3_gps_tod_ms(RTCM_CONSTELLATION_GPS, tow_ms, 0);
+  uint16_t evicted = 0;
+  for (uint16_t i = 0; i < cache->num_entries; i++) {
+    rtcm3_fanout_entry *entry = &cache->entries[i];
+    if (0 != entry->frame_len && 0 == entry->refs &&
+        epoch_age(key_gps_tod(cache, &entry->key), tod_ms) >
+            cache->max_age_ms) {
+      entry->frame_len = 0;
+      evicted++;
+    }
+  }
+  cache->stats.evictions += evicted;
+  return evicted;
+}
@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/framer.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "rtcm3/crc24q.h"
+
+#define LIBRTCM_LOG_INTERNAL
+#include "rtcm3/logging.h"
+
+/** Check a frame header and extract the payload length.
+ *
+ * \param header The three header bytes, starting with the preamble
+ * \param payload_len Set to the 10-bit payload length on success
+ * \return true if the preamble matches and the reserved bits are zero
+ */
+static bool parse_header(const uint8_t header[RTCM3_FRAME_HEADER_LEN],
+                         uint16_t *payload_len) {
+  if (RTCM3_PREAMBLE != header[0] || 0 != (header[1] & 0xFC)) {
+    return false;
+  }
+  *payload_len = (uint16_t)(((header[1] & 0x3) << 8) | header[2]);
+  return true;
+}
+
+/** Check the CRC of a complete frame */
+static bool check_crc(const uint8_t *frame, uint16_t frame_len) {
+  uint16_t crc_pos = frame_len - RTCM3_FRAME_CRC_LEN;
+  uint32_t crc = rtcm3_crc24q(frame, crc_pos, RTCM3_CRC24Q_INIT);
+  uint32_t expected = ((uint32_t)frame[crc_pos] << 16) |
+                      ((uint32_t)frame[crc_pos + 1] << 8) |
+                      frame[crc_pos + 2];
+  return crc == expected;
+}
+
+static void fill_frame(const uint8_t *data,
+                       uint16_t payload_len,
+                       rtcm3_frame *frame) {
+  frame->frame = data;
+  frame->frame_len = payload_len + RTCM3_FRAME_OVERHEAD;
+  frame->payload = data + RTCM3_FRAME_HEADER_LEN;
+  frame->payload_len = payload_len;
+  frame->msg_num =
+      payload_len >= 2
+          ? (uint16_t)((frame->payload[0] << 4) | (frame->payload[1] >> 4))
+          : 0;
+}
+
+/** Drop the leading byte of the partial buffer and move up to the next
+ * candidate preamble, if there is one.
+ */
+static void resync_partial(rtcm3_framer *framer) {
+  const uint8_t *next = NULL;
+  if (framer->partial_len > 1) {
+    next = memchr(
+        framer->partial + 1, RTCM3_PREAMBLE, framer->partial_len - 1u);
+  }
+  uint16_t skip = (NULL == next) ? framer->partial_len
+                                 : (uint16_t)(next - framer->partial);
+  framer->stats.dropped_bytes += skip;
+  framer->partial_len -= skip;
+  memmove(framer->partial, framer->partial + skip, framer->partial_len);
+}
+
+/** Top up the partial buffer to `want` bytes from the current chunk.
+ *
+ * \return true if the partial buffer now holds `want` bytes
+ */
+static bool fill_partial(rtcm3_framer *framer, uint16_t want) {
+  if (framer->partial_len < want) {
+    size_t avail = framer->chunk_len - framer->chunk_pos;
+    size_t take = want - framer->partial_len;
+    if (take > avail) {
+      take = avail;
+    }
+    memcpy(framer->partial + framer->partial_len,
+           framer->chunk + framer->chunk_pos,
+           take);
+    framer->partial_len += (uint16_t)take;
+    framer->chunk_pos += take;
+  }
+  return framer->partial_len >= want;
+}
+
+static void crc_error(rtcm3_framer *framer) {
+  static const char msg[] = "RTCM3 frame CRC error";
+  framer->stats.crc_errors++;
+  if (NULL != framer->logger) {
+    RTCM3_LOG(framer->logger,
+              LOG_WARNING,
+              (const uint8_t *)msg,
+              (uint16_t)(sizeof(msg) - 1));
+  }
+}
+
+/** Continue a frame that started in a previous chunk.
+ *
+ * \return true if a frame was emitted from the partial buffer
+ */
+static bool next_partial(rtcm3_framer *framer, rtcm3_frame *frame) {
+  if (framer->partial_emitted > 0) {
+    /* after a resync the buffer may hold input beyond the frame returned last
+     * time, which still has to be scanned */
+    framer->partial_len -= framer->partial_emitted;
+    memmove(framer->partial,
+            framer->partial + framer->partial_emitted,
+            framer->partial_len);
+    framer->partial_emitted = 0;
+  }
+  while (framer->partial_len > 0) {
+    if (!fill_partial(framer, RTCM3_FRAME_HEADER_LEN)) {
+      return false;
+    }
+    uint16_t payload_len = 0;
+    if (!parse_header(framer->partial, &payload_len)) {
+      resync_partial(framer);
+      continue;
+    }
+    uint16_t frame_len = payload_len + RTCM3_FRAME_OVERHEAD;
+    if (!fill_partial(framer, frame_len)) {
+      return false;
+    }
+    if (!check_crc(framer->partial, frame_len)) {
+      crc_error(framer);
+      resync_partial(framer);
+      continue;
+    }
+    /* the view aliases the partial buffer, which is not touched again until
+     * the next call */
+    fill_frame(framer->partial, payload_len, frame);
+    framer->partial_emitted = frame_len;
+    framer->stats.frames++;
+    return true;
+  }
+  return false;
+}
+
+/** Initialize a framer. It has no logger, set `framer->logger` afterwards
+ * to get its CRC errors reported.
+ *
+ * \param framer Framer to initialize
+ */
+void rtcm3_framer_init(rtcm3_framer *framer) {
+  assert(framer);
+  memset(framer, 0, sizeof(*framer));
+}
+
+/** Hand a new chunk of input to the framer.
+ *
+ * Frames are extracted from the chunk by calling rtcm3_framer_next() until
+ * it returns false. The chunk must stay valid until then; a frame that is
+ * cut off at the end of the chunk is copied into the framer and completed
+ * from the following chunks.
+ *
+ * \param framer Framer
+ * \param data Input data, any alignment or chunking
+ * \param len Length of the data in bytes
+ */
+void rtcm3_framer_feed(rtcm3_framer *framer, const uint8_t *data, size_t len) {
+  assert(framer);
+  assert(data || 0 == len);
+  framer->chunk = data;
+  framer->chunk_len = len;
+  framer->chunk_pos = 0;
+}
+
+/** Extract the next complete frame from the input.
+ *
+ * Frames entirely inside the current chunk are returned as zero-copy views
+ * into it. Bytes that cannot be part of a frame (no preamble, non-zero
+ * reserved bits or bad CRC) are skipped and counted as dropped, and the
+ * search restarts at the byte following the rejected preamble.
+ *
+ * \param framer Framer
+ * \param frame Set to the frame on success
+ * \return true if a frame was found, false if more input is needed
+ */
+bool rtcm3_framer_next(rtcm3_framer *framer, rtcm3_frame *frame) {
+  assert(framer);
+  assert(frame);
+
+  if (next_partial(framer, frame)) {
+    return true;
+  }
+  if (framer->partial_len > 0) {
+    /* the chunk has been used up trying to complete a partial frame */
+    return false;
+  }
+
+  while (framer->chunk_pos < framer->chunk_len) {
+    const uint8_t *start = framer->chunk + framer->chunk_pos;
+    size_t avail = framer->chunk_len - framer->chunk_pos;
+    const uint8_t *preamble = memchr(start, RTCM3_PREAMBLE, avail);
+    if (NULL == preamble) {
+      framer->stats.dropped_bytes += avail;
+      framer->chunk_pos = framer->chunk_len;
+      return false;
+    }
+    size_t skip = (size_t)(preamble - start);
+    framer->stats.dropped_bytes += skip;
+    framer->chunk_pos += skip;
+    avail -= skip;
+
+    uint16_t payload_len = 0;
+    if (avail < RTCM3_FRAME_HEADER_LEN ||
+        (parse_header(preamble, &payload_len) &&
+         avail < (size_t)payload_len + RTCM3_FRAME_OVERHEAD)) {
+      /* keep the tail for the next chunk */
+      memcpy(framer->partial, preamble, avail);
+      framer->partial_len = (uint16_t)avail;
+      framer->chunk_pos = framer->chunk_len;
+      return false;
+    }
+    if (!parse_header(preamble, &payload_len)) {
+      framer->stats.dropped_bytes++;
+      framer->chunk_pos++;
+      continue;
+    }
+    uint16_t frame_len = payload_len + RTCM3_FRAME_OVERHEAD;
+    if (!check_crc(preamble, frame_len)) {
+      crc_error(framer);
+      framer->stats.dropped_bytes++;
+      framer->chunk_pos++;
+      continue;
+    }
+    fill_frame(preamble, payload_len, frame);
+    framer->chunk_pos += frame_len;
+    framer->stats.frames++;
+    return true;
+  }
+  return false;
+}
+
+/** Complete a frame around an encoded payload.
+ *
+ * Writes the preamble, reserved bits and length in front of the payload and
+ * appends the CRC-24Q, e.g.
+ *
+ *   uint16_t n = rtcm3_encode_msm5(&msg, frame + RTCM3_FRAME_HEADER_LEN);
+ *   uint16_t frame_len = rtcm3_frame_finalize(frame, n);
+ *
+ * \param frame Buffer of at least payload_len + RTCM3_FRAME_OVERHEAD bytes,
+ *              holding the payload at frame + RTCM3_FRAME_HEADER_LEN
+ * \param payload_len Length of the payload in bytes
+ * \return Length of the frame in bytes, or 0 if the payload is too long
+ */
+uint16_t rtcm3_frame_finalize(uint8_t frame[], uint16_t payload_len) {
+  assert(frame);
+  if (payload_len > RTCM3_MAX_MSG_LEN) {
+    return 0;
+  }
+  frame[0] = RTCM3_PREAMBLE;
+  frame[1] = (uint8_t)(payload_len >> 8);
+  frame[2] = (uint8_t)payload_len;
+  uint16_t crc_pos = payload_len + RTCM3_FRAME_HEADER_LEN;
+  uint32_t crc = rtcm3_crc24q(frame, crc_pos, RTCM3_CRC24Q_INIT);
+  frame[crc_pos] = (uint8_t)(crc >> 16);
+  frame[crc_pos + 1] = (uint8_t)(crc >> 8);
+  frame[crc_pos + 2] = (uint8_t)crc;
+  return crc_pos + RTCM3_FRAME_CRC_LEN;
+}
@@ -10,7 +10,9 @@
  * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
  */
 
+#include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <rtcm3/logging.h>
 
@@ -27,3 +29,125 @@ void rtcm_log(uint8_t level, uint8_t *msg, uint16_t len) {
     log_callback_(level, msg, len, log_context_);
   }
 }
+
+/* The ring indices are shared between two threads: the producer publishes
+ * head after writing a record, the consumer publishes tail after reading
+ * one. Targets without the GCC atomics are expected to be single core,
+ * where volatile accesses are enough. */
+#if defined(__GNUC__) || defined(__clang__)
+#define RING_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define RING_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#else
+#define RING_LOAD(x) (*(volatile uint32_t *)&(x))
+#define RING_STORE(x, v) (*(volatile uint32_t *)&(x) = (v))
+#endif
+
+/** Initialize a logger with every level enabled and no ring.
+ *
+ * \param logger Logger to initialize
+ * \param callback Called for each record, may be NULL
+ * \param context Passed to the callback
+ */
+void rtcm3_logger_init(rtcm3_logger *logger,
+                       rtcm_log_callback callback,
+                       void *context) {
+  assert(logger);
+  logger->callback = callback;
+  logger->context = context;
+  logger->ring = NULL;
+  logger->source = 0;
+  logger->max_level = UINT8_MAX;
+}
+
+static void ring_push(rtcm3_log_ring *ring,
+                      uint16_t source,
+                      uint8_t level,
+                      const uint8_t *msg,
+                      uint16_t len) {
+  uint32_t head = ring->head;
+  if (head - RING_LOAD(ring->tail) >= ring->size) {
+    ring->dropped++;
+    return;
+  }
+  rtcm3_log_record *record = &ring->records[head & (ring->size - 1)];
+  record->source = source;
+  record->level = level;
+  record->len = len < RTCM3_LOG_RECORD_LEN ? (uint8_t)len
+                                           : RTCM3_LOG_RECORD_LEN;
+  if (record->len > 0) {
+    memcpy(record->msg, msg, record->len);
+  }
+  RING_STORE(ring->head, head + 1);
+}
+
+/** Log a message of a decoding context.
+ *
+ * \param logger Logger of the context, NULL for the global callback set by
+ *               rtcm_init_logging()
+ * \param level Syslog style level
+ * \param msg The message, not necessarily NUL terminated
+ * \param len Length of the message
+ */
+void rtcm3_log(const rtcm3_logger *logger,
+               uint8_t level,
+               const uint8_t *msg,
+               uint16_t len) {
+  if (NULL == logger) {
+    rtcm_log(level, (uint8_t *)msg, len);
+    return;
+  }
+  if (level > logger->max_level) {
+    return;
+  }
+  if (NULL != logger->ring) {
+    ring_push(logger->ring, logger->source, level, msg, len);
+  } else if (NULL != logger->callback) {
+    logger->callback(level, (uint8_t *)msg, len, logger->context);
+  }
+}
+
+/** Initialize a log ring.
+ *
+ * \param ring Ring to initialize
+ * \param records Storage for the records
+ * \param size Number of records, a power of two
+ */
+void rtcm3_log_ring_init(rtcm3_log_ring *ring,
+                         rtcm3_log_record records[],
+                         uint32_t size) {
+  assert(ring);
+  assert(records);
+  assert(size > 0 && (size & (size - 1)) == 0);
+  ring->records = records;
+  ring->size = size;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->dropped = 0;
+}
+
+/** Hand the queued records to a callback, oldest first. Must only be called
+ * from the consumer thread.
+ *
+ * \param ring The ring
+ * \param callback Called for each record
+ * \param context Passed to the callback
+ * \param max_records Maximum number of records to drain
+ * \return Number of records drained
+ */
+uint32_t rtcm3_log_ring_drain(rtcm3_log_ring *ring,
+                              rtcm3_log_record_callback callback,
+                              void *context,
+                              uint32_t max_records) {
+  assert(ring);
+  assert(callback);
+  uint32_t tail = ring->tail;
+  uint32_t count = RING_LOAD(ring->head) - tail;
+  if (count > max_records) {
+    count = max_records;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    callback(&ring->records[(tail + i) & (ring->size - 1)], context);
+  }
+  RING_STORE(ring->tail, tail + count);
+  return count;
+}
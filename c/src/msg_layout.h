@@ -0,0 +1,461 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* Field tables of the fixed-layout message blocks, not installed */
+
+#ifndef SWIFTNAV_RTCM3_MSG_LAYOUT_H
+#define SWIFTNAV_RTCM3_MSG_LAYOUT_H
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "rtcm3/messages.h"
+
+#include "bits_internal.h"
+
+/* A layout table is a macro calling X(Kind, Member, Bits, Scale) for each
+ * field of a block, in transmission order. The kinds are
+ *
+ *   U  unsigned integer member
+ *   S  signed integer member
+ *   SD signed field, double member equal to the field divided by Scale
+ *   UD unsigned field, as SD, clamped to the field range when encoding
+ *   SM signed integer member, sign-magnitude field
+ *   OR unsigned field ORed into the member when decoding, as U when encoding
+ *   R  reserved field, skipped when decoding and written as 0
+ *   C  constant field, skipped when decoding and written as Scale
+ *
+ * DEFINE_MSG_LAYOUT() turns a table into decode and encode functions, and
+ * LAYOUT_BITS() gives its length. All the widths are constants, so once
+ * the functions are inlined at a constant start bit every field read becomes
+ * a word load and shift, and every field write a store of the bytes it
+ * covers. */
+
+/* The GPS and GLO observation headers differ only in the epoch time */
+#define OBS_HEADER_FIELDS(X, TowBits)                                       \
+  X(U, msg_num, 12, 1)        /* DF002 */                                   \
+  X(U, stn_id, 12, 1)         /* DF003 */                                   \
+  X(U, tow_ms, TowBits, 1)    /* DF004 30 bits, DF034 27 */                 \
+  X(U, sync, 1, 1)            /* DF005 */                                   \
+  X(U, n_sat, 5, 1)           /* DF006 */                                   \
+  X(U, div_free, 1, 1)        /* DF007 */                                   \
+  X(U, smooth, 3, 1)          /* DF008 */
+
+#define GPS_OBS_HEADER_FIELDS(X) OBS_HEADER_FIELDS(X, 30)
+#define GLO_OBS_HEADER_FIELDS(X) OBS_HEADER_FIELDS(X, 27)
+
+/* L1 part of a satellite of 1001-1004 after the satellite ID */
+#define GPS_L1_OBS_FIELDS(X)                                                \
+  X(U, code, 1, 1)            /* DF010 */                                   \
+  X(U, pr, 24, 1)             /* DF011 */                                   \
+  X(S, phr_pr_diff, 20, 1)    /* DF012 */                                   \
+  X(U, lock_ind, 7, 1)        /* DF013 */
+
+/* L1 part of a satellite of 1009-1012 after the satellite ID */
+#define GLO_L1_OBS_FIELDS(X)                                                \
+  X(U, code, 1, 1)            /* DF039 */                                   \
+  X(U, fcn, 5, 1)             /* DF040 */                                   \
+  X(U, pr, 25, 1)             /* DF041 */                                   \
+  X(S, phr_pr_diff, 20, 1)    /* DF042 */                                   \
+  X(U, lock_ind, 7, 1)        /* DF043 */
+
+/* L2 part of a satellite, the same for GPS and GLO */
+#define L2_OBS_FIELDS(X)                                                    \
+  X(U, code, 2, 1)            /* DF016, DF046 */                            \
+  X(S, pr, 14, 1)             /* DF017, DF047: difference to L1 */          \
+  X(S, phr_pr_diff, 20, 1)    /* DF018, DF048 */                            \
+  X(U, lock_ind, 7, 1)        /* DF019, DF049 */
+
+/* Fields of the L1 or L2 part of a satellite of 1001-1004 and 1009-1012,
+ * as transmitted */
+typedef struct {
+  uint8_t code;
+  uint8_t fcn; /* GLO L1 only */
+  int32_t pr;  /* Unsigned for L1 */
+  int32_t phr_pr_diff;
+  uint8_t lock_ind;
+} obs_freq_fields;
+
+/* 1005 after the message number, also the start of 1006 */
+#define MSG_1005_FIELDS(X)                                                  \
+  X(U, stn_id, 12, 1)         /* DF003 */                                   \
+  X(U, ITRF, 6, 1)            /* DF021 */                                   \
+  X(U, GPS_ind, 1, 1)         /* DF022 */                                   \
+  X(U, GLO_ind, 1, 1)         /* DF023 */                                   \
+  X(U, GAL_ind, 1, 1)         /* DF024 */                                   \
+  X(U, ref_stn_ind, 1, 1)     /* DF141 */                                   \
+  X(SD, arp_x, 38, 10000.0)   /* DF025 */                                   \
+  X(U, osc_ind, 1, 1)         /* DF142 */                                   \
+  X(R, reserved, 1, 1)        /* DF001 */                                   \
+  X(SD, arp_y, 38, 10000.0)   /* DF026 */                                   \
+  X(U, quart_cycle_ind, 2, 1) /* DF364 */                                   \
+  X(SD, arp_z, 38, 10000.0)   /* DF027 */
+
+/* 1006 after the 1005 fields */
+#define MSG_1006_FIELDS(X) X(UD, ant_height, 16, 10000.0) /* DF028 */
+
+/* 1013 after the message number, followed by n_msgs entries */
+#define MSG_1013_FIELDS(X)                                                  \
+  X(U, stn_id, 12, 1)         /* DF003 */                                   \
+  X(U, mjd_num, 16, 1)        /* DF051 */                                   \
+  X(U, utc_sec_of_day, 17, 1) /* DF052 */                                   \
+  X(U, n_msgs, 5, 1)          /* DF053 */                                   \
+  X(U, leap_seconds, 8, 1)    /* DF054 */
+
+#define MSG_1013_ENTRY_FIELDS(X)                                            \
+  X(U, msg_num, 12, 1)        /* DF055 */                                   \
+  X(U, sync, 1, 1)            /* DF056 */                                   \
+  X(UD, interval_s, 16, 10.0) /* DF057 */
+
+/* 1019 after the message number */
+#define GPS_EPH_FIELDS(X)                                                   \
+  X(U, sat_id, 6, 1)                 /* DF009 */                            \
+  X(U, wn, 10, 1)                    /* DF076 */                            \
+  X(U, ura, 4, 1)                    /* DF077 */                            \
+  X(U, kepler.codeL2, 2, 1)          /* DF078 */                            \
+  X(S, kepler.inc_dot, 14, 1)        /* DF079 */                            \
+  X(U, kepler.iode, 8, 1)            /* DF071 */                            \
+  X(U, kepler.toc, 16, 1)            /* DF081 */                            \
+  X(S, kepler.af2, 8, 1)             /* DF082 */                            \
+  X(S, kepler.af1, 16, 1)            /* DF083 */                            \
+  X(S, kepler.af0, 22, 1)            /* DF084 */                            \
+  X(U, kepler.iodc, 10, 1)           /* DF085 */                            \
+  X(S, kepler.crs, 16, 1)            /* DF086 */                            \
+  X(S, kepler.dn, 16, 1)             /* DF087 */                            \
+  X(S, kepler.m0, 32, 1)             /* DF088 */                            \
+  X(S, kepler.cuc, 16, 1)            /* DF089 */                            \
+  X(U, kepler.ecc, 32, 1)            /* DF090 */                            \
+  X(S, kepler.cus, 16, 1)            /* DF091 */                            \
+  X(U, kepler.sqrta, 32, 1)          /* DF092 */                            \
+  X(U, toe, 16, 1)                   /* DF093 */                            \
+  X(S, kepler.cic, 16, 1)            /* DF094 */                            \
+  X(S, kepler.omega0, 32, 1)         /* DF095 */                            \
+  X(S, kepler.cis, 16, 1)            /* DF096 */                            \
+  X(S, kepler.inc, 32, 1)            /* DF097 */                            \
+  X(S, kepler.crc, 16, 1)            /* DF098 */                            \
+  X(S, kepler.w, 32, 1)              /* DF099 */                            \
+  X(S, kepler.omegadot, 24, 1)       /* DF100 */                            \
+  X(S, kepler.tgd_gps_s, 8, 1)       /* DF101 */                            \
+  X(U, health_bits, 6, 1)            /* DF102 */                            \
+  X(U, kepler.L2_data_bit, 1, 1)     /* DF103 */                            \
+  X(U, fit_interval, 1, 1)           /* DF137 */
+
+/* 1020 after the message number, up to DF131. The two health flags are
+ * ORed into health_bits, and the almanac health is always sent as 1 */
+#define GLO_EPH_FIELDS(X)                                                   \
+  X(U, sat_id, 6, 1)                 /* DF038 */                            \
+  X(U, glo.fcn, 5, 1)                /* DF040 */                            \
+  X(C, alm_health, 1, 1)             /* DF104 */                            \
+  X(R, alm_health_avail, 1, 1)       /* DF105 */                            \
+  X(U, fit_interval, 2, 1)           /* DF106: P1 */                        \
+  X(R, t_k, 12, 1)                   /* DF107 */                            \
+  X(OR, health_bits, 1, 1)           /* DF108: MSB of Bn */                 \
+  X(R, p2, 1, 1)                     /* DF109 */                            \
+  X(U, glo.t_b, 7, 1)                /* DF110 */                            \
+  X(SM, glo.vel[0], 24, 1)           /* DF111 */                            \
+  X(SM, glo.pos[0], 27, 1)           /* DF112 */                            \
+  X(SM, glo.acc[0], 5, 1)            /* DF113 */                            \
+  X(SM, glo.vel[1], 24, 1)           /* DF114 */                            \
+  X(SM, glo.pos[1], 27, 1)           /* DF115 */                            \
+  X(SM, glo.acc[1], 5, 1)            /* DF116 */                            \
+  X(SM, glo.vel[2], 24, 1)           /* DF117 */                            \
+  X(SM, glo.pos[2], 27, 1)           /* DF118 */                            \
+  X(SM, glo.acc[2], 5, 1)            /* DF119 */                            \
+  X(R, p3, 1, 1)                     /* DF120 */                            \
+  X(SM, glo.gamma, 11, 1)            /* DF121 */                            \
+  X(R, p, 2, 1)                      /* DF122 */                            \
+  X(OR, health_bits, 1, 1)           /* DF123: ln of string 3 */            \
+  X(SM, glo.tau, 22, 1)              /* DF124 */                            \
+  X(SM, glo.d_tau, 5, 1)             /* DF125 */                            \
+  X(R, e_n, 5, 1)                    /* DF126 */                            \
+  X(R, p4, 1, 1)                     /* DF127 */                            \
+  X(U, ura, 4, 1)                    /* DF128: F_T */                       \
+  X(R, n_t, 11, 1)                   /* DF129 */                            \
+  X(R, m, 2, 1)                      /* DF130 */
+
+/* 1020 after DF131, which tells whether these fields are valid */
+#define GLO_EPH_ADDITIONAL_FIELDS(X)                                        \
+  X(R, n_a, 11, 1)                   /* DF132 */                            \
+  X(R, tau_c, 32, 1)                 /* DF133 */                            \
+  X(R, n_4, 5, 1)                    /* DF134 */                            \
+  X(R, tau_gps, 22, 1)               /* DF135 */                            \
+  X(OR, health_bits, 1, 1)           /* DF136: ln of string 5 */            \
+  X(R, reserved, 7, 1)               /* DF001 */
+
+/* 1042 after the message number */
+#define BDS_EPH_FIELDS(X)                                                   \
+  X(U, sat_id, 6, 1)                 /* DF488 */                            \
+  X(U, wn, 13, 1)                    /* DF489 */                            \
+  X(U, ura, 4, 1)                    /* DF490 */                            \
+  X(S, kepler.inc_dot, 14, 1)        /* DF491 */                            \
+  X(U, kepler.iode, 5, 1)            /* DF492 */                            \
+  X(U, kepler.toc, 17, 1)            /* DF493 */                            \
+  X(S, kepler.af2, 11, 1)            /* DF494 */                            \
+  X(S, kepler.af1, 22, 1)            /* DF495 */                            \
+  X(S, kepler.af0, 24, 1)            /* DF496 */                            \
+  X(U, kepler.iodc, 5, 1)            /* DF497 */                            \
+  X(S, kepler.crs, 18, 1)            /* DF498 */                            \
+  X(S, kepler.dn, 16, 1)             /* DF499 */                            \
+  X(S, kepler.m0, 32, 1)             /* DF500 */                            \
+  X(S, kepler.cuc, 18, 1)            /* DF501 */                            \
+  X(U, kepler.ecc, 32, 1)            /* DF502 */                            \
+  X(S, kepler.cus, 18, 1)            /* DF503 */                            \
+  X(U, kepler.sqrta, 32, 1)          /* DF504 */                            \
+  X(U, toe, 17, 1)                   /* DF505 */                            \
+  X(S, kepler.cic, 18, 1)            /* DF506 */                            \
+  X(S, kepler.omega0, 32, 1)         /* DF507 */                            \
+  X(S, kepler.cis, 18, 1)            /* DF508 */                            \
+  X(S, kepler.inc, 32, 1)            /* DF509 */                            \
+  X(S, kepler.crc, 18, 1)            /* DF510 */                            \
+  X(S, kepler.w, 32, 1)              /* DF511 */                            \
+  X(S, kepler.omegadot, 24, 1)       /* DF512 */                            \
+  X(S, kepler.tgd_bds_s[0], 10, 1)   /* DF513 */                            \
+  X(S, kepler.tgd_bds_s[1], 10, 1)   /* DF514 */                            \
+  X(U, health_bits, 1, 1)            /* DF515 */
+
+/* 1044 after the message number */
+#define QZSS_EPH_FIELDS(X)                                                  \
+  X(U, sat_id, 4, 1)                 /* DF429 */                            \
+  X(U, kepler.toc, 16, 1)            /* DF430 */                            \
+  X(S, kepler.af2, 8, 1)             /* DF431 */                            \
+  X(S, kepler.af1, 16, 1)            /* DF432 */                            \
+  X(S, kepler.af0, 22, 1)            /* DF433 */                            \
+  X(U, kepler.iode, 8, 1)            /* DF434 */                            \
+  X(S, kepler.crs, 16, 1)            /* DF435 */                            \
+  X(S, kepler.dn, 16, 1)             /* DF436 */                            \
+  X(S, kepler.m0, 32, 1)             /* DF437 */                            \
+  X(S, kepler.cuc, 16, 1)            /* DF438 */                            \
+  X(U, kepler.ecc, 32, 1)            /* DF439 */                            \
+  X(S, kepler.cus, 16, 1)            /* DF440 */                            \
+  X(U, kepler.sqrta, 32, 1)          /* DF441 */                            \
+  X(U, toe, 16, 1)                   /* DF442 */                            \
+  X(S, kepler.cic, 16, 1)            /* DF443 */                            \
+  X(S, kepler.omega0, 32, 1)         /* DF444 */                            \
+  X(S, kepler.cis, 16, 1)            /* DF445 */                            \
+  X(S, kepler.inc, 32, 1)            /* DF446 */                            \
+  X(S, kepler.crc, 16, 1)            /* DF447 */                            \
+  X(S, kepler.w, 32, 1)              /* DF448 */                            \
+  X(S, kepler.omegadot, 24, 1)       /* DF449 */                            \
+  X(S, kepler.inc_dot, 14, 1)        /* DF450 */                            \
+  X(U, kepler.codeL2, 2, 1)          /* DF451 */                            \
+  X(U, wn, 10, 1)                    /* DF452 */                            \
+  X(U, ura, 4, 1)                    /* DF453 */                            \
+  X(U, health_bits, 6, 1)            /* DF454 */                            \
+  X(S, kepler.tgd_qzss_s, 8, 1)      /* DF455 */                            \
+  X(U, kepler.iodc, 10, 1)           /* DF456 */                            \
+  X(U, fit_interval, 1, 1)           /* DF457 */
+
+/* 1045 and 1046 after the message number, up to the E5a/E1 group delay */
+#define GAL_EPH_FIELDS(X)                                                   \
+  X(U, sat_id, 6, 1)                 /* DF252 */                            \
+  X(U, wn, 12, 1)                    /* DF289 */                            \
+  X(U, kepler.iode, 10, 1)           /* DF290 */                            \
+  X(U, ura, 8, 1)                    /* DF291 */                            \
+  X(S, kepler.inc_dot, 14, 1)        /* DF292 */                            \
+  X(U, kepler.toc, 14, 1)            /* DF293 */                            \
+  X(S, kepler.af2, 6, 1)             /* DF294 */                            \
+  X(S, kepler.af1, 21, 1)            /* DF295 */                            \
+  X(S, kepler.af0, 31, 1)            /* DF296 */                            \
+  X(S, kepler.crs, 16, 1)            /* DF297 */                            \
+  X(S, kepler.dn, 16, 1)             /* DF298 */                            \
+  X(S, kepler.m0, 32, 1)             /* DF299 */                            \
+  X(S, kepler.cuc, 16, 1)            /* DF300 */                            \
+  X(U, kepler.ecc, 32, 1)            /* DF301 */                            \
+  X(S, kepler.cus, 16, 1)            /* DF302 */                            \
+  X(U, kepler.sqrta, 32, 1)          /* DF303 */                            \
+  X(U, toe, 14, 1)                   /* DF304 */                            \
+  X(S, kepler.cic, 16, 1)            /* DF305 */                            \
+  X(S, kepler.omega0, 32, 1)         /* DF306 */                            \
+  X(S, kepler.cis, 16, 1)            /* DF307 */                            \
+  X(S, kepler.inc, 32, 1)            /* DF308 */                            \
+  X(S, kepler.crc, 16, 1)            /* DF309 */                            \
+  X(S, kepler.w, 32, 1)              /* DF310 */                            \
+  X(S, kepler.omegadot, 24, 1)       /* DF311 */                            \
+  X(S, kepler.tgd_gal_s[0], 10, 1)   /* DF312 */
+
+/* 1045 F/NAV */
+#define GAL_EPH_FNAV_FIELDS(X)                                              \
+  GAL_EPH_FIELDS(X)                                                         \
+  X(U, health_bits, 3, 1)            /* DF314, DF315 */                     \
+  X(R, reserved, 7, 1)               /* DF001 */
+
+/* 1046 I/NAV */
+#define GAL_EPH_INAV_FIELDS(X)                                              \
+  GAL_EPH_FIELDS(X)                                                         \
+  X(S, kepler.tgd_gal_s[1], 10, 1)   /* DF313 */                            \
+  X(U, health_bits, 6, 1)            /* DF316, DF317, DF287, DF288 */       \
+  X(R, reserved, 2, 1)               /* DF001 */
+
+/* Largest field width handled by msg_layout_get() and msg_layout_set(),
+ * such that a field at any bit offset spans at most 8 bytes */
+#define MSG_LAYOUT_MAX_BITS 57
+
+/* Field at bit `pos` of a buffer holding `buff_len` bytes. A field with 8
+ * bytes left from its first byte is read with a single word load, one near
+ * the end of the buffer one byte at a time so that nothing past it is
+ * touched */
+static inline uint64_t msg_layout_get(const uint8_t buff[],
+                                      uint32_t buff_len,
+                                      uint32_t pos,
+                                      uint8_t len) {
+  assert(len > 0 && len <= MSG_LAYOUT_MAX_BITS);
+  uint32_t byte = pos / 8;
+  uint32_t shift = pos % 8;
+  uint64_t word;
+  if (byte + 8 <= buff_len) {
+    word = rtcm_load_be64(&buff[byte]);
+  } else {
+    word = rtcm_load_be_bytes(&buff[byte], (shift + len + 7) / 8);
+  }
+  return (word << shift) >> (64 - len);
+}
+
+static inline int64_t msg_layout_get_signed(const uint8_t buff[],
+                                            uint32_t buff_len,
+                                            uint32_t pos,
+                                            uint8_t len) {
+  uint64_t sign = UINT64_C(1) << (len - 1);
+  return (int64_t)(msg_layout_get(buff, buff_len, pos, len) ^ sign) -
+         (int64_t)sign;
+}
+
+/* Write a field at bit `pos`, leaving the bits around it untouched */
+static inline void msg_layout_set(uint8_t buff[],
+                                  uint32_t pos,
+                                  uint8_t len,
+                                  uint64_t data) {
+  assert(len > 0 && len <= MSG_LAYOUT_MAX_BITS);
+  uint8_t *bytes = &buff[pos / 8];
+  uint32_t span = pos % 8 + len;
+  uint32_t num_bytes = (span + 7) / 8;
+  uint32_t pad = num_bytes * 8 - span;
+  uint64_t mask = ((UINT64_C(1) << len) - 1) << pad;
+  uint64_t bits = (data << pad) & mask;
+  for (uint32_t i = 0; i < num_bytes; i++) {
+    uint32_t shift = (num_bytes - 1 - i) * 8;
+    uint8_t byte_mask = (uint8_t)(mask >> shift);
+    bytes[i] = (uint8_t)((bytes[i] & ~byte_mask) | (uint8_t)(bits >> shift));
+  }
+}
+
+/* Encoded value of a UD field, rounded and clamped to the field range */
+static inline uint64_t msg_layout_unsigned(double value,
+                                           double scale,
+                                           uint8_t len) {
+  double max = (double)((UINT64_C(1) << len) - 1);
+  double scaled = round(value * scale);
+  if (!(scaled > 0.0)) {
+    return 0;
+  }
+  return scaled > max ? (UINT64_C(1) << len) - 1 : (uint64_t)scaled;
+}
+
+/* Value of a sign-magnitude field, see Note 1, Table 3.3-1, RTCM 3.3 */
+static inline int64_t msg_layout_from_sign_magnitude(uint64_t field,
+                                                     uint8_t len) {
+  int64_t magnitude = (int64_t)(field & ((UINT64_C(1) << (len - 1)) - 1));
+  return (field >> (len - 1)) ? -magnitude : magnitude;
+}
+
+/* Sign-magnitude field of `value`, the magnitude truncated to the field */
+static inline uint64_t msg_layout_to_sign_magnitude(int64_t value,
+                                                    uint8_t len) {
+  uint64_t magnitude = value < 0 ? -(uint64_t)value : (uint64_t)value;
+  uint64_t sign = value < 0 ? 1 : 0;
+  return (sign << (len - 1)) | (magnitude & ((UINT64_C(1) << (len - 1)) - 1));
+}
+
+#define LAYOUT_FIELD_BITS(Kind, Member, Bits, Scale) +(Bits)
+
+/* Length of a layout in bits, a constant expression */
+#define LAYOUT_BITS(Table) (0 Table(LAYOUT_FIELD_BITS))
+
+#define LAYOUT_DECODE_U(Member, Bits, Scale) \
+  msg->Member = msg_layout_get(buff, buff_len, bit, (Bits));
+#define LAYOUT_DECODE_S(Member, Bits, Scale) \
+  msg->Member = msg_layout_get_signed(buff, buff_len, bit, (Bits));
+#define LAYOUT_DECODE_SD(Member, Bits, Scale)                          \
+  msg->Member =                                                        \
+      (double)msg_layout_get_signed(buff, buff_len, bit, (Bits)) / (Scale);
+#define LAYOUT_DECODE_UD(Member, Bits, Scale) \
+  msg->Member = (double)msg_layout_get(buff, buff_len, bit, (Bits)) / (Scale);
+#define LAYOUT_DECODE_SM(Member, Bits, Scale) \
+  msg->Member = msg_layout_from_sign_magnitude(  \
+      msg_layout_get(buff, buff_len, bit, (Bits)), (Bits));
+#define LAYOUT_DECODE_OR(Member, Bits, Scale) \
+  msg->Member |= msg_layout_get(buff, buff_len, bit, (Bits));
+#define LAYOUT_DECODE_R(Member, Bits, Scale)
+#define LAYOUT_DECODE_C(Member, Bits, Scale)
+
+#define LAYOUT_ENCODE_U(Member, Bits, Scale) \
+  msg_layout_set(buff, bit, (Bits), msg->Member);
+#define LAYOUT_ENCODE_S(Member, Bits, Scale) \
+  msg_layout_set(buff, bit, (Bits), (uint64_t)(int64_t)msg->Member);
+#define LAYOUT_ENCODE_SD(Member, Bits, Scale) \
+  msg_layout_set(                             \
+      buff, bit, (Bits), (uint64_t)(int64_t)round(msg->Member * (Scale)));
+#define LAYOUT_ENCODE_UD(Member, Bits, Scale) \
+  msg_layout_set(                             \
+      buff, bit, (Bits), msg_layout_unsigned(msg->Member, (Scale), (Bits)));
+#define LAYOUT_ENCODE_SM(Member, Bits, Scale) \
+  msg_layout_set(                             \
+      buff, bit, (Bits), msg_layout_to_sign_magnitude(msg->Member, (Bits)));
+#define LAYOUT_ENCODE_OR(Member, Bits, Scale) \
+  msg_layout_set(buff, bit, (Bits), msg->Member);
+#define LAYOUT_ENCODE_R(Member, Bits, Scale) \
+  msg_layout_set(buff, bit, (Bits), 0);
+#define LAYOUT_ENCODE_C(Member, Bits, Scale) \
+  msg_layout_set(buff, bit, (Bits), (Scale));
+
+#define LAYOUT_DECODE_FIELD(Kind, Member, Bits, Scale) \
+  LAYOUT_DECODE_##Kind(Member, Bits, Scale) bit += (Bits);
+#define LAYOUT_ENCODE_FIELD(Kind, Member, Bits, Scale) \
+  LAYOUT_ENCODE_##Kind(Member, Bits, Scale) bit += (Bits);
+
+/* Define Name_decode() and Name_encode(), which read or write the fields of
+ * Table starting at `bit` and return the bit following the block. The
+ * decoder is given the number of bytes of `buff` it may read, at least up
+ * to the end of the block, and the more of the message that covers the
+ * more fields are read with word loads */
+#define DEFINE_MSG_LAYOUT(Name, Type, Table)                                 \
+  static inline uint32_t Name##_decode(                                      \
+      const uint8_t buff[], uint32_t buff_len, uint32_t bit, Type *msg) {    \
+    Table(LAYOUT_DECODE_FIELD) return bit;                                   \
+  }                                                                          \
+  static inline uint32_t Name##_encode(                                      \
+      const Type *msg, uint8_t buff[], uint32_t bit) {                       \
+    Table(LAYOUT_ENCODE_FIELD) return bit;                                   \
+  }
+
+DEFINE_MSG_LAYOUT(gps_obs_header, rtcm_obs_header, GPS_OBS_HEADER_FIELDS)
+DEFINE_MSG_LAYOUT(glo_obs_header, rtcm_obs_header, GLO_OBS_HEADER_FIELDS)
+DEFINE_MSG_LAYOUT(gps_l1_obs_layout, obs_freq_fields, GPS_L1_OBS_FIELDS)
+DEFINE_MSG_LAYOUT(glo_l1_obs_layout, obs_freq_fields, GLO_L1_OBS_FIELDS)
+DEFINE_MSG_LAYOUT(l2_obs_layout, obs_freq_fields, L2_OBS_FIELDS)
+DEFINE_MSG_LAYOUT(msg_1005_layout, rtcm_msg_1005, MSG_1005_FIELDS)
+DEFINE_MSG_LAYOUT(msg_1006_layout, rtcm_msg_1006, MSG_1006_FIELDS)
+DEFINE_MSG_LAYOUT(msg_1013_layout, rtcm_msg_1013, MSG_1013_FIELDS)
+DEFINE_MSG_LAYOUT(msg_1013_entry_layout,
+                  rtcm_1013_msg_info,
+                  MSG_1013_ENTRY_FIELDS)
+DEFINE_MSG_LAYOUT(gps_eph_layout, rtcm_msg_eph, GPS_EPH_FIELDS)
+DEFINE_MSG_LAYOUT(glo_eph_layout, rtcm_msg_eph, GLO_EPH_FIELDS)
+DEFINE_MSG_LAYOUT(glo_eph_additional_layout,
+                  rtcm_msg_eph,
+                  GLO_EPH_ADDITIONAL_FIELDS)
+DEFINE_MSG_LAYOUT(bds_eph_layout, rtcm_msg_eph, BDS_EPH_FIELDS)
+DEFINE_MSG_LAYOUT(qzss_eph_layout, rtcm_msg_eph, QZSS_EPH_FIELDS)
+DEFINE_MSG_LAYOUT(gal_eph_fnav_layout, rtcm_msg_eph, GAL_EPH_FNAV_FIELDS)
+DEFINE_MSG_LAYOUT(gal_eph_inav_layout, rtcm_msg_eph, GAL_EPH_INAV_FIELDS)
+
+#endif /* SWIFTNAV_RTCM3_MSG_LAYOUT_H */
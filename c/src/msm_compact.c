@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/msm_compact.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "rtcm3/bits.h"
+#include "rtcm3/decode.h"
+
+#include "decode_internal.h"
+#include "msm_unpack.h"
+
+/* The raw fields follow the struct in three regions of decreasing width:
+ *   int32_t  pseudorange DF400/DF405, phaserange DF401/DF406 (per cell)
+ *   uint16_t phaserange rate DF404, lock time DF402/DF407, CNR DF403/DF408
+ *            (per cell), rough range modulo 1 ms DF398, rough range rate
+ *            DF399 (per satellite)
+ *   uint8_t  rough range integer ms DF397, extended satellite info DF419
+ *            (per satellite)
+ * Signed fields in the uint16_t region are stored as two's complement. */
+typedef struct {
+  int32_t *pseudorange;
+  int32_t *phaserange;
+  uint16_t *phaserange_rate;
+  uint16_t *lock_time;
+  uint16_t *cnr;
+  uint16_t *rough_range_mod;
+  uint16_t *rough_rate;
+  uint8_t *rough_range_ms;
+  uint8_t *sat_info;
+} compact_layout;
+
+static uint16_t compact_bytes(uint8_t num_sats, uint8_t num_cells) {
+  size_t bytes = offsetof(rtcm_msm_compact, data) +
+                 num_cells * (2 * sizeof(int32_t) + 3 * sizeof(uint16_t)) +
+                 num_sats * (2 * sizeof(uint16_t) + 2 * sizeof(uint8_t));
+  bytes = (bytes + RTCM_MSM_COMPACT_ALIGN - 1) / RTCM_MSM_COMPACT_ALIGN *
+          RTCM_MSM_COMPACT_ALIGN;
+  return (uint16_t)bytes;
+}
+
+static void get_layout(const rtcm_msm_compact *msg, compact_layout *layout) {
+  int32_t *words = (int32_t *)msg->data;
+  layout->pseudorange = words;
+  layout->phaserange = words + msg->num_cells;
+  uint16_t *halves = (uint16_t *)(words + 2 * msg->num_cells);
+  layout->phaserange_rate = halves;
+  layout->lock_time = halves + msg->num_cells;
+  layout->cnr = halves + 2 * msg->num_cells;
+  layout->rough_range_mod = halves + 3 * msg->num_cells;
+  layout->rough_rate = halves + 3 * msg->num_cells + msg->num_sats;
+  uint8_t *bytes = (uint8_t *)(halves + 3 * msg->num_cells + 2 * msg->num_sats);
+  layout->rough_range_ms = bytes;
+  layout->sat_info = bytes + msg->num_sats;
+}
+
+/** Get the number of bytes needed to hold an MSM message in compact form.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \return Number of bytes to reserve for rtcm3_decode_msm_compact(), or 0 if
+ *         the payload is not an MSM4-7 message that fits in `len` bytes
+ */
+uint16_t rtcm3_msm_compact_size(const uint8_t buff[], uint16_t len) {
+  if (len < 2) {
+    return 0;
+  }
+  msm_enum msm_type = to_msm_type(rtcm_getbitu(buff, 0, 12));
+  if ((MSM4 != msm_type && MSM5 != msm_type && MSM6 != msm_type &&
+       MSM7 != msm_type) ||
+      !rtcm3_msm_payload_fits(buff, len, msm_type)) {
+    return 0;
+  }
+  /* the payload check has validated the masks */
+  uint64_t sats = rtcm_getbitul(buff, 73, MSM_SATELLITE_MASK_SIZE);
+  uint32_t sigs = rtcm_getbitu(buff, 137, MSM_SIGNAL_MASK_SIZE);
+  uint8_t cell_mask_size = count_mask_bits(sats) * count_mask_bits(sigs);
+  uint8_t num_cells = 0;
+  if (cell_mask_size > 0) {
+    num_cells = count_mask_bits(rtcm_getbitul(buff, 169, cell_mask_size));
+  }
+  return compact_bytes(count_mask_bits(sats), num_cells);
+}
+
+static void narrow_fields(const int32_t fields[],
+                          uint8_t count,
+                          uint16_t out[]) {
+  for (uint8_t i = 0; i < count; i++) {
+    out[i] = (uint16_t)fields[i];
+  }
+}
+
+/** Decode an RTCMv3 Multi System Message 4-7 into compact form.
+ *
+ * The raw fields are copied from the payload without scaling, so the result
+ * takes only as much memory as the message needs.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param msg The compact message
+ * \param size Number of bytes available at msg, at least
+ *             rtcm3_msm_compact_size()
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not an MSM4-7 message
+ *          - RC_INVALID_MESSAGE : Cell mask too large, invalid TOW, message
+ *            longer than the payload or size too small
+ */
+rtcm3_rc rtcm3_decode_msm_compact(const uint8_t buff[],
+                                  uint16_t len,
+                                  rtcm_msm_compact *msg,
+                                  uint16_t size) {
+  assert(msg);
+  if (len < 2) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint16_t msg_num = rtcm_getbitu(buff, 0, 12);
+  msm_enum msm_type = to_msm_type(msg_num);
+  rtcm_constellation_t cons = to_constellation(msg_num);
+  if ((MSM4 != msm_type && MSM5 != msm_type && MSM6 != msm_type &&
+       MSM7 != msm_type) ||
+      RTCM_CONSTELLATION_INVALID == cons) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  if (!rtcm3_msm_payload_fits(buff, len, msm_type)) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  rtcm_msm_header header;
+  rtcm_msm_masks masks;
+  uint16_t bit = rtcm3_read_msm_header(buff, cons, &header, &masks);
+  uint8_t num_sats = count_mask_bits(masks.sats);
+  uint8_t num_sigs = count_mask_bits(masks.sigs);
+  uint8_t num_cells = count_mask_bits(masks.cells);
+  if (!rtcm3_msm_tow_valid(cons, header.tow_ms) ||
+      num_sats > RTCM_MAX_SATS) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint16_t bytes = compact_bytes(num_sats, num_cells);
+  if (size < bytes) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  msg->msg_num = header.msg_num;
+  msg->stn_id = header.stn_id;
+  msg->tow_ms = header.tow_ms;
+  msg->multiple = header.multiple;
+  msg->iods = header.iods;
+  msg->reserved = header.reserved;
+  msg->steering = header.steering;
+  msg->ext_clock = header.ext_clock;
+  msg->div_free = header.div_free;
+  msg->smooth = header.smooth;
+  msg->num_sats = num_sats;
+  msg->num_sigs = num_sigs;
+  msg->num_cells = num_cells;
+  msg->size = bytes;
+  msg->masks = masks;
+
+  compact_layout layout;
+  get_layout(msg, &layout);
+  bool extended = (MSM6 == msm_type || MSM7 == msm_type);
+  bool full = (MSM5 == msm_type || MSM7 == msm_type);
+  int32_t fields[MSM_MAX_CELLS];
+
+  /* Satellite Data */
+  for (uint8_t i = 0; i < num_sats; i++) {
+    layout.rough_range_ms[i] = rtcm_getbitu(buff, bit, 8);
+    bit += 8;
+  }
+  for (uint8_t i = 0; i < num_sats; i++) {
+    layout.sat_info[i] = 0;
+    if (full) {
+      layout.sat_info[i] = rtcm_getbitu(buff, bit, 4);
+      bit += 4;
+    }
+  }
+  for (uint8_t i = 0; i < num_sats; i++) {
+    layout.rough_range_mod[i] = rtcm_getbitu(buff, bit, 10);
+    bit += 10;
+  }
+  for (uint8_t i = 0; i < num_sats; i++) {
+    layout.rough_rate[i] = 0;
+    if (full) {
+      layout.rough_rate[i] = (uint16_t)rtcm_getbits(buff, bit, 14);
+      bit += 14;
+    }
+  }
+
+  /* Signal Data */
+  uint8_t pr_bits = extended ? 20 : 15;
+  uint8_t cp_bits = extended ? 24 : 22;
+  uint8_t lock_bits = extended ? 10 : 4;
+  uint8_t cnr_bits = extended ? 10 : 6;
+  rtcm3_unpack_fields(buff,
+                      bit,
+                      pr_bits,
+                      true,
+                      num_cells,
+                      MSM_UNPACK_NO_SENTINEL,
+                      layout.pseudorange);
+  bit += pr_bits * num_cells;
+  rtcm3_unpack_fields(buff,
+                      bit,
+                      cp_bits,
+                      true,
+                      num_cells,
+                      MSM_UNPACK_NO_SENTINEL,
+                      layout.phaserange);
+  bit += cp_bits * num_cells;
+  rtcm3_unpack_fields(
+      buff, bit, lock_bits, false, num_cells, MSM_UNPACK_NO_SENTINEL, fields);
+  narrow_fields(fields, num_cells, layout.lock_time);
+  bit += lock_bits * num_cells;
+  msg->hca_indicator =
+      rtcm3_unpack_fields(buff, bit, 1, false, num_cells, 0, NULL);
+  bit += num_cells;
+  rtcm3_unpack_fields(
+      buff, bit, cnr_bits, false, num_cells, MSM_UNPACK_NO_SENTINEL, fields);
+  narrow_fields(fields, num_cells, layout.cnr);
+  bit += cnr_bits * num_cells;
+  if (full) {
+    rtcm3_unpack_fields(
+        buff, bit, 15, true, num_cells, MSM_UNPACK_NO_SENTINEL, fields);
+    narrow_fields(fields, num_cells, layout.phaserange_rate);
+  } else {
+    for (uint8_t i = 0; i < num_cells; i++) {
+      layout.phaserange_rate[i] = 0;
+    }
+  }
+
+  return RC_OK;
+}
+
+/** Expand a compact MSM message into an rtcm_msm_message.
+ *
+ * The result is the same as decoding the original payload with
+ * rtcm3_decode_msm4() etc.
+ *
+ * \param msg The compact message
+ * \param out The expanded message
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not an MSM4-7 message
+ */
+rtcm3_rc rtcm3_msm_compact_expand(const rtcm_msm_compact *msg,
+                                  rtcm_msm_message *out) {
+  assert(msg);
+  assert(out);
+  msm_enum msm_type = to_msm_type(msg->msg_num);
+  rtcm_constellation_t cons = to_constellation(msg->msg_num);
+  if ((MSM4 != msm_type && MSM5 != msm_type && MSM6 != msm_type &&
+       MSM7 != msm_type) ||
+      RTCM_CONSTELLATION_INVALID == cons) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  bool extended = (MSM6 == msm_type || MSM7 == msm_type);
+  bool full = (MSM5 == msm_type || MSM7 == msm_type);
+
+  out->header.msg_num = msg->msg_num;
+  out->header.stn_id = msg->stn_id;
+  out->header.tow_ms = msg->tow_ms;
+  out->header.multiple = msg->multiple;
+  out->header.iods = msg->iods;
+  out->header.reserved = msg->reserved;
+  out->header.steering = msg->steering;
+  out->header.ext_clock = msg->ext_clock;
+  out->header.div_free = msg->div_free;
+  out->header.smooth = msg->smooth;
+  msm_unpack_masks(&msg->masks, &out->header);
+
+  compact_layout layout;
+  get_layout(msg, &layout);
+
+  bool rough_range_valid[RTCM_MAX_SATS];
+  bool rough_rate_valid[RTCM_MAX_SATS];
+  for (uint8_t sat = 0; sat < msg->num_sats; sat++) {
+    rtcm_msm_sat_data *sat_data = &out->sats[sat];
+    rough_range_valid[sat] =
+        (MSM_ROUGH_RANGE_INVALID != layout.rough_range_ms[sat]);
+    sat_data->rough_range_ms = layout.rough_range_ms[sat];
+    if (rough_range_valid[sat]) {
+      sat_data->rough_range_ms += (double)layout.rough_range_mod[sat] / 1024;
+    }
+    int16_t rate = (int16_t)layout.rough_rate[sat];
+    sat_data->rough_range_rate_m_s = (double)rate;
+    rough_rate_valid[sat] = full && (MSM_ROUGH_RATE_INVALID != rate);
+    if (RTCM_CONSTELLATION_GLO == cons && !full) {
+      sat_data->glo_fcn = MSM_GLO_FCN_UNKNOWN;
+    } else {
+      sat_data->glo_fcn = layout.sat_info[sat];
+    }
+  }
+
+  uint64_t cell_mask = msg->masks.cells;
+  for (uint8_t i = 0; i < msg->num_cells; i++) {
+    uint8_t sat = pop_first_mask_bit(&cell_mask) / msg->num_sigs;
+    rtcm_msm_signal_data *signal = &out->signals[i];
+    double rough_range_ms = out->sats[sat].rough_range_ms;
+    signal->flags.data = 0;
+
+    int32_t pr = layout.pseudorange[i];
+    int32_t cp = layout.phaserange[i];
+    uint16_t lock = layout.lock_time[i];
+    uint16_t cnr = layout.cnr[i];
+    double fine_pr_ms;
+    double fine_cp_ms;
+    if (extended) {
+      signal->flags.valid_pr = (MSM_PR_EXT_INVALID != pr);
+      fine_pr_ms = (double)pr * C_1_2P29;
+      signal->flags.valid_cp = (MSM_CP_EXT_INVALID != cp);
+      fine_cp_ms = (double)cp * C_1_2P31;
+      signal->lock_time_s = (double)rtcm3_from_msm_lock_ind_ext(lock) / 1000;
+      signal->cnr = (double)cnr * C_1_2P4;
+    } else {
+      signal->flags.valid_pr = (MSM_PR_INVALID != pr);
+      fine_pr_ms = (double)pr * C_1_2P24;
+      signal->flags.valid_cp = (MSM_CP_INVALID != cp);
+      fine_cp_ms = (double)cp * C_1_2P29;
+      signal->lock_time_s = rtcm3_decode_lock_time((uint8_t)lock);
+      signal->cnr = (double)cnr;
+    }
+    signal->flags.valid_lock = 1;
+    signal->flags.valid_cnr = (0 != cnr);
+    signal->hca_indicator = (msg->hca_indicator >> i) & 1;
+
+    if (rough_range_valid[sat] && signal->flags.valid_pr) {
+      signal->pseudorange_ms = fine_pr_ms + rough_range_ms;
+    } else {
+      signal->pseudorange_ms = 0;
+      signal->flags.valid_pr = 0;
+    }
+    if (rough_range_valid[sat] && signal->flags.valid_cp) {
+      signal->carrier_phase_ms = fine_cp_ms + rough_range_ms;
+    } else {
+      signal->carrier_phase_ms = 0;
+      signal->flags.valid_cp = 0;
+    }
+
+    int16_t dop = (int16_t)layout.phaserange_rate[i];
+    if (full && rough_rate_valid[sat] && MSM_DOP_INVALID != dop) {
+      signal->flags.valid_dop = 1;
+      signal->range_rate_m_s =
+          (double)dop * 0.0001 + out->sats[sat].rough_range_rate_m_s;
+    } else {
+      signal->range_rate_m_s = 0;
+    }
+  }
+
+  return RC_OK;
+}
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "msm_unpack.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "rtcm3/bits.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MSM_UNPACK_AVX2
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define MSM_UNPACK_NEON
+#include <arm_neon.h>
+#endif
+
+/* Every kernel reads the fields of a run as big endian 32 bit words starting
+ * at the byte holding their first bit, shifts the field to the top of the
+ * word and then shifts it back down, sign extending if needed. A word is
+ * only loaded when it lies within the bytes of the run, the fields at the
+ * end of a run are left to the scalar loop. */
+
+typedef uint64_t (*unpack_fn)(const uint8_t buff[],
+                              uint32_t bit,
+                              uint8_t width,
+                              bool is_signed,
+                              uint8_t count,
+                              int32_t invalid,
+                              double scale,
+                              int32_t iout[],
+                              double dout[]);
+
+static uint64_t unpack_scalar(const uint8_t buff[],
+                              uint32_t bit,
+                              uint8_t width,
+                              bool is_signed,
+                              uint8_t first,
+                              uint8_t count,
+                              int32_t invalid,
+                              double scale,
+                              int32_t iout[],
+                              double dout[]) {
+  uint64_t valid = 0;
+  for (uint8_t i = first; i < count; i++) {
+    uint32_t pos = bit + (uint32_t)i * width;
+    int32_t field = is_signed ? rtcm_getbits(buff, pos, width)
+                              : (int32_t)rtcm_getbitu(buff, pos, width);
+    valid |= (uint64_t)(field != invalid) << i;
+    if (NULL != iout) {
+      iout[i] = field;
+    }
+    if (NULL != dout) {
+      dout[i] = (double)field * scale;
+    }
+  }
+  return valid;
+}
+
+static uint64_t unpack_portable(const uint8_t buff[],
+                                uint32_t bit,
+                                uint8_t width,
+                                bool is_signed,
+                                uint8_t count,
+                                int32_t invalid,
+                                double scale,
+                                int32_t iout[],
+                                double dout[]) {
+  return unpack_scalar(
+      buff, bit, width, is_signed, 0, count, invalid, scale, iout, dout);
+}
+
+/* Number of leading fields of a run whose 32 bit word can be loaded */
+static uint8_t loadable_fields(uint32_t bit, uint8_t width, uint8_t count) {
+  uint32_t end_byte = (bit + (uint32_t)count * width + 7) / 8;
+  uint8_t n = count;
+  while (n > 0 && (bit + (uint32_t)(n - 1) * width) / 8 + 4 > end_byte) {
+    n--;
+  }
+  return n;
+}
+
+#if defined(MSM_UNPACK_AVX2)
+
+__attribute__((target("avx2"))) static uint64_t unpack_avx2(
+    const uint8_t buff[],
+    uint32_t bit,
+    uint8_t width,
+    bool is_signed,
+    uint8_t count,
+    int32_t invalid,
+    double scale,
+    int32_t iout[],
+    double dout[]) {
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                         11, 10, 9, 8, 15, 14, 13, 12,
+                                         3, 2, 1, 0, 7, 6, 5, 4,
+                                         11, 10, 9, 8, 15, 14, 13, 12);
+  const __m256i lane_offsets =
+      _mm256_mullo_epi32(lanes, _mm256_set1_epi32(width));
+  const __m256i seven = _mm256_set1_epi32(7);
+  const __m256i sentinel = _mm256_set1_epi32(invalid);
+  const __m128i down = _mm_cvtsi32_si128(32 - width);
+  const __m256d vscale = _mm256_set1_pd(scale);
+
+  uint8_t loadable = loadable_fields(bit, width, count);
+  uint64_t valid = 0;
+  uint8_t i = 0;
+  for (; i + 8 <= loadable; i += 8) {
+    __m256i offsets = _mm256_add_epi32(
+        _mm256_set1_epi32((int32_t)(bit + (uint32_t)i * width)), lane_offsets);
+    __m256i words = _mm256_i32gather_epi32(
+        (const int *)buff, _mm256_srli_epi32(offsets, 3), 1);
+    words = _mm256_shuffle_epi8(words, bswap);
+    words = _mm256_sllv_epi32(words, _mm256_and_si256(offsets, seven));
+    __m256i fields = is_signed ? _mm256_sra_epi32(words, down)
+                               : _mm256_srl_epi32(words, down);
+
+    uint32_t bad = (uint32_t)_mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(fields, sentinel)));
+    valid |= (uint64_t)(~bad & 0xFFu) << i;
+    if (NULL != iout) {
+      _mm256_storeu_si256((__m256i *)&iout[i], fields);
+    }
+    if (NULL != dout) {
+      __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(fields));
+      __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(fields, 1));
+      _mm256_storeu_pd(&dout[i], _mm256_mul_pd(lo, vscale));
+      _mm256_storeu_pd(&dout[i + 4], _mm256_mul_pd(hi, vscale));
+    }
+  }
+  return valid | unpack_scalar(buff,
+                               bit,
+                               width,
+                               is_signed,
+                               i,
+                               count,
+                               invalid,
+                               scale,
+                               iout,
+                               dout);
+}
+
+/* The CPU flags are not enough, the OS must also have enabled saving the
+ * SSE and AVX state, bits 1 and 2 of XCR0, or AVX instructions fault */
+static bool simd_supported(void) {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE) ||
+      !(ecx & bit_AVX)) {
+    return false;
+  }
+  unsigned int xcr0_lo, xcr0_hi;
+  __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  if (0x6 != (xcr0_lo & 0x6)) {
+    return false;
+  }
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  return 0 != (ebx & bit_AVX2);
+}
+
+#define unpack_simd unpack_avx2
+
+#elif defined(MSM_UNPACK_NEON)
+
+static uint64_t unpack_neon(const uint8_t buff[],
+                            uint32_t bit,
+                            uint8_t width,
+                            bool is_signed,
+                            uint8_t count,
+                            int32_t invalid,
+                            double scale,
+                            int32_t iout[],
+                            double dout[]) {
+  const int32x4_t down = vdupq_n_s32(-(32 - (int32_t)width));
+  const int32x4_t sentinel = vdupq_n_s32(invalid);
+
+  uint8_t loadable = loadable_fields(bit, width, count);
+  uint64_t valid = 0;
+  uint8_t i = 0;
+  for (; i + 4 <= loadable; i += 4) {
+    uint32_t words[4];
+    int32_t shifts[4];
+    for (uint8_t lane = 0; lane < 4; lane++) {
+      uint32_t pos = bit + (uint32_t)(i + lane) * width;
+      memcpy(&words[lane], &buff[pos / 8], sizeof(words[lane]));
+      shifts[lane] = (int32_t)(pos % 8);
+    }
+    uint32x4_t v = vreinterpretq_u32_u8(
+        vrev32q_u8(vreinterpretq_u8_u32(vld1q_u32(words))));
+    v = vshlq_u32(v, vld1q_s32(shifts));
+    int32x4_t fields = is_signed
+                           ? vshlq_s32(vreinterpretq_s32_u32(v), down)
+                           : vreinterpretq_s32_u32(vshlq_u32(v, down));
+
+    uint32_t bad[4];
+    vst1q_u32(bad, vceqq_s32(fields, sentinel));
+    for (uint8_t lane = 0; lane < 4; lane++) {
+      valid |= (uint64_t)(0 == bad[lane]) << (i + lane);
+    }
+    if (NULL != iout) {
+      vst1q_s32(&iout[i], fields);
+    }
+    if (NULL != dout) {
+      float64x2_t lo = vcvtq_f64_s64(vmovl_s32(vget_low_s32(fields)));
+      float64x2_t hi = vcvtq_f64_s64(vmovl_high_s32(fields));
+      vst1q_f64(&dout[i], vmulq_n_f64(lo, scale));
+      vst1q_f64(&dout[i + 2], vmulq_n_f64(hi, scale));
+    }
+  }
+  return valid | unpack_scalar(buff,
+                               bit,
+                               width,
+                               is_signed,
+                               i,
+                               count,
+                               invalid,
+                               scale,
+                               iout,
+                               dout);
+}
+
+/* Advanced SIMD is part of the AArch64 base architecture */
+static bool simd_supported(void) { return true; }
+
+#define unpack_simd unpack_neon
+
+#endif
+
+#if defined(MSM_UNPACK_AVX2) || defined(MSM_UNPACK_NEON)
+
+/* Implementation picked on first use. Concurrent first calls may race to set
+ * it, but all of them store the same value. */
+static unpack_fn unpack_impl = NULL;
+
+static unpack_fn unpack_select(void) {
+  unpack_fn impl = __atomic_load_n(&unpack_impl, __ATOMIC_RELAXED);
+  if (NULL == impl) {
+    impl = simd_supported() ? unpack_simd : unpack_portable;
+    __atomic_store_n(&unpack_impl, impl, __ATOMIC_RELAXED);
+  }
+  return impl;
+}
+
+#else
+
+static unpack_fn unpack_select(void) { return unpack_portable; }
+
+#endif
+
+/** Unpack a run of consecutive fields of the same width.
+ *
+ * Uses AVX2 or NEON when available and a scalar loop otherwise. Only the
+ * bytes holding the run are read.
+ *
+ * \param buff The input data buffer
+ * \param bit Position of the first field
+ * \param width Width of each field in bits, at most MSM_UNPACK_MAX_WIDTH
+ * \param is_signed Whether the fields are two's complement
+ * \param count Number of fields, at most MSM_UNPACK_MAX_FIELDS
+ * \param invalid Value marking an invalid field, or MSM_UNPACK_NO_SENTINEL
+ * \param out The unpacked fields, count entries, or NULL if only the mask
+ *            is needed
+ * \return Mask with bit i set if field i is not equal to invalid
+ */
+uint64_t rtcm3_unpack_fields(const uint8_t buff[],
+                             uint32_t bit,
+                             uint8_t width,
+                             bool is_signed,
+                             uint8_t count,
+                             int32_t invalid,
+                             int32_t out[]) {
+  assert(width > 0 && width <= MSM_UNPACK_MAX_WIDTH);
+  assert(count <= MSM_UNPACK_MAX_FIELDS);
+  return unpack_select()(
+      buff, bit, width, is_signed, count, invalid, 1.0, out, NULL);
+}
+
+/** Unpack a run of consecutive fields of the same width and multiply them
+ * by a scale factor, see rtcm3_unpack_fields().
+ *
+ * \param buff The input data buffer
+ * \param bit Position of the first field
+ * \param width Width of each field in bits, at most MSM_UNPACK_MAX_WIDTH
+ * \param is_signed Whether the fields are two's complement
+ * \param count Number of fields, at most MSM_UNPACK_MAX_FIELDS
+ * \param invalid Value marking an invalid field, or MSM_UNPACK_NO_SENTINEL
+ * \param scale Scale factor applied to each field
+ * \param out The scaled fields, count entries
+ * \return Mask with bit i set if field i is not equal to invalid
+ */
+uint64_t rtcm3_unpack_scaled(const uint8_t buff[],
+                             uint32_t bit,
+                             uint8_t width,
+                             bool is_signed,
+                             uint8_t count,
+                             int32_t invalid,
+                             double scale,
+                             double out[]) {
+  assert(width > 0 && width <= MSM_UNPACK_MAX_WIDTH);
+  assert(count <= MSM_UNPACK_MAX_FIELDS);
+  return unpack_select()(
+      buff, bit, width, is_signed, count, invalid, scale, NULL, out);
+}
+
+/** Unpack a run of fields with the scalar loop only, regardless of the CPU,
+ * see rtcm3_unpack_fields().
+ *
+ * \param buff The input data buffer
+ * \param bit Position of the first field
+ * \param width Width of each field in bits, at most MSM_UNPACK_MAX_WIDTH
+ * \param is_signed Whether the fields are two's complement
+ * \param count Number of fields, at most MSM_UNPACK_MAX_FIELDS
+ * \param invalid Value marking an invalid field, or MSM_UNPACK_NO_SENTINEL
+ * \param out The unpacked fields, count entries
+ * \return Mask with bit i set if field i is not equal to invalid
+ */
+uint64_t rtcm3_unpack_fields_scalar(const uint8_t buff[],
+                                    uint32_t bit,
+                                    uint8_t width,
+                                    bool is_signed,
+                                    uint8_t count,
+                                    int32_t invalid,
+                                    int32_t out[]) {
+  return unpack_portable(
+      buff, bit, width, is_signed, count, invalid, 1.0, out, NULL);
+}
+
+/** Check whether the unpack functions use a SIMD implementation.
+ *
+ * \return true if AVX2 or NEON is in use
+ */
+bool rtcm3_unpack_accelerated(void) {
+  return unpack_select() != unpack_portable;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* Unpacking of runs of same-width MSM cell fields, not installed */
+
+#ifndef SWIFTNAV_RTCM3_MSM_UNPACK_H
+#define SWIFTNAV_RTCM3_MSM_UNPACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Maximum number of fields in one run, one bit each in the returned mask */
+#define MSM_UNPACK_MAX_FIELDS 64
+/* Maximum field width supported by the unpack functions */
+#define MSM_UNPACK_MAX_WIDTH 25
+/* Sentinel for fields that have no invalid value */
+#define MSM_UNPACK_NO_SENTINEL INT32_MIN
+
+uint64_t rtcm3_unpack_fields(const uint8_t buff[],
+                             uint32_t bit,
+                             uint8_t width,
+                             bool is_signed,
+                             uint8_t count,
+                             int32_t invalid,
+                             int32_t out[]);
+uint64_t rtcm3_unpack_scaled(const uint8_t buff[],
+                             uint32_t bit,
+                             uint8_t width,
+                             bool is_signed,
+                             uint8_t count,
+                             int32_t invalid,
+                             double scale,
+                             double out[]);
+uint64_t rtcm3_unpack_fields_scalar(const uint8_t buff[],
+                                    uint32_t bit,
+                                    uint8_t width,
+                                    bool is_signed,
+                                    uint8_t count,
+                                    int32_t invalid,
+                                    int32_t out[]);
+bool rtcm3_unpack_accelerated(void);
+
+#endif /* SWIFTNAV_RTCM3_MSM_UNPACK_H */
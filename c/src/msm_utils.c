@@ -115,3 +115,130 @@ uint8_t find_nth_mask_value(const uint8_t mask_size,
   /* this will never be reached */
   return 0;
 }
+
+/** Count the set bits in a packed mask
+ *
+ * \param mask Packed mask
+ * \return number of set bits
+ */
+uint8_t count_mask_bits(uint64_t mask) {
+#if defined(__GNUC__)
+  return (uint8_t)__builtin_popcountll(mask);
+#else
+  uint8_t ret = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    ret++;
+  }
+  return ret;
+#endif
+}
+
+/** Return the position of the lowest set bit of a packed mask and clear it,
+ * for iterating over the set entries of the mask
+ *
+ * \param mask Packed mask, must not be 0 (causes an assert if it is)
+ * \return The 0-based position of the lowest set bit
+ */
+uint8_t pop_first_mask_bit(uint64_t *mask) {
+  assert(*mask != 0);
+#if defined(__GNUC__)
+  uint8_t pos = (uint8_t)__builtin_ctzll(*mask);
+#else
+  uint8_t pos = 0;
+  while (0 == ((*mask >> pos) & 1)) {
+    pos++;
+  }
+#endif
+  *mask &= *mask - 1;
+  return pos;
+}
+
+/** Return the position of the nth set bit of a packed mask, the packed
+ * equivalent of find_nth_mask_value()
+ *
+ * \param mask Packed mask
+ * \param n A number between 1 and count_mask_bits (causes an assert if not)
+ * \return The 0-based position of the nth set bit
+ */
+uint8_t find_nth_mask_bit(uint64_t mask, uint8_t n) {
+  assert(n > 0 && n <= count_mask_bits(mask));
+  for (uint8_t i = 1; i < n; i++) {
+    mask &= mask - 1;
+  }
+  return pop_first_mask_bit(&mask);
+}
+
+/** Convert between a packed mask and the order the mask is sent in, where
+ * the first entry is the most significant bit of the field
+ *
+ * \param mask Mask or field of mask_size bits
+ * \param mask_size Number of entries in the mask, at most 64
+ * \return The mask with the order of its mask_size low bits reversed
+ */
+uint64_t reverse_mask_bits(uint64_t mask, uint8_t mask_size) {
+  assert(mask_size <= 64);
+  if (0 == mask_size) {
+    return 0;
+  }
+  mask = ((mask >> 1) & 0x5555555555555555ULL) |
+         ((mask & 0x5555555555555555ULL) << 1);
+  mask = ((mask >> 2) & 0x3333333333333333ULL) |
+         ((mask & 0x3333333333333333ULL) << 2);
+  mask = ((mask >> 4) & 0x0F0F0F0F0F0F0F0FULL) |
+         ((mask & 0x0F0F0F0F0F0F0F0FULL) << 4);
+#if defined(__GNUC__)
+  mask = __builtin_bswap64(mask);
+#else
+  mask = ((mask >> 8) & 0x00FF00FF00FF00FFULL) |
+         ((mask & 0x00FF00FF00FF00FFULL) << 8);
+  mask = ((mask >> 16) & 0x0000FFFF0000FFFFULL) |
+         ((mask & 0x0000FFFF0000FFFFULL) << 16);
+  mask = (mask >> 32) | (mask << 32);
+#endif
+  return mask >> (64 - mask_size);
+}
+
+/** Pack the Boolean masks of an MSM header
+ *
+ * The Boolean masks are the only masks the header holds, callers wanting
+ * the packed words get them from here.
+ *
+ * \param header MSM header
+ * \param masks The packed masks
+ */
+void msm_pack_masks(const rtcm_msm_header *header, rtcm_msm_masks *masks) {
+  masks->sats = 0;
+  for (uint8_t i = 0; i < MSM_SATELLITE_MASK_SIZE; i++) {
+    masks->sats |= (uint64_t)header->satellite_mask[i] << i;
+  }
+  masks->sigs = 0;
+  for (uint8_t i = 0; i < MSM_SIGNAL_MASK_SIZE; i++) {
+    masks->sigs |= (uint32_t)header->signal_mask[i] << i;
+  }
+  uint16_t cell_mask_size =
+      count_mask_bits(masks->sats) * count_mask_bits(masks->sigs);
+  if (cell_mask_size > MSM_MAX_CELLS) {
+    cell_mask_size = MSM_MAX_CELLS;
+  }
+  masks->cells = 0;
+  for (uint8_t i = 0; i < cell_mask_size; i++) {
+    masks->cells |= (uint64_t)header->cell_mask[i] << i;
+  }
+}
+
+/** Expand packed masks into the Boolean masks of an MSM header
+ *
+ * \param masks The packed masks
+ * \param header MSM header
+ */
+void msm_unpack_masks(const rtcm_msm_masks *masks, rtcm_msm_header *header) {
+  for (uint8_t i = 0; i < MSM_SATELLITE_MASK_SIZE; i++) {
+    header->satellite_mask[i] = (masks->sats >> i) & 1;
+  }
+  for (uint8_t i = 0; i < MSM_SIGNAL_MASK_SIZE; i++) {
+    header->signal_mask[i] = (masks->sigs >> i) & 1;
+  }
+  for (uint8_t i = 0; i < MSM_MAX_CELLS; i++) {
+    header->cell_mask[i] = (masks->cells >> i) & 1;
+  }
+}
@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/obs_convert.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include "rtcm3/constants.h"
+#include "rtcm3/msm_utils.h"
+
+#define NO_SIGNAL 0xFF
+
+/* MSM signal IDs of the legacy code indicators, DF010 for L1 and DF016 for
+ * L2. The L2 C/A indicator covers all the L2C signals, reported as 2X. */
+static const uint8_t gps_l1_signal[2] = {2 /* 1C */, 3 /* 1P */};
+static const uint8_t gps_l2_signal[4] = {
+    17 /* 2X */, 9 /* 2P */, 10 /* 2W */, 10 /* 2W */};
+static const uint8_t glo_l1_signal[2] = {2 /* 1C */, 3 /* 1P */};
+static const uint8_t glo_l2_signal[4] = {
+    8 /* 2C */, 9 /* 2P */, 9 /* 2P */, 9 /* 2P */};
+
+/* Legacy frequency and code indicator of an MSM signal */
+typedef struct {
+  uint8_t freq; /* NO_SIGNAL if the signal has no legacy equivalent */
+  uint8_t code;
+} legacy_signal;
+
+static legacy_signal to_legacy_signal(rtcm_constellation_t cons,
+                                      uint8_t signal_id) {
+  legacy_signal ret = {NO_SIGNAL, 0};
+  if (RTCM_CONSTELLATION_GPS == cons) {
+    switch (signal_id) {
+      case 2:
+        ret.freq = L1_FREQ;
+        ret.code = 0;
+        break;
+      case 3:
+      case 4:
+        ret.freq = L1_FREQ;
+        ret.code = 1;
+        break;
+      case 8:
+      case 15:
+      case 16:
+      case 17:
+        ret.freq = L2_FREQ;
+        ret.code = 0;
+        break;
+      case 9:
+        ret.freq = L2_FREQ;
+        ret.code = 1;
+        break;
+      case 10:
+        ret.freq = L2_FREQ;
+        ret.code = 3;
+        break;
+      default:
+        break;
+    }
+  } else if (RTCM_CONSTELLATION_GLO == cons) {
+    switch (signal_id) {
+      case 2:
+      case 3:
+        ret.freq = L1_FREQ;
+        ret.code = signal_id - 2;
+        break;
+      case 8:
+      case 9:
+        ret.freq = L2_FREQ;
+        ret.code = signal_id - 8;
+        break;
+      default:
+        break;
+    }
+  }
+  return ret;
+}
+
+/* Carrier wavelength of a legacy signal in light milliseconds, 0 if the
+ * GLONASS frequency channel is unknown */
+static double wavelength_ms(rtcm_constellation_t cons,
+                            uint8_t freq,
+                            uint8_t fcn) {
+  double freq_hz;
+  if (RTCM_CONSTELLATION_GPS == cons) {
+    freq_hz = L1_FREQ == freq ? GPS_L1_HZ : GPS_L2_HZ;
+  } else if (fcn <= MT1012_GLO_MAX_FCN) {
+    int8_t glo_fcn = (int8_t)(fcn - MT1012_GLO_FCN_OFFSET);
+    freq_hz = L1_FREQ == freq ? GLO_L1_HZ + glo_fcn * GLO_L1_DELTA_HZ
+                              : GLO_L2_HZ + glo_fcn * GLO_L2_DELTA_HZ;
+  } else {
+    return 0;
+  }
+  return 1000.0 / freq_hz;
+}
+
+static bool has_observation(const rtcm_freq_data *freq_data) {
+  return freq_data->flags.valid_pr || freq_data->flags.valid_cp;
+}
+
+/** Convert a legacy GPS or GLONASS observation message into MSM columns.
+ *
+ * The whole epoch is converted in one pass: the satellite and signal masks
+ * are built from the satellite IDs and code indicators, then the cells are
+ * filled in mask order. Pseudoranges and carrier phases are converted from
+ * meters and cycles to light milliseconds, and the rough range of each
+ * satellite is its first observation rounded to 2^-10 ms. The legacy
+ * messages carry no range rates, those are marked invalid.
+ *
+ * \param obs Decoded 1001-1004 or 1009-1012 message
+ * \param msm_type MSM4 to MSM7, selects the message number of the header
+ * \param header Set to the MSM header
+ * \param sats Satellite data, RTCM_MAX_SATS entries
+ * \param cells Signal columns with caller owned arrays of MSM_MAX_CELLS
+ *              entries
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not a legacy observation message or
+ *            not an MSM4-7 type
+ *          - RC_INVALID_MESSAGE : Invalid or repeated satellite ID, or more
+ *            satellites and signals than an MSM cell mask holds
+ */
+rtcm3_rc rtcm3_obs_to_msm(const rtcm_obs_message *obs,
+                          msm_enum msm_type,
+                          rtcm_msm_header *header,
+                          rtcm_msm_sat_data sats[],
+                          rtcm_msm_signal_columns *cells) {
+  assert(obs);
+  assert(header);
+  assert(sats);
+  assert(cells);
+  uint16_t msg_num = obs->header.msg_num;
+  rtcm_constellation_t cons;
+  const uint8_t *l1_signal;
+  const uint8_t *l2_signal;
+  if (msg_num >= 1001 && msg_num <= 1004) {
+    cons = RTCM_CONSTELLATION_GPS;
+    l1_signal = gps_l1_signal;
+    l2_signal = gps_l2_signal;
+  } else if (msg_num >= 1009 && msg_num <= 1012) {
+    cons = RTCM_CONSTELLATION_GLO;
+    l1_signal = glo_l1_signal;
+    l2_signal = glo_l2_signal;
+  } else {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  if (MSM4 != msm_type && MSM5 != msm_type && MSM6 != msm_type &&
+      MSM7 != msm_type) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  if (obs->header.n_sat > RTCM_MAX_SATS) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  /* signal IDs of each satellite, 0 if not observed, and the masks */
+  uint8_t signal_ids[RTCM_MAX_SATS][NUM_FREQS];
+  uint8_t legacy_index[MSM_SATELLITE_MASK_SIZE];
+  rtcm_msm_masks masks = {0, 0, 0};
+  for (uint8_t i = 0; i < obs->header.n_sat; i++) {
+    const rtcm_sat_data *sat = &obs->sats[i];
+    if (sat->svId == 0 || sat->svId > MSM_SATELLITE_MASK_SIZE ||
+        ((masks.sats >> (sat->svId - 1)) & 1)) {
+      return RC_INVALID_MESSAGE;
+    }
+    masks.sats |= (uint64_t)1 << (sat->svId - 1);
+    legacy_index[sat->svId - 1] = i;
+    signal_ids[i][L1_FREQ] = has_observation(&sat->obs[L1_FREQ])
+                                 ? l1_signal[sat->obs[L1_FREQ].code & 1]
+                                 : 0;
+    signal_ids[i][L2_FREQ] = has_observation(&sat->obs[L2_FREQ])
+                                 ? l2_signal[sat->obs[L2_FREQ].code & 3]
+                                 : 0;
+    for (uint8_t f = 0; f < NUM_FREQS; f++) {
+      if (signal_ids[i][f] != 0) {
+        masks.sigs |= (uint32_t)1 << (signal_ids[i][f] - 1);
+      }
+    }
+  }
+  uint8_t num_sigs = count_mask_bits(masks.sigs);
+  if (count_mask_bits(masks.sats) * num_sigs > MSM_MAX_CELLS) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  /* cells in mask order, satellite by satellite */
+  cells->num_cells = 0;
+  cells->valid_pr = 0;
+  cells->valid_cp = 0;
+  cells->valid_cnr = 0;
+  cells->valid_lock = 0;
+  cells->valid_dop = 0;
+  cells->hca_indicator = 0;
+  uint64_t sat_mask = masks.sats;
+  for (uint8_t sat = 0; sat_mask != 0; sat++) {
+    uint8_t i = legacy_index[pop_first_mask_bit(&sat_mask)];
+    const rtcm_sat_data *sat_data = &obs->sats[i];
+    rtcm_msm_sat_data *msm_sat = &sats[sat];
+    msm_sat->rough_range_ms = 0;
+    msm_sat->rough_range_rate_m_s = 0;
+    msm_sat->glo_fcn =
+        RTCM_CONSTELLATION_GLO == cons && sat_data->fcn <= MSM_GLO_MAX_FCN
+            ? sat_data->fcn
+            : MSM_GLO_FCN_UNKNOWN;
+    bool has_range = false;
+
+    uint64_t sig_mask = masks.sigs;
+    for (uint8_t sig = 0; sig < num_sigs; sig++) {
+      uint8_t signal_id = pop_first_mask_bit(&sig_mask) + 1;
+      uint8_t f;
+      if (signal_ids[i][L1_FREQ] == signal_id) {
+        f = L1_FREQ;
+      } else if (signal_ids[i][L2_FREQ] == signal_id) {
+        f = L2_FREQ;
+      } else {
+        continue;
+      }
+      const rtcm_freq_data *freq_data = &sat_data->obs[f];
+      uint8_t cell = cells->num_cells++;
+      masks.cells |= (uint64_t)1 << (sat * num_sigs + sig);
+      uint64_t cell_bit = (uint64_t)1 << cell;
+      cells->sat_index[cell] = sat;
+      cells->sig_index[cell] = sig;
+      cells->pseudorange_ms[cell] = freq_data->pseudorange / PRUNIT_GPS;
+      double wavelength = wavelength_ms(cons, f, sat_data->fcn);
+      cells->carrier_phase_ms[cell] = freq_data->carrier_phase * wavelength;
+      cells->range_rate_m_s[cell] = 0;
+      cells->cnr[cell] = freq_data->cnr;
+      cells->lock_time_s[cell] = freq_data->lock;
+      if (freq_data->flags.valid_pr) {
+        cells->valid_pr |= cell_bit;
+      }
+      if (freq_data->flags.valid_cp && wavelength > 0) {
+        cells->valid_cp |= cell_bit;
+      }
+      if (freq_data->flags.valid_cnr) {
+        cells->valid_cnr |= cell_bit;
+      }
+      if (freq_data->flags.valid_lock) {
+        cells->valid_lock |= cell_bit;
+      }
+
+      if (!has_range && ((cells->valid_pr | cells->valid_cp) & cell_bit)) {
+        double range_ms = (cells->valid_pr & cell_bit)
+                              ? cells->pseudorange_ms[cell]
+                              : cells->carrier_phase_ms[cell];
+        msm_sat->rough_range_ms = round(range_ms * 1024) / 1024;
+        has_range = true;
+      }
+    }
+  }
+
+  memset(header, 0, sizeof(*header));
+  header->msg_num = (uint16_t)((RTCM_CONSTELLATION_GPS == cons ? 1070 : 1080) +
+                               msm_type);
+  header->stn_id = obs->header.stn_id;
+  header->tow_ms = obs->header.tow_ms;
+  header->multiple = obs->header.sync;
+  header->div_free = obs->header.div_free;
+  header->smooth = obs->header.smooth;
+  msm_unpack_masks(&masks, header);
+  return RC_OK;
+}
+
+/** Convert MSM columns of a GPS or GLONASS message into a legacy
+ * observation message.
+ *
+ * The cells of the signals with a legacy equivalent are converted in one
+ * pass; when several signals map to one frequency the first in the signal
+ * mask is kept. Satellites without such a signal are left out. The message
+ * number is set to 1004 or 1012.
+ *
+ * \param header MSM header
+ * \param sats Satellite data of the message
+ * \param cells Signal columns of the message
+ * \param obs Set to the legacy observations
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not a GPS or GLONASS MSM
+ *          - RC_INVALID_MESSAGE : More than RTCM_MAX_SATS satellites with
+ *            legacy signals
+ */
+rtcm3_rc rtcm3_msm_to_obs(const rtcm_msm_header *header,
+                          const rtcm_msm_sat_data sats[],
+                          const rtcm_msm_signal_columns *cells,
+                          rtcm_obs_message *obs) {
+  assert(header);
+  assert(sats);
+  assert(cells);
+  assert(obs);
+  rtcm_constellation_t cons = to_constellation(header->msg_num);
+  if (RTCM_CONSTELLATION_GPS != cons && RTCM_CONSTELLATION_GLO != cons) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  rtcm_msm_masks masks;
+  msm_pack_masks(header, &masks);
+
+  legacy_signal signals[MSM_SIGNAL_MASK_SIZE];
+  uint64_t sig_mask = masks.sigs;
+  for (uint8_t sig = 0; sig_mask != 0; sig++) {
+    signals[sig] = to_legacy_signal(cons, pop_first_mask_bit(&sig_mask) + 1);
+  }
+  uint8_t sat_ids[MSM_SATELLITE_MASK_SIZE];
+  uint64_t sat_mask = masks.sats;
+  for (uint8_t sat = 0; sat_mask != 0; sat++) {
+    sat_ids[sat] = pop_first_mask_bit(&sat_mask) + 1;
+  }
+
+  memset(&obs->header, 0, sizeof(obs->header));
+  obs->header.msg_num = RTCM_CONSTELLATION_GPS == cons ? 1004 : 1012;
+  obs->header.stn_id = header->stn_id;
+  obs->header.tow_ms = header->tow_ms;
+  obs->header.sync = header->multiple;
+  obs->header.div_free = header->div_free;
+  obs->header.smooth = header->smooth;
+
+  /* cells come satellite by satellite, a new legacy entry is started at
+   * the first usable cell of each */
+  uint8_t last_sat = NO_SIGNAL;
+  rtcm_sat_data *sat_data = NULL;
+  for (uint8_t cell = 0; cell < cells->num_cells; cell++) {
+    legacy_signal signal = signals[cells->sig_index[cell]];
+    if (NO_SIGNAL == signal.freq) {
+      continue;
+    }
+    uint8_t sat = cells->sat_index[cell];
+    if (sat != last_sat) {
+      if (obs->header.n_sat == RTCM_MAX_SATS) {
+        return RC_INVALID_MESSAGE;
+      }
+      sat_data = &obs->sats[obs->header.n_sat++];
+      memset(sat_data, 0, sizeof(*sat_data));
+      sat_data->svId = sat_ids[sat];
+      sat_data->fcn = RTCM_CONSTELLATION_GLO == cons ? sats[sat].glo_fcn : 0;
+      last_sat = sat;
+    }
+    rtcm_freq_data *freq_data = &sat_data->obs[signal.freq];
+    if (freq_data->flags.data != 0) {
+      continue;
+    }
+
+    uint64_t cell_bit = (uint64_t)1 << cell;
+    double wavelength = wavelength_ms(cons, signal.freq, sat_data->fcn);
+    freq_data->code = signal.code;
+    freq_data->pseudorange = cells->pseudorange_ms[cell] * PRUNIT_GPS;
+    freq_data->carrier_phase =
+        wavelength > 0 ? cells->carrier_phase_ms[cell] / wavelength : 0;
+    freq_data->lock = cells->lock_time_s[cell];
+    freq_data->cnr = cells->cnr[cell];
+    freq_data->flags.valid_pr = (cells->valid_pr & cell_bit) != 0;
+    freq_data->flags.valid_cp =
+        wavelength > 0 && (cells->valid_cp & cell_bit) != 0;
+    freq_data->flags.valid_cnr = (cells->valid_cnr & cell_bit) != 0;
+    freq_data->flags.valid_lock = (cells->valid_lock & cell_bit) != 0;
+  }
+  return RC_OK;
+}
@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/orbit.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "rtcm3/constants.h"
+
+#define ORBIT_PI 3.1415926535897932
+#define HALF_WEEK_S 302400.0
+#define WEEK_S 604800.0
+/* Inclination of the frame BDS GEO orbits are computed in */
+#define BDS_GEO_TILT_RAD (-5.0 * ORBIT_PI / 180.0)
+
+/* Constellation specific constants and scale factors of the Keplerian
+ * ephemeris fields, as powers of two unless noted */
+typedef struct {
+  double gm;            /* Earth gravitational constant, m^3 / s^2 */
+  double omega_e;       /* Earth rotation rate, rad / s */
+  double time_unit_s;   /* toe and toc */
+  double time_offset_s; /* GPS time minus system time */
+  int af0;
+  int af1;
+  int af2;
+  int cr; /* crc, crs */
+  int cu; /* cuc, cus, cic, cis */
+} kepler_scales;
+
+static const kepler_scales gps_scales = {
+    3.986005e14, 7.2921151467e-5, 16.0, 0.0, -31, -43, -55, -5, -29};
+static const kepler_scales gal_scales = {
+    3.986004418e14, 7.2921151467e-5, 60.0, 0.0, -34, -46, -59, -5, -29};
+static const kepler_scales bds_scales = {3.986004418e14,
+                                         7.2921150e-5,
+                                         8.0,
+                                         BDS_SECOND_TO_GPS_SECOND,
+                                         -33,
+                                         -50,
+                                         -66,
+                                         -6,
+                                         -31};
+
+static const kepler_scales *get_kepler_scales(
+    rtcm_constellation_t constellation) {
+  switch (constellation) {
+    case RTCM_CONSTELLATION_GPS:
+    case RTCM_CONSTELLATION_QZS:
+      return &gps_scales;
+    case RTCM_CONSTELLATION_GAL:
+      return &gal_scales;
+    case RTCM_CONSTELLATION_BDS:
+      return &bds_scales;
+    case RTCM_CONSTELLATION_SBAS:
+    case RTCM_CONSTELLATION_GLO:
+    case RTCM_CONSTELLATION_INVALID:
+    case RTCM_CONSTELLATION_COUNT:
+    default:
+      return NULL;
+  }
+}
+
+/* Bring a time difference into [-half week, half week) */
+static double wrap_week(double dt_s) {
+  if (dt_s >= HALF_WEEK_S) {
+    return dt_s - WEEK_S;
+  }
+  if (dt_s < -HALF_WEEK_S) {
+    return dt_s + WEEK_S;
+  }
+  return dt_s;
+}
+
+static bool is_bds_geo(const rtcm_msg_eph *eph) {
+  return RTCM_CONSTELLATION_BDS == eph->constellation &&
+         ((eph->sat_id >= 1 && eph->sat_id <= BEIDOU_GEOS_MAX_PRN) ||
+          (eph->sat_id >= BEIDOU_GEOS_EXT_MIN_PRN &&
+           eph->sat_id <= BEIDOU_GEOS_EXT_MAX_PRN));
+}
+
+/** Initialize an empty orbit cache
+ * \param cache Cache to initialize
+ */
+void rtcm3_orbit_cache_init(rtcm3_orbit_cache *cache) {
+  assert(cache);
+  cache->num_sats = 0;
+  cache->generation = 0;
+}
+
+/** Find the slot of a satellite
+ * \param cache Cache to search
+ * \param constellation Constellation of the satellite
+ * \param sat_id Satellite ID as in the ephemeris message
+ * \return The slot, or -1 if the satellite has not been added
+ */
+int32_t rtcm3_orbit_cache_find(const rtcm3_orbit_cache *cache,
+                               rtcm_constellation_t constellation,
+                               uint8_t sat_id) {
+  assert(cache);
+  for (uint16_t i = 0; i < cache->num_sats; i++) {
+    if (cache->constellation[i] == (uint8_t)constellation &&
+        cache->sat_id[i] == sat_id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/** Convert the Keplerian ephemeris of a satellite into the cache.
+ *
+ * Each satellite takes one slot, kept across updates of its ephemeris. The
+ * conversion is skipped if the slot already holds the same issue of data
+ * (IODE, IODC, week number and toe), so callers sharing a cache can add
+ * every ephemeris they receive. BDS GEO satellites, C01 to C05 and C59 to
+ * C63, are set up for the GEO coordinate transformation of the BDS ICD.
+ *
+ * \param cache Cache to update
+ * \param eph Decoded GPS, QZSS, Galileo or BDS ephemeris
+ * \param slot Set to the slot of the satellite
+ * \return  - RC_OK : Success
+ *          - RC_INVALID_MESSAGE : The ephemeris is not Keplerian (GLONASS,
+ *            SBAS) or the cache is full
+ */
+rtcm3_rc rtcm3_orbit_cache_add(rtcm3_orbit_cache *cache,
+                               const rtcm_msg_eph *eph,
+                               uint16_t *slot) {
+  assert(cache);
+  assert(eph);
+  assert(slot);
+  const kepler_scales *scales = get_kepler_scales(eph->constellation);
+  if (scales == NULL) {
+    return RC_INVALID_MESSAGE;
+  }
+  const ephemeris_kepler_raw_rtcm_t *k = &eph->kepler;
+  int32_t found =
+      rtcm3_orbit_cache_find(cache, eph->constellation, eph->sat_id);
+  /* toe in system time, and in GPS time for the propagation */
+  double sys_toe_s = eph->toe * scales->time_unit_s;
+  double toe_s = sys_toe_s + scales->time_offset_s;
+  uint16_t i;
+  if (found >= 0) {
+    i = (uint16_t)found;
+    if (cache->iode[i] == k->iode && cache->iodc[i] == k->iodc &&
+        cache->wn[i] == eph->wn && cache->toe_s[i] == toe_s) {
+      *slot = i;
+      return RC_OK;
+    }
+  } else {
+    if (cache->num_sats == RTCM3_ORBIT_MAX_SATS) {
+      return RC_INVALID_MESSAGE;
+    }
+    i = cache->num_sats++;
+  }
+
+  cache->constellation[i] = (uint8_t)eph->constellation;
+  cache->sat_id[i] = eph->sat_id;
+  cache->iode[i] = k->iode;
+  cache->iodc[i] = k->iodc;
+  cache->wn[i] = eph->wn;
+  cache->toe_s[i] = toe_s;
+  cache->toc_s[i] = k->toc * scales->time_unit_s + scales->time_offset_s;
+
+  double sqrta = ldexp(k->sqrta, -19);
+  double a = sqrta * sqrta;
+  double ecc = ldexp(k->ecc, -33);
+  cache->a_m[i] = a;
+  cache->n_rad_s[i] =
+      sqrt(scales->gm / (a * a * a)) + ldexp(k->dn, -43) * ORBIT_PI;
+  cache->ecc[i] = ecc;
+  cache->sqrt_1_e2[i] = sqrt(1.0 - ecc * ecc);
+  cache->m0[i] = ldexp(k->m0, -31) * ORBIT_PI;
+  cache->w[i] = ldexp(k->w, -31) * ORBIT_PI;
+  cache->omega0_toe[i] =
+      ldexp(k->omega0, -31) * ORBIT_PI - scales->omega_e * sys_toe_s;
+  bool geo = is_bds_geo(eph);
+  cache->omega_dot_e[i] =
+      ldexp(k->omegadot, -43) * ORBIT_PI - (geo ? 0.0 : scales->omega_e);
+  cache->geo_rate[i] = geo ? scales->omega_e : 0.0;
+  cache->geo_cos_tilt[i] = geo ? cos(BDS_GEO_TILT_RAD) : 1.0;
+  cache->geo_sin_tilt[i] = geo ? sin(BDS_GEO_TILT_RAD) : 0.0;
+  cache->inc[i] = ldexp(k->inc, -31) * ORBIT_PI;
+  cache->inc_dot[i] = ldexp(k->inc_dot, -43) * ORBIT_PI;
+  cache->cuc[i] = ldexp(k->cuc, scales->cu);
+  cache->cus[i] = ldexp(k->cus, scales->cu);
+  cache->crc_m[i] = ldexp(k->crc, scales->cr);
+  cache->crs_m[i] = ldexp(k->crs, scales->cr);
+  cache->cic[i] = ldexp(k->cic, scales->cu);
+  cache->cis[i] = ldexp(k->cis, scales->cu);
+
+  cache->af0[i] = ldexp(k->af0, scales->af0);
+  cache->af1[i] = ldexp(k->af1, scales->af1);
+  cache->af2[i] = ldexp(k->af2, scales->af2);
+  cache->rel_f[i] = -2.0 * sqrt(scales->gm) / (GPS_C * GPS_C) * ecc * sqrta;
+
+  cache->generation++;
+  *slot = i;
+  return RC_OK;
+}
+
+/** Evaluate the positions and clock offsets of all the satellites of a
+ * cache.
+ *
+ * The loop runs the same operations for every slot, Kepler's equation is
+ * solved with a fixed number of iterations, so it vectorizes where the
+ * compiler has vector versions of the math functions. The extra rotations
+ * of BDS GEO satellites are applied to every slot, with angles of 0 for the
+ * others.
+ *
+ * \param cache Cache to evaluate
+ * \param gps_tow_s GPS time of week in seconds
+ * \param states Set to the states of slots 0 to `cache->num_sats - 1`
+ */
+void rtcm3_orbit_cache_eval(const rtcm3_orbit_cache *cache,
+                            double gps_tow_s,
+                            rtcm3_orbit_states *states) {
+  assert(cache);
+  assert(states);
+  for (uint16_t i = 0; i < cache->num_sats; i++) {
+    double tk = wrap_week(gps_tow_s - cache->toe_s[i]);
+    double m = cache->m0[i] + cache->n_rad_s[i] * tk;
+    double e = m;
+    for (int j = 0; j < RTCM3_ORBIT_KEPLER_ITERATIONS; j++) {
+      e -= (e - cache->ecc[i] * sin(e) - m) / (1.0 - cache->ecc[i] * cos(e));
+    }
+    double sin_e = sin(e);
+    double cos_e = cos(e);
+    double v = atan2(cache->sqrt_1_e2[i] * sin_e, cos_e - cache->ecc[i]);
+
+    double phi = v + cache->w[i];
+    double sin_2phi = sin(2.0 * phi);
+    double cos_2phi = cos(2.0 * phi);
+    double u = phi + cache->cus[i] * sin_2phi + cache->cuc[i] * cos_2phi;
+    double r = cache->a_m[i] * (1.0 - cache->ecc[i] * cos_e) +
+               cache->crs_m[i] * sin_2phi + cache->crc_m[i] * cos_2phi;
+    double inc = cache->inc[i] + cache->inc_dot[i] * tk +
+                 cache->cis[i] * sin_2phi + cache->cic[i] * cos_2phi;
+    double omega = cache->omega0_toe[i] + cache->omega_dot_e[i] * tk;
+
+    double x_orb = r * cos(u);
+    double y_orb = r * sin(u);
+    double y_inc = y_orb * cos(inc);
+    double sin_omega = sin(omega);
+    double cos_omega = cos(omega);
+    double x = x_orb * cos_omega - y_inc * sin_omega;
+    double y = x_orb * sin_omega + y_inc * cos_omega;
+    double z = y_orb * sin(inc);
+
+    /* the identity except for BDS GEO slots */
+    double y_tilt = y * cache->geo_cos_tilt[i] + z * cache->geo_sin_tilt[i];
+    double sin_rot = sin(cache->geo_rate[i] * tk);
+    double cos_rot = cos(cache->geo_rate[i] * tk);
+    states->x_m[i] = x * cos_rot + y_tilt * sin_rot;
+    states->y_m[i] = y_tilt * cos_rot - x * sin_rot;
+    states->z_m[i] = z * cache->geo_cos_tilt[i] - y * cache->geo_sin_tilt[i];
+
+    double dt = wrap_week(gps_tow_s - cache->toc_s[i]);
+    states->clock_s[i] = cache->af0[i] + cache->af1[i] * dt +
+                         cache->af2[i] * dt * dt + cache->rel_f[i] * sin_e;
+  }
+}
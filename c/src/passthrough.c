@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/passthrough.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "rtcm3/bits.h"
+#include "rtcm3/msm_utils.h"
+
+/* Position of the Multiple Message Bit DF393 in an MSM payload, after the
+ * message number, station ID and 30 bits of epoch time */
+#define MSM_MULTIPLE_BIT 54
+
+/** Check whether a message carries the Reference Station ID DF003 right
+ * after the message number.
+ *
+ * \param msg_num Message number
+ * \return true for the observation, station and MSM messages
+ */
+bool rtcm3_msg_has_station_id(uint16_t msg_num) {
+  if ((msg_num >= 1001 && msg_num <= 1013) || 1029 == msg_num ||
+      1032 == msg_num || 1033 == msg_num || 1230 == msg_num) {
+    return true;
+  }
+  return MSM_UNKNOWN != to_msm_type(msg_num) &&
+         RTCM_CONSTELLATION_INVALID != to_constellation(msg_num);
+}
+
+/* Length of the payload of a complete frame, or 0 if the frame header does
+ * not match the frame length */
+static uint16_t frame_payload_len(const uint8_t frame[], uint16_t frame_len) {
+  if (frame_len < RTCM3_FRAME_OVERHEAD + 2 || RTCM3_PREAMBLE != frame[0]) {
+    return 0;
+  }
+  uint16_t payload_len = (uint16_t)(((frame[1] & 0x03) << 8) | frame[2]);
+  if (payload_len + RTCM3_FRAME_OVERHEAD != frame_len) {
+    return 0;
+  }
+  return payload_len;
+}
+
+/* Overwrite an unsigned field of the payload and recompute the CRC */
+static void patch_field(uint8_t frame[],
+                        uint16_t payload_len,
+                        uint16_t pos,
+                        uint8_t len,
+                        uint32_t data) {
+  rtcm_bitwriter writer;
+  rtcm_bitwriter_init(
+      &writer, frame + RTCM3_FRAME_HEADER_LEN, payload_len, pos);
+  rtcm_write_bitu(&writer, len, data);
+  rtcm_bitwriter_flush(&writer);
+  rtcm3_frame_finalize(frame, payload_len);
+}
+
+/** Rewrite the Reference Station ID DF003 of a frame in place.
+ *
+ * The payload is not decoded, only the field and the CRC are rewritten.
+ *
+ * \param frame Complete frame, starting with the preamble
+ * \param frame_len Length of the frame including the CRC
+ * \param stn_id New station ID, 0-4095
+ * \return true on success, false if the frame is malformed or the message
+ *         has no DF003, see rtcm3_msg_has_station_id()
+ */
+bool rtcm3_frame_set_station_id(uint8_t frame[],
+                                uint16_t frame_len,
+                                uint16_t stn_id) {
+  assert(frame);
+  uint16_t payload_len = frame_payload_len(frame, frame_len);
+  if (payload_len < 3 || stn_id > 4095) {
+    return false;
+  }
+  const uint8_t *payload = frame + RTCM3_FRAME_HEADER_LEN;
+  if (!rtcm3_msg_has_station_id(rtcm_getbitu(payload, 0, 12))) {
+    return false;
+  }
+  patch_field(frame, payload_len, 12, 12, stn_id);
+  return true;
+}
+
+/** Set or clear the MSM Multiple Message Bit DF393 of a frame in place.
+ *
+ * \param frame Complete frame, starting with the preamble
+ * \param frame_len Length of the frame including the CRC
+ * \param multiple New value of DF393
+ * \return true on success, false if the frame is malformed or not an MSM
+ */
+bool rtcm3_frame_set_msm_multiple(uint8_t frame[],
+                                  uint16_t frame_len,
+                                  bool multiple) {
+  assert(frame);
+  uint16_t payload_len = frame_payload_len(frame, frame_len);
+  if (payload_len * 8 <= MSM_MULTIPLE_BIT) {
+    return false;
+  }
+  uint16_t msg_num = rtcm_getbitu(frame + RTCM3_FRAME_HEADER_LEN, 0, 12);
+  if (MSM_UNKNOWN == to_msm_type(msg_num) ||
+      RTCM_CONSTELLATION_INVALID == to_constellation(msg_num)) {
+    return false;
+  }
+  patch_field(frame, payload_len, MSM_MULTIPLE_BIT, 1, multiple ? 1 : 0);
+  return true;
+}
+
+/** Initialize a message filter.
+ *
+ * \param filter Filter to initialize
+ * \param pass_all true to forward every message number, false to drop all
+ */
+void rtcm3_msg_filter_init(rtcm3_msg_filter *filter, bool pass_all) {
+  assert(filter);
+  memset(filter->pass, pass_all ? 0xFF : 0x00, sizeof(filter->pass));
+  filter->forwarded = 0;
+  filter->dropped = 0;
+}
+
+/** Forward or drop one message number.
+ *
+ * \param filter The filter
+ * \param msg_num Message number, 0-4095
+ * \param pass true to forward the message number
+ */
+void rtcm3_msg_filter_set(rtcm3_msg_filter *filter,
+                          uint16_t msg_num,
+                          bool pass) {
+  assert(filter);
+  assert(msg_num <= RTCM3_MAX_MSG_NUM);
+  uint8_t bit = (uint8_t)(1u << (msg_num % 8));
+  if (pass) {
+    filter->pass[msg_num / 8] |= bit;
+  } else {
+    filter->pass[msg_num / 8] &= (uint8_t)~bit;
+  }
+}
+
+/** Check whether a message number is forwarded.
+ *
+ * \param filter The filter
+ * \param msg_num Message number
+ * \return true if the filter forwards the message number
+ */
+bool rtcm3_msg_filter_passes(const rtcm3_msg_filter *filter,
+                             uint16_t msg_num) {
+  assert(filter);
+  if (msg_num > RTCM3_MAX_MSG_NUM) {
+    return false;
+  }
+  return (filter->pass[msg_num / 8] >> (msg_num % 8)) & 1;
+}
+
+/** Copy the frames that pass the filter from a framer to an output buffer.
+ *
+ * Frames are taken from the framer while the output has room for a frame
+ * of the maximum length, the payloads are not decoded. Frames too short to
+ * hold a message number are dropped.
+ *
+ * \param filter The filter
+ * \param framer Framer holding the input, see rtcm3_framer_feed()
+ * \param out Output buffer
+ * \param out_len Size of the output buffer in bytes
+ * \return Number of bytes written to out
+ */
+size_t rtcm3_msg_filter_forward(rtcm3_msg_filter *filter,
+                                rtcm3_framer *framer,
+                                uint8_t out[],
+                                size_t out_len) {
+  assert(filter);
+  assert(framer);
+  assert(out);
+  size_t pos = 0;
+  rtcm3_frame frame;
+  while (out_len - pos >= RTCM3_MAX_FRAME_LEN &&
+         rtcm3_framer_next(framer, &frame)) {
+    if (frame.payload_len < 2 ||
+        !rtcm3_msg_filter_passes(filter, frame.msg_num)) {
+      filter->dropped++;
+      continue;
+    }
+    memcpy(&out[pos], frame.frame, frame.frame_len);
+    pos += frame.frame_len;
+    filter->forwarded++;
+  }
+  return pos;
+}
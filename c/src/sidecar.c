@@ -0,0 +1,691 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/sidecar.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rtcm3/constants.h"
+
+/* Field offsets of the header */
+#define HDR_VERSION 8
+#define HDR_FLAGS 10
+#define HDR_RECORD_COUNT 12
+#define HDR_ARCHIVE_LEN 16
+#define HDR_RECORDS_OFFSET 24
+#define HDR_N_STATIONS 32
+#define HDR_N_TYPES 36
+#define HDR_STATIONS_OFFSET 40
+#define HDR_TYPES_OFFSET 48
+
+/* Field offsets of a record */
+#define REC_OFFSET 0
+#define REC_EPOCH 8
+#define REC_FRAME_LEN 16
+#define REC_MSG_NUM 18
+#define REC_STN_ID 20
+#define REC_FLAGS 22
+#define REC_TIMESCALE 23
+
+/* Field offsets of a directory group */
+#define GRP_KEY 0
+#define GRP_FIRST 4
+#define GRP_COUNT 8
+
+#define NUM_KEYS (RTCM3_MAX_MSG_NUM + 1)
+
+static void put_le(uint8_t buff[], uint64_t value, uint8_t len) {
+  for (uint8_t i = 0; i < len; i++) {
+    buff[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+static uint64_t get_le(const uint8_t buff[], uint8_t len) {
+  uint64_t value = 0;
+  for (uint8_t i = 0; i < len; i++) {
+    value |= (uint64_t)buff[i] << (8 * i);
+  }
+  return value;
+}
+
+/* Length of the week or day a time scale rolls over at */
+static int64_t period_ms(uint8_t timescale) {
+  return RTCM3_TIMESCALE_GLO == timescale ? RTCM_GLO_MAX_TOW_MS + 1
+                                          : RTCM_MAX_TOW_MS + 1;
+}
+
+/* Start of the week or day of an unwrapped epoch */
+static int64_t period_start(int64_t epoch_ms, int64_t period) {
+  int64_t rem = epoch_ms % period;
+  return epoch_ms - (rem < 0 ? rem + period : rem);
+}
+
+/* Place a time of week or day next to the latest epoch of its time scale.
+ * Only later epochs move the current week or day on, so a late message
+ * from before a rollover does not undo it. */
+static int64_t unwrap(rtcm3_sidecar_writer *writer,
+                      uint8_t timescale,
+                      int64_t tow_ms) {
+  int64_t period = period_ms(timescale);
+  if (!writer->seen[timescale]) {
+    writer->seen[timescale] = true;
+    writer->base_ms[timescale] = 0;
+    writer->last_ms[timescale] = tow_ms;
+    return tow_ms;
+  }
+  int64_t last = writer->last_ms[timescale];
+  int64_t epoch = writer->base_ms[timescale] + tow_ms;
+  if (epoch < last - period / 2) {
+    epoch += period;
+  } else if (epoch > last + period / 2) {
+    epoch -= period;
+  }
+  if (epoch > last) {
+    writer->last_ms[timescale] = epoch;
+    writer->base_ms[timescale] = epoch - tow_ms;
+  }
+  return epoch;
+}
+
+static void write_record(const rtcm3_sidecar_record *record, uint8_t buff[]) {
+  put_le(&buff[REC_OFFSET], record->offset, 8);
+  put_le(&buff[REC_EPOCH], (uint64_t)record->epoch_ms, 8);
+  put_le(&buff[REC_FRAME_LEN], record->frame_len, 2);
+  put_le(&buff[REC_MSG_NUM], record->msg_num, 2);
+  put_le(&buff[REC_STN_ID], record->stn_id, 2);
+  buff[REC_FLAGS] = record->flags;
+  buff[REC_TIMESCALE] = record->timescale;
+}
+
+static void read_record(const uint8_t buff[], rtcm3_sidecar_record *record) {
+  record->offset = get_le(&buff[REC_OFFSET], 8);
+  record->epoch_ms = (int64_t)get_le(&buff[REC_EPOCH], 8);
+  record->frame_len = (uint16_t)get_le(&buff[REC_FRAME_LEN], 2);
+  record->msg_num = (uint16_t)get_le(&buff[REC_MSG_NUM], 2);
+  record->stn_id = (uint16_t)get_le(&buff[REC_STN_ID], 2);
+  record->flags = buff[REC_FLAGS];
+  record->timescale = buff[REC_TIMESCALE];
+}
+
+static void write_header(uint8_t buff[],
+                         uint16_t flags,
+                         uint32_t record_count,
+                         uint64_t archive_len) {
+  memset(buff, 0, RTCM3_SIDECAR_HEADER_LEN);
+  memcpy(buff, RTCM3_SIDECAR_MAGIC, RTCM3_SIDECAR_MAGIC_LEN);
+  put_le(&buff[HDR_VERSION], RTCM3_SIDECAR_VERSION, 2);
+  put_le(&buff[HDR_FLAGS], flags, 2);
+  put_le(&buff[HDR_RECORD_COUNT], record_count, 4);
+  put_le(&buff[HDR_ARCHIVE_LEN], archive_len, 8);
+  put_le(&buff[HDR_RECORDS_OFFSET], RTCM3_SIDECAR_HEADER_LEN, 8);
+}
+
+/** Initialize the journal writer of a new recording.
+ *
+ * \param writer Writer to initialize
+ */
+void rtcm3_sidecar_writer_init(rtcm3_sidecar_writer *writer) {
+  assert(writer);
+  memset(writer, 0, sizeof(*writer));
+}
+
+/** Continue the journal of a recording, e.g. after a restart.
+ *
+ * The rollover state is rebuilt from the latest epoch of each time scale
+ * in the journal, so records appended afterwards line up with it.
+ *
+ * \param writer Writer to initialize
+ * \param journal Opened journal, see rtcm3_sidecar_open()
+ * \return true on success, false if the index is already sorted
+ */
+bool rtcm3_sidecar_writer_resume(rtcm3_sidecar_writer *writer,
+                                 const rtcm3_sidecar *journal) {
+  assert(writer);
+  assert(journal);
+  rtcm3_sidecar_writer_init(writer);
+  if (journal->sorted) {
+    return false;
+  }
+  rtcm3_sidecar_record record;
+  for (uint32_t i = 0; i < journal->record_count; i++) {
+    rtcm3_sidecar_record_at(journal, i, &record);
+    uint64_t end = record.offset + record.frame_len;
+    if (end > writer->archive_len) {
+      writer->archive_len = end;
+    }
+    uint8_t ts = record.timescale;
+    if (RTCM3_TIMESCALE_NONE == ts || ts > RTCM3_TIMESCALE_GLO) {
+      continue;
+    }
+    if (!writer->seen[ts] || record.epoch_ms > writer->last_ms[ts]) {
+      writer->seen[ts] = true;
+      writer->last_ms[ts] = record.epoch_ms;
+      writer->base_ms[ts] = period_start(record.epoch_ms, period_ms(ts));
+    }
+  }
+  writer->record_count = journal->record_count;
+  return true;
+}
+
+/** Write the header of a journal.
+ *
+ * The header goes at the start of the journal file. Readers take the
+ * number of records of a journal from its length, so the header only needs
+ * rewriting from time to time to keep archive_len current.
+ *
+ * \param writer Journal writer
+ * \param buff Output, RTCM3_SIDECAR_HEADER_LEN bytes
+ * \return Number of bytes written
+ */
+uint16_t rtcm3_sidecar_write_header(const rtcm3_sidecar_writer *writer,
+                                    uint8_t buff[]) {
+  assert(writer);
+  assert(buff);
+  write_header(buff, 0, writer->record_count, writer->archive_len);
+  return RTCM3_SIDECAR_HEADER_LEN;
+}
+
+/** Make the journal record of a frame as it is recorded.
+ *
+ * Times of week and day are unwrapped across rollovers with respect to the
+ * frames appended before. Times out of range for their message are kept as
+ * records without an epoch.
+ *
+ * \param writer Journal writer
+ * \param entry Frame, see rtcm3_archive_read_entry()
+ * \param buff Output, RTCM3_SIDECAR_RECORD_LEN bytes to append to the
+ *             journal
+ * \return Number of bytes written
+ */
+uint16_t rtcm3_sidecar_append(rtcm3_sidecar_writer *writer,
+                              const rtcm3_archive_entry *entry,
+                              uint8_t buff[]) {
+  assert(writer);
+  assert(entry);
+  assert(buff);
+  rtcm3_sidecar_record record;
+  memset(&record, 0, sizeof(record));
+  record.offset = entry->offset;
+  record.frame_len = entry->frame_len;
+  record.msg_num = entry->msg_num;
+  record.stn_id = entry->stn_id;
+  record.flags = entry->flags;
+  uint8_t ts;
+  uint32_t tow_ms;
+  if (rtcm3_archive_entry_time(entry, &ts, &tow_ms)) {
+    record.timescale = ts;
+    record.epoch_ms = unwrap(writer, ts, tow_ms);
+  } else {
+    record.flags &= (uint8_t)~RTCM3_ARCHIVE_HAS_TIME;
+  }
+  write_record(&record, buff);
+
+  writer->record_count++;
+  if (entry->offset + entry->frame_len > writer->archive_len) {
+    writer->archive_len = entry->offset + entry->frame_len;
+  }
+  return RTCM3_SIDECAR_RECORD_LEN;
+}
+
+/* Order of the records of a sorted index */
+static int compare_records(const void *a, const void *b) {
+  const rtcm3_sidecar_record *ra = a;
+  const rtcm3_sidecar_record *rb = b;
+  if (ra->timescale != rb->timescale) {
+    return ra->timescale < rb->timescale ? -1 : 1;
+  }
+  if (ra->epoch_ms != rb->epoch_ms) {
+    return ra->epoch_ms < rb->epoch_ms ? -1 : 1;
+  }
+  if (ra->offset != rb->offset) {
+    return ra->offset < rb->offset ? -1 : 1;
+  }
+  return 0;
+}
+
+/* Number of keys in use */
+static uint32_t count_groups(const uint32_t counts[]) {
+  uint32_t n = 0;
+  for (uint32_t key = 0; key < NUM_KEYS; key++) {
+    n += counts[key] > 0 ? 1 : 0;
+  }
+  return n;
+}
+
+/* Write the directory of a posting list set, leaving counts[key] set to the
+ * first posting of the key */
+static void write_groups(uint8_t buff[], uint32_t counts[]) {
+  uint32_t first = 0;
+  for (uint32_t key = 0; key < NUM_KEYS; key++) {
+    uint32_t count = counts[key];
+    if (0 == count) {
+      continue;
+    }
+    memset(buff, 0, RTCM3_SIDECAR_GROUP_LEN);
+    put_le(&buff[GRP_KEY], key, 2);
+    put_le(&buff[GRP_FIRST], first, 4);
+    put_le(&buff[GRP_COUNT], count, 4);
+    buff += RTCM3_SIDECAR_GROUP_LEN;
+    counts[key] = first;
+    first += count;
+  }
+}
+
+/** Upper bound of the size of a sorted index.
+ *
+ * \param record_count Number of records
+ * \return Size in bytes of the output rtcm3_sidecar_build() needs at most
+ */
+size_t rtcm3_sidecar_max_len(uint32_t record_count) {
+  size_t groups = record_count < NUM_KEYS ? record_count : NUM_KEYS;
+  return RTCM3_SIDECAR_HEADER_LEN +
+         (size_t)record_count *
+             (RTCM3_SIDECAR_RECORD_LEN + 2 * RTCM3_SIDECAR_POSTING_LEN) +
+         2 * groups * RTCM3_SIDECAR_GROUP_LEN;
+}
+
+/** Build a sorted index from the records of a journal.
+ *
+ * The records are sorted in place by time scale, epoch and offset, and
+ * written out together with the station and message type posting lists.
+ *
+ * \param builder Scratch space
+ * \param records Records, e.g. read with rtcm3_sidecar_record_at()
+ * \param record_count Number of records
+ * \param archive_len Length of the indexed archive
+ * \param out Output for the index file
+ * \param out_len Size of the output, see rtcm3_sidecar_max_len()
+ * \return Size of the index in bytes, or 0 if it does not fit in out
+ */
+size_t rtcm3_sidecar_build(rtcm3_sidecar_builder *builder,
+                           rtcm3_sidecar_record records[],
+                           uint32_t record_count,
+                           uint64_t archive_len,
+                           uint8_t out[],
+                           size_t out_len) {
+  assert(builder);
+  assert(records || 0 == record_count);
+  assert(out);
+  if (record_count > 0) {
+    qsort(records, record_count, sizeof(records[0]), compare_records);
+  }
+
+  memset(builder, 0, sizeof(*builder));
+  uint32_t n_stn_postings = 0;
+  uint32_t n_type_postings = 0;
+  for (uint32_t i = 0; i < record_count; i++) {
+    const rtcm3_sidecar_record *record = &records[i];
+    if (0 != (record->flags & RTCM3_ARCHIVE_HAS_STN_ID) &&
+        record->stn_id < NUM_KEYS) {
+      builder->stn_counts[record->stn_id]++;
+      n_stn_postings++;
+    }
+    if (record->msg_num < NUM_KEYS) {
+      builder->type_counts[record->msg_num]++;
+      n_type_postings++;
+    }
+  }
+  uint32_t n_stations = count_groups(builder->stn_counts);
+  uint32_t n_types = count_groups(builder->type_counts);
+
+  size_t stations_offset = RTCM3_SIDECAR_HEADER_LEN +
+                           (size_t)record_count * RTCM3_SIDECAR_RECORD_LEN;
+  size_t stn_postings_offset =
+      stations_offset + (size_t)n_stations * RTCM3_SIDECAR_GROUP_LEN;
+  size_t types_offset =
+      stn_postings_offset + (size_t)n_stn_postings * RTCM3_SIDECAR_POSTING_LEN;
+  size_t type_postings_offset =
+      types_offset + (size_t)n_types * RTCM3_SIDECAR_GROUP_LEN;
+  size_t len = type_postings_offset +
+               (size_t)n_type_postings * RTCM3_SIDECAR_POSTING_LEN;
+  if (len > out_len) {
+    return 0;
+  }
+
+  write_header(out, RTCM3_SIDECAR_SORTED, record_count, archive_len);
+  put_le(&out[HDR_N_STATIONS], n_stations, 4);
+  put_le(&out[HDR_N_TYPES], n_types, 4);
+  put_le(&out[HDR_STATIONS_OFFSET], stations_offset, 8);
+  put_le(&out[HDR_TYPES_OFFSET], types_offset, 8);
+  for (uint32_t i = 0; i < record_count; i++) {
+    write_record(&records[i],
+                 &out[RTCM3_SIDECAR_HEADER_LEN +
+                      (size_t)i * RTCM3_SIDECAR_RECORD_LEN]);
+  }
+
+  /* records are visited in sorted order, so each posting list is too */
+  write_groups(&out[stations_offset], builder->stn_counts);
+  write_groups(&out[types_offset], builder->type_counts);
+  for (uint32_t i = 0; i < record_count; i++) {
+    const rtcm3_sidecar_record *record = &records[i];
+    if (0 != (record->flags & RTCM3_ARCHIVE_HAS_STN_ID) &&
+        record->stn_id < NUM_KEYS) {
+      uint32_t pos = builder->stn_counts[record->stn_id]++;
+      put_le(&out[stn_postings_offset +
+                  (size_t)pos * RTCM3_SIDECAR_POSTING_LEN],
+             i,
+             4);
+    }
+    if (record->msg_num < NUM_KEYS) {
+      uint32_t pos = builder->type_counts[record->msg_num]++;
+      put_le(&out[type_postings_offset +
+                  (size_t)pos * RTCM3_SIDECAR_POSTING_LEN],
+             i,
+             4);
+    }
+  }
+  return len;
+}
+
+/** Open a sidecar index or journal held in memory.
+ *
+ * Nothing is copied, the data must stay valid while the sidecar is used.
+ * A journal may still be growing: a record cut off at its end is ignored.
+ *
+ * \param sidecar Sidecar to open
+ * \param data Index file, e.g. from rtcm3_archive_map()
+ * \param len Length of the data
+ * \return true on success, false if the data is not a valid index file
+ */
+bool rtcm3_sidecar_open(rtcm3_sidecar *sidecar,
+                        const uint8_t *data,
+                        size_t len) {
+  assert(sidecar);
+  memset(sidecar, 0, sizeof(*sidecar));
+  if (NULL == data || len < RTCM3_SIDECAR_HEADER_LEN ||
+      0 != memcmp(data, RTCM3_SIDECAR_MAGIC, RTCM3_SIDECAR_MAGIC_LEN) ||
+      RTCM3_SIDECAR_VERSION != get_le(&data[HDR_VERSION], 2)) {
+    return false;
+  }
+  uint64_t records_offset = get_le(&data[HDR_RECORDS_OFFSET], 8);
+  if (records_offset < RTCM3_SIDECAR_HEADER_LEN || records_offset > len) {
+    return false;
+  }
+  sidecar->data = data;
+  sidecar->len = len;
+  sidecar->archive_len = get_le(&data[HDR_ARCHIVE_LEN], 8);
+  sidecar->records = data + records_offset;
+  sidecar->sorted =
+      0 != (get_le(&data[HDR_FLAGS], 2) & RTCM3_SIDECAR_SORTED);
+  if (!sidecar->sorted) {
+    uint64_t count = (len - records_offset) / RTCM3_SIDECAR_RECORD_LEN;
+    sidecar->record_count = count > UINT32_MAX ? UINT32_MAX : (uint32_t)count;
+    return true;
+  }
+
+  uint64_t count = get_le(&data[HDR_RECORD_COUNT], 4);
+  uint64_t n_stations = get_le(&data[HDR_N_STATIONS], 4);
+  uint64_t n_types = get_le(&data[HDR_N_TYPES], 4);
+  uint64_t stations_offset = get_le(&data[HDR_STATIONS_OFFSET], 8);
+  uint64_t types_offset = get_le(&data[HDR_TYPES_OFFSET], 8);
+  uint64_t stn_postings_offset =
+      stations_offset + n_stations * RTCM3_SIDECAR_GROUP_LEN;
+  uint64_t type_postings_offset =
+      types_offset + n_types * RTCM3_SIDECAR_GROUP_LEN;
+  if (stations_offset > len || types_offset > len ||
+      records_offset + count * RTCM3_SIDECAR_RECORD_LEN > stations_offset ||
+      stn_postings_offset > types_offset || type_postings_offset > len) {
+    memset(sidecar, 0, sizeof(*sidecar));
+    return false;
+  }
+  sidecar->record_count = (uint32_t)count;
+  sidecar->stations = data + stations_offset;
+  sidecar->n_stations = (uint32_t)n_stations;
+  sidecar->station_postings = data + stn_postings_offset;
+  sidecar->n_station_postings = (uint32_t)(
+      (types_offset - stn_postings_offset) / RTCM3_SIDECAR_POSTING_LEN);
+  sidecar->types = data + types_offset;
+  sidecar->n_types = (uint32_t)n_types;
+  sidecar->type_postings = data + type_postings_offset;
+  sidecar->n_type_postings = (uint32_t)(
+      (len - type_postings_offset) / RTCM3_SIDECAR_POSTING_LEN);
+  return true;
+}
+
+/** Read a record of a sidecar.
+ *
+ * \param sidecar Opened sidecar
+ * \param index Record number, in sorted order for a sorted index
+ * \param record Set to the record
+ * \return true on success, false if index is out of range
+ */
+bool rtcm3_sidecar_record_at(const rtcm3_sidecar *sidecar,
+                             uint32_t index,
+                             rtcm3_sidecar_record *record) {
+  assert(sidecar);
+  assert(record);
+  if (index >= sidecar->record_count) {
+    return false;
+  }
+  read_record(&sidecar->records[(size_t)index * RTCM3_SIDECAR_RECORD_LEN],
+              record);
+  return true;
+}
+
+/* Record number of entry i of a posting list, or of the records */
+static uint32_t list_at(const uint8_t *postings, uint32_t i) {
+  if (NULL == postings) {
+    return i;
+  }
+  return (uint32_t)get_le(&postings[(size_t)i * RTCM3_SIDECAR_POSTING_LEN], 4);
+}
+
+/* Compare the sort key of a record with a time scale and epoch, records
+ * out of range compare greater */
+static int compare_key(const rtcm3_sidecar *sidecar,
+                       uint32_t index,
+                       uint8_t timescale,
+                       int64_t epoch_ms) {
+  if (index >= sidecar->record_count) {
+    return 1;
+  }
+  const uint8_t *rec =
+      &sidecar->records[(size_t)index * RTCM3_SIDECAR_RECORD_LEN];
+  if (rec[REC_TIMESCALE] != timescale) {
+    return rec[REC_TIMESCALE] < timescale ? -1 : 1;
+  }
+  int64_t epoch = (int64_t)get_le(&rec[REC_EPOCH], 8);
+  return epoch < epoch_ms ? -1 : (epoch > epoch_ms ? 1 : 0);
+}
+
+/* First entry of [lo, hi) of a list whose record key is not below (or,
+ * with after set, is above) the given key */
+static uint32_t bound(const rtcm3_sidecar *sidecar,
+                      const uint8_t *postings,
+                      uint32_t lo,
+                      uint32_t hi,
+                      uint8_t timescale,
+                      int64_t epoch_ms,
+                      bool after) {
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    int cmp = compare_key(sidecar, list_at(postings, mid), timescale, epoch_ms);
+    if (cmp < 0 || (after && 0 == cmp)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/* Find the posting list of a key in a directory */
+static bool find_group(const uint8_t *groups,
+                       uint32_t n_groups,
+                       uint32_t n_postings,
+                       uint16_t key,
+                       uint32_t *first,
+                       uint32_t *count) {
+  uint32_t lo = 0;
+  uint32_t hi = n_groups;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    const uint8_t *group = &groups[(size_t)mid * RTCM3_SIDECAR_GROUP_LEN];
+    uint16_t group_key = (uint16_t)get_le(&group[GRP_KEY], 2);
+    if (group_key < key) {
+      lo = mid + 1;
+    } else if (group_key > key) {
+      hi = mid;
+    } else {
+      *first = (uint32_t)get_le(&group[GRP_FIRST], 4);
+      *count = (uint32_t)get_le(&group[GRP_COUNT], 4);
+      return *first <= n_postings && *count <= n_postings - *first;
+    }
+  }
+  return false;
+}
+
+/* Candidate entries of a lookup */
+typedef struct {
+  const uint8_t *postings;
+  uint32_t pos;
+  uint32_t end;
+} candidates;
+
+/* Narrow candidates to the time range of a query */
+static void narrow_to_time(const rtcm3_sidecar *sidecar,
+                           const rtcm3_sidecar_query *query,
+                           candidates *list) {
+  if (RTCM3_TIMESCALE_NONE == query->timescale) {
+    return;
+  }
+  uint32_t end = list->end;
+  list->pos = bound(sidecar,
+                    list->postings,
+                    list->pos,
+                    end,
+                    query->timescale,
+                    query->epoch_min_ms,
+                    false);
+  list->end = bound(sidecar,
+                    list->postings,
+                    list->pos,
+                    end,
+                    query->timescale,
+                    query->epoch_max_ms,
+                    true);
+}
+
+/* Narrow a posting list set to one key and then to the time range, and
+ * keep it if it is shorter than best */
+static void pick_list(const rtcm3_sidecar *sidecar,
+                      const rtcm3_sidecar_query *query,
+                      const uint8_t *groups,
+                      uint32_t n_groups,
+                      const uint8_t *postings,
+                      uint32_t n_postings,
+                      uint16_t key,
+                      candidates *best) {
+  uint32_t first = 0;
+  uint32_t count = 0;
+  if (!find_group(groups, n_groups, n_postings, key, &first, &count)) {
+    best->pos = best->end = 0;
+    return;
+  }
+  candidates list = {postings, first, first + count};
+  narrow_to_time(sidecar, query, &list);
+  if (list.end - list.pos < best->end - best->pos) {
+    *best = list;
+  }
+}
+
+/** Start a lookup in a sidecar.
+ *
+ * A sorted index is searched through the shortest of the time range of
+ * the records and the posting lists of the station and message type. A
+ * journal is scanned record by record.
+ *
+ * \param sidecar Opened sidecar
+ * \param query Records to return
+ * \param cursor Set to the start of the lookup, see rtcm3_sidecar_next()
+ */
+void rtcm3_sidecar_find(const rtcm3_sidecar *sidecar,
+                        const rtcm3_sidecar_query *query,
+                        rtcm3_sidecar_cursor *cursor) {
+  assert(sidecar);
+  assert(query);
+  assert(cursor);
+  cursor->query = *query;
+  candidates best = {NULL, 0, sidecar->record_count};
+  if (sidecar->sorted) {
+    narrow_to_time(sidecar, query, &best);
+    if (query->by_station) {
+      pick_list(sidecar,
+                query,
+                sidecar->stations,
+                sidecar->n_stations,
+                sidecar->station_postings,
+                sidecar->n_station_postings,
+                query->stn_id,
+                &best);
+    }
+    if (0 != query->msg_num) {
+      pick_list(sidecar,
+                query,
+                sidecar->types,
+                sidecar->n_types,
+                sidecar->type_postings,
+                sidecar->n_type_postings,
+                query->msg_num,
+                &best);
+    }
+  }
+  cursor->postings = best.postings;
+  cursor->pos = best.pos;
+  cursor->end = best.end;
+}
+
+static bool matches(const rtcm3_sidecar_query *query,
+                    const rtcm3_sidecar_record *record) {
+  if (0 != query->msg_num && record->msg_num != query->msg_num) {
+    return false;
+  }
+  if (query->by_station &&
+      (0 == (record->flags & RTCM3_ARCHIVE_HAS_STN_ID) ||
+       record->stn_id != query->stn_id)) {
+    return false;
+  }
+  if (RTCM3_TIMESCALE_NONE != query->timescale) {
+    return record->timescale == query->timescale &&
+           record->epoch_ms >= query->epoch_min_ms &&
+           record->epoch_ms <= query->epoch_max_ms;
+  }
+  return true;
+}
+
+/** Get the next record of a lookup.
+ *
+ * Records of a sorted index come in epoch order, those of a journal in
+ * file order.
+ *
+ * \param sidecar Opened sidecar
+ * \param cursor Lookup, see rtcm3_sidecar_find()
+ * \param record Set to the next matching record
+ * \return true if a record was found, false at the end of the lookup
+ */
+bool rtcm3_sidecar_next(const rtcm3_sidecar *sidecar,
+                        rtcm3_sidecar_cursor *cursor,
+                        rtcm3_sidecar_record *record) {
+  assert(sidecar);
+  assert(cursor);
+  assert(record);
+  while (cursor->pos < cursor->end) {
+    uint32_t index = list_at(cursor->postings, cursor->pos++);
+    if (rtcm3_sidecar_record_at(sidecar, index, record) &&
+        matches(&cursor->query, record)) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -16,6 +16,8 @@
 #include "rtcm3/bits.h"
 #include "rtcm3/msm_utils.h"
 
+#include "decode_internal.h"
+
 /** Get the numbers of bits for the  Epoch Time 1s field
  * \param constellation Message constellation
  * \return Number of bits
@@ -182,10 +184,10 @@ enum rtcm3_rc_e decode_ssr_header(const uint8_t buff[],
   return RC_OK;
 }
 
-static rtcm3_rc decode_ssr_orbit(const uint8_t buff[],
-                                 uint16_t *bit,
-                                 uint8_t constellation,
-                                 rtcm_msg_ssr_orbit_corr *orbit) {
+rtcm3_rc rtcm3_decode_ssr_orbit(const uint8_t buff[],
+                                uint16_t *bit,
+                                uint8_t constellation,
+                                rtcm_msg_ssr_orbit_corr *orbit) {
   uint8_t number_of_bits_for_iode;
   if (!(RC_OK ==
         get_number_of_bits_for_iode(constellation, &number_of_bits_for_iode))) {
@@ -216,9 +218,9 @@ static rtcm3_rc decode_ssr_orbit(const uint8_t buff[],
   return RC_OK;
 }
 
-static void decode_ssr_clock(const uint8_t buff[],
-                             uint16_t *bit,
-                             rtcm_msg_ssr_clock_corr *clock) {
+void rtcm3_decode_ssr_clock(const uint8_t buff[],
+                            uint16_t *bit,
+                            rtcm_msg_ssr_clock_corr *clock) {
   clock->c0 = rtcm_getbits(buff, *bit, 22);
   *bit += 22;
   clock->c1 = rtcm_getbits(buff, *bit, 21);
@@ -227,10 +229,10 @@ static void decode_ssr_clock(const uint8_t buff[],
   *bit += 27;
 }
 
-static rtcm3_rc decode_satellite_id(const uint8_t buff[],
-                                    uint16_t *bit,
-                                    uint8_t constellation,
-                                    uint8_t *sat_id) {
+rtcm3_rc rtcm3_decode_ssr_satellite_id(const uint8_t buff[],
+                                       uint16_t *bit,
+                                       uint8_t constellation,
+                                       uint8_t *sat_id) {
   uint8_t number_of_bits_for_sat_id;
   if (!(RC_OK == get_number_of_bits_for_sat_id(constellation,
                                                &number_of_bits_for_sat_id))) {
@@ -243,6 +245,152 @@ static rtcm3_rc decode_satellite_id(const uint8_t buff[],
   return RC_OK;
 }
 
+/** Decode the satellite ID and bias count of a code bias satellite block
+ * \param buff The input data buffer
+ * \param bit Position of the satellite ID, advanced past the bias count
+ * \param constellation Message constellation
+ * \param sat_id Satellite ID
+ * \param num_code_biases Number of code biases that follow
+ * \return RC_OK, or RC_INVALID_MESSAGE for an unknown constellation
+ */
+rtcm3_rc rtcm3_decode_ssr_code_bias_sat_header(const uint8_t buff[],
+                                               uint16_t *bit,
+                                               uint8_t constellation,
+                                               uint8_t *sat_id,
+                                               uint8_t *num_code_biases) {
+  if (!(RC_OK ==
+        rtcm3_decode_ssr_satellite_id(buff, bit, constellation, sat_id))) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  *num_code_biases = rtcm_getbitu(buff, *bit, 5);
+  *bit += 5;
+  return RC_OK;
+}
+
+/** Decode the code biases of one satellite block
+ * \param buff The input data buffer
+ * \param bit Position of the first bias, advanced past the biases
+ * \param num_code_biases Number of code biases
+ * \param signals The biases, `num_code_biases` entries are written
+ */
+void rtcm3_decode_ssr_code_bias_signals(const uint8_t buff[],
+                                        uint16_t *bit,
+                                        uint8_t num_code_biases,
+                                        rtcm_msg_ssr_code_bias_sig signals[]) {
+  for (int j = 0; j < num_code_biases; j++) {
+    signals[j].signal_id = rtcm_getbitu(buff, *bit, 5);
+    *bit += 5;
+    signals[j].code_bias = rtcm_getbits(buff, *bit, 14);
+    *bit += 14;
+  }
+}
+
+/** Decode the code biases of one satellite
+ * \param buff The input data buffer
+ * \param bit Position of the satellite ID, advanced past the biases
+ * \param constellation Message constellation
+ * \param sat The biases of the satellite
+ * \return RC_OK, or RC_INVALID_MESSAGE for an unknown constellation
+ */
+rtcm3_rc rtcm3_decode_ssr_code_bias_sat(const uint8_t buff[],
+                                        uint16_t *bit,
+                                        uint8_t constellation,
+                                        rtcm_msg_ssr_code_bias_sat *sat) {
+  if (!(RC_OK == rtcm3_decode_ssr_code_bias_sat_header(buff,
+                                                       bit,
+                                                       constellation,
+                                                       &sat->sat_id,
+                                                       &sat->num_code_biases))) {
+    return RC_INVALID_MESSAGE;
+  }
+  rtcm3_decode_ssr_code_bias_signals(
+      buff, bit, sat->num_code_biases, sat->signals);
+  return RC_OK;
+}
+
+/** Decode the satellite ID, bias count and yaw of a phase bias satellite
+ * block
+ * \param buff The input data buffer
+ * \param bit Position of the satellite ID, advanced past the yaw rate
+ * \param constellation Message constellation
+ * \param sat_id Satellite ID
+ * \param num_phase_biases Number of phase biases that follow
+ * \param yaw_angle Yaw angle
+ * \param yaw_rate Yaw rate
+ * \return RC_OK, or RC_INVALID_MESSAGE for an unknown constellation
+ */
+rtcm3_rc rtcm3_decode_ssr_phase_bias_sat_header(const uint8_t buff[],
+                                                uint16_t *bit,
+                                                uint8_t constellation,
+                                                uint8_t *sat_id,
+                                                uint8_t *num_phase_biases,
+                                                uint16_t *yaw_angle,
+                                                int8_t *yaw_rate) {
+  if (!(RC_OK ==
+        rtcm3_decode_ssr_satellite_id(buff, bit, constellation, sat_id))) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  *num_phase_biases = rtcm_getbitu(buff, *bit, 5);
+  *bit += 5;
+  *yaw_angle = rtcm_getbitu(buff, *bit, 9);
+  *bit += 9;
+  *yaw_rate = rtcm_getbits(buff, *bit, 8);
+  *bit += 8;
+  return RC_OK;
+}
+
+/** Decode the phase biases of one satellite block
+ * \param buff The input data buffer
+ * \param bit Position of the first bias, advanced past the biases
+ * \param num_phase_biases Number of phase biases
+ * \param signals The biases, `num_phase_biases` entries are written
+ */
+void rtcm3_decode_ssr_phase_bias_signals(
+    const uint8_t buff[],
+    uint16_t *bit,
+    uint8_t num_phase_biases,
+    rtcm_msg_ssr_phase_bias_sig signals[]) {
+  for (int j = 0; j < num_phase_biases; j++) {
+    signals[j].signal_id = rtcm_getbitu(buff, *bit, 5);
+    *bit += 5;
+    signals[j].integer_indicator = rtcm_getbitu(buff, *bit, 1);
+    *bit += 1;
+    signals[j].widelane_indicator = rtcm_getbitu(buff, *bit, 2);
+    *bit += 2;
+    signals[j].discontinuity_indicator = rtcm_getbitu(buff, *bit, 4);
+    *bit += 4;
+    signals[j].phase_bias = rtcm_getbits(buff, *bit, 20);
+    *bit += 20;
+  }
+}
+
+/** Decode the phase biases of one satellite
+ * \param buff The input data buffer
+ * \param bit Position of the satellite ID, advanced past the biases
+ * \param constellation Message constellation
+ * \param sat The biases of the satellite
+ * \return RC_OK, or RC_INVALID_MESSAGE for an unknown constellation
+ */
+rtcm3_rc rtcm3_decode_ssr_phase_bias_sat(const uint8_t buff[],
+                                         uint16_t *bit,
+                                         uint8_t constellation,
+                                         rtcm_msg_ssr_phase_bias_sat *sat) {
+  if (!(RC_OK == rtcm3_decode_ssr_phase_bias_sat_header(buff,
+                                                        bit,
+                                                        constellation,
+                                                        &sat->sat_id,
+                                                        &sat->num_phase_biases,
+                                                        &sat->yaw_angle,
+                                                        &sat->yaw_rate))) {
+    return RC_INVALID_MESSAGE;
+  }
+  rtcm3_decode_ssr_phase_bias_signals(
+      buff, bit, sat->num_phase_biases, sat->signals);
+  return RC_OK;
+}
+
 rtcm3_rc rtcm3_decode_orbit(const uint8_t buff[], rtcm_msg_orbit *msg_orbit) {
   assert(msg_orbit);
   uint16_t bit = 0;
@@ -258,14 +406,14 @@ rtcm3_rc rtcm3_decode_orbit(const uint8_t buff[], rtcm_msg_orbit *msg_orbit) {
     rtcm_msg_ssr_orbit_corr *orbit = &msg_orbit->orbit[sat_count];
 
     uint8_t sat_id;
-    if (!(RC_OK == decode_satellite_id(
+    if (!(RC_OK == rtcm3_decode_ssr_satellite_id(
                        buff, &bit, msg_orbit->header.constellation, &sat_id))) {
       return RC_INVALID_MESSAGE;
     }
 
     orbit->sat_id = sat_id;
 
-    if (!(RC_OK == decode_ssr_orbit(
+    if (!(RC_OK == rtcm3_decode_ssr_orbit(
                        buff, &bit, msg_orbit->header.constellation, orbit))) {
       return RC_INVALID_MESSAGE;
     }
@@ -288,13 +436,13 @@ rtcm3_rc rtcm3_decode_clock(const uint8_t buff[], rtcm_msg_clock *msg_clock) {
     rtcm_msg_ssr_clock_corr *clock = &msg_clock->clock[sat_count];
 
     uint8_t sat_id;
-    if (!(RC_OK == decode_satellite_id(
+    if (!(RC_OK == rtcm3_decode_ssr_satellite_id(
                        buff, &bit, msg_clock->header.constellation, &sat_id))) {
       return RC_INVALID_MESSAGE;
     }
 
     clock->sat_id = sat_id;
-    decode_ssr_clock(buff, &bit, clock);
+    rtcm3_decode_ssr_clock(buff, &bit, clock);
   }
   return RC_OK;
 }
@@ -326,7 +474,7 @@ rtcm3_rc rtcm3_decode_orbit_clock(const uint8_t buff[],
 
     uint8_t sat_id;
     if (!(RC_OK ==
-          decode_satellite_id(
+          rtcm3_decode_ssr_satellite_id(
               buff, &bit, msg_orbit_clock->header.constellation, &sat_id))) {
       return RC_INVALID_MESSAGE;
     }
@@ -335,11 +483,11 @@ rtcm3_rc rtcm3_decode_orbit_clock(const uint8_t buff[],
     clock->sat_id = sat_id;
 
     if (!(RC_OK ==
-          decode_ssr_orbit(
+          rtcm3_decode_ssr_orbit(
               buff, &bit, msg_orbit_clock->header.constellation, orbit))) {
       return RC_INVALID_MESSAGE;
     }
-    decode_ssr_clock(buff, &bit, clock);
+    rtcm3_decode_ssr_clock(buff, &bit, clock);
   }
   return RC_OK;
 }
@@ -365,27 +513,13 @@ rtcm3_rc rtcm3_decode_code_bias(const uint8_t buff[],
   }
 
   for (int i = 0; i < msg_code_bias->header.num_sats; i++) {
-    rtcm_msg_ssr_code_bias_sat *sat = &msg_code_bias->sats[i];
-
-    uint8_t number_of_bits_for_sat_id;
     if (!(RC_OK ==
-          get_number_of_bits_for_sat_id(msg_code_bias->header.constellation,
-                                        &number_of_bits_for_sat_id))) {
+          rtcm3_decode_ssr_code_bias_sat(buff,
+                                         &bit,
+                                         msg_code_bias->header.constellation,
+                                         &msg_code_bias->sats[i]))) {
       return RC_INVALID_MESSAGE;
     }
-
-    sat->sat_id = rtcm_getbitu(buff, bit, number_of_bits_for_sat_id);
-    bit += number_of_bits_for_sat_id;
-
-    sat->num_code_biases = rtcm_getbitu(buff, bit, 5);
-    bit += 5;
-
-    for (int j = 0; j < sat->num_code_biases; j++) {
-      sat->signals[j].signal_id = rtcm_getbitu(buff, bit, 5);
-      bit += 5;
-      sat->signals[j].code_bias = rtcm_getbits(buff, bit, 14);
-      bit += 14;
-    }
   }
   return RC_OK;
 }
@@ -411,37 +545,307 @@ rtcm3_rc rtcm3_decode_phase_bias(const uint8_t buff[],
   }
 
   for (int i = 0; i < msg_phase_bias->header.num_sats; i++) {
-    rtcm_msg_ssr_phase_bias_sat *sat = &msg_phase_bias->sats[i];
-
-    uint8_t number_of_bits_for_sat_id;
     if (!(RC_OK ==
-          get_number_of_bits_for_sat_id(msg_phase_bias->header.constellation,
-                                        &number_of_bits_for_sat_id))) {
+          rtcm3_decode_ssr_phase_bias_sat(buff,
+                                          &bit,
+                                          msg_phase_bias->header.constellation,
+                                          &msg_phase_bias->sats[i]))) {
       return RC_INVALID_MESSAGE;
     }
+  }
+  return RC_OK;
+}
 
-    sat->sat_id = rtcm_getbitu(buff, bit, number_of_bits_for_sat_id);
+/** Get the number of bits in the SSR header of a message, and the number of
+ * satellites it announces
+ * \param buff The input data buffer
+ * \param len_bits Length of the payload in bits
+ * \param num_bit Number of header bits
+ * \param num_sats Number of satellites
+ * \return RC_OK, or RC_INVALID_MESSAGE if the header does not fit
+ */
+static rtcm3_rc get_ssr_header_bits(const uint8_t buff[],
+                                    uint32_t len_bits,
+                                    uint32_t *num_bit,
+                                    uint8_t *num_sats) {
+  if (len_bits < 12) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint16_t message_num = rtcm_getbitu(buff, 0, 12);
+  uint8_t number_of_bits_for_epoch_time;
+  if (!(RC_OK ==
+        get_number_of_bits_for_epoch_time(to_constellation(message_num),
+                                          &number_of_bits_for_epoch_time))) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint32_t bits = 12 + number_of_bits_for_epoch_time + 4 + 1 + 4 + 16 + 4;
+  if (is_ssr_orbit_clock_message(message_num)) {
+    bits += 1;
+  }
+  if (is_ssr_phase_biases_message(message_num)) {
+    bits += 2;
+  }
+  if (bits + 6 > len_bits) {
+    return RC_INVALID_MESSAGE;
+  }
+  *num_sats = rtcm_getbitu(buff, bits, 6);
+  *num_bit = bits + 6;
+  return RC_OK;
+}
+
+/** Check that an orbit and/or clock message fits in the payload, all the
+ * satellite blocks have the same size so this is a single comparison */
+bool rtcm3_ssr_orbit_clock_fits(const uint8_t buff[],
+                                uint16_t len,
+                                bool orbit,
+                                bool clock) {
+  uint32_t len_bits = (uint32_t)len * 8u;
+  uint32_t header_bits;
+  uint8_t num_sats;
+  if (!(RC_OK ==
+        get_ssr_header_bits(buff, len_bits, &header_bits, &num_sats))) {
+    return false;
+  }
+  rtcm_constellation_t cons = to_constellation(rtcm_getbitu(buff, 0, 12));
+  uint8_t number_of_bits_for_sat_id;
+  if (!(RC_OK ==
+        get_number_of_bits_for_sat_id(cons, &number_of_bits_for_sat_id))) {
+    return false;
+  }
+  uint32_t sat_bits = number_of_bits_for_sat_id;
+  if (orbit) {
+    uint8_t number_of_bits_for_iode;
+    if (!(RC_OK ==
+          get_number_of_bits_for_iode(cons, &number_of_bits_for_iode))) {
+      return false;
+    }
+    sat_bits += number_of_bits_for_iode + 121;
+    if (cons == RTCM_CONSTELLATION_BDS || cons == RTCM_CONSTELLATION_SBAS) {
+      sat_bits += 24;
+    }
+  }
+  if (clock) {
+    sat_bits += 70;
+  }
+  return header_bits + num_sats * sat_bits <= len_bits;
+}
+
+/** Check that a code or phase bias message fits in the payload, walking the
+ * per satellite signal counts without decoding anything else */
+bool rtcm3_ssr_bias_fits(const uint8_t buff[],
+                         uint16_t len,
+                         uint32_t sat_fixed_bits,
+                         uint32_t signal_bits) {
+  uint32_t len_bits = (uint32_t)len * 8u;
+  uint32_t bit;
+  uint8_t num_sats;
+  if (!(RC_OK == get_ssr_header_bits(buff, len_bits, &bit, &num_sats))) {
+    return false;
+  }
+  uint8_t number_of_bits_for_sat_id;
+  if (!(RC_OK ==
+        get_number_of_bits_for_sat_id(
+            to_constellation(rtcm_getbitu(buff, 0, 12)),
+            &number_of_bits_for_sat_id))) {
+    return false;
+  }
+  for (uint8_t i = 0; i < num_sats; i++) {
     bit += number_of_bits_for_sat_id;
+    if (bit + sat_fixed_bits > len_bits) {
+      return false;
+    }
+    uint8_t num_signals = rtcm_getbitu(buff, bit, 5);
+    bit += sat_fixed_bits + num_signals * signal_bits;
+  }
+  return bit <= len_bits;
+}
 
-    sat->num_phase_biases = rtcm_getbitu(buff, bit, 5);
+/** Length-bounded variant of rtcm3_decode_orbit().
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param msg_orbit RTCM message struct
+ * \return As rtcm3_decode_orbit(), or RC_INVALID_MESSAGE if the message does
+ *         not fit in the payload
+ */
+rtcm3_rc rtcm3_decode_orbit_bounded(const uint8_t buff[],
+                                    uint16_t len,
+                                    rtcm_msg_orbit *msg_orbit) {
+  if (!rtcm3_ssr_orbit_clock_fits(buff, len, true, false)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_orbit(buff, msg_orbit);
+}
+
+/** Length-bounded variant of rtcm3_decode_clock(), see
+ * rtcm3_decode_orbit_bounded() */
+rtcm3_rc rtcm3_decode_clock_bounded(const uint8_t buff[],
+                                    uint16_t len,
+                                    rtcm_msg_clock *msg_clock) {
+  if (!rtcm3_ssr_orbit_clock_fits(buff, len, false, true)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_clock(buff, msg_clock);
+}
+
+/** Length-bounded variant of rtcm3_decode_orbit_clock(), see
+ * rtcm3_decode_orbit_bounded() */
+rtcm3_rc rtcm3_decode_orbit_clock_bounded(
+    const uint8_t buff[],
+    uint16_t len,
+    rtcm_msg_orbit_clock *msg_orbit_clock) {
+  if (!rtcm3_ssr_orbit_clock_fits(buff, len, true, true)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_orbit_clock(buff, msg_orbit_clock);
+}
+
+/** Length-bounded variant of rtcm3_decode_code_bias(), see
+ * rtcm3_decode_orbit_bounded() */
+rtcm3_rc rtcm3_decode_code_bias_bounded(const uint8_t buff[],
+                                        uint16_t len,
+                                        rtcm_msg_code_bias *msg_code_bias) {
+  if (!rtcm3_ssr_bias_fits(
+          buff, len, SSR_CODE_BIAS_SAT_BITS, SSR_CODE_BIAS_SIGNAL_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_code_bias(buff, msg_code_bias);
+}
+
+/** Length-bounded variant of rtcm3_decode_phase_bias(), see
+ * rtcm3_decode_orbit_bounded() */
+rtcm3_rc rtcm3_decode_phase_bias_bounded(const uint8_t buff[],
+                                         uint16_t len,
+                                         rtcm_msg_phase_bias *msg_phase_bias) {
+  if (!rtcm3_ssr_bias_fits(
+          buff, len, SSR_PHASE_BIAS_SAT_BITS, SSR_PHASE_BIAS_SIGNAL_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  return rtcm3_decode_phase_bias(buff, msg_phase_bias);
+}
+
+/** Decode an RTCMv3 Code bias message, keeping only the selected signals.
+ *
+ * The biases of the signals in `signal_mask` are packed into the caller
+ * provided `msg->signals` array, the others are skipped without being
+ * stored. Every satellite of the message is listed, with no signals if
+ * none of its biases are selected.
+ *
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \param signal_mask Bit `1 << signal_id` set for each signal to keep
+ * \param msg RTCM message struct, `signals` and `max_signals` set by the
+ *            caller
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Message type mismatch
+ *          - RC_INVALID_MESSAGE : Unknown constellation, the message does
+ *            not fit in the payload or the kept signals do not fit in
+ *            `msg->signals`
+ */
+rtcm3_rc rtcm3_decode_code_bias_sparse(const uint8_t buff[],
+                                       uint16_t len,
+                                       uint32_t signal_mask,
+                                       rtcm_msg_code_bias_sparse *msg) {
+  assert(msg);
+  assert(msg->signals || msg->max_signals == 0);
+  if (!rtcm3_ssr_bias_fits(
+          buff, len, SSR_CODE_BIAS_SAT_BITS, SSR_CODE_BIAS_SIGNAL_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint16_t bit = 0;
+  if (!(RC_OK == decode_ssr_header(buff, &bit, &msg->header))) {
+    return RC_INVALID_MESSAGE;
+  }
+  if (!is_ssr_code_biases_message(msg->header.message_num)) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+
+  uint16_t num_signals = 0;
+  for (uint8_t i = 0; i < msg->header.num_sats; i++) {
+    msg->offsets[i] = num_signals;
+    if (!(RC_OK ==
+          rtcm3_decode_ssr_satellite_id(
+              buff, &bit, msg->header.constellation, &msg->sat_id[i]))) {
+      return RC_INVALID_MESSAGE;
+    }
+    uint8_t num_code_biases = rtcm_getbitu(buff, bit, 5);
+    bit += 5;
+    for (uint8_t j = 0; j < num_code_biases; j++) {
+      uint8_t signal_id = rtcm_getbitu(buff, bit, 5);
+      bit += 5;
+      if (!(signal_mask & (1u << signal_id))) {
+        bit += SSR_CODE_BIAS_SIGNAL_BITS - 5;
+        continue;
+      }
+      if (num_signals >= msg->max_signals) {
+        return RC_INVALID_MESSAGE;
+      }
+      rtcm_msg_ssr_code_bias_sig *sig = &msg->signals[num_signals++];
+      sig->signal_id = signal_id;
+      sig->code_bias = rtcm_getbits(buff, bit, 14);
+      bit += 14;
+    }
+  }
+  msg->offsets[msg->header.num_sats] = num_signals;
+  return RC_OK;
+}
+
+/** Decode an RTCMv3 Phase bias message, keeping only the selected signals,
+ * see rtcm3_decode_code_bias_sparse() */
+rtcm3_rc rtcm3_decode_phase_bias_sparse(const uint8_t buff[],
+                                        uint16_t len,
+                                        uint32_t signal_mask,
+                                        rtcm_msg_phase_bias_sparse *msg) {
+  assert(msg);
+  assert(msg->signals || msg->max_signals == 0);
+  if (!rtcm3_ssr_bias_fits(
+          buff, len, SSR_PHASE_BIAS_SAT_BITS, SSR_PHASE_BIAS_SIGNAL_BITS)) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint16_t bit = 0;
+  if (!(RC_OK == decode_ssr_header(buff, &bit, &msg->header))) {
+    return RC_INVALID_MESSAGE;
+  }
+  if (!is_ssr_phase_biases_message(msg->header.message_num)) {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+
+  uint16_t num_signals = 0;
+  for (uint8_t i = 0; i < msg->header.num_sats; i++) {
+    msg->offsets[i] = num_signals;
+    if (!(RC_OK ==
+          rtcm3_decode_ssr_satellite_id(
+              buff, &bit, msg->header.constellation, &msg->sat_id[i]))) {
+      return RC_INVALID_MESSAGE;
+    }
+    uint8_t num_phase_biases = rtcm_getbitu(buff, bit, 5);
     bit += 5;
-    sat->yaw_angle = rtcm_getbitu(buff, bit, 9);
+    msg->yaw_angle[i] = rtcm_getbitu(buff, bit, 9);
     bit += 9;
-    sat->yaw_rate = rtcm_getbits(buff, bit, 8);
+    msg->yaw_rate[i] = rtcm_getbits(buff, bit, 8);
     bit += 8;
-
-    for (int j = 0; j < sat->num_phase_biases; j++) {
-      sat->signals[j].signal_id = rtcm_getbitu(buff, bit, 5);
+    for (uint8_t j = 0; j < num_phase_biases; j++) {
+      uint8_t signal_id = rtcm_getbitu(buff, bit, 5);
       bit += 5;
-      sat->signals[j].integer_indicator = rtcm_getbitu(buff, bit, 1);
+      if (!(signal_mask & (1u << signal_id))) {
+        bit += SSR_PHASE_BIAS_SIGNAL_BITS - 5;
+        continue;
+      }
+      if (num_signals >= msg->max_signals) {
+        return RC_INVALID_MESSAGE;
+      }
+      rtcm_msg_ssr_phase_bias_sig *sig = &msg->signals[num_signals++];
+      sig->signal_id = signal_id;
+      sig->integer_indicator = rtcm_getbitu(buff, bit, 1);
       bit += 1;
-      sat->signals[j].widelane_indicator = rtcm_getbitu(buff, bit, 2);
+      sig->widelane_indicator = rtcm_getbitu(buff, bit, 2);
       bit += 2;
-      sat->signals[j].discontinuity_indicator = rtcm_getbitu(buff, bit, 4);
+      sig->discontinuity_indicator = rtcm_getbitu(buff, bit, 4);
       bit += 4;
-      sat->signals[j].phase_bias = rtcm_getbits(buff, bit, 20);
+      sig->phase_bias = rtcm_getbits(buff, bit, 20);
       bit += 20;
     }
   }
+  msg->offsets[msg->header.num_sats] = num_signals;
   return RC_OK;
 }
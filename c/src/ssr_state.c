@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/ssr_state.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "rtcm3/bits.h"
+
+#include "decode_internal.h"
+
+/** Initialize an SSR correction store over caller owned solution slots.
+ *
+ * Every combination of constellation, SSR provider ID and SSR solution ID
+ * seen by rtcm3_ssr_state_update() takes one slot. The store is not thread
+ * safe.
+ *
+ * \param state Store to initialize
+ * \param solutions Storage for the solutions
+ * \param num_solutions Number of elements in `solutions`
+ */
+void rtcm3_ssr_state_init(rtcm3_ssr_state *state,
+                          rtcm_ssr_solution *solutions,
+                          uint16_t num_solutions) {
+  assert(state);
+  assert(solutions || num_solutions == 0);
+  memset(solutions, 0, num_solutions * sizeof(*solutions));
+  state->solutions = solutions;
+  state->num_solutions = num_solutions;
+  state->generation = 0;
+}
+
+static bool solution_matches(const rtcm_ssr_solution *solution,
+                             uint8_t constellation,
+                             uint16_t ssr_provider_id,
+                             uint16_t ssr_solution_id) {
+  return solution->used && solution->constellation == constellation &&
+         solution->ssr_provider_id == ssr_provider_id &&
+         solution->ssr_solution_id == ssr_solution_id;
+}
+
+/** Find the solution of a message header, taking a free slot for a new one
+ * \return The solution, or NULL if all the slots are taken
+ */
+static rtcm_ssr_solution *get_solution(rtcm3_ssr_state *state,
+                                       const rtcm_msg_ssr_header *header) {
+  rtcm_ssr_solution *free_slot = NULL;
+  for (uint16_t i = 0; i < state->num_solutions; i++) {
+    rtcm_ssr_solution *solution = &state->solutions[i];
+    if (solution_matches(solution,
+                         header->constellation,
+                         header->ssr_provider_id,
+                         header->ssr_solution_id)) {
+      return solution;
+    }
+    if (!solution->used && free_slot == NULL) {
+      free_slot = solution;
+    }
+  }
+  if (free_slot != NULL) {
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->used = true;
+    free_slot->constellation = header->constellation;
+    free_slot->ssr_provider_id = header->ssr_provider_id;
+    free_slot->ssr_solution_id = header->ssr_solution_id;
+  }
+  return free_slot;
+}
+
+/** Record a message of the given correction type. A change of IOD SSR
+ * invalidates all the records of the type, they refer to another set of
+ * corrections.
+ * \return true if any satellite record was dropped
+ */
+static bool start_message(rtcm_ssr_solution *solution,
+                          rtcm_ssr_type type,
+                          const rtcm_msg_ssr_header *header,
+                          uint32_t generation) {
+  rtcm_ssr_type_state *type_state = &solution->types[type];
+  bool changed = false;
+  if (type_state->valid && type_state->iod_ssr != header->iod_ssr) {
+    uint8_t type_bit = (uint8_t)(1u << type);
+    for (uint8_t i = 0; i < MAX_SSR_SATELLITES; i++) {
+      rtcm_ssr_sat_state *sat = &solution->sats[i];
+      if (sat->valid & type_bit) {
+        sat->valid &= (uint8_t)~type_bit;
+        sat->generation = generation;
+        changed = true;
+      }
+    }
+  }
+  type_state->valid = true;
+  type_state->complete = !header->multi_message;
+  type_state->epoch_time = header->epoch_time;
+  type_state->update_interval = header->update_interval;
+  type_state->iod_ssr = header->iod_ssr;
+  return changed;
+}
+
+/** Store one satellite record, leaving the satellite generation untouched
+ * if the record is unchanged
+ * \return true if the record changed
+ */
+static bool store_record(rtcm_ssr_sat_state *sat,
+                         rtcm_ssr_type type,
+                         void *record,
+                         const void *update,
+                         size_t size,
+                         uint32_t epoch_time,
+                         uint32_t generation) {
+  uint8_t type_bit = (uint8_t)(1u << type);
+  sat->epoch_time[type] = epoch_time;
+  if ((sat->valid & type_bit) && memcmp(record, update, size) == 0) {
+    return false;
+  }
+  memcpy(record, update, size);
+  sat->valid |= type_bit;
+  sat->generation = generation;
+  return true;
+}
+
+static rtcm3_rc update_orbit_clock(rtcm_ssr_solution *solution,
+                                   const uint8_t buff[],
+                                   uint16_t bit,
+                                   const rtcm_msg_ssr_header *header,
+                                   bool orbit,
+                                   bool clock,
+                                   uint32_t generation,
+                                   bool *changed) {
+  for (uint8_t i = 0; i < header->num_sats; i++) {
+    uint8_t sat_id;
+    if (!(RC_OK == rtcm3_decode_ssr_satellite_id(
+                       buff, &bit, header->constellation, &sat_id))) {
+      return RC_INVALID_MESSAGE;
+    }
+    assert(sat_id < MAX_SSR_SATELLITES);
+    rtcm_ssr_sat_state *sat = &solution->sats[sat_id];
+
+    /* cleared so that fields not in the message compare equal */
+    rtcm_msg_ssr_orbit_corr orbit_corr;
+    rtcm_msg_ssr_clock_corr clock_corr;
+    memset(&orbit_corr, 0, sizeof(orbit_corr));
+    memset(&clock_corr, 0, sizeof(clock_corr));
+    orbit_corr.sat_id = sat_id;
+    clock_corr.sat_id = sat_id;
+
+    if (orbit) {
+      if (!(RC_OK == rtcm3_decode_ssr_orbit(
+                         buff, &bit, header->constellation, &orbit_corr))) {
+        return RC_INVALID_MESSAGE;
+      }
+      *changed |= store_record(sat,
+                               RTCM_SSR_ORBIT,
+                               &sat->orbit,
+                               &orbit_corr,
+                               sizeof(orbit_corr),
+                               header->epoch_time,
+                               generation);
+    }
+    if (clock) {
+      rtcm3_decode_ssr_clock(buff, &bit, &clock_corr);
+      *changed |= store_record(sat,
+                               RTCM_SSR_CLOCK,
+                               &sat->clock,
+                               &clock_corr,
+                               sizeof(clock_corr),
+                               header->epoch_time,
+                               generation);
+    }
+  }
+  return RC_OK;
+}
+
+static rtcm3_rc update_code_bias(rtcm_ssr_solution *solution,
+                                 const uint8_t buff[],
+                                 uint16_t bit,
+                                 const rtcm_msg_ssr_header *header,
+                                 uint32_t generation,
+                                 bool *changed) {
+  for (uint8_t i = 0; i < header->num_sats; i++) {
+    rtcm_msg_ssr_code_bias_sat bias;
+    memset(&bias, 0, sizeof(bias));
+    if (!(RC_OK == rtcm3_decode_ssr_code_bias_sat(
+                       buff, &bit, header->constellation, &bias))) {
+      return RC_INVALID_MESSAGE;
+    }
+    assert(bias.sat_id < MAX_SSR_SATELLITES);
+    rtcm_ssr_sat_state *sat = &solution->sats[bias.sat_id];
+    *changed |= store_record(sat,
+                             RTCM_SSR_CODE_BIAS,
+                             &sat->code_bias,
+                             &bias,
+                             sizeof(bias),
+                             header->epoch_time,
+                             generation);
+  }
+  return RC_OK;
+}
+
+static rtcm3_rc update_phase_bias(rtcm_ssr_solution *solution,
+                                  const uint8_t buff[],
+                                  uint16_t bit,
+                                  const rtcm_msg_ssr_header *header,
+                                  uint32_t generation,
+                                  bool *changed) {
+  for (uint8_t i = 0; i < header->num_sats; i++) {
+    rtcm_msg_ssr_phase_bias_sat bias;
+    memset(&bias, 0, sizeof(bias));
+    if (!(RC_OK == rtcm3_decode_ssr_phase_bias_sat(
+                       buff, &bit, header->constellation, &bias))) {
+      return RC_INVALID_MESSAGE;
+    }
+    assert(bias.sat_id < MAX_SSR_SATELLITES);
+    rtcm_ssr_sat_state *sat = &solution->sats[bias.sat_id];
+    *changed |= store_record(sat,
+                             RTCM_SSR_PHASE_BIAS,
+                             &sat->phase_bias,
+                             &bias,
+                             sizeof(bias),
+                             header->epoch_time,
+                             generation);
+  }
+  return RC_OK;
+}
+
+/** Merge an SSR orbit, clock, combined orbit and clock, code bias or phase
+ * bias message into the store.
+ *
+ * Satellite records are updated in place. The records of satellites left
+ * out of a message are kept, so the messages of a multi-message sequence
+ * fill in the solution one by one; the type state is marked complete once
+ * the last message of the sequence has been merged. A change of IOD SSR
+ * drops the records of the previous IOD before the new ones are stored.
+ *
+ * Every update that changes, adds or drops a record increments the store
+ * generation, and the changed satellites and their solution take the new
+ * value. Consumers can compare generations against the last value they saw
+ * to recompute only the satellites that changed.
+ *
+ * \param state Store to update
+ * \param buff The input data buffer
+ * \param len Length of the payload in bytes
+ * \return  - RC_OK : Success
+ *          - RC_MESSAGE_TYPE_MISMATCH : Not an SSR message
+ *          - RC_INVALID_MESSAGE : The message does not fit in the payload
+ *            or all the solution slots are taken
+ */
+rtcm3_rc rtcm3_ssr_state_update(rtcm3_ssr_state *state,
+                                const uint8_t buff[],
+                                uint16_t len) {
+  assert(state);
+  assert(buff);
+  if (len < 2) {
+    return RC_INVALID_MESSAGE;
+  }
+  uint16_t message_num = rtcm_getbitu(buff, 0, 12);
+  bool orbit = is_ssr_orbit_message(message_num) ||
+               is_ssr_orbit_clock_message(message_num);
+  bool clock = is_ssr_clock_message(message_num) ||
+               is_ssr_orbit_clock_message(message_num);
+  bool code_bias = is_ssr_code_biases_message(message_num);
+  bool phase_bias = is_ssr_phase_biases_message(message_num);
+
+  bool fits;
+  if (orbit || clock) {
+    fits = rtcm3_ssr_orbit_clock_fits(buff, len, orbit, clock);
+  } else if (code_bias) {
+    fits = rtcm3_ssr_bias_fits(
+        buff, len, SSR_CODE_BIAS_SAT_BITS, SSR_CODE_BIAS_SIGNAL_BITS);
+  } else if (phase_bias) {
+    fits = rtcm3_ssr_bias_fits(
+        buff, len, SSR_PHASE_BIAS_SAT_BITS, SSR_PHASE_BIAS_SIGNAL_BITS);
+  } else {
+    return RC_MESSAGE_TYPE_MISMATCH;
+  }
+  if (!fits) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  rtcm_msg_ssr_header header;
+  memset(&header, 0, sizeof(header));
+  uint16_t bit = 0;
+  if (!(RC_OK == decode_ssr_header(buff, &bit, &header))) {
+    return RC_INVALID_MESSAGE;
+  }
+  rtcm_ssr_solution *solution = get_solution(state, &header);
+  if (solution == NULL) {
+    return RC_INVALID_MESSAGE;
+  }
+
+  uint32_t generation = state->generation + 1;
+  bool changed = false;
+  rtcm3_rc ret;
+  if (orbit || clock) {
+    if (orbit) {
+      changed |= start_message(solution, RTCM_SSR_ORBIT, &header, generation);
+    }
+    if (clock) {
+      changed |= start_message(solution, RTCM_SSR_CLOCK, &header, generation);
+    }
+    ret = update_orbit_clock(
+        solution, buff, bit, &header, orbit, clock, generation, &changed);
+  } else if (code_bias) {
+    changed |=
+        start_message(solution, RTCM_SSR_CODE_BIAS, &header, generation);
+    ret = update_code_bias(solution, buff, bit, &header, generation, &changed);
+  } else {
+    changed |=
+        start_message(solution, RTCM_SSR_PHASE_BIAS, &header, generation);
+    ret =
+        update_phase_bias(solution, buff, bit, &header, generation, &changed);
+  }
+
+  if (changed) {
+    solution->generation = generation;
+    state->generation = generation;
+  }
+  return ret;
+}
+
+/** Look up the corrections of one provider solution
+ * \param state Store to search
+ * \param constellation Constellation of the corrections
+ * \param ssr_provider_id SSR provider ID DF414
+ * \param ssr_solution_id SSR solution ID DF415
+ * \return The solution, or NULL if no message of it has been merged
+ */
+const rtcm_ssr_solution *rtcm3_ssr_state_find(const rtcm3_ssr_state *state,
+                                              uint8_t constellation,
+                                              uint16_t ssr_provider_id,
+                                              uint16_t ssr_solution_id) {
+  assert(state);
+  for (uint16_t i = 0; i < state->num_solutions; i++) {
+    if (solution_matches(&state->solutions[i],
+                         constellation,
+                         ssr_provider_id,
+                         ssr_solution_id)) {
+      return &state->solutions[i];
+    }
+  }
+  return NULL;
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "rtcm3/stats.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "rtcm3/bits.h"
+
+/** Initialize the counters of one thread.
+ *
+ * \param stats The counters
+ * \param clock Time source for the latency histograms, NULL to count only
+ * \param sample_interval Time one call in this many, 0 to count only
+ */
+void rtcm3_stats_init(rtcm3_stats *stats,
+                      rtcm3_stats_clock clock,
+                      uint32_t sample_interval) {
+  assert(stats);
+  memset(stats, 0, sizeof(*stats));
+  stats->clock = clock;
+  stats->sample_interval = NULL == clock ? 0 : sample_interval;
+  stats->until_sample = stats->sample_interval;
+}
+
+/** Get the counter slot of a message number.
+ *
+ * \param msg_num Message number DF002
+ * \return Index into rtcm3_stats.decode and rtcm3_stats.encode
+ */
+uint16_t rtcm3_stats_slot(uint16_t msg_num) {
+  if (msg_num >= RTCM3_STATS_FIRST_MSG && msg_num <= RTCM3_STATS_LAST_MSG) {
+    return msg_num - RTCM3_STATS_FIRST_MSG;
+  }
+  switch (msg_num) {
+    case 999:
+      return RTCM3_STATS_SLOT_999;
+    case 4062:
+      return RTCM3_STATS_SLOT_4062;
+    default:
+      return RTCM3_STATS_SLOT_OTHER;
+  }
+}
+
+/** Get the message number counted in a slot.
+ *
+ * \param slot Index into rtcm3_stats.decode and rtcm3_stats.encode
+ * \return The message number, or 0 for RTCM3_STATS_SLOT_OTHER
+ */
+uint16_t rtcm3_stats_slot_msg_num(uint16_t slot) {
+  assert(slot < RTCM3_STATS_NUM_SLOTS);
+  if (slot < RTCM3_STATS_SLOT_999) {
+    return RTCM3_STATS_FIRST_MSG + slot;
+  }
+  if (RTCM3_STATS_SLOT_999 == slot) {
+    return 999;
+  }
+  if (RTCM3_STATS_SLOT_4062 == slot) {
+    return 4062;
+  }
+  return 0;
+}
+
+/** Start timing a call if it is one of the sampled ones */
+static bool sample_start(rtcm3_stats *stats, uint64_t *start) {
+  if (0 == stats->sample_interval || --stats->until_sample > 0) {
+    return false;
+  }
+  stats->until_sample = stats->sample_interval;
+  *start = stats->clock();
+  return true;
+}
+
+static void sample_end(rtcm3_stats *stats,
+                       rtcm3_msg_counters *counters,
+                       uint64_t start) {
+  uint64_t ticks = stats->clock() - start;
+  counters->samples++;
+  counters->ticks += ticks;
+  uint8_t bucket = 0;
+  while (ticks > 1 && bucket < RTCM3_STATS_HIST_BUCKETS - 1) {
+    ticks >>= 1;
+    bucket++;
+  }
+  counters->hist[bucket]++;
+}
+
+static void count_rc(rtcm3_msg_counters *counters, rtcm3_rc ret) {
+  switch (ret) {
+    case RC_OK:
+      break;
+    case RC_MESSAGE_TYPE_MISMATCH:
+      counters->mismatches++;
+      break;
+    case RC_INVALID_MESSAGE:
+      counters->invalid++;
+      break;
+    default:
+      assert(!"unknown return code");
+      break;
+  }
+}
+
+/** Decode any supported RTCMv3 message with rtcm3_decode_frame(), counting
+ * it in the decode counters of its message number.
+ *
+ * \param stats Counters of the calling thread
+ * \param payload The message payload starting at DF002
+ * \param len Length of the payload in bytes
+ * \param msg The decoded message
+ * \return As rtcm3_decode_frame()
+ */
+rtcm3_rc rtcm3_decode_frame_counted(rtcm3_stats *stats,
+                                    const uint8_t payload[],
+                                    uint16_t len,
+                                    rtcm3_any_msg *msg) {
+  assert(stats);
+  uint16_t msg_num = len >= 2 ? rtcm_getbitu(payload, 0, 12) : 0;
+  rtcm3_msg_counters *counters = &stats->decode[rtcm3_stats_slot(msg_num)];
+  uint64_t start = 0;
+  bool timed = sample_start(stats, &start);
+  rtcm3_rc ret = rtcm3_decode_frame(payload, len, msg);
+  if (timed) {
+    sample_end(stats, counters, start);
+  }
+  counters->messages++;
+  counters->bytes += len;
+  count_rc(counters, ret);
+  return ret;
+}
+
+/** Encode a message payload, counting it in the encode counters of its
+ * message number. A failed encode is counted as a mismatch.
+ *
+ * \param stats Counters of the calling thread
+ * \param msg_num Message number the encoder produces
+ * \param encode The encoder, e.g. a wrapper around rtcm3_encode_msm7()
+ * \param msg Message passed to the encoder
+ * \param buff Output buffer passed to the encoder
+ * \return Length of the payload, or 0 on failure
+ */
+uint16_t rtcm3_encode_counted(rtcm3_stats *stats,
+                              uint16_t msg_num,
+                              rtcm3_stats_encoder encode,
+                              const void *msg,
+                              uint8_t buff[]) {
+  assert(stats);
+  assert(encode);
+  rtcm3_msg_counters *counters = &stats->encode[rtcm3_stats_slot(msg_num)];
+  uint64_t start = 0;
+  bool timed = sample_start(stats, &start);
+  uint16_t len = encode(msg, buff);
+  if (timed) {
+    sample_end(stats, counters, start);
+  }
+  counters->messages++;
+  counters->bytes += len;
+  if (0 == len) {
+    counters->mismatches++;
+  }
+  return len;
+}
+
+static void merge_counters(rtcm3_msg_counters *total,
+                           const rtcm3_msg_counters *counters) {
+  total->messages += counters->messages;
+  total->bytes += counters->bytes;
+  total->mismatches += counters->mismatches;
+  total->invalid += counters->invalid;
+  total->samples += counters->samples;
+  total->ticks += counters->ticks;
+  for (uint8_t i = 0; i < RTCM3_STATS_HIST_BUCKETS; i++) {
+    total->hist[i] += counters->hist[i];
+  }
+}
+
+/** Add the counters of one thread to a snapshot. Call it from the thread
+ * owning `stats`, or while that thread is stopped, e.g. each worker merging
+ * into a snapshot under the exporter's lock between epochs.
+ *
+ * \param total The snapshot, e.g. cleared with rtcm3_stats_init()
+ * \param stats Counters of one thread
+ */
+void rtcm3_stats_merge(rtcm3_stats *total, const rtcm3_stats *stats) {
+  assert(total);
+  assert(stats);
+  for (uint16_t i = 0; i < RTCM3_STATS_NUM_SLOTS; i++) {
+    merge_counters(&total->decode[i], &stats->decode[i]);
+    merge_counters(&total->encode[i], &stats->encode[i]);
+  }
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "rtcm3/encode.h"
+#include "rtcm3/framer.h"
+#include "rtcm3/ingest.h"
+
+#define NUM_STREAMS 3
+#define BUFF_LEN 4096
+#define FRAMES 50
+
+static rtcm3_ingest ingest;
+static rtcm3_ingest_stream streams[NUM_STREAMS];
+static uint8_t buffers[NUM_STREAMS * BUFF_LEN];
+
+static uint16_t next_stn[NUM_STREAMS];
+static bool ended[NUM_STREAMS];
+static bool decoded = true;
+
+static void on_frame(void *context,
+                     uint32_t stream,
+                     const rtcm3_frame *frame,
+                     const rtcm3_any_msg *msg,
+                     rtcm3_rc rc) {
+  assert(&ingest == context);
+  assert(stream < NUM_STREAMS);
+  if (NULL == frame) {
+    assert(!ended[stream]);
+    ended[stream] = true;
+    return;
+  }
+  assert(1005 == frame->msg_num && RC_OK == rc);
+  /* frames are views into the stream's buffer or its framer */
+  assert((frame->frame >= streams[stream].buff &&
+          frame->frame < streams[stream].buff + BUFF_LEN) ||
+         frame->frame == streams[stream].framer.partial);
+  if (decoded) {
+    assert(NULL != msg && next_stn[stream] == msg->msg.msg_1005.stn_id);
+  } else {
+    assert(NULL == msg);
+  }
+  next_stn[stream]++;
+}
+
+static uint16_t write_1005_frame(uint8_t frame[], uint16_t stn_id) {
+  rtcm_msg_1005 msg_1005;
+  memset(&msg_1005, 0, sizeof(msg_1005));
+  msg_1005.stn_id = stn_id;
+  msg_1005.arp_x = 3573346.6114;
+  uint16_t payload_len =
+      rtcm3_encode_1005(&msg_1005, frame + RTCM3_FRAME_HEADER_LEN);
+  return rtcm3_frame_finalize(frame, payload_len);
+}
+
+static void poll_until(bool (*done)(void)) {
+  for (int i = 0; i < 1000 && !done(); i++) {
+    assert(rtcm3_ingest_poll(&ingest, 10) >= 0);
+  }
+  assert(done());
+}
+
+static bool all_received(void) {
+  for (int i = 0; i < NUM_STREAMS; i++) {
+    if (next_stn[i] < FRAMES) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool stream_ended(void) { return ended[0]; }
+
+static void test_ingest(uint32_t flags) {
+  decoded = 0 == (flags & RTCM3_INGEST_NO_DECODE);
+  memset(next_stn, 0, sizeof(next_stn));
+  memset(ended, 0, sizeof(ended));
+  assert(rtcm3_ingest_init(&ingest,
+                           streams,
+                           NUM_STREAMS,
+                           buffers,
+                           BUFF_LEN,
+                           flags,
+                           on_frame,
+                           &ingest));
+  assert((0 != (flags & RTCM3_INGEST_NO_URING)) ==
+         (RTCM3_INGEST_EPOLL == ingest.backend));
+
+  /* two byte streams and a datagram socket */
+  int fds[NUM_STREAMS][2];
+  for (uint32_t i = 0; i < NUM_STREAMS; i++) {
+    int type = 2 == i ? SOCK_DGRAM : SOCK_STREAM;
+    assert(0 == socketpair(AF_UNIX, type, 0, fds[i]));
+    assert(rtcm3_ingest_add(&ingest, i, fds[i][0]));
+    assert(!rtcm3_ingest_add(&ingest, i, fds[i][0]));
+  }
+  assert(streams[2].datagram && !streams[0].datagram);
+
+  /* frames split at odd places on the byte streams, one per datagram */
+  uint8_t frame[RTCM3_MAX_FRAME_LEN];
+  for (uint16_t n = 0; n < FRAMES; n++) {
+    uint16_t len = write_1005_frame(frame, n);
+    uint16_t split = n % len;
+    for (uint32_t i = 0; i < 2; i++) {
+      assert(split == write(fds[i][1], frame, split));
+      assert(len - split == write(fds[i][1], frame + split, len - split));
+    }
+    assert(len == write(fds[2][1], frame, len));
+    if (0 == n % 10) {
+      assert(rtcm3_ingest_poll(&ingest, 0) >= 0);
+    }
+  }
+  poll_until(all_received);
+
+  /* a closed peer ends the stream */
+  close(fds[0][1]);
+  poll_until(stream_ended);
+  assert(!streams[0].active && 0 == streams[0].error);
+
+  /* a removed stream delivers nothing more */
+  rtcm3_ingest_remove(&ingest, 1);
+  uint16_t len = write_1005_frame(frame, FRAMES);
+  assert(len == write(fds[1][1], frame, len));
+  for (int i = 0; i < 5; i++) {
+    assert(rtcm3_ingest_poll(&ingest, 1) >= 0);
+  }
+  assert(FRAMES == next_stn[1] && !ended[1]);
+
+  for (uint32_t i = 0; i < NUM_STREAMS; i++) {
+    close(fds[i][0]);
+    if (0 != i) {
+      close(fds[i][1]);
+    }
+  }
+  assert(ingest.syscalls > 0);
+  rtcm3_ingest_deinit(&ingest);
+}
+
+int main(void) {
+  test_ingest(0);
+  test_ingest(RTCM3_INGEST_NO_DECODE);
+  test_ingest(RTCM3_INGEST_NO_URING);
+  test_ingest(RTCM3_INGEST_NO_URING | RTCM3_INGEST_NO_DECODE);
+}
@@ -0,0 +1,1027 @@
+/*
+ * Copyright (C) 2018 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "rtcm3/archive.h"
+#include "rtcm3/bits.h"
+#include "rtcm3/crc24q.h"
+#include "rtcm3/decode.h"
+#include "rtcm3/encode.h"
+#include "rtcm3/engine.h"
+#include "rtcm3/fanout.h"
+#include "rtcm3/framer.h"
+#include "rtcm3/logging.h"
+#include "rtcm3/passthrough.h"
+#include "rtcm3/sidecar.h"
+
+/* MT 999 firmware version and RF status frames captured from a receiver */
+static const uint8_t fw_ver_frame[] = {
+    0xD3, 0x00, 0x1A, 0x3E, 0x71, 0x91, 0x64, 0x74, 0xE5, 0x35, 0x34,
+    0xC4, 0x94, 0x25, 0xF3, 0x92, 0xE3, 0x32, 0xE3, 0x02, 0xE3, 0x05,
+    0xF5, 0x24, 0x35, 0xF4, 0x15, 0x24, 0xD0, 0x43, 0xB8, 0xC9};
+
+static const uint8_t rf_status_frames[] = {
+    0xD3, 0x00, 0x32, 0x3E, 0x71, 0x86, 0x91, 0x4A, 0x47, 0xC7, 0xFC, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x03, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0xD4, 0x00, 0x00, 0x30, 0xD4,
+    0x00, 0x00, 0x30, 0xD4, 0x00, 0x00, 0x30, 0xD4, 0x00, 0x00, 0x30, 0xD4,
+    0x00, 0x00, 0x30, 0xD4, 0x00, 0x09, 0xFB, 0xB1, 0xD3, 0x00, 0x10, 0x3E,
+    0x71, 0xA0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0xF0, 0xFE, 0x9C, 0x87, 0xD2, 0xD3, 0x00, 0x10, 0x3E, 0x71, 0xA0,
+    0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xF0,
+    0xFE, 0x50, 0x2A, 0x81, 0xD3, 0x00, 0x10, 0x3E, 0x71, 0xA0, 0x00, 0x00,
+    0x00, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xF0, 0xFE, 0xF5,
+    0x5A, 0x55};
+
+#define MAX_TEST_FRAMES 64
+#define STREAM_SIZE (MAX_TEST_FRAMES * (RTCM3_MAX_FRAME_LEN + 16))
+
+typedef struct {
+  size_t offset;
+  uint16_t len;
+} frame_loc;
+
+static uint8_t stream[STREAM_SIZE];
+
+/* bit at a time reference implementation */
+static uint32_t crc24q_reference(const uint8_t *buff, size_t len) {
+  uint32_t crc = 0;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint32_t)buff[i] << 16;
+    for (uint8_t j = 0; j < 8; j++) {
+      crc <<= 1;
+      if (crc & 0x1000000) {
+        crc ^= 0x1864CFB;
+      }
+    }
+  }
+  return crc & 0xFFFFFF;
+}
+
+static void test_crc24q(void) {
+  /* check value of the CRC-24Q catalogue entry */
+  const uint8_t check[] = "123456789";
+  assert(rtcm3_crc24q(check, 9, RTCM3_CRC24Q_INIT) == 0xCDE703);
+
+  uint8_t buff[256];
+  srand(1);
+  for (size_t i = 0; i < sizeof(buff); i++) {
+    buff[i] = (uint8_t)rand();
+  }
+  for (size_t len = 0; len <= sizeof(buff); len++) {
+    uint32_t expected = crc24q_reference(buff, len);
+    assert(rtcm3_crc24q(buff, len, RTCM3_CRC24Q_INIT) == expected);
+    /* continuing a calculation must give the same result */
+    size_t split = len / 3;
+    uint32_t crc = rtcm3_crc24q(buff, split, RTCM3_CRC24Q_INIT);
+    assert(rtcm3_crc24q(buff + split, len - split, crc) == expected);
+  }
+}
+
+/* the dispatched implementation must match the tables for every length and
+ * alignment, whichever implementation the CPU selects */
+static void test_crc24q_dispatch(void) {
+  printf("CRC-24Q hardware acceleration: %s\n",
+         rtcm3_crc24q_accelerated() ? "yes" : "no");
+  static uint8_t buff[2 * RTCM3_MAX_FRAME_LEN + 16];
+  srand(4);
+  for (size_t i = 0; i < sizeof(buff); i++) {
+    buff[i] = (uint8_t)rand();
+  }
+  for (size_t offset = 0; offset < 16; offset++) {
+    for (size_t len = 0; len + offset <= sizeof(buff); len += 1 + len / 64) {
+      uint32_t init = (uint32_t)rand() & 0xFFFFFF;
+      assert(rtcm3_crc24q(buff + offset, len, init) ==
+             rtcm3_crc24q_table(buff + offset, len, init));
+    }
+  }
+  assert(rtcm3_crc24q(buff, sizeof(buff), RTCM3_CRC24Q_INIT) ==
+         crc24q_reference(buff, sizeof(buff)));
+}
+
+static void test_frame_finalize(void) {
+  rtcm_msg_1005 msg_1005;
+  memset(&msg_1005, 0, sizeof(msg_1005));
+  msg_1005.stn_id = 7;
+  msg_1005.arp_x = 3573346.6114;
+  msg_1005.arp_y = 1.2;
+  msg_1005.arp_z = -3.4;
+
+  uint8_t frame[RTCM3_MAX_FRAME_LEN];
+  uint16_t payload_len =
+      rtcm3_encode_1005(&msg_1005, frame + RTCM3_FRAME_HEADER_LEN);
+  uint16_t frame_len = rtcm3_frame_finalize(frame, payload_len);
+  assert(frame_len == payload_len + RTCM3_FRAME_OVERHEAD);
+
+  rtcm3_framer framer;
+  rtcm3_frame view;
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, frame, frame_len);
+  assert(rtcm3_framer_next(&framer, &view));
+  assert(view.frame == frame && view.frame_len == frame_len);
+  assert(view.msg_num == 1005);
+  rtcm_msg_1005 decoded;
+  assert(rtcm3_decode_1005(view.payload, &decoded) == RC_OK);
+  assert(decoded.stn_id == 7);
+
+  assert(rtcm3_frame_finalize(frame, RTCM3_MAX_MSG_LEN + 1) == 0);
+}
+
+/* Write a random frame, avoiding the preamble anywhere after the first byte
+ * so that the resync counts of the tests below are deterministic. */
+static uint16_t write_frame(uint8_t *buff, uint16_t payload_len) {
+  uint16_t frame_len = payload_len + RTCM3_FRAME_OVERHEAD;
+  do {
+    for (uint16_t i = 0; i < payload_len; i++) {
+      buff[RTCM3_FRAME_HEADER_LEN + i] = (uint8_t)(rand() % RTCM3_PREAMBLE);
+    }
+    rtcm3_frame_finalize(buff, payload_len);
+  } while (NULL != memchr(buff + 1, RTCM3_PREAMBLE, frame_len - 1u));
+  return frame_len;
+}
+
+/* Feed the stream in chunks of chunk_len bytes and check the frames against
+ * the expected locations. */
+static void check_stream(const uint8_t *data,
+                         size_t len,
+                         size_t chunk_len,
+                         const frame_loc *expected,
+                         size_t n_expected,
+                         rtcm3_framer_stats *stats) {
+  rtcm3_framer framer;
+  rtcm3_framer_init(&framer);
+  size_t n_frames = 0;
+  for (size_t pos = 0; pos < len; pos += chunk_len) {
+    size_t n = len - pos < chunk_len ? len - pos : chunk_len;
+    rtcm3_framer_feed(&framer, data + pos, n);
+    rtcm3_frame frame;
+    while (rtcm3_framer_next(&framer, &frame)) {
+      assert(n_frames < n_expected);
+      const frame_loc *loc = &expected[n_frames];
+      assert(frame.frame_len == loc->len);
+      assert(frame.payload_len + RTCM3_FRAME_OVERHEAD == loc->len);
+      assert(frame.payload == frame.frame + RTCM3_FRAME_HEADER_LEN);
+      assert(memcmp(frame.frame, data + loc->offset, loc->len) == 0);
+      /* frames inside a chunk must not be copied */
+      if (loc->offset >= pos && loc->offset + loc->len <= pos + n) {
+        assert(frame.frame == data + loc->offset);
+      }
+      n_frames++;
+    }
+  }
+  assert(n_frames == n_expected);
+  assert(framer.stats.frames == n_expected);
+  *stats = framer.stats;
+}
+
+static void test_captured_frames(void) {
+  const frame_loc fw_loc[] = {{0, sizeof(fw_ver_frame)}};
+  const frame_loc rf_loc[] = {{0, 56}, {56, 22}, {78, 22}, {100, 22}};
+  rtcm3_framer_stats stats;
+
+  check_stream(fw_ver_frame, sizeof(fw_ver_frame), 1, fw_loc, 1, &stats);
+  assert(stats.crc_errors == 0 && stats.dropped_bytes == 0);
+
+  for (size_t chunk_len = 1; chunk_len <= sizeof(rf_status_frames);
+       chunk_len++) {
+    check_stream(rf_status_frames,
+                 sizeof(rf_status_frames),
+                 chunk_len,
+                 rf_loc,
+                 4,
+                 &stats);
+    assert(stats.crc_errors == 0 && stats.dropped_bytes == 0);
+  }
+
+  rtcm3_framer framer;
+  rtcm3_frame frame;
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, fw_ver_frame, sizeof(fw_ver_frame));
+  assert(rtcm3_framer_next(&framer, &frame));
+  assert(frame.msg_num == 999);
+  assert(!rtcm3_framer_next(&framer, &frame));
+}
+
+static void test_resync(void) {
+  frame_loc expected[MAX_TEST_FRAMES];
+  size_t len = 0;
+  uint64_t garbage = 0;
+  srand(2);
+
+  for (size_t i = 0; i < MAX_TEST_FRAMES; i++) {
+    /* garbage without any preamble between frames */
+    uint16_t n_garbage = (uint16_t)(rand() % 16);
+    for (uint16_t j = 0; j < n_garbage; j++) {
+      stream[len++] = (uint8_t)(rand() % RTCM3_PREAMBLE);
+    }
+    garbage += n_garbage;
+    uint16_t payload_len;
+    if (0 == i) {
+      payload_len = 0;
+    } else if (1 == i) {
+      payload_len = RTCM3_MAX_MSG_LEN;
+    } else {
+      payload_len = (uint16_t)(rand() % 300);
+    }
+    expected[i].offset = len;
+    expected[i].len = write_frame(stream + len, payload_len);
+    len += expected[i].len;
+  }
+
+  const size_t chunk_lens[] = {1, 2, 3, 5, 64, 1000, 1029, STREAM_SIZE};
+  for (size_t i = 0; i < sizeof(chunk_lens) / sizeof(chunk_lens[0]); i++) {
+    rtcm3_framer_stats stats;
+    check_stream(
+        stream, len, chunk_lens[i], expected, MAX_TEST_FRAMES, &stats);
+    assert(stats.crc_errors == 0);
+    assert(stats.dropped_bytes == garbage);
+  }
+
+  /* corrupt the payload of one frame and set the reserved bits of another,
+   * both must be dropped entirely */
+  stream[expected[5].offset + 4] ^= 0x01;
+  stream[expected[9].offset + 1] |= 0x80;
+  frame_loc remaining[MAX_TEST_FRAMES];
+  size_t n_remaining = 0;
+  for (size_t i = 0; i < MAX_TEST_FRAMES; i++) {
+    if (5 != i && 9 != i) {
+      remaining[n_remaining++] = expected[i];
+    }
+  }
+  for (size_t i = 0; i < sizeof(chunk_lens) / sizeof(chunk_lens[0]); i++) {
+    rtcm3_framer_stats stats;
+    check_stream(stream, len, chunk_lens[i], remaining, n_remaining, &stats);
+    assert(stats.crc_errors == 1);
+    assert(stats.dropped_bytes ==
+           garbage + expected[5].len + expected[9].len);
+  }
+}
+
+/* A bad candidate frame that straddles chunks may hide a real frame, which
+ * must be found again from the buffered bytes */
+static void test_resync_partial(void) {
+  uint8_t buff[64];
+  srand(3);
+  uint16_t real_len = write_frame(buff + 3, 10);
+  /* bogus header claiming a frame that covers the real one */
+  buff[0] = RTCM3_PREAMBLE;
+  buff[1] = 0x00;
+  buff[2] = 40;
+  size_t len = 3 + real_len;
+  memset(buff + len, 0x55, sizeof(buff) - len);
+  len = sizeof(buff);
+
+  const frame_loc loc[] = {{3, real_len}};
+  for (size_t chunk_len = 1; chunk_len <= len; chunk_len++) {
+    rtcm3_framer_stats stats;
+    check_stream(buff, len, chunk_len, loc, 1, &stats);
+    assert(stats.crc_errors == 1);
+    assert(stats.dropped_bytes == len - real_len);
+  }
+}
+
+static uint16_t logged_sources[4];
+static uint32_t num_logged = 0;
+
+static void framer_log_drain(const rtcm3_log_record *record, void *context) {
+  (void)context;
+  assert(record->level == 4 && record->len > 0);
+  logged_sources[num_logged++] = record->source;
+}
+
+/* Each stream logs its CRC errors through its own logger, tagged with the
+ * stream, into one ring */
+static void test_framer_logger(void) {
+  uint8_t bad[sizeof(fw_ver_frame)];
+  memcpy(bad, fw_ver_frame, sizeof(bad));
+  bad[10] ^= 0x01;
+
+  rtcm3_log_record records[4];
+  rtcm3_log_ring ring;
+  rtcm3_log_ring_init(&ring, records, 4);
+  rtcm3_logger loggers[2];
+  rtcm3_framer framers[2];
+  for (uint16_t i = 0; i < 2; i++) {
+    rtcm3_logger_init(&loggers[i], NULL, NULL);
+    loggers[i].ring = &ring;
+    loggers[i].source = 100 + i;
+    rtcm3_framer_init(&framers[i]);
+  }
+
+  /* no logger, nothing queued */
+  rtcm3_frame frame;
+  rtcm3_framer_feed(&framers[0], bad, sizeof(bad));
+  assert(!rtcm3_framer_next(&framers[0], &frame));
+  assert(framers[0].stats.crc_errors == 1);
+  assert(ring.head == 0);
+
+  framers[0].logger = &loggers[0];
+  framers[1].logger = &loggers[1];
+  rtcm3_framer_feed(&framers[1], bad, sizeof(bad));
+  assert(!rtcm3_framer_next(&framers[1], &frame));
+  rtcm3_framer_feed(&framers[0], fw_ver_frame, sizeof(fw_ver_frame));
+  assert(rtcm3_framer_next(&framers[0], &frame));
+  rtcm3_framer_feed(&framers[0], bad, sizeof(bad));
+  assert(!rtcm3_framer_next(&framers[0], &frame));
+
+  assert(rtcm3_log_ring_drain(&ring, framer_log_drain, NULL, 4) == 2);
+  assert(num_logged == 2);
+  assert(logged_sources[0] == 101 && logged_sources[1] == 100);
+}
+
+static int fanout_encodes = 0;
+
+static uint16_t fanout_encode_1005(const void *msg, uint8_t buff[]) {
+  fanout_encodes++;
+  return rtcm3_encode_1005((const rtcm_msg_1005 *)msg, buff);
+}
+
+static uint16_t fanout_encode_fail(const void *msg, uint8_t buff[]) {
+  (void)msg;
+  (void)buff;
+  return 0;
+}
+
+static void test_fanout(void) {
+  rtcm_msg_1005 msg_1005;
+  memset(&msg_1005, 0, sizeof(msg_1005));
+  msg_1005.stn_id = 7;
+  msg_1005.arp_x = 3573346.6114;
+
+  static rtcm3_fanout_entry entries[2];
+  rtcm3_fanout_cache cache;
+  rtcm3_fanout_init(&cache, entries, 2, 10000);
+
+  /* clients asking for the same frame share one encoding */
+  rtcm3_fanout_key key = {
+      .stn_id = 7, .tow_ms = 1000, .msg_num = 1005, .options = 0};
+  const rtcm3_fanout_entry *first =
+      rtcm3_fanout_get(&cache, &key, fanout_encode_1005, &msg_1005);
+  const rtcm3_fanout_entry *second =
+      rtcm3_fanout_get(&cache, &key, fanout_encode_1005, &msg_1005);
+  assert(first && first == second && 2 == first->refs);
+  assert(1 == fanout_encodes && 1 == cache.stats.misses);
+  assert(1 == cache.stats.hits);
+
+  rtcm3_framer framer;
+  rtcm3_frame view;
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, first->frame, first->frame_len);
+  assert(rtcm3_framer_next(&framer, &view) && 1005 == view.msg_num);
+
+  /* other options get their own frame, held entries are never replaced */
+  key.options = 1;
+  const rtcm3_fanout_entry *other =
+      rtcm3_fanout_get(&cache, &key, fanout_encode_1005, &msg_1005);
+  assert(other && other != first && 2 == fanout_encodes);
+  key.tow_ms = 2000;
+  assert(NULL == rtcm3_fanout_get(&cache, &key, fanout_encode_1005, &msg_1005));
+  assert(1 == cache.stats.failures);
+
+  /* once released, the oldest epoch is replaced */
+  rtcm3_fanout_release(&cache, first);
+  rtcm3_fanout_release(&cache, second);
+  rtcm3_fanout_release(&cache, other);
+  const rtcm3_fanout_entry *newer =
+      rtcm3_fanout_get(&cache, &key, fanout_encode_1005, &msg_1005);
+  assert(newer && 1 == cache.stats.evictions);
+  rtcm3_fanout_release(&cache, newer);
+
+  /* eviction by age, across the week rollover */
+  assert(0 == rtcm3_fanout_evict(&cache, 11000));
+  assert(1 == rtcm3_fanout_evict(&cache, 11001));
+  assert(1 == rtcm3_fanout_evict(&cache, 12001));
+  assert(3 == cache.stats.evictions);
+  key.tow_ms = 604799000;
+  newer = rtcm3_fanout_get(&cache, &key, fanout_encode_1005, &msg_1005);
+  rtcm3_fanout_release(&cache, newer);
+  assert(0 == rtcm3_fanout_evict(&cache, 5000));
+  assert(1 == rtcm3_fanout_evict(&cache, 10000));
+
+  /* encoder failures are not cached */
+  assert(NULL == rtcm3_fanout_get(&cache, &key, fanout_encode_fail, NULL));
+  assert(2 == cache.stats.failures);
+  assert(NULL == rtcm3_fanout_get(&cache, &key, fanout_encode_fail, NULL));
+  assert(3 == cache.stats.failures);
+
+  /* nor do they replace a cached frame */
+  rtcm3_fanout_key a = {.stn_id = 7, .tow_ms = 1000, .msg_num = 1005};
+  rtcm3_fanout_key b = {.stn_id = 7, .tow_ms = 2000, .msg_num = 1005};
+  rtcm3_fanout_release(
+      &cache, rtcm3_fanout_get(&cache, &a, fanout_encode_1005, &msg_1005));
+  rtcm3_fanout_release(
+      &cache, rtcm3_fanout_get(&cache, &b, fanout_encode_1005, &msg_1005));
+  uint64_t evictions = cache.stats.evictions;
+  key.tow_ms = 3000;
+  assert(NULL == rtcm3_fanout_get(&cache, &key, fanout_encode_fail, NULL));
+  assert(evictions == cache.stats.evictions);
+  uint64_t hits = cache.stats.hits;
+  rtcm3_fanout_release(
+      &cache, rtcm3_fanout_get(&cache, &a, fanout_encode_1005, &msg_1005));
+  rtcm3_fanout_release(
+      &cache, rtcm3_fanout_get(&cache, &b, fanout_encode_1005, &msg_1005));
+  assert(hits + 2 == cache.stats.hits);
+
+  /* an epoch slightly ahead of the current time is not old */
+  assert(0 == rtcm3_fanout_evict(&cache, 1500));
+  assert(0 == rtcm3_fanout_evict(&cache, 11000));
+  assert(2 == rtcm3_fanout_evict(&cache, 12001));
+
+  /* GLO epochs are UTC(SU) time of day and BDS epochs are 14 s behind,
+   * both are aged in GPS time */
+  uint32_t gps_tow_ms = 2 * 86400000 + 36000000;
+  rtcm3_fanout_key glo = {
+      .stn_id = 7,
+      .tow_ms = 36000000 + 3 * 3600 * 1000 - 18000,
+      .msg_num = 1012};
+  rtcm3_fanout_key bds = {
+      .stn_id = 7, .tow_ms = gps_tow_ms - 14000, .msg_num = 1127};
+  rtcm3_fanout_release(
+      &cache, rtcm3_fanout_get(&cache, &glo, fanout_encode_1005, &msg_1005));
+  rtcm3_fanout_release(
+      &cache, rtcm3_fanout_get(&cache, &bds, fanout_encode_1005, &msg_1005));
+  assert(0 == rtcm3_fanout_evict(&cache, gps_tow_ms + 10000));
+  assert(2 == rtcm3_fanout_evict(&cache, gps_tow_ms + 10001));
+}
+
+/* Frame a minimal MSM4 with a single cell */
+static uint16_t write_msm4_frame(uint8_t frame[]) {
+  static rtcm_msm_message msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.header.msg_num = 1074;
+  msg.header.stn_id = 7;
+  msg.header.tow_ms = 309000000;
+  msg.header.satellite_mask[3] = true;
+  msg.header.signal_mask[1] = true;
+  msg.header.cell_mask[0] = true;
+  msg.sats[0].rough_range_ms = 70.5;
+  msg.signals[0].pseudorange_ms = 70.5001;
+  msg.signals[0].cnr = 40;
+  msg.signals[0].flags.valid_pr = 1;
+  msg.signals[0].flags.valid_cnr = 1;
+  memset(frame, 0, RTCM3_MAX_FRAME_LEN);
+  uint16_t payload_len =
+      rtcm3_encode_msm4(&msg, frame + RTCM3_FRAME_HEADER_LEN);
+  return rtcm3_frame_finalize(frame, payload_len);
+}
+
+static uint16_t write_1005_frame(uint8_t frame[], uint16_t stn_id) {
+  rtcm_msg_1005 msg_1005;
+  memset(&msg_1005, 0, sizeof(msg_1005));
+  msg_1005.stn_id = stn_id;
+  msg_1005.arp_x = 3573346.6114;
+  uint16_t payload_len =
+      rtcm3_encode_1005(&msg_1005, frame + RTCM3_FRAME_HEADER_LEN);
+  return rtcm3_frame_finalize(frame, payload_len);
+}
+
+static void test_passthrough_patch(void) {
+  uint8_t frame[RTCM3_MAX_FRAME_LEN];
+  uint8_t original[RTCM3_MAX_FRAME_LEN];
+  rtcm3_framer framer;
+  rtcm3_frame view;
+
+  /* station ID rewrite */
+  uint16_t frame_len = write_1005_frame(frame, 7);
+  assert(rtcm3_frame_set_station_id(frame, frame_len, 4000));
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, frame, frame_len);
+  assert(rtcm3_framer_next(&framer, &view) && view.frame_len == frame_len);
+  rtcm_msg_1005 msg_1005;
+  assert(RC_OK == rtcm3_decode_1005(view.payload, &msg_1005));
+  assert(4000 == msg_1005.stn_id);
+  assert(!rtcm3_frame_set_station_id(frame, frame_len, 4096));
+  assert(!rtcm3_frame_set_station_id(frame, frame_len - 1, 7));
+
+  /* DF393 is the only change to the MSM payload */
+  frame_len = write_msm4_frame(frame);
+  memcpy(original, frame, frame_len);
+  assert(rtcm3_frame_set_msm_multiple(frame, frame_len, true));
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, frame, frame_len);
+  assert(rtcm3_framer_next(&framer, &view));
+  const uint8_t *payload = original + RTCM3_FRAME_HEADER_LEN;
+  for (uint16_t bit = 0; bit < view.payload_len * 8; bit++) {
+    uint32_t expected = rtcm_getbitu(payload, bit, 1);
+    if (54 == bit) {
+      expected = 1;
+    }
+    assert(expected == rtcm_getbitu(view.payload, bit, 1));
+  }
+  static rtcm_msm_message msg;
+  assert(RC_OK == rtcm3_decode_msm4(view.payload, &msg));
+  assert(1 == msg.header.multiple && 309000000 == msg.header.tow_ms);
+  assert(rtcm3_frame_set_station_id(frame, frame_len, 9));
+  assert(rtcm3_frame_set_msm_multiple(frame, frame_len, false));
+  assert(RC_OK == rtcm3_decode_msm4(frame + RTCM3_FRAME_HEADER_LEN, &msg));
+  assert(0 == msg.header.multiple && 9 == msg.header.stn_id);
+
+  /* messages without the fields */
+  assert(!rtcm3_frame_set_msm_multiple(original, 0, true));
+  frame_len = write_1005_frame(frame, 7);
+  assert(!rtcm3_frame_set_msm_multiple(frame, frame_len, true));
+  assert(!rtcm3_msg_has_station_id(1019));
+  assert(!rtcm3_msg_has_station_id(1060));
+  assert(rtcm3_msg_has_station_id(1127));
+}
+
+static void test_passthrough_filter(void) {
+  rtcm3_msg_filter filter;
+  rtcm3_msg_filter_init(&filter, true);
+  assert(rtcm3_msg_filter_passes(&filter, 1005));
+  rtcm3_msg_filter_set(&filter, 1005, false);
+  assert(!rtcm3_msg_filter_passes(&filter, 1005));
+  assert(rtcm3_msg_filter_passes(&filter, 1004));
+  assert(rtcm3_msg_filter_passes(&filter, 1006));
+  assert(!rtcm3_msg_filter_passes(&filter, 4096));
+
+  /* alternate 1005 and 1074 frames */
+  size_t len = 0;
+  size_t msm_len = 0;
+  for (int i = 0; i < 10; i++) {
+    len += write_1005_frame(&stream[len], 7);
+    uint16_t frame_len = write_msm4_frame(&stream[len]);
+    len += frame_len;
+    msm_len += frame_len;
+  }
+
+  static uint8_t out[STREAM_SIZE];
+  rtcm3_framer framer;
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, stream, len);
+  size_t out_len = rtcm3_msg_filter_forward(&filter, &framer, out, sizeof(out));
+  assert(out_len == msm_len);
+  assert(10 == filter.forwarded && 10 == filter.dropped);
+
+  rtcm3_frame view;
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, out, out_len);
+  for (int i = 0; i < 10; i++) {
+    assert(rtcm3_framer_next(&framer, &view) && 1074 == view.msg_num);
+  }
+  assert(!rtcm3_framer_next(&framer, &view));
+
+  /* the output must have room for a full frame */
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, stream, len);
+  assert(0 == rtcm3_msg_filter_forward(
+                  &filter, &framer, out, RTCM3_MAX_FRAME_LEN - 1));
+}
+
+/* Frame an SSR GPS clock message without satellites */
+static uint16_t write_ssr_clock_frame(uint8_t frame[], uint32_t epoch_s) {
+  rtcm_bitwriter writer;
+  memset(frame, 0, RTCM3_MAX_FRAME_LEN);
+  rtcm_bitwriter_init(
+      &writer, frame + RTCM3_FRAME_HEADER_LEN, RTCM3_MAX_MSG_LEN, 0);
+  rtcm_write_bitu(&writer, 12, 1058);
+  rtcm_write_bitu(&writer, 20, epoch_s);
+  rtcm_write_bitu(&writer, 4 + 1 + 4 + 16 + 4 + 6, 0);
+  return rtcm3_frame_finalize(frame, rtcm_bitwriter_flush(&writer));
+}
+
+static void test_archive(void) {
+  size_t len = 0;
+  len += write_1005_frame(&stream[len], 3);
+  memset(&stream[len], 0x55, 5);
+  len += 5;
+  size_t msm_offset = len;
+  len += write_msm4_frame(&stream[len]);
+  size_t bad_offset = len;
+  len += write_1005_frame(&stream[len], 4);
+  stream[bad_offset + 5] ^= 0x01;
+  len += write_ssr_clock_frame(&stream[len], 309001);
+  len += write_1005_frame(&stream[len], 5);
+
+  rtcm3_archive_entry entries[8];
+  rtcm3_archive archive;
+  rtcm3_archive_init(&archive, entries, 8);
+  assert(4 == rtcm3_archive_index(&archive, stream, len));
+  assert(len == archive.scanned);
+  assert(4 == archive.stats.frames && 1 == archive.stats.crc_errors);
+
+  assert(0 == entries[0].offset && 1005 == entries[0].msg_num);
+  assert(RTCM3_ARCHIVE_HAS_STN_ID == entries[0].flags);
+  assert(3 == entries[0].stn_id);
+  assert(msm_offset == entries[1].offset && 1074 == entries[1].msg_num);
+  assert((RTCM3_ARCHIVE_HAS_STN_ID | RTCM3_ARCHIVE_HAS_TIME) ==
+         entries[1].flags);
+  assert(7 == entries[1].stn_id && 309000000 == entries[1].time_ms);
+  assert(RTCM3_ARCHIVE_HAS_TIME == entries[2].flags);
+  assert(1058 == entries[2].msg_num && 309001000 == entries[2].time_ms);
+  assert(5 == entries[3].stn_id);
+
+  /* by type */
+  rtcm3_msg_filter types;
+  rtcm3_msg_filter_init(&types, false);
+  rtcm3_msg_filter_set(&types, 1005, true);
+  rtcm3_archive_query query = {&types, false, RTCM3_TIMESCALE_NONE, 0, 0};
+  size_t pos = 0;
+  assert(&entries[0] == rtcm3_archive_next(&archive, &query, &pos));
+  assert(&entries[3] == rtcm3_archive_next(&archive, &query, &pos));
+  assert(NULL == rtcm3_archive_next(&archive, &query, &pos));
+
+  /* by time, entries without a time never match */
+  query.types = NULL;
+  query.by_time = true;
+  query.timescale = RTCM3_TIMESCALE_GPS;
+  query.time_min_ms = 309000500;
+  query.time_max_ms = 309001000;
+  pos = 0;
+  assert(&entries[2] == rtcm3_archive_next(&archive, &query, &pos));
+  assert(NULL == rtcm3_archive_next(&archive, &query, &pos));
+
+  /* a range only covers the entries of its time scale, in GPS time */
+  {
+    rtcm3_archive_entry timed[3];
+    memset(timed, 0, sizeof(timed));
+    timed[0].msg_num = 1074;
+    timed[1].msg_num = 1084;
+    timed[2].msg_num = 1124;
+    for (uint8_t i = 0; i < 3; i++) {
+      timed[i].flags = RTCM3_ARCHIVE_HAS_TIME;
+      timed[i].time_ms = 50000;
+    }
+    timed[2].time_ms -= BDS_SECOND_TO_GPS_SECOND * 1000;
+    rtcm3_archive timed_archive;
+    rtcm3_archive_init(&timed_archive, timed, 3);
+    timed_archive.count = 3;
+    rtcm3_archive_query range = {NULL, true, RTCM3_TIMESCALE_GPS, 0, 50000};
+    pos = 0;
+    assert(&timed[0] == rtcm3_archive_next(&timed_archive, &range, &pos));
+    assert(&timed[2] == rtcm3_archive_next(&timed_archive, &range, &pos));
+    assert(NULL == rtcm3_archive_next(&timed_archive, &range, &pos));
+    range.timescale = RTCM3_TIMESCALE_GLO;
+    pos = 0;
+    assert(&timed[1] == rtcm3_archive_next(&timed_archive, &range, &pos));
+    assert(NULL == rtcm3_archive_next(&timed_archive, &range, &pos));
+  }
+
+  /* decoding reads straight from the data */
+  rtcm3_frame frame;
+  assert(rtcm3_archive_frame(&archive, &entries[1], &frame));
+  assert(stream + msm_offset == frame.frame);
+  rtcm3_any_msg msg;
+  assert(RC_OK == rtcm3_archive_decode(&archive, &entries[1], &msg));
+  assert(RTCM3_MSG_MSM == msg.kind && 7 == msg.msg.msm.header.stn_id);
+  assert(RC_OK == rtcm3_archive_decode(&archive, &entries[3], &msg));
+  assert(5 == msg.msg.msg_1005.stn_id);
+  rtcm3_archive_entry outside = entries[3];
+  outside.offset = len - 1;
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_archive_decode(&archive, &outside, &msg));
+
+  /* a full index stops at the first frame that does not fit */
+  rtcm3_archive_init(&archive, entries, 2);
+  assert(2 == rtcm3_archive_index(&archive, stream, len));
+  size_t scanned = archive.scanned;
+  assert(entries[1].offset + entries[1].frame_len < scanned);
+  rtcm3_archive_init(&archive, entries, 8);
+  assert(2 == rtcm3_archive_index(&archive, stream + scanned, len - scanned));
+  assert(1058 == entries[0].msg_num && 0 == entries[0].offset);
+
+  /* BeiDou epochs just before the start of the GPS week wrap to its end */
+  uint8_t bds_frame[RTCM3_MAX_FRAME_LEN];
+  uint16_t bds_len = write_msm4_frame(bds_frame);
+  rtcm_setbitu(bds_frame + RTCM3_FRAME_HEADER_LEN, 0, 12, 1124);
+  rtcm_setbitu(bds_frame + RTCM3_FRAME_HEADER_LEN, 24, 30, C_2P30 - 2000);
+  rtcm3_frame_finalize(bds_frame, bds_len - RTCM3_FRAME_OVERHEAD);
+  rtcm3_archive_init(&archive, entries, 8);
+  assert(1 == rtcm3_archive_index(&archive, bds_frame, bds_len));
+  assert(1124 == entries[0].msg_num);
+  assert(RTCM_MAX_TOW_MS + 1 - 2000 == entries[0].time_ms);
+
+#ifdef RTCM3_ARCHIVE_HAVE_MAP
+  char path[] = "/tmp/rtcm3_archive_XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  assert((ssize_t)len == write(fd, stream, len));
+  close(fd);
+  const uint8_t *data;
+  size_t data_len;
+  assert(rtcm3_archive_map(path, &data, &data_len));
+  assert(len == data_len && 0 == memcmp(data, stream, len));
+  rtcm3_archive_init(&archive, entries, 8);
+  assert(4 == rtcm3_archive_index(&archive, data, data_len));
+  assert(RC_OK == rtcm3_archive_decode(&archive, &entries[1], &msg));
+  rtcm3_archive_unmap(data, data_len);
+  unlink(path);
+  assert(!rtcm3_archive_map(path, &data, &data_len));
+#endif
+}
+
+#define SIDECAR_EPOCHS 60
+/* Per epoch GPS and GLONASS MSM7 of two stations, 1005 every 10 epochs */
+#define SIDECAR_RECORDS (SIDECAR_EPOCHS * 4 + SIDECAR_EPOCHS / 10 + 2)
+
+static uint8_t sidecar_buff[RTCM3_SIDECAR_HEADER_LEN +
+                            SIDECAR_RECORDS * RTCM3_SIDECAR_RECORD_LEN];
+static rtcm3_sidecar_record sidecar_records[SIDECAR_RECORDS];
+static uint8_t sidecar_index[RTCM3_SIDECAR_HEADER_LEN +
+                             SIDECAR_RECORDS * 64];
+static rtcm3_sidecar_builder sidecar_builder;
+
+static void sidecar_add(rtcm3_sidecar_writer *writer,
+                        size_t *len,
+                        uint16_t msg_num,
+                        uint8_t flags,
+                        uint16_t stn_id,
+                        uint32_t time_ms) {
+  rtcm3_archive_entry entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.offset = writer->archive_len;
+  entry.frame_len = 100;
+  entry.msg_num = msg_num;
+  entry.flags = flags;
+  entry.stn_id = stn_id;
+  entry.time_ms = time_ms;
+  *len += rtcm3_sidecar_append(writer, &entry, &sidecar_buff[*len]);
+}
+
+static uint32_t sidecar_count(const rtcm3_sidecar *sidecar,
+                              const rtcm3_sidecar_query *query) {
+  rtcm3_sidecar_cursor cursor;
+  rtcm3_sidecar_record record;
+  rtcm3_sidecar_find(sidecar, query, &cursor);
+  uint32_t n = 0;
+  int64_t last = INT64_MIN;
+  while (rtcm3_sidecar_next(sidecar, &cursor, &record)) {
+    /* a sorted index returns the records of a time scale in epoch order */
+    assert(!sidecar->sorted || RTCM3_TIMESCALE_NONE == query->timescale ||
+           record.epoch_ms >= last);
+    last = record.epoch_ms;
+    n++;
+  }
+  return n;
+}
+
+static void test_sidecar(void) {
+  const uint8_t has_all = RTCM3_ARCHIVE_HAS_STN_ID | RTCM3_ARCHIVE_HAS_TIME;
+  const int64_t week = RTCM_MAX_TOW_MS + 1;
+  const int64_t day = RTCM_GLO_MAX_TOW_MS + 1;
+
+  /* the recording starts 30 s before the end of the GPS week and the
+   * GLONASS day */
+  rtcm3_sidecar_writer writer;
+  rtcm3_sidecar_writer_init(&writer);
+  size_t len = RTCM3_SIDECAR_HEADER_LEN;
+  for (uint32_t k = 0; k < SIDECAR_EPOCHS; k++) {
+    uint32_t tow = (uint32_t)((week - 30000 + k * 1000) % week);
+    uint32_t tod = (uint32_t)((day - 30000 + k * 1000) % day);
+    for (uint16_t stn = 42; stn <= 43; stn++) {
+      sidecar_add(&writer, &len, 1077, has_all, stn, tow);
+      sidecar_add(&writer, &len, 1087, has_all, stn, tod);
+    }
+    if (0 == k % 10) {
+      sidecar_add(&writer, &len, 1005, RTCM3_ARCHIVE_HAS_STN_ID, 42, 0);
+    }
+    if (35 == k) {
+      /* late, from before the rollover */
+      sidecar_add(&writer, &len, 1077, has_all, 42, (uint32_t)(week - 500));
+    }
+    if (40 == k) {
+      /* BeiDou time is 14 s behind GPS time */
+      sidecar_add(
+          &writer, &len, 1127, has_all, 44, (uint32_t)(week - 5000));
+    }
+  }
+  assert(SIDECAR_RECORDS == writer.record_count);
+  rtcm3_sidecar_write_header(&writer, sidecar_buff);
+
+  /* a journal, with a partly written record at its end */
+  rtcm3_sidecar journal;
+  assert(rtcm3_sidecar_open(&journal, sidecar_buff, len - 1));
+  assert(!journal.sorted && SIDECAR_RECORDS - 1 == journal.record_count);
+  assert(rtcm3_sidecar_open(&journal, sidecar_buff, len));
+  assert(SIDECAR_RECORDS == journal.record_count);
+  assert(writer.archive_len == journal.archive_len);
+
+  rtcm3_sidecar_query query = {1077, true, 42, RTCM3_TIMESCALE_GPS, 0, 0};
+  query.epoch_min_ms = week - 5000;
+  query.epoch_max_ms = week + 5000;
+  assert(12 == sidecar_count(&journal, &query));
+
+  rtcm3_sidecar_writer resumed;
+  assert(rtcm3_sidecar_writer_resume(&resumed, &journal));
+  assert(0 == memcmp(resumed.last_ms, writer.last_ms, sizeof(writer.last_ms)));
+  assert(0 == memcmp(resumed.base_ms, writer.base_ms, sizeof(writer.base_ms)));
+  assert(resumed.record_count == writer.record_count);
+  assert(resumed.archive_len == writer.archive_len);
+
+  /* sorted index */
+  for (uint32_t i = 0; i < journal.record_count; i++) {
+    assert(rtcm3_sidecar_record_at(&journal, i, &sidecar_records[i]));
+  }
+  assert(!rtcm3_sidecar_record_at(
+      &journal, journal.record_count, &sidecar_records[0]));
+  size_t max_len = rtcm3_sidecar_max_len(SIDECAR_RECORDS);
+  assert(max_len <= sizeof(sidecar_index));
+  size_t index_len = rtcm3_sidecar_build(&sidecar_builder,
+                                         sidecar_records,
+                                         SIDECAR_RECORDS,
+                                         journal.archive_len,
+                                         sidecar_index,
+                                         max_len);
+  assert(index_len > 0 && index_len <= max_len);
+  assert(0 == rtcm3_sidecar_build(&sidecar_builder,
+                                  sidecar_records,
+                                  SIDECAR_RECORDS,
+                                  journal.archive_len,
+                                  sidecar_index,
+                                  index_len - 1));
+  assert(index_len == rtcm3_sidecar_build(&sidecar_builder,
+                                          sidecar_records,
+                                          SIDECAR_RECORDS,
+                                          journal.archive_len,
+                                          sidecar_index,
+                                          index_len));
+
+  rtcm3_sidecar index;
+  assert(rtcm3_sidecar_open(&index, sidecar_index, index_len));
+  assert(index.sorted && SIDECAR_RECORDS == index.record_count);
+  assert(4 == index.n_types && 3 == index.n_stations);
+  assert(!rtcm3_sidecar_writer_resume(&resumed, &index));
+
+  rtcm3_sidecar_cursor cursor;
+  rtcm3_sidecar_find(&index, &query, &cursor);
+  assert(NULL != cursor.postings && cursor.end - cursor.pos == 12);
+  assert(12 == sidecar_count(&index, &query));
+
+  query.msg_num = 0;
+  query.timescale = RTCM3_TIMESCALE_NONE;
+  assert(SIDECAR_EPOCHS * 2 + SIDECAR_EPOCHS / 10 + 1 ==
+         sidecar_count(&index, &query));
+  query.stn_id = 45;
+  assert(0 == sidecar_count(&index, &query));
+  query.by_station = false;
+  query.msg_num = 1005;
+  assert(SIDECAR_EPOCHS / 10 == sidecar_count(&index, &query));
+  query.msg_num = 1087;
+  query.timescale = RTCM3_TIMESCALE_GLO;
+  query.epoch_min_ms = day;
+  query.epoch_max_ms = day + 9000;
+  assert(20 == sidecar_count(&index, &query));
+
+  rtcm3_sidecar_record record;
+  query.msg_num = 1127;
+  query.timescale = RTCM3_TIMESCALE_NONE;
+  rtcm3_sidecar_find(&index, &query, &cursor);
+  assert(rtcm3_sidecar_next(&index, &cursor, &record));
+  assert(RTCM3_TIMESCALE_GPS == record.timescale);
+  assert(week + 9000 == record.epoch_ms);
+  assert(!rtcm3_sidecar_next(&index, &cursor, &record));
+
+  /* the journal and index agree */
+  query.msg_num = 1077;
+  query.timescale = RTCM3_TIMESCALE_GPS;
+  query.epoch_min_ms = 0;
+  query.epoch_max_ms = 2 * week;
+  assert(sidecar_count(&journal, &query) == sidecar_count(&index, &query));
+
+  assert(!rtcm3_sidecar_open(&index, sidecar_index, index_len / 2));
+  assert(!rtcm3_sidecar_open(&index, stream, sizeof(stream)));
+  assert(!rtcm3_sidecar_open(&index, sidecar_index, 10));
+}
+
+#ifdef RTCM3_ENGINE_AVAILABLE
+#define ENGINE_STREAMS 3
+#define ENGINE_WORKERS 2
+#define ENGINE_INPUT 2048
+#define ENGINE_RESULTS 4
+
+static rtcm3_engine engine;
+static rtcm3_engine_stream engine_streams[ENGINE_STREAMS];
+static uint8_t engine_inputs[ENGINE_STREAMS][ENGINE_INPUT];
+static rtcm3_engine_result engine_results[ENGINE_STREAMS][ENGINE_RESULTS];
+static rtcm3_engine_worker engine_workers[ENGINE_WORKERS];
+static uint32_t engine_slots[ENGINE_WORKERS][4];
+static rtcm3_engine_cell engine_cells[4];
+
+/* Feed 1005 frames with consecutive station IDs */
+static void engine_feed_1005(uint32_t stream, uint16_t first, uint16_t n) {
+  uint8_t frame[RTCM3_MAX_FRAME_LEN];
+  for (uint16_t i = 0; i < n; i++) {
+    uint16_t len = write_1005_frame(frame, first + i);
+    assert(len == rtcm3_engine_feed(&engine, stream, frame, len));
+  }
+}
+
+/* Consume the results of a stream, checking they come in order */
+static uint16_t engine_consume(uint32_t stream, uint16_t next_stn) {
+  const rtcm3_engine_result *result;
+  while (NULL != (result = rtcm3_engine_peek(&engine, stream))) {
+    assert(RC_OK == result->rc && 1005 == result->msg_num);
+    assert(next_stn == result->msg.msg.msg_1005.stn_id);
+    next_stn++;
+    rtcm3_engine_release(&engine, stream);
+  }
+  return next_stn;
+}
+
+static void test_engine(void) {
+  for (uint32_t i = 0; i < ENGINE_STREAMS; i++) {
+    rtcm3_engine_stream_init(&engine_streams[i],
+                             engine_inputs[i],
+                             ENGINE_INPUT,
+                             engine_results[i],
+                             ENGINE_RESULTS);
+  }
+  for (uint32_t i = 0; i < ENGINE_WORKERS; i++) {
+    rtcm3_engine_worker_init(&engine_workers[i], engine_slots[i], 4);
+  }
+  rtcm3_engine_init(&engine,
+                    engine_streams,
+                    ENGINE_STREAMS,
+                    engine_workers,
+                    ENGINE_WORKERS,
+                    engine_cells,
+                    4);
+  engine.budget = 2;
+  assert(0 == rtcm3_engine_work(&engine, 0));
+
+  /* stream 0 is heavy, stream 1 light */
+  engine_feed_1005(0, 0, 10);
+  engine_feed_1005(1, 100, 3);
+  assert(2 == rtcm3_engine_work(&engine, 0));
+  assert(2 == rtcm3_engine_work(&engine, 1));
+  assert(1 == rtcm3_engine_work(&engine, 1));
+  /* worker 1 is out of work and steals stream 0 from worker 0 */
+  assert(2 == rtcm3_engine_work(&engine, 1));
+  assert(1 == engine_workers[1].steals);
+  /* stream 0 has filled its results and waits for the consumer */
+  assert(0 == rtcm3_engine_work(&engine, 0));
+  assert(0 == rtcm3_engine_work(&engine, 1));
+  assert(103 == engine_consume(1, 100));
+
+  uint16_t next_stn = 0;
+  for (int turns = 0; next_stn < 10; turns++) {
+    assert(turns < 20);
+    next_stn = engine_consume(0, next_stn);
+    rtcm3_engine_work(&engine, (uint32_t)turns % ENGINE_WORKERS);
+  }
+  assert(0 == rtcm3_engine_work(&engine, 0));
+  assert(0 == rtcm3_engine_work(&engine, 1));
+
+  /* a frame split across feeds and the wrap of the input ring, with
+   * garbage in between */
+  uint8_t frame[RTCM3_MAX_FRAME_LEN];
+  uint16_t len = write_1005_frame(frame, 7);
+  const uint8_t garbage[] = {0x01, 0x02, 0x03};
+  for (int i = 0; i < 200; i++) {
+    assert(sizeof(garbage) ==
+           rtcm3_engine_feed(&engine, 2, garbage, sizeof(garbage)));
+    assert(5 == rtcm3_engine_feed(&engine, 2, frame, 5));
+    assert(len - 5u == rtcm3_engine_feed(&engine, 2, frame + 5, len - 5u));
+    while (rtcm3_engine_work(&engine, 1) > 0) {
+    }
+    const rtcm3_engine_result *result = rtcm3_engine_peek(&engine, 2);
+    assert(NULL != result && RC_OK == result->rc);
+    assert(7 == result->msg.msg.msg_1005.stn_id);
+    rtcm3_engine_release(&engine, 2);
+    assert(NULL == rtcm3_engine_peek(&engine, 2));
+  }
+  assert(200 * sizeof(garbage) ==
+         engine_streams[2].framer.stats.dropped_bytes);
+
+  /* the input ring takes up to its size */
+  static uint8_t zeros[ENGINE_INPUT + 1];
+  assert(ENGINE_INPUT == rtcm3_engine_feed(&engine, 1, zeros, sizeof(zeros)));
+  assert(0 == rtcm3_engine_feed(&engine, 1, zeros, 1));
+  while (rtcm3_engine_work(&engine, 0) > 0) {
+  }
+  assert(NULL == rtcm3_engine_peek(&engine, 1));
+  assert(ENGINE_INPUT == rtcm3_engine_feed(&engine, 1, zeros, sizeof(zeros)));
+}
+#endif
+
+int main(void) {
+  test_crc24q();
+  test_crc24q_dispatch();
+  test_frame_finalize();
+  test_captured_frames();
+  test_resync();
+  test_resync_partial();
+  test_framer_logger();
+  test_fanout();
+  test_passthrough_patch();
+  test_passthrough_filter();
+  test_archive();
+  test_sidecar();
+#ifdef RTCM3_ENGINE_AVAILABLE
+  test_engine();
+#endif
+}
@@ -17,19 +17,36 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "rtcm3/arena.h"
 #include "rtcm3/bits.h"
 #include "rtcm3/decode.h"
+#include "rtcm3/decode_frame.h"
+#include "rtcm3/epoch.h"
 #include "rtcm3/encode.h"
+#include "rtcm3/epoch_encode.h"
 #include "rtcm3/eph_decode.h"
 #include "rtcm3/eph_encode.h"
+#include "rtcm3/eph_store.h"
+#include "rtcm3/framer.h"
 #include "rtcm3/messages.h"
+#include "rtcm3/msm_compact.h"
 #include "rtcm3/msm_utils.h"
+#include "rtcm3/obs_convert.h"
+#include "rtcm3/orbit.h"
+#include "rtcm3/ssr_decode.h"
+#include "rtcm3/ssr_state.h"
+#include "rtcm3/stats.h"
+
+#include "../src/msg_layout.h"
+#include "../src/msm_unpack.h"
 
 #define LIBRTCM_LOG_INTERNAL
 #include "rtcm3/logging.h"
 
 int main(void) {
   test_msm_bit_utils();
+  test_bit_reader();
+  test_bit_writer();
   test_lock_time_decoding();
   test_rtcm_1001();
   test_rtcm_1002();
@@ -39,21 +56,44 @@ int main(void) {
   test_rtcm_1006();
   test_rtcm_1007();
   test_rtcm_1008();
+  test_rtcm_1009();
   test_rtcm_1010();
+  test_rtcm_1011();
   test_rtcm_1012();
+  test_rtcm_1013();
   test_rtcm_1019();
   test_rtcm_1020();
   test_rtcm_1029();
   test_rtcm_1033();
   test_rtcm_1042();
+  test_rtcm_1044();
   test_rtcm_1045();
   test_rtcm_1046();
   test_rtcm_1230();
+  test_eph_store();
+  test_orbit_cache();
   test_rtcm_msm4();
   test_rtcm_msm5();
   test_rtcm_msm5_glo();
   test_rtcm_msm7();
+  test_rtcm_msm6_encode();
+  test_rtcm_msm7_encode();
+  test_msm_layout();
+  test_msm_epoch_encode();
+  test_epoch_assembler();
   test_rtcm_4062();
+  test_decode_frame();
+  test_peek_header();
+  test_stats();
+  test_decode_bounded();
+  test_ssr_state();
+  test_ssr_bias_sparse();
+  test_msm_columns();
+  test_obs_convert();
+  test_msm_compact();
+  test_decode_arena();
+  test_msg_layout();
+  test_msm_unpack();
   test_rtcm_random_bits();
   test_logging();
 }
@@ -415,6 +455,60 @@ void test_rtcm_1008(void) {
   assert(RC_OK == ret && msg1008_equals(&msg1008, &msg1008_out));
 }
 
+void test_rtcm_1009(void) {
+  rtcm_obs_header header;
+  header.msg_num = 1009;
+  header.div_free = 0;
+  header.n_sat = 3;
+  header.smooth = 0;
+  header.stn_id = 7;
+  header.sync = 1;
+  header.tow_ms = 86399000;
+
+  rtcm_obs_message msg1009;
+  memset((void *)&msg1009, 0, sizeof(msg1009));
+  msg1009.header = header;
+  msg1009.sats[0].svId = 4;
+  msg1009.sats[0].fcn = 9;
+  msg1009.sats[0].obs[0].code = 0;
+  msg1009.sats[0].obs[0].pseudorange = 20000004.4;
+  msg1009.sats[0].obs[0].carrier_phase = 106949010.6;
+  msg1009.sats[0].obs[0].lock = 900;
+  msg1009.sats[0].obs[0].flags.valid_pr = 1;
+  msg1009.sats[0].obs[0].flags.valid_cp = 1;
+  msg1009.sats[0].obs[0].flags.valid_lock = 1;
+
+  msg1009.sats[1].svId = 6;
+  msg1009.sats[1].fcn = 0x03;
+  msg1009.sats[1].obs[0].code = 0;
+  msg1009.sats[1].obs[0].pseudorange = 22000004.4;
+  msg1009.sats[1].obs[0].carrier_phase = 117396240.5;
+  msg1009.sats[1].obs[0].lock = 254;
+  msg1009.sats[1].obs[0].flags.valid_pr = 1;
+  msg1009.sats[1].obs[0].flags.valid_cp = 1;
+  msg1009.sats[1].obs[0].flags.valid_lock = 1;
+
+  msg1009.sats[2].svId = 6;
+  msg1009.sats[2].fcn = 5;
+  msg1009.sats[2].obs[0].code = 0;
+  msg1009.sats[2].obs[0].pseudorange = 22000004.4;
+  msg1009.sats[2].obs[0].flags.valid_pr = 1;
+
+  uint8_t buff[1024];
+  memset(buff, 0, 1024);
+  uint16_t len = rtcm3_encode_1009(&msg1009, buff);
+  assert(8 + (2 * 64 + 5) / 8 == len);
+
+  rtcm_obs_message msg1009_out;
+  int8_t ret = rtcm3_decode_1009(buff, &msg1009_out);
+
+  assert(RC_OK == ret && msgobs_glo_equals(&msg1009, &msg1009_out));
+  assert(RC_OK == rtcm3_decode_1009_bounded(buff, len, &msg1009_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_1009_bounded(buff, len - 1, &msg1009_out));
+  assert(RC_MESSAGE_TYPE_MISMATCH == rtcm3_decode_1010(buff, &msg1009_out));
+}
+
 void test_rtcm_1010(void) {
   rtcm_obs_header header;
   header.msg_num = 1010;
@@ -474,6 +568,66 @@ void test_rtcm_1010(void) {
   assert(RC_OK == ret && msgobs_glo_equals(&msg1010, &msg1010_out));
 }
 
+void test_rtcm_1011(void) {
+  rtcm_obs_header header;
+  header.msg_num = 1011;
+  header.div_free = 0;
+  header.n_sat = 3;
+  header.smooth = 0;
+  header.stn_id = 7;
+  header.sync = 1;
+  header.tow_ms = 34700000;
+
+  rtcm_obs_message msg1011;
+  memset((void *)&msg1011, 0, sizeof(msg1011));
+  msg1011.header = header;
+  msg1011.sats[0].svId = 4;
+  msg1011.sats[0].fcn = 7;
+  msg1011.sats[0].obs[0].code = 0;
+  msg1011.sats[0].obs[0].pseudorange = 20000004.4;
+  msg1011.sats[0].obs[0].carrier_phase = 106874009.6;
+  msg1011.sats[0].obs[0].lock = 900;
+  msg1011.sats[0].obs[0].flags.valid_pr = 1;
+  msg1011.sats[0].obs[0].flags.valid_cp = 1;
+  msg1011.sats[0].obs[0].flags.valid_lock = 1;
+  msg1011.sats[0].obs[1] = msg1011.sats[0].obs[0];
+  msg1011.sats[0].obs[1].pseudorange = 20000124.4;
+  msg1011.sats[0].obs[1].carrier_phase = 83124100.9;
+
+  msg1011.sats[1].svId = 6;
+  msg1011.sats[1].fcn = 13;
+  msg1011.sats[1].obs[0].code = 0;
+  msg1011.sats[1].obs[0].pseudorange = 22000004.4;
+  msg1011.sats[1].obs[0].carrier_phase = 117809044.6;
+  msg1011.sats[1].obs[0].lock = 254;
+  msg1011.sats[1].obs[0].flags.valid_pr = 1;
+  msg1011.sats[1].obs[0].flags.valid_cp = 1;
+  msg1011.sats[1].obs[0].flags.valid_lock = 1;
+  msg1011.sats[1].obs[1] = msg1011.sats[1].obs[0];
+  msg1011.sats[1].obs[1].pseudorange = 22000024.4;
+  msg1011.sats[1].obs[1].flags.valid_cp = 0;
+  msg1011.sats[1].obs[1].flags.valid_lock = 0;
+
+  msg1011.sats[2].svId = 7;
+  msg1011.sats[2].fcn = 1;
+  msg1011.sats[2].obs[0].code = 0;
+  msg1011.sats[2].obs[0].pseudorange = 22000004.4;
+  msg1011.sats[2].obs[0].flags.valid_pr = 1;
+
+  uint8_t buff[1024];
+  memset(buff, 0, 1024);
+  uint16_t len = rtcm3_encode_1011(&msg1011, buff);
+  assert(8 + (2 * 107 + 5) / 8 == len);
+
+  rtcm_obs_message msg1011_out;
+  int8_t ret = rtcm3_decode_1011(buff, &msg1011_out);
+
+  assert(RC_OK == ret && msgobs_glo_equals(&msg1011, &msg1011_out));
+  assert(RC_OK == rtcm3_decode_1011_bounded(buff, len, &msg1011_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_1011_bounded(buff, len - 1, &msg1011_out));
+}
+
 void test_rtcm_1012(void) {
   rtcm_obs_header header;
   header.msg_num = 1012;
@@ -609,6 +763,64 @@ static const uint8_t sample_1029_raw[] = {
     0x65,
     0x72};
 
+void test_rtcm_1013(void) {
+  rtcm_msg_1013 msg1013;
+  memset(&msg1013, 0, sizeof(msg1013));
+  msg1013.stn_id = 2003;
+  msg1013.mjd_num = 58400;
+  msg1013.utc_sec_of_day = 86399;
+  msg1013.n_msgs = 3;
+  msg1013.leap_seconds = 18;
+  msg1013.msgs[0].msg_num = 1077;
+  msg1013.msgs[0].sync = 1;
+  msg1013.msgs[0].interval_s = 1.0;
+  msg1013.msgs[1].msg_num = 1087;
+  msg1013.msgs[1].sync = 0;
+  msg1013.msgs[1].interval_s = 0.5;
+  msg1013.msgs[2].msg_num = 1006;
+  msg1013.msgs[2].interval_s = 7000.0; /* past the DF057 range */
+
+  uint8_t buff[1024];
+  memset(buff, 0, sizeof(buff));
+  uint16_t len = rtcm3_encode_1013(&msg1013, buff);
+  assert((70 + 3 * 29 + 7) / 8 == len);
+  assert(1013 == rtcm_getbitu(buff, 0, 12));
+  assert(2003 == rtcm_getbitu(buff, 12, 12));
+  assert(58400 == rtcm_getbitu(buff, 24, 16));
+  assert(86399 == rtcm_getbitu(buff, 40, 17));
+  assert(3 == rtcm_getbitu(buff, 57, 5));
+  assert(18 == rtcm_getbitu(buff, 62, 8));
+  assert(1077 == rtcm_getbitu(buff, 70, 12));
+  assert(1 == rtcm_getbitu(buff, 82, 1));
+  assert(10 == rtcm_getbitu(buff, 83, 16));
+  assert(5 == rtcm_getbitu(buff, 70 + 29 + 13, 16));
+  assert(0xFFFF == rtcm_getbitu(buff, 70 + 58 + 13, 16));
+
+  rtcm_msg_1013 msg1013_out;
+  assert(RC_OK == rtcm3_decode_1013(buff, &msg1013_out));
+  assert(msg1013_out.stn_id == 2003 && msg1013_out.mjd_num == 58400);
+  assert(msg1013_out.utc_sec_of_day == 86399);
+  assert(msg1013_out.n_msgs == 3 && msg1013_out.leap_seconds == 18);
+  for (uint8_t i = 0; i < 2; i++) {
+    assert(msg1013_out.msgs[i].msg_num == msg1013.msgs[i].msg_num);
+    assert(msg1013_out.msgs[i].sync == msg1013.msgs[i].sync);
+    assert(msg1013_out.msgs[i].interval_s == msg1013.msgs[i].interval_s);
+  }
+  assert(fabs(msg1013_out.msgs[2].interval_s - 6553.5) < 1e-9);
+
+  assert(RC_OK == rtcm3_decode_1013_bounded(buff, len, &msg1013_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_1013_bounded(buff, len - 1, &msg1013_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_1013_bounded(buff, 8, &msg1013_out));
+  rtcm3_any_msg any;
+  assert(RC_OK == rtcm3_decode_frame(buff, len, &any));
+  assert(RTCM3_MSG_1013 == any.kind && 3 == any.msg.msg_1013.n_msgs);
+
+  rtcm_setbitu(buff, 0, 12, 1012);
+  assert(RC_MESSAGE_TYPE_MISMATCH == rtcm3_decode_1013(buff, &msg1013_out));
+}
+
 void test_rtcm_1029(void) {
   rtcm_msg_1029 msg1029;
   msg1029.stn_id = 23;
@@ -1704,6 +1916,452 @@ void test_rtcm_msm7(void) {
   assert(RC_OK == ret && msg_msm_equals(&msg_msm7_expected, &msg_msm7_decoded));
 }
 
+void test_rtcm_msm6_encode(void) {
+  /* the captured 1077, padded to its full length */
+  uint8_t msm7_padded[sizeof(msm7_raw) + 1];
+  memset(msm7_padded, 0, sizeof(msm7_padded));
+  memcpy(msm7_padded, msm7_raw, sizeof(msm7_raw));
+
+  static rtcm_msm_message msg_msm6;
+  assert(RC_OK == rtcm3_decode_msm7(msm7_padded, &msg_msm6));
+
+  /* MSM6 has no range rates */
+  msg_msm6.header.msg_num = 1076;
+  for (uint8_t i = 0; i < RTCM_MAX_SATS; i++) {
+    msg_msm6.sats[i].rough_range_rate_m_s = 0;
+  }
+  for (uint8_t i = 0; i < MSM_MAX_CELLS; i++) {
+    msg_msm6.signals[i].flags.valid_dop = 0;
+  }
+
+  uint8_t buff[1024];
+  memset(buff, 0, sizeof(buff));
+  uint16_t num_bytes = rtcm3_encode_msm6(&msg_msm6, buff);
+  assert(num_bytes > 0 && num_bytes < sizeof(msm7_raw));
+  assert(0 == rtcm3_encode_msm7(&msg_msm6, buff));
+  assert(0 == rtcm3_encode_msm4(&msg_msm6, buff));
+
+  static rtcm_msm_message msg_msm6_out;
+  int8_t ret = rtcm3_decode_msm6(buff, &msg_msm6_out);
+  assert(RC_OK == ret && msg_msm_equals(&msg_msm6, &msg_msm6_out));
+  assert(RC_OK == rtcm3_decode_msm6_bounded(buff, num_bytes, &msg_msm6_out));
+}
+
+void test_rtcm_msm7_encode(void) {
+  /* the captured 1077, padded to its full length */
+  uint8_t msm7_padded[sizeof(msm7_raw) + 1];
+  memset(msm7_padded, 0, sizeof(msm7_padded));
+  memcpy(msm7_padded, msm7_raw, sizeof(msm7_raw));
+
+  static rtcm_msm_message msg_msm7;
+  assert(RC_OK == rtcm3_decode_msm7(msm7_padded, &msg_msm7));
+
+  /* re-encoding gives back the captured message */
+  uint8_t buff[1024];
+  memset(buff, 0, sizeof(buff));
+  uint16_t num_bytes = rtcm3_encode_msm7(&msg_msm7, buff);
+  assert(num_bytes == sizeof(msm7_padded));
+  assert(0 == memcmp(buff, msm7_raw, sizeof(msm7_raw)));
+
+  static rtcm_msm_message msg_msm7_out;
+  int8_t ret = rtcm3_decode_msm7(buff, &msg_msm7_out);
+  assert(RC_OK == ret && msg_msm_equals(&msg_msm7, &msg_msm7_out));
+
+  /* an invalid pseudorange comes back invalid from both decoders */
+  msg_msm7.signals[3].flags.valid_pr = 0;
+  memset(buff, 0, sizeof(buff));
+  num_bytes = rtcm3_encode_msm7(&msg_msm7, buff);
+  assert(num_bytes == sizeof(msm7_padded));
+  assert(RC_OK == rtcm3_decode_msm7(buff, &msg_msm7_out));
+  assert(!msg_msm7_out.signals[3].flags.valid_pr);
+  assert(msg_msm7_out.signals[2].flags.valid_pr);
+  assert(msg_msm7_out.signals[4].flags.valid_pr);
+
+  static uint64_t storage[sizeof(rtcm_msm_message) / sizeof(uint64_t)];
+  rtcm_msm_compact *compact = (rtcm_msm_compact *)storage;
+  assert(RC_OK ==
+         rtcm3_decode_msm_compact(buff, num_bytes, compact, sizeof(storage)));
+  assert(RC_OK == rtcm3_msm_compact_expand(compact, &msg_msm7_out));
+  assert(!msg_msm7_out.signals[3].flags.valid_pr);
+  assert(msg_msm7_out.signals[2].flags.valid_pr);
+}
+
+void test_msm_layout(void) {
+  uint8_t msm7_padded[sizeof(msm7_raw) + 1];
+  memset(msm7_padded, 0, sizeof(msm7_padded));
+  memcpy(msm7_padded, msm7_raw, sizeof(msm7_raw));
+
+  static rtcm_msm_message msg;
+  assert(RC_OK == rtcm3_decode_msm7(msm7_padded, &msg));
+
+  rtcm_msm_masks masks;
+  msm_pack_masks(&msg.header, &masks);
+  rtcm_msm_layout layout;
+  assert(rtcm3_msm_layout_init(1077, &masks, &layout));
+  assert(layout.num_cells == 49 && layout.length == sizeof(msm7_padded));
+  assert(layout.num_bits == 169 + 12 * 5 + 12 * 36 + 49 * 80);
+  assert(layout.dop_bit == layout.num_bits - 49 * 15);
+  assert(rtcm3_msm_layout_matches(&layout, 1077, &masks));
+  assert(!rtcm3_msm_layout_matches(&layout, 1076, &masks));
+
+  /* cell mask bits past the 12 * 5 cells do not change the layout */
+  rtcm_msm_masks stray = masks;
+  stray.cells |= (uint64_t)1 << 63;
+  assert(rtcm3_msm_layout_matches(&layout, 1077, &stray));
+
+  /* the layout is reused across epochs with the same masks */
+  uint8_t expected[1024];
+  uint8_t buff[1024];
+  for (uint8_t epoch = 0; epoch < 3; epoch++) {
+    msg.header.tow_ms += 1000;
+    for (uint8_t i = 0; i < layout.num_cells; i++) {
+      msg.signals[i].pseudorange_ms += 1e-6;
+      msg.signals[i].lock_time_s += 1;
+    }
+    memset(expected, 0, sizeof(expected));
+    memset(buff, 0, sizeof(buff));
+    uint16_t num_bytes = rtcm3_encode_msm7(&msg, expected);
+    assert(num_bytes == layout.length);
+    assert(num_bytes == rtcm3_encode_msm_layout(&layout, &msg, buff));
+    assert(0 == memcmp(buff, expected, num_bytes));
+  }
+
+  /* messages that do not match the layout */
+  msg.header.msg_num = 1076;
+  assert(0 == rtcm3_encode_msm_layout(&layout, &msg, buff));
+  masks.cells &= ~(uint64_t)1;
+  assert(!rtcm3_msm_layout_matches(&layout, 1077, &masks));
+  assert(rtcm3_msm_layout_init(1076, &masks, &layout));
+  assert(layout.num_cells == 48);
+
+  /* unsupported message types and too many cells */
+  assert(!rtcm3_msm_layout_init(1073, &masks, &layout));
+  assert(!rtcm3_msm_layout_init(1005, &masks, &layout));
+  masks.sigs = 0x3F;
+  assert(!rtcm3_msm_layout_init(1077, &masks, &layout));
+}
+
+void test_msm_epoch_encode(void) {
+  uint8_t msm7_padded[sizeof(msm7_raw) + 1];
+  memset(msm7_padded, 0, sizeof(msm7_padded));
+  memcpy(msm7_padded, msm7_raw, sizeof(msm7_raw));
+  static rtcm_msm_message msg;
+  assert(RC_OK == rtcm3_decode_msm7(msm7_padded, &msg));
+
+  /* the captured GPS observations, the same again on satellites 33-64 and
+   * once more as GAL */
+  rtcm_msm_masks masks;
+  msm_pack_masks(&msg.header, &masks);
+  uint8_t num_sigs = count_mask_bits(masks.sigs);
+  static rtcm_msm_obs obs[3 * MSM_MAX_CELLS];
+  uint16_t num_obs = 0;
+  uint64_t cells = masks.cells;
+  for (uint8_t i = 0; cells != 0; i++) {
+    uint8_t cell = pop_first_mask_bit(&cells);
+    rtcm_msm_obs *gps = &obs[num_obs++];
+    gps->cons = RTCM_CONSTELLATION_GPS;
+    gps->sat = find_nth_mask_bit(masks.sats, cell / num_sigs + 1);
+    gps->sig = find_nth_mask_bit(masks.sigs, cell % num_sigs + 1);
+    gps->glo_fcn = 0;
+    gps->data = msg.signals[i];
+    obs[num_obs] = *gps;
+    obs[num_obs++].sat += 32;
+    obs[num_obs] = *gps;
+    obs[num_obs++].cons = RTCM_CONSTELLATION_GAL;
+  }
+
+  rtcm_msm_epoch epoch;
+  memset(&epoch, 0, sizeof(epoch));
+  epoch.msm_type = MSM7;
+  epoch.stn_id = 17;
+  epoch.tow_ms[RTCM_CONSTELLATION_GPS] = msg.header.tow_ms;
+  epoch.tow_ms[RTCM_CONSTELLATION_GAL] = msg.header.tow_ms;
+  epoch.iods = 3;
+  epoch.num_obs = num_obs;
+  epoch.obs = obs;
+
+  static uint8_t buff[4 * RTCM3_MAX_FRAME_LEN];
+  size_t len = rtcm3_encode_msm_epoch(&epoch, buff, sizeof(buff));
+  assert(len > 0);
+
+  /* 24 GPS satellites with 5 signals need two messages */
+  static const uint16_t expected_msg_num[] = {1077, 1077, 1097};
+  rtcm3_framer framer;
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, buff, len);
+  rtcm3_frame frame;
+  uint8_t num_frames = 0;
+  size_t total_len = 0;
+  uint16_t num_cells = 0;
+  while (rtcm3_framer_next(&framer, &frame)) {
+    assert(num_frames < 3);
+    assert(frame.msg_num == expected_msg_num[num_frames]);
+    static rtcm_msm_message msg_out;
+    assert(RC_OK == rtcm3_decode_msm7_bounded(
+                        frame.payload, frame.payload_len, &msg_out));
+    assert(msg_out.header.stn_id == 17 && msg_out.header.iods == 3);
+    assert(msg_out.header.tow_ms == msg.header.tow_ms);
+    assert(msg_out.header.multiple == (num_frames < 2 ? 1 : 0));
+
+    rtcm_msm_masks masks_out;
+    msm_pack_masks(&msg_out.header, &masks_out);
+    uint8_t num_sigs_out = count_mask_bits(masks_out.sigs);
+    cells = masks_out.cells;
+    for (uint8_t i = 0; cells != 0; i++) {
+      uint8_t cell = pop_first_mask_bit(&cells);
+      uint8_t sat = find_nth_mask_bit(masks_out.sats, cell / num_sigs_out + 1);
+      uint8_t sig = find_nth_mask_bit(masks_out.sigs, cell % num_sigs_out + 1);
+      const rtcm_msm_obs *in = NULL;
+      for (uint16_t j = 0; j < num_obs; j++) {
+        if (obs[j].sat == sat && obs[j].sig == sig &&
+            (obs[j].cons == RTCM_CONSTELLATION_GAL) == (num_frames == 2)) {
+          in = &obs[j];
+        }
+      }
+      assert(in);
+      const rtcm_msm_signal_data *out = &msg_out.signals[i];
+      assert(out->flags.valid_cp == in->data.flags.valid_cp);
+      assert(out->flags.valid_dop == in->data.flags.valid_dop);
+      assert(!out->flags.valid_pr ||
+             fabs(out->pseudorange_ms - in->data.pseudorange_ms) < 1e-9);
+      assert(!out->flags.valid_cp ||
+             fabs(out->carrier_phase_ms - in->data.carrier_phase_ms) < 1e-9);
+      assert(!out->flags.valid_dop ||
+             fabs(out->range_rate_m_s - in->data.range_rate_m_s) < 1e-4);
+      num_cells++;
+    }
+    total_len += frame.frame_len;
+    num_frames++;
+  }
+  assert(3 == num_frames && len == total_len && num_obs == num_cells);
+
+  /* output buffer too small */
+  assert(0 == rtcm3_encode_msm_epoch(&epoch, buff, len - 1));
+
+  /* duplicate observations, unsupported message types */
+  obs[1].sat = obs[0].sat;
+  obs[1].sig = obs[0].sig;
+  assert(0 == rtcm3_encode_msm_epoch(&epoch, buff, sizeof(buff)));
+  epoch.num_obs = 1;
+  assert(0 < rtcm3_encode_msm_epoch(&epoch, buff, sizeof(buff)));
+  epoch.msm_type = MSM3;
+  assert(0 == rtcm3_encode_msm_epoch(&epoch, buff, sizeof(buff)));
+}
+
+/* Epochs passed on by the assembler in test_epoch_assembler() */
+static struct {
+  uint8_t count;
+  rtcm3_epoch last;
+  rtcm_msm_obs obs[RTCM3_EPOCH_MAX_OBS];
+} test_epochs;
+
+static void test_epoch_callback(const rtcm3_epoch *epoch, void *context) {
+  assert(context == &test_epochs);
+  test_epochs.count++;
+  test_epochs.last = *epoch;
+  assert(epoch->msm.num_obs <= RTCM3_EPOCH_MAX_OBS);
+  memcpy(test_epochs.obs,
+         epoch->msm.obs,
+         epoch->msm.num_obs * sizeof(epoch->msm.obs[0]));
+}
+
+void test_epoch_assembler(void) {
+  uint8_t msm7_padded[sizeof(msm7_raw) + 1];
+  memset(msm7_padded, 0, sizeof(msm7_padded));
+  memcpy(msm7_padded, msm7_raw, sizeof(msm7_raw));
+  static rtcm_msm_message msg;
+  assert(RC_OK == rtcm3_decode_msm7(msm7_padded, &msg));
+  const uint32_t tow_ms = msg.header.tow_ms;
+  const uint32_t tod_ms = tow_ms % (24 * 3600 * 1000);
+
+  /* the captured GPS observations, the same again as GLO and BDS, with
+   * the epoch time of each constellation */
+  rtcm_msm_masks masks;
+  msm_pack_masks(&msg.header, &masks);
+  uint8_t num_sigs = count_mask_bits(masks.sigs);
+  static rtcm_msm_obs obs[3 * MSM_MAX_CELLS];
+  uint16_t num_obs = 0;
+  uint64_t cells = masks.cells;
+  for (uint8_t i = 0; cells != 0; i++) {
+    uint8_t cell = pop_first_mask_bit(&cells);
+    rtcm_msm_obs *gps = &obs[num_obs++];
+    gps->cons = RTCM_CONSTELLATION_GPS;
+    gps->sat = find_nth_mask_bit(masks.sats, cell / num_sigs + 1);
+    gps->sig = find_nth_mask_bit(masks.sigs, cell % num_sigs + 1);
+    gps->glo_fcn = 0;
+    gps->data = msg.signals[i];
+    obs[num_obs] = *gps;
+    obs[num_obs].cons = RTCM_CONSTELLATION_GLO;
+    obs[num_obs++].glo_fcn = MSM_GLO_FCN_OFFSET;
+    obs[num_obs] = *gps;
+    obs[num_obs++].cons = RTCM_CONSTELLATION_BDS;
+  }
+  assert(num_obs <= RTCM3_EPOCH_MAX_OBS);
+
+  rtcm_msm_epoch epoch;
+  memset(&epoch, 0, sizeof(epoch));
+  epoch.msm_type = MSM7;
+  epoch.stn_id = 17;
+  epoch.tow_ms[RTCM_CONSTELLATION_GPS] = tow_ms;
+  epoch.tow_ms[RTCM_CONSTELLATION_GLO] =
+      (tod_ms + 3 * 3600 * 1000 - RTCM3_EPOCH_DEFAULT_LEAP_SECONDS * 1000) %
+      (24 * 3600 * 1000);
+  epoch.tow_ms[RTCM_CONSTELLATION_BDS] =
+      tow_ms - BDS_SECOND_TO_GPS_SECOND * 1000;
+  epoch.iods = 3;
+  epoch.num_obs = num_obs;
+  epoch.obs = obs;
+  static uint8_t buff[8 * RTCM3_MAX_FRAME_LEN];
+  size_t len = rtcm3_encode_msm_epoch(&epoch, buff, sizeof(buff));
+  assert(len > 0);
+
+  static rtcm3_any_msg msgs[8];
+  uint8_t num_msgs = 0;
+  rtcm3_framer framer;
+  rtcm3_framer_init(&framer);
+  rtcm3_framer_feed(&framer, buff, len);
+  rtcm3_frame frame;
+  while (rtcm3_framer_next(&framer, &frame)) {
+    assert(num_msgs < 8);
+    assert(RC_OK == rtcm3_decode_frame(
+                        frame.payload, frame.payload_len, &msgs[num_msgs]));
+    num_msgs++;
+  }
+  assert(num_msgs >= 3);
+
+  static rtcm3_epoch_slot slots[2];
+  rtcm3_epoch_assembler assembler;
+  rtcm3_epoch_init(
+      &assembler, slots, 2, 1000, test_epoch_callback, &test_epochs);
+
+  /* one callback, after the last message */
+  memset(&test_epochs, 0, sizeof(test_epochs));
+  for (uint8_t i = 0; i < num_msgs; i++) {
+    assert(0 == test_epochs.count);
+    assert(RC_OK == rtcm3_epoch_add(&assembler, &msgs[i], 100 + i));
+  }
+  assert(1 == test_epochs.count);
+  const rtcm3_epoch *out = &test_epochs.last;
+  assert(RTCM3_EPOCH_COMPLETE == out->end && !out->truncated);
+  assert(num_msgs == out->num_msgs && tod_ms == out->gps_tod_ms);
+  assert(((1 << RTCM_CONSTELLATION_GPS) | (1 << RTCM_CONSTELLATION_GLO) |
+          (1 << RTCM_CONSTELLATION_BDS)) == out->constellations);
+  assert(MSM7 == out->msm.msm_type && 17 == out->msm.stn_id);
+  assert(3 == out->msm.iods);
+  for (uint8_t i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+    assert(epoch.tow_ms[i] == out->msm.tow_ms[i]);
+  }
+  assert(num_obs == out->msm.num_obs);
+  for (uint16_t i = 0; i < num_obs; i++) {
+    const rtcm_msm_obs *in = NULL;
+    for (uint16_t j = 0; j < num_obs; j++) {
+      if (obs[j].cons == test_epochs.obs[i].cons &&
+          obs[j].sat == test_epochs.obs[i].sat &&
+          obs[j].sig == test_epochs.obs[i].sig) {
+        in = &obs[j];
+      }
+    }
+    assert(in);
+    const rtcm_msm_signal_data *data = &test_epochs.obs[i].data;
+    assert(data->flags.valid_pr == in->data.flags.valid_pr);
+    assert(!data->flags.valid_pr ||
+           fabs(data->pseudorange_ms - in->data.pseudorange_ms) < 1e-9);
+    assert(RTCM_CONSTELLATION_GLO != in->cons ||
+           MSM_GLO_FCN_OFFSET == test_epochs.obs[i].glo_fcn);
+  }
+
+  /* repeated messages of the epoch are late */
+  assert(RC_OK == rtcm3_epoch_add(&assembler, &msgs[0], 200));
+  assert(1 == test_epochs.count && 1 == assembler.stats.late);
+
+  /* a later epoch without its final message is passed on when the next
+   * one starts, or after the timeout */
+  msgs[0].msg.msm.header.tow_ms += 1000;
+  assert(RC_OK == rtcm3_epoch_add(&assembler, &msgs[0], 300));
+  msgs[0].msg.msm.header.tow_ms += 1000;
+  assert(RC_OK == rtcm3_epoch_add(&assembler, &msgs[0], 400));
+  assert(2 == test_epochs.count);
+  assert(RTCM3_EPOCH_SUPERSEDED == test_epochs.last.end);
+  assert((tod_ms + 1000) == test_epochs.last.gps_tod_ms);
+  assert(1 == test_epochs.last.num_msgs);
+  rtcm3_epoch_tick(&assembler, 1399);
+  assert(2 == test_epochs.count);
+  rtcm3_epoch_tick(&assembler, 1400);
+  assert(3 == test_epochs.count);
+  assert(RTCM3_EPOCH_TIMEOUT == test_epochs.last.end);
+  assert((tod_ms + 2000) == test_epochs.last.gps_tod_ms);
+  rtcm3_epoch_tick(&assembler, 5000);
+  assert(3 == test_epochs.count);
+
+  /* a third station takes over the least recently used slot */
+  msgs[0].msg.msm.header.tow_ms += 1000;
+  msgs[0].msg.msm.header.stn_id = 18;
+  assert(RC_OK == rtcm3_epoch_add(&assembler, &msgs[0], 500));
+  msgs[0].msg.msm.header.stn_id = 19;
+  assert(RC_OK == rtcm3_epoch_add(&assembler, &msgs[0], 600));
+  assert(3 == test_epochs.count);
+  msgs[0].msg.msm.header.stn_id = 17;
+  assert(RC_OK == rtcm3_epoch_add(&assembler, &msgs[0], 700));
+  assert(4 == test_epochs.count);
+  assert(RTCM3_EPOCH_EVICTED == test_epochs.last.end);
+  assert(18 == test_epochs.last.msm.stn_id);
+  rtcm3_epoch_flush(&assembler);
+  assert(6 == test_epochs.count);
+  assert(RTCM3_EPOCH_FLUSHED == test_epochs.last.end);
+  assert(1 == assembler.stats.epochs[RTCM3_EPOCH_COMPLETE]);
+  assert(2 == assembler.stats.epochs[RTCM3_EPOCH_FLUSHED]);
+
+  /* legacy GLO observations, completed by the synchronous flag */
+  rtcm_obs_message obs_msg;
+  memset(&obs_msg, 0, sizeof(obs_msg));
+  obs_msg.header.msg_num = 1012;
+  obs_msg.header.stn_id = 17;
+  obs_msg.header.tow_ms = 34700000;
+  obs_msg.header.sync = 1;
+  obs_msg.header.n_sat = 1;
+  obs_msg.sats[0].svId = 6;
+  obs_msg.sats[0].fcn = 13;
+  obs_msg.sats[0].obs[L1_FREQ].pseudorange = 22000004.4;
+  obs_msg.sats[0].obs[L1_FREQ].carrier_phase = 117809044.6;
+  obs_msg.sats[0].obs[L1_FREQ].lock = 254;
+  obs_msg.sats[0].obs[L1_FREQ].cnr = 50.25;
+  obs_msg.sats[0].obs[L1_FREQ].flags.data = 0x0F;
+  obs_msg.sats[0].obs[L2_FREQ] = obs_msg.sats[0].obs[L1_FREQ];
+  obs_msg.sats[0].obs[L2_FREQ].pseudorange = 22000024.4;
+  obs_msg.sats[0].obs[L2_FREQ].carrier_phase = 91629341.2;
+  assert(RC_OK == rtcm3_epoch_add_obs(&assembler, &obs_msg, 800));
+  assert(6 == test_epochs.count);
+  obs_msg.header.msg_num = 1004;
+  obs_msg.header.tow_ms = 34700000 - 3 * 3600 * 1000 +
+                          RTCM3_EPOCH_DEFAULT_LEAP_SECONDS * 1000;
+  obs_msg.header.sync = 0;
+  obs_msg.sats[0].fcn = 0;
+  assert(RC_OK == rtcm3_epoch_add_obs(&assembler, &obs_msg, 810));
+  assert(7 == test_epochs.count);
+  out = &test_epochs.last;
+  assert(RTCM3_EPOCH_COMPLETE == out->end && 2 == out->num_msgs);
+  assert(MSM_UNKNOWN == out->msm.msm_type);
+  assert(obs_msg.header.tow_ms == out->gps_tod_ms);
+  assert(4 == out->msm.num_obs);
+  assert(RTCM_CONSTELLATION_GLO == test_epochs.obs[0].cons);
+  assert(5 == test_epochs.obs[0].sat && 13 == test_epochs.obs[0].glo_fcn);
+  assert(test_epochs.obs[0].data.flags.valid_pr &&
+         test_epochs.obs[0].data.flags.valid_cp);
+  assert(RTCM_CONSTELLATION_GPS == test_epochs.obs[3].cons);
+
+  /* not observations, invalid epoch time */
+  rtcm3_any_msg other;
+  memset(&other, 0, sizeof(other));
+  other.kind = RTCM3_MSG_1005;
+  assert(RC_MESSAGE_TYPE_MISMATCH == rtcm3_epoch_add(&assembler, &other, 0));
+  obs_msg.header.msg_num = 1005;
+  assert(RC_MESSAGE_TYPE_MISMATCH ==
+         rtcm3_epoch_add_obs(&assembler, &obs_msg, 0));
+  msgs[0].msg.msm.header.tow_ms = RTCM_MAX_TOW_MS + 1;
+  assert(RC_INVALID_MESSAGE == rtcm3_epoch_add(&assembler, &msgs[0], 0));
+  assert(7 == test_epochs.count);
+}
+
 void test_rtcm_4062(void) {
   rtcm_msg_swift_proprietary msg_in;
   msg_in.msg_type = 12345;
@@ -1730,6 +2388,260 @@ void test_rtcm_4062(void) {
   }
 }
 
+void test_decode_frame(void) {
+  static rtcm3_any_msg any;
+
+  /* the captured 1077 is missing the last 5 bits of its final cell */
+  rtcm3_rc ret = rtcm3_decode_frame(msm7_raw, sizeof(msm7_raw), &any);
+  assert(RC_INVALID_MESSAGE == ret && 1077 == any.msg_num);
+
+  /* MSM goes through the table without the per-decoder type checks */
+  uint8_t msm7_padded[sizeof(msm7_raw) + 1];
+  memset(msm7_padded, 0, sizeof(msm7_padded));
+  memcpy(msm7_padded, msm7_raw, sizeof(msm7_raw));
+  ret = rtcm3_decode_frame(msm7_padded, sizeof(msm7_padded), &any);
+  assert(RC_OK == ret && RTCM3_MSG_MSM == any.kind && 1077 == any.msg_num);
+  rtcm_msm_message msg_msm7_expected;
+  msg_msm7_expected.header = msm7_expected_header;
+  memcpy(msg_msm7_expected.sats,
+         msm7_expected_sat_data,
+         sizeof(msm7_expected_sat_data));
+  memcpy(msg_msm7_expected.signals,
+         msm7_expected_sig_data,
+         sizeof(msm7_expected_sig_data));
+  assert(msg_msm_equals(&msg_msm7_expected, &any.msg.msm));
+
+  rtcm_msg_1005 msg1005;
+  memset(&msg1005, 0, sizeof(msg1005));
+  msg1005.stn_id = 5;
+  msg1005.ITRF = 1;
+  msg1005.GPS_ind = 1;
+  msg1005.arp_x = 3578346.5475;
+  msg1005.arp_y = -5578346.5578;
+  msg1005.arp_z = 2578346.6757;
+  uint8_t buff[1024];
+  memset(buff, 0, sizeof(buff));
+  uint16_t len = rtcm3_encode_1005(&msg1005, buff);
+  ret = rtcm3_decode_frame(buff, len, &any);
+  assert(RC_OK == ret && RTCM3_MSG_1005 == any.kind);
+  assert(msg1005_equals(&msg1005, &any.msg.msg_1005));
+
+  rtcm_msg_swift_proprietary msg4062;
+  msg4062.msg_type = 12345;
+  msg4062.sender_id = 56789;
+  msg4062.len = 3;
+  memset(msg4062.data, 0xAA, msg4062.len);
+  len = rtcm3_encode_4062(&msg4062, buff);
+  ret = rtcm3_decode_frame(buff, len, &any);
+  assert(RC_OK == ret && RTCM3_MSG_SWIFT_PROPRIETARY == any.kind);
+  assert(any.msg.swift.sender_id == 56789 && any.msg.swift.len == 3);
+
+  /* unsupported message numbers, inside and outside the table range */
+  const uint16_t unsupported[] = {1014, 1015, 1131, 1264, 4095, 0};
+  for (size_t i = 0; i < sizeof(unsupported) / sizeof(unsupported[0]); i++) {
+    rtcm_setbitu(buff, 0, 12, unsupported[i]);
+    ret = rtcm3_decode_frame(buff, sizeof(buff), &any);
+    assert(RC_MESSAGE_TYPE_MISMATCH == ret && RTCM3_MSG_NONE == any.kind);
+    assert(unsupported[i] == any.msg_num);
+  }
+
+  assert(RC_INVALID_MESSAGE == rtcm3_decode_frame(buff, 1, &any));
+}
+
+void test_peek_header(void) {
+  static rtcm3_any_msg any;
+  rtcm3_msg_peek peek;
+
+  /* MSM header matches the full decode, even of the truncated capture */
+  uint8_t msm7_padded[sizeof(msm7_raw) + 1];
+  memset(msm7_padded, 0, sizeof(msm7_padded));
+  memcpy(msm7_padded, msm7_raw, sizeof(msm7_raw));
+  assert(RC_OK ==
+         rtcm3_decode_frame(msm7_padded, sizeof(msm7_padded), &any));
+  assert(RC_OK == rtcm3_peek_header(msm7_raw, sizeof(msm7_raw), &peek));
+  assert(1077 == peek.msg_num && RTCM3_MSG_MSM == peek.kind);
+  assert(RTCM_CONSTELLATION_GPS == peek.cons && MSM7 == peek.msm_type);
+  assert((RTCM3_PEEK_HAS_STN_ID | RTCM3_PEEK_HAS_TIME |
+          RTCM3_PEEK_HAS_MULTIPLE) == peek.flags);
+  assert(any.msg.msm.header.stn_id == peek.stn_id);
+  assert(any.msg.msm.header.tow_ms == peek.tow_ms);
+  assert(any.msg.msm.header.multiple == peek.multiple);
+
+  /* legacy observation headers */
+  uint8_t buff[1024];
+  rtcm_obs_message obs;
+  memset(&obs, 0, sizeof(obs));
+  obs.header.msg_num = 1004;
+  obs.header.stn_id = 4095;
+  obs.header.tow_ms = 604799000;
+  obs.header.sync = 1;
+  memset(buff, 0, sizeof(buff));
+  uint16_t len = rtcm3_encode_1004(&obs, buff);
+  assert(RC_OK == rtcm3_peek_header(buff, len, &peek));
+  assert(1004 == peek.msg_num && RTCM3_MSG_OBS == peek.kind);
+  assert(RTCM_CONSTELLATION_GPS == peek.cons && MSM_UNKNOWN == peek.msm_type);
+  assert(4095 == peek.stn_id && 604799000 == peek.tow_ms && peek.multiple);
+
+  obs.header.msg_num = 1012;
+  obs.header.tow_ms = 86399000;
+  obs.header.sync = 0;
+  memset(buff, 0, sizeof(buff));
+  len = rtcm3_encode_1012(&obs, buff);
+  assert(RC_OK == rtcm3_peek_header(buff, len, &peek));
+  assert(1012 == peek.msg_num && RTCM_CONSTELLATION_GLO == peek.cons);
+  assert(86399000 == peek.tow_ms && !peek.multiple);
+  assert(RTCM3_PEEK_HAS_MULTIPLE & peek.flags);
+
+  /* 1011 shares the header of 1012 */
+  rtcm_setbitu(buff, 0, 12, 1011);
+  assert(RC_OK == rtcm3_peek_header(buff, len, &peek));
+  assert(RTCM3_MSG_OBS == peek.kind && 86399000 == peek.tow_ms);
+
+  /* headers of message numbers rtcm3_decode_frame() does not decode; the
+   * GLONASS MSM time of day follows the day of week */
+  memset(buff, 0, sizeof(buff));
+  rtcm_setbitu(buff, 0, 12, 1083);
+  rtcm_setbitu(buff, 12, 12, 17);
+  rtcm_setbitu(buff, 24, 3, 6);
+  rtcm_setbitu(buff, 27, 27, 43200000);
+  rtcm_setbitu(buff, 54, 1, 1);
+  assert(RC_OK == rtcm3_peek_header(buff, 8, &peek));
+  assert(RTCM3_MSG_NONE == peek.kind && MSM3 == peek.msm_type);
+  assert(RTCM_CONSTELLATION_GLO == peek.cons && 17 == peek.stn_id);
+  assert(43200000 == peek.tow_ms && peek.multiple);
+
+  /* fields past the end of the payload are left out */
+  assert(RC_OK == rtcm3_peek_header(buff, 6, &peek));
+  assert(RTCM3_PEEK_HAS_STN_ID == peek.flags && 17 == peek.stn_id);
+
+  /* BeiDou MSM epochs are normalized as by the decoders */
+  rtcm_setbitu(buff, 0, 12, 1127);
+  rtcm_setbitu(buff, 24, 30, C_2P30 - 1000);
+  assert(RC_OK == rtcm3_peek_header(buff, 8, &peek));
+  assert(RTCM_CONSTELLATION_BDS == peek.cons && MSM7 == peek.msm_type);
+  assert(RTCM_MAX_TOW_MS + 1 - 1000 == peek.tow_ms);
+
+  /* SSR epoch time in seconds, then the update interval and DF388 */
+  memset(buff, 0, sizeof(buff));
+  rtcm_setbitu(buff, 0, 12, 1060);
+  rtcm_setbitu(buff, 12, 20, 345600);
+  rtcm_setbitu(buff, 32, 4, 2);
+  rtcm_setbitu(buff, 36, 1, 1);
+  assert(RC_OK == rtcm3_peek_header(buff, 9, &peek));
+  assert(RTCM3_MSG_SSR_ORBIT_CLOCK == peek.kind);
+  assert(RTCM_CONSTELLATION_GPS == peek.cons);
+  assert((RTCM3_PEEK_HAS_TIME | RTCM3_PEEK_HAS_MULTIPLE) == peek.flags);
+  assert(345600000 == peek.tow_ms && peek.multiple);
+
+  memset(buff, 0, sizeof(buff));
+  rtcm_setbitu(buff, 0, 12, 1266);
+  rtcm_setbitu(buff, 12, 17, 86399);
+  rtcm_setbitu(buff, 33, 1, 1);
+  assert(RC_OK == rtcm3_peek_header(buff, 9, &peek));
+  assert(RTCM3_MSG_SSR_PHASE_BIAS == peek.kind);
+  assert(RTCM_CONSTELLATION_GLO == peek.cons);
+  assert(86399000 == peek.tow_ms && peek.multiple);
+
+  /* ephemeris satellite, which is 4 bits for QZSS */
+  memset(buff, 0, sizeof(buff));
+  rtcm_setbitu(buff, 0, 12, 1044);
+  rtcm_setbitu(buff, 12, 4, 9);
+  rtcm_setbitu(buff, 16, 8, 0xFF);
+  assert(RC_OK == rtcm3_peek_header(buff, 3, &peek));
+  assert(RTCM3_MSG_EPH == peek.kind && RTCM_CONSTELLATION_QZS == peek.cons);
+  assert(RTCM3_PEEK_HAS_SAT_ID == peek.flags && 9 == peek.sat_id);
+
+  rtcm_msg_1005 msg1005;
+  memset(&msg1005, 0, sizeof(msg1005));
+  msg1005.stn_id = 5;
+  memset(buff, 0, sizeof(buff));
+  len = rtcm3_encode_1005(&msg1005, buff);
+  assert(RC_OK == rtcm3_peek_header(buff, len, &peek));
+  assert(RTCM3_MSG_1005 == peek.kind && RTCM3_PEEK_HAS_STN_ID == peek.flags);
+  assert(5 == peek.stn_id && RTCM_CONSTELLATION_INVALID == peek.cons);
+
+  rtcm_setbitu(buff, 0, 12, 4095);
+  assert(RC_MESSAGE_TYPE_MISMATCH == rtcm3_peek_header(buff, len, &peek));
+  assert(4095 == peek.msg_num && 0 == peek.flags);
+  assert(RC_INVALID_MESSAGE == rtcm3_peek_header(buff, 1, &peek));
+}
+
+static uint64_t test_stats_ticks = 0;
+
+static uint64_t test_stats_clock(void) {
+  test_stats_ticks += 5;
+  return test_stats_ticks;
+}
+
+static uint16_t test_stats_encode_1005(const void *msg, uint8_t buff[]) {
+  return rtcm3_encode_1005((const rtcm_msg_1005 *)msg, buff);
+}
+
+static uint16_t test_stats_encode_fail(const void *msg, uint8_t buff[]) {
+  (void)msg;
+  (void)buff;
+  return 0;
+}
+
+void test_stats(void) {
+  static rtcm3_stats stats;
+  static rtcm3_stats total;
+  static rtcm3_any_msg any;
+  rtcm3_stats_init(&stats, test_stats_clock, 2);
+  rtcm3_stats_init(&total, NULL, 0);
+
+  assert(rtcm3_stats_slot(1005) == 4);
+  assert(rtcm3_stats_slot_msg_num(4) == 1005);
+  assert(rtcm3_stats_slot_msg_num(rtcm3_stats_slot(999)) == 999);
+  assert(rtcm3_stats_slot_msg_num(rtcm3_stats_slot(4062)) == 4062);
+  assert(rtcm3_stats_slot(1300) == RTCM3_STATS_SLOT_OTHER);
+  assert(rtcm3_stats_slot(1000) == RTCM3_STATS_SLOT_OTHER);
+
+  rtcm_msg_1005 msg1005;
+  memset(&msg1005, 0, sizeof(msg1005));
+  msg1005.stn_id = 5;
+  msg1005.arp_x = 3578346.5475;
+  uint8_t buff[1024];
+  memset(buff, 0, sizeof(buff));
+  uint16_t len = rtcm3_encode_counted(
+      &stats, 1005, test_stats_encode_1005, &msg1005, buff);
+  assert(len == 19);
+  assert(rtcm3_encode_counted(
+             &stats, 1006, test_stats_encode_fail, &msg1005, buff + 100) ==
+         0);
+  for (uint8_t i = 0; i < 3; i++) {
+    assert(RC_OK == rtcm3_decode_frame_counted(&stats, buff, len, &any));
+  }
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_frame_counted(&stats, buff, len - 1, &any));
+  rtcm_setbitu(buff, 0, 12, 2000);
+  assert(RC_MESSAGE_TYPE_MISMATCH ==
+         rtcm3_decode_frame_counted(&stats, buff, len, &any));
+
+  const rtcm3_msg_counters *decode = &stats.decode[rtcm3_stats_slot(1005)];
+  assert(decode->messages == 4);
+  assert(decode->bytes == 4u * len - 1);
+  assert(decode->invalid == 1 && decode->mismatches == 0);
+  const rtcm3_msg_counters *other = &stats.decode[RTCM3_STATS_SLOT_OTHER];
+  assert(other->messages == 1 && other->mismatches == 1);
+  const rtcm3_msg_counters *encode = &stats.encode[rtcm3_stats_slot(1005)];
+  assert(encode->messages == 1 && encode->bytes == len);
+  assert(stats.encode[rtcm3_stats_slot(1006)].mismatches == 1);
+
+  /* every second call is timed, each taking 5 ticks */
+  assert(encode->samples == 0);
+  assert(stats.encode[rtcm3_stats_slot(1006)].samples == 1);
+  assert(decode->samples == 2 && decode->ticks == 10);
+  assert(decode->hist[2] == 2);
+  assert(other->samples == 0);
+
+  rtcm3_stats_merge(&total, &stats);
+  rtcm3_stats_merge(&total, &stats);
+  assert(total.decode[rtcm3_stats_slot(1005)].messages == 8);
+  assert(total.decode[rtcm3_stats_slot(1005)].hist[2] == 4);
+  assert(total.encode[rtcm3_stats_slot(1006)].mismatches == 2);
+}
+
 void test_rtcm_random_bits(void) {
   /* test the MSM decoders with random garbage, they should either return a
    * failure code or manage to decode something, but not crash */
@@ -1833,6 +2745,213 @@ void test_msm_bit_utils(void) {
     assert(3 == find_nth_mask_value(sizeof(mask), mask, 4));
     assert(4 == find_nth_mask_value(sizeof(mask), mask, 5));
   }
+
+  /* packed masks */
+  assert(0 == count_mask_bits(0));
+  assert(64 == count_mask_bits(UINT64_MAX));
+  {
+    uint64_t mask = 0x8000000000000011ULL;
+    assert(3 == count_mask_bits(mask));
+    assert(0 == find_nth_mask_bit(mask, 1));
+    assert(4 == find_nth_mask_bit(mask, 2));
+    assert(63 == find_nth_mask_bit(mask, 3));
+    assert(0 == pop_first_mask_bit(&mask));
+    assert(4 == pop_first_mask_bit(&mask));
+    assert(63 == pop_first_mask_bit(&mask));
+    assert(0 == mask);
+  }
+  assert(0x1 == reverse_mask_bits(0x10, 5));
+  assert(0x6 == reverse_mask_bits(0x3, 3));
+  assert(0x8000000000000000ULL == reverse_mask_bits(1, 64));
+  assert(0 == reverse_mask_bits(1, 0));
+  for (uint64_t mask = 1; mask != 0; mask <<= 3) {
+    assert(mask == reverse_mask_bits(reverse_mask_bits(mask, 64), 64));
+  }
+
+  /* the packed masks match the Boolean arrays */
+  rtcm_msm_header header;
+  memset(&header, 0, sizeof(header));
+  header.satellite_mask[2] = true;
+  header.satellite_mask[40] = true;
+  header.signal_mask[1] = true;
+  header.signal_mask[30] = true;
+  header.cell_mask[0] = true;
+  header.cell_mask[3] = true;
+  rtcm_msm_masks masks;
+  msm_pack_masks(&header, &masks);
+  assert(((uint64_t)1 << 2 | (uint64_t)1 << 40) == masks.sats);
+  assert(((uint32_t)1 << 1 | (uint32_t)1 << 30) == masks.sigs);
+  assert(0x9 == masks.cells);
+  rtcm_msm_header unpacked;
+  memset(&unpacked, 0xFF, sizeof(unpacked));
+  msm_unpack_masks(&masks, &unpacked);
+  assert(0 == memcmp(header.satellite_mask,
+                     unpacked.satellite_mask,
+                     sizeof(header.satellite_mask)));
+  assert(0 == memcmp(header.signal_mask,
+                     unpacked.signal_mask,
+                     sizeof(header.signal_mask)));
+  assert(0 == memcmp(header.cell_mask,
+                     unpacked.cell_mask,
+                     sizeof(header.cell_mask)));
+}
+
+/* reference bit-at-a-time implementation to check the word based readers */
+static uint64_t getbitul_reference(const uint8_t *buff,
+                                   uint32_t pos,
+                                   uint8_t len) {
+  uint64_t bits = 0;
+  for (uint32_t i = pos; i < pos + len; i++) {
+    bits = (bits << 1) + ((buff[i / 8] >> (7 - i % 8)) & 1u);
+  }
+  return bits;
+}
+
+void test_bit_reader(void) {
+  uint8_t buff[64];
+  for (uint16_t i = 0; i < sizeof(buff); i++) {
+    buff[i] = rand() & 0xFF;
+  }
+
+  /* random access functions against the reference */
+  for (uint32_t pos = 0; pos + 64 <= sizeof(buff) * 8; pos++) {
+    for (uint8_t len = 1; len <= 64; len++) {
+      uint64_t expected = getbitul_reference(buff, pos, len);
+      assert(rtcm_getbitul(buff, pos, len) == expected);
+      uint64_t m = ((uint64_t)1) << (len - 1);
+      int64_t expected_signed = (int64_t)((expected ^ m) - m);
+      assert(rtcm_getbitsl(buff, pos, len) == expected_signed);
+      if (len <= 32) {
+        assert(rtcm_getbitu(buff, pos, len) == (uint32_t)expected);
+        assert(rtcm_getbits(buff, pos, len) == (int32_t)expected_signed);
+        int32_t magnitude = (int32_t)(expected & ~(uint32_t)m);
+        assert(rtcm_get_sign_magnitude_bit(buff, pos, len) ==
+               ((expected >> (len - 1)) ? -magnitude : magnitude));
+      }
+    }
+  }
+
+  /* sequential reads of random widths must match the random access reads,
+   * including the tail of the buffer where no full word can be loaded */
+  for (uint32_t rep = 0; rep < 1000; rep++) {
+    rtcm_bitreader reader;
+    rtcm_bitreader_init(&reader, buff, sizeof(buff));
+    uint32_t pos = 0;
+    while (true) {
+      int kind = rand() % 4;
+      /* 64 bit fields for the long readers, 32 bit for the others */
+      uint8_t len = (kind < 2) ? 1 + rand() % 64 : 2 + rand() % 31;
+      if (pos + len > sizeof(buff) * 8) {
+        break;
+      }
+      switch (kind) {
+        case 0:
+          assert(rtcm_read_bitul(&reader, len) ==
+                 getbitul_reference(buff, pos, len));
+          break;
+        case 1:
+          assert(rtcm_read_bitsl(&reader, len) ==
+                 rtcm_getbitsl(buff, pos, len));
+          break;
+        case 2:
+          assert(rtcm_read_bits(&reader, len) == rtcm_getbits(buff, pos, len));
+          break;
+        default:
+          assert(rtcm_read_sign_magnitude_bit(&reader, len) ==
+                 rtcm_get_sign_magnitude_bit(buff, pos, len));
+          break;
+      }
+      pos += len;
+      assert(reader.pos == pos && !reader.overrun);
+      assert(rtcm_bitreader_remaining(&reader) == sizeof(buff) * 8 - pos);
+    }
+  }
+
+  /* reading past the end of the buffer returns 0 and flags the overrun */
+  {
+    rtcm_bitreader reader;
+    rtcm_bitreader_init(&reader, buff, 4);
+    rtcm_read_skip(&reader, 20);
+    assert(rtcm_read_bitu(&reader, 12) == rtcm_getbitu(buff, 20, 12));
+    assert(!reader.overrun && rtcm_bitreader_remaining(&reader) == 0);
+    assert(rtcm_read_bitu(&reader, 1) == 0 && reader.overrun);
+  }
+}
+
+void test_bit_writer(void) {
+  uint8_t expected[128];
+  uint8_t buff[128];
+
+  for (uint32_t rep = 0; rep < 1000; rep++) {
+    /* the writer must leave the bits around the written range untouched,
+     * exactly like the rtcm_setbit* functions */
+    for (uint16_t i = 0; i < sizeof(buff); i++) {
+      expected[i] = buff[i] = rand() & 0xFF;
+    }
+
+    uint32_t pos = rand() % 64;
+    rtcm_bitwriter writer;
+    rtcm_bitwriter_init(&writer, buff, sizeof(buff), pos);
+    while (true) {
+      int kind = rand() % 4;
+      uint8_t len = (kind < 2) ? 1 + rand() % 64 : 2 + rand() % 31;
+      if (pos + len > (sizeof(buff) - 8) * 8) {
+        break;
+      }
+      int64_t data = (int64_t)(((uint64_t)rand() << 33) ^
+                               ((uint64_t)rand() << 16) ^ (uint64_t)rand());
+      switch (kind) {
+        case 0:
+          rtcm_setbitul(expected, pos, len, (uint64_t)data);
+          rtcm_write_bitul(&writer, len, (uint64_t)data);
+          break;
+        case 1:
+          rtcm_setbitsl(expected, pos, len, data);
+          rtcm_write_bitsl(&writer, len, data);
+          break;
+        case 2:
+          rtcm_setbits(expected, pos, len, (int32_t)data);
+          rtcm_write_bits(&writer, len, (int32_t)data);
+          break;
+        default:
+          data = (int32_t)data % ((int64_t)1 << (len - 1));
+          rtcm_set_sign_magnitude_bit(expected, pos, len, data);
+          rtcm_write_sign_magnitude_bit(&writer, len, data);
+          assert(rtcm_get_sign_magnitude_bit(expected, pos, len) == data);
+          break;
+      }
+      pos += len;
+      if (rand() % 16 == 0) {
+        /* an intermediate flush must not disturb later writes */
+        assert(rtcm_bitwriter_flush(&writer) == (pos + 7) / 8);
+      }
+    }
+    assert(rtcm_bitwriter_flush(&writer) == (pos + 7) / 8);
+    assert(!writer.overrun);
+    assert(memcmp(expected, buff, sizeof(buff)) == 0);
+  }
+
+  /* writes past the end of the buffer are dropped and flagged */
+  {
+    memset(buff, 0, sizeof(buff));
+    rtcm_bitwriter writer;
+    rtcm_bitwriter_init(&writer, buff, 2, 4);
+    rtcm_write_bitu(&writer, 12, 0xFFF);
+    assert(!writer.overrun);
+    rtcm_write_bitu(&writer, 1, 1);
+    assert(writer.overrun && rtcm_bitwriter_flush(&writer) == 0);
+    assert(buff[2] == 0);
+  }
+
+  /* the flushed length is not truncated for buffers over 64 KiB */
+  {
+    static uint8_t big[70000];
+    rtcm_bitwriter writer;
+    rtcm_bitwriter_init(&writer, big, sizeof(big), 69990 * 8);
+    rtcm_write_bitu(&writer, 12, 0xABC);
+    assert(rtcm_bitwriter_flush(&writer) == 69992);
+    assert(big[69990] == 0xAB && big[69991] == 0xC0);
+  }
 }
 
 // Get an example Keplerian orbit for testing
@@ -1859,6 +2978,21 @@ static rtcm_msg_eph get_example_keplerian_rtcm_eph(
     // L2 data is only for GPS
     ret.kepler.codeL2 = 1;
     ret.kepler.L2_data_bit = true;
+  } else if (cons == RTCM_CONSTELLATION_QZS) {
+    // sat_id is 4 bits
+    ret.sat_id = 3;
+    // wn is mod 1024
+    ret.wn = 1022;
+    // toe is in 16 second increments
+    ret.toe = 460800 / 16;
+    // only one TGD
+    ret.kepler.tgd_qzss_s = -3;
+    // toc is in 16 second increments
+    ret.kepler.toc = 460800 / 16;
+    // iodc can be 0-1023
+    ret.kepler.iodc = 954;
+    // iode can be 0-255
+    ret.kepler.iode = 250;
   } else if (cons == RTCM_CONSTELLATION_GAL) {
     // wn is mod 4096
     ret.wn = 4000;
@@ -2035,6 +3169,8 @@ static void compare_glonass_ephs(const rtcm_msg_eph *first,
 void test_rtcm_1019() {
   rtcm_msg_eph msg_1019_in =
       get_example_keplerian_rtcm_eph(RTCM_CONSTELLATION_GPS);
+  /* toc and toe apart, so that the two cannot be swapped */
+  msg_1019_in.kepler.toc = msg_1019_in.toe - 1;
   uint8_t frame[1023];
   rtcm3_encode_gps_eph(&msg_1019_in, &frame[0]);
 
@@ -2067,6 +3203,17 @@ void test_rtcm_1042() {
   compare_keplerian_ephs(&msg_1042_in, &msg_1042_out);
 }
 
+void test_rtcm_1044() {
+  rtcm_msg_eph msg_1044_in =
+      get_example_keplerian_rtcm_eph(RTCM_CONSTELLATION_QZS);
+  uint8_t frame[1023];
+  rtcm3_encode_qzss_eph(&msg_1044_in, &frame[0]);
+
+  rtcm_msg_eph msg_1044_out;
+  rtcm3_decode_qzss_eph(&frame[0], &msg_1044_out);
+  compare_keplerian_ephs(&msg_1044_in, &msg_1044_out);
+}
+
 void test_rtcm_1045() {
   rtcm_msg_eph msg_1045_in =
       get_example_keplerian_rtcm_eph(RTCM_CONSTELLATION_GAL);
@@ -2090,6 +3237,1234 @@ void test_rtcm_1046() {
   compare_keplerian_ephs(&msg_1046_in, &msg_1046_out);
 }
 
+static rtcm3_eph_msg last_eph_source;
+
+static void count_eph_updates(const rtcm_msg_eph *eph,
+                              rtcm3_eph_msg source,
+                              void *context) {
+  (void)eph;
+  last_eph_source = source;
+  (*(uint32_t *)context)++;
+}
+
+void test_eph_store(void) {
+  static rtcm3_eph_store store;
+  uint32_t num_callbacks = 0;
+  rtcm3_eph_store_init(&store, count_eph_updates, &num_callbacks);
+  assert(rtcm3_eph_store_get(&store, RTCM_CONSTELLATION_GPS, 25) == NULL);
+
+  uint8_t buff[1023];
+  memset(buff, 0, sizeof(buff));
+  rtcm_msg_eph gps = get_example_keplerian_rtcm_eph(RTCM_CONSTELLATION_GPS);
+  uint16_t len = rtcm3_encode_gps_eph(&gps, buff);
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  assert(num_callbacks == 1 && store.stats.updates == 1);
+  const rtcm_msg_eph *stored =
+      rtcm3_eph_store_get(&store, RTCM_CONSTELLATION_GPS, 25);
+  assert(stored != NULL);
+  compare_keplerian_ephs(&gps, stored);
+  assert(store.sats[RTCM3_EPH_GPS][25].generation == 1);
+
+  /* a rebroadcast is not decoded */
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  assert(num_callbacks == 1 && store.stats.repeats == 1);
+
+  /* the same issue of data with other contents is not an update */
+  gps.ura = 3;
+  len = rtcm3_encode_gps_eph(&gps, buff);
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  assert(num_callbacks == 1 && store.stats.unchanged == 1);
+  assert(stored->ura != 3);
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  assert(store.stats.repeats == 2);
+
+  /* new IODE */
+  gps.kepler.iode = 251;
+  len = rtcm3_encode_gps_eph(&gps, buff);
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  assert(num_callbacks == 2 && store.stats.updates == 2);
+  assert(stored->kepler.iode == 251 && stored->ura == 3);
+  assert(store.sats[RTCM3_EPH_GPS][25].generation == 2);
+
+  /* F/NAV and I/NAV of the same issue are stored and notified apart */
+  rtcm_msg_eph gal = get_example_keplerian_rtcm_eph(RTCM_CONSTELLATION_GAL);
+  len = rtcm3_encode_gal_eph_fnav(&gal, buff);
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  assert(num_callbacks == 3 && last_eph_source == RTCM3_EPH_GAL_FNAV);
+  gal.kepler.af0 += 1;
+  len = rtcm3_encode_gal_eph_inav(&gal, buff);
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  assert(num_callbacks == 4 && last_eph_source == RTCM3_EPH_GAL_INAV);
+  assert(store.stats.unchanged == 1);
+  const rtcm_msg_eph *fnav =
+      rtcm3_eph_store_get_msg(&store, RTCM3_EPH_GAL_FNAV, 25);
+  const rtcm_msg_eph *inav =
+      rtcm3_eph_store_get_msg(&store, RTCM3_EPH_GAL_INAV, 25);
+  assert(fnav != NULL && inav != NULL);
+  assert(inav->kepler.af0 == fnav->kepler.af0 + 1);
+  assert(rtcm3_eph_store_get(&store, RTCM_CONSTELLATION_GAL, 25) == inav);
+  assert(rtcm3_eph_store_get_msg(&store, RTCM3_EPH_GAL_INAV, 24) == NULL);
+
+  /* GLONASS ephemerides are identified by N_t and t_b */
+  rtcm_msg_eph glo = get_example_glonass_rtcm_eph(10);
+  len = rtcm3_encode_glo_eph(&glo, buff);
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  glo.glo.pos[0] += 1;
+  len = rtcm3_encode_glo_eph(&glo, buff);
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  assert(num_callbacks == 5 && store.stats.unchanged == 2);
+  glo = get_example_glonass_rtcm_eph(11);
+  len = rtcm3_encode_glo_eph(&glo, buff);
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  assert(num_callbacks == 6 && last_eph_source == RTCM3_EPH_GLO);
+  assert(rtcm3_eph_store_get(&store, RTCM_CONSTELLATION_GLO, glo.sat_id)
+             ->glo.t_b == 11);
+  /* the same t_b on the next day */
+  rtcm_setbitu(buff, 268, 11, 1);
+  assert(rtcm3_eph_store_update(&store, buff, len) == RC_OK);
+  assert(num_callbacks == 7);
+  assert(store.sats[RTCM3_EPH_GLO][glo.sat_id].glo_day == 1);
+
+  /* the QZSS satellite ID DF429 is 4 bits, followed by toc */
+  uint8_t qzss[61]; /* 485 bits */
+  memset(qzss, 0, sizeof(qzss));
+  rtcm_setbitu(qzss, 0, 12, 1044);
+  rtcm_setbitu(qzss, 12, 4, 5);
+  rtcm_setbitu(qzss, 16, 16, 0xC000);
+  rtcm_setbitu(qzss, 246, 16, 100);
+  assert(rtcm3_eph_store_update(&store, qzss, sizeof(qzss)) == RC_OK);
+  assert(num_callbacks == 8);
+  stored = rtcm3_eph_store_get(&store, RTCM_CONSTELLATION_QZS, 5);
+  assert(stored != NULL && stored->toe == 100);
+  rtcm_setbitu(qzss, 16, 16, 0x4000);
+  rtcm_setbitu(qzss, 246, 16, 101);
+  assert(rtcm3_eph_store_update(&store, qzss, sizeof(qzss)) == RC_OK);
+  assert(num_callbacks == 9 && stored->toe == 101);
+  assert(stored->kepler.toc == 0x4000);
+  rtcm_setbitu(qzss, 246, 16, 100);
+  assert(rtcm3_eph_store_update(&store, qzss, sizeof(qzss)) == RC_OK);
+  assert(num_callbacks == 10 && stored->toe == 100);
+  assert(store.raw_valid[RTCM3_EPH_QZSS][5]);
+  for (uint8_t i = 0; i < RTCM3_EPH_MAX_SATS; i++) {
+    assert(store.sats[RTCM3_EPH_QZSS][i].valid == (5 == i));
+    assert(store.raw_valid[RTCM3_EPH_QZSS][i] == (5 == i));
+  }
+
+  /* truncated and other messages */
+  assert(rtcm3_eph_store_update(&store, buff, (uint16_t)(len - 1)) ==
+         RC_INVALID_MESSAGE);
+  rtcm_setbitu(buff, 0, 12, 1005);
+  assert(rtcm3_eph_store_update(&store, buff, len) ==
+         RC_MESSAGE_TYPE_MISMATCH);
+  assert(num_callbacks == 10 && store.generation == 10);
+}
+
+void test_orbit_cache(void) {
+  static rtcm3_orbit_cache cache;
+  static rtcm3_orbit_states states;
+  rtcm3_orbit_cache_init(&cache);
+  const double gm = 3.986005e14;
+  const double omega_e = 7.2921151467e-5;
+  const double pi = 3.1415926535897932;
+
+  /* circular equatorial orbit */
+  rtcm_msg_eph eph;
+  memset(&eph, 0, sizeof(eph));
+  eph.constellation = RTCM_CONSTELLATION_GPS;
+  eph.sat_id = 1;
+  eph.kepler.sqrta = 5153u << 19;
+  const double a = 5153.0 * 5153.0;
+  uint16_t slot = 99;
+  assert(rtcm3_orbit_cache_add(&cache, &eph, &slot) == RC_OK);
+  assert(slot == 0 && cache.num_sats == 1 && cache.generation == 1);
+  rtcm3_orbit_cache_eval(&cache, 0.0, &states);
+  assert(fabs(states.x_m[0] - a) < 1e-6);
+  assert(fabs(states.y_m[0]) < 1e-6 && fabs(states.z_m[0]) < 1e-6);
+  assert(states.clock_s[0] == 0.0);
+  /* a quarter of a revolution later, seen from the rotating Earth */
+  double quarter_s = pi / 2 / sqrt(gm / (a * a * a));
+  rtcm3_orbit_cache_eval(&cache, quarter_s, &states);
+  assert(fabs(states.x_m[0] - a * sin(omega_e * quarter_s)) < 1e-4);
+  assert(fabs(states.y_m[0] - a * cos(omega_e * quarter_s)) < 1e-4);
+  /* the same instant one week earlier */
+  rtcm3_orbit_cache_eval(&cache, quarter_s - 604800.0, &states);
+  assert(fabs(states.x_m[0] - a * sin(omega_e * quarter_s)) < 1e-4);
+
+  /* the same issue of data is not converted again */
+  assert(rtcm3_orbit_cache_add(&cache, &eph, &slot) == RC_OK);
+  assert(slot == 0 && cache.generation == 1);
+
+  /* eccentric orbit, a quarter of a revolution after perigee */
+  eph.kepler.iode = 1;
+  eph.kepler.ecc = 1u << 29;
+  eph.kepler.m0 = 1 << 30;
+  eph.kepler.af0 = 1000;
+  assert(rtcm3_orbit_cache_add(&cache, &eph, &slot) == RC_OK);
+  assert(slot == 0 && cache.num_sats == 1 && cache.generation == 2);
+  rtcm3_orbit_cache_eval(&cache, 0.0, &states);
+  const double e = 1.0 / 16;
+  double ecc_anomaly = pi / 2;
+  for (int i = 0; i < 50; i++) {
+    ecc_anomaly = pi / 2 + e * sin(ecc_anomaly);
+  }
+  double r = sqrt(states.x_m[0] * states.x_m[0] +
+                  states.y_m[0] * states.y_m[0] +
+                  states.z_m[0] * states.z_m[0]);
+  assert(fabs(r - a * (1 - e * cos(ecc_anomaly))) < 1e-6);
+  double rel_s = -2 * sqrt(gm) / (GPS_C * GPS_C) * e * 5153.0;
+  assert(fabs(states.clock_s[0] - (1000 * C_1_2P31 +
+                                   rel_s * sin(ecc_anomaly))) < 1e-15);
+
+  /* BDS time is 14 s behind GPS time */
+  memset(&eph, 0, sizeof(eph));
+  eph.constellation = RTCM_CONSTELLATION_BDS;
+  eph.sat_id = 20;
+  eph.toe = 1000;
+  eph.kepler.sqrta = 5282u << 19;
+  assert(rtcm3_orbit_cache_add(&cache, &eph, &slot) == RC_OK);
+  assert(slot == 1 && cache.num_sats == 2);
+  assert(rtcm3_orbit_cache_find(&cache, RTCM_CONSTELLATION_BDS, 20) == 1);
+  rtcm3_orbit_cache_eval(&cache, 8000.0 + 14, &states);
+  double omega = -7.2921150e-5 * 8000.0;
+  assert(fabs(states.x_m[1] - 5282.0 * 5282.0 * cos(omega)) < 1e-6);
+  assert(fabs(states.y_m[1] - 5282.0 * 5282.0 * sin(omega)) < 1e-6);
+
+  /* BDS GEO orbits are tilted by -5 degrees, then turned with the Earth */
+  eph.sat_id = 3;
+  eph.toe = 0;
+  eph.kepler.sqrta = 6493u << 19;
+  assert(rtcm3_orbit_cache_add(&cache, &eph, &slot) == RC_OK);
+  assert(slot == 2 && cache.num_sats == 3);
+  const double a_geo = 6493.0 * 6493.0;
+  const double omega_bds = 7.2921150e-5;
+  const double tk = 3600.0;
+  rtcm3_orbit_cache_eval(&cache, tk + 14, &states);
+  double u = sqrt(3.986004418e14 / (a_geo * a_geo * a_geo)) * tk;
+  double x_geo = a_geo * cos(u);
+  double y_geo = a_geo * sin(u) * cos(-5 * pi / 180);
+  double z_geo = -a_geo * sin(u) * sin(-5 * pi / 180);
+  double rot = omega_bds * tk;
+  assert(fabs(states.x_m[2] - (x_geo * cos(rot) + y_geo * sin(rot))) < 1e-6);
+  assert(fabs(states.y_m[2] - (y_geo * cos(rot) - x_geo * sin(rot))) < 1e-6);
+  assert(fabs(states.z_m[2] - z_geo) < 1e-6 && z_geo > 5e5);
+  /* the other BDS satellite stays in the equatorial plane */
+  r = sqrt(states.x_m[1] * states.x_m[1] + states.y_m[1] * states.y_m[1]);
+  assert(fabs(r - 5282.0 * 5282.0) < 1e-6 && fabs(states.z_m[1]) < 1e-6);
+
+  /* a broadcast ephemeris stays within its orbit */
+  rtcm_msg_eph gps = get_example_keplerian_rtcm_eph(RTCM_CONSTELLATION_GPS);
+  assert(rtcm3_orbit_cache_add(&cache, &gps, &slot) == RC_OK);
+  assert(slot == 3);
+  rtcm3_orbit_cache_eval(&cache, 460800.0 + 3600, &states);
+  double a_gps = cache.a_m[3];
+  double e_gps = cache.ecc[3];
+  r = sqrt(states.x_m[3] * states.x_m[3] + states.y_m[3] * states.y_m[3] +
+           states.z_m[3] * states.z_m[3]);
+  assert(r > a_gps * (1 - e_gps) - 1000 && r < a_gps * (1 + e_gps) + 1000);
+
+  /* GLONASS orbits are not Keplerian */
+  rtcm_msg_eph glo = get_example_glonass_rtcm_eph(10);
+  assert(rtcm3_orbit_cache_add(&cache, &glo, &slot) == RC_INVALID_MESSAGE);
+  assert(rtcm3_orbit_cache_find(&cache, RTCM_CONSTELLATION_GLO, glo.sat_id) ==
+         -1);
+  assert(cache.num_sats == 4);
+}
+
+void test_decode_bounded(void) {
+  uint8_t buff[1024];
+  uint16_t len;
+
+  rtcm_msg_1005 msg1005;
+  memset(&msg1005, 0, sizeof(msg1005));
+  msg1005.stn_id = 5;
+  msg1005.arp_x = 3578346.5475;
+  rtcm_msg_1005 msg1005_out;
+  memset(buff, 0, sizeof(buff));
+  len = rtcm3_encode_1005(&msg1005, buff);
+  assert(RC_OK == rtcm3_decode_1005_bounded(buff, len, &msg1005_out));
+  assert(msg1005_equals(&msg1005, &msg1005_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_1005_bounded(buff, len - 1, &msg1005_out));
+
+  rtcm_msg_1029 msg1029;
+  memset(&msg1029, 0, sizeof(msg1029));
+  msg1029.utf8_code_units_n = 30;
+  rtcm_msg_1029 msg1029_out;
+  memset(buff, 0, sizeof(buff));
+  len = rtcm3_encode_1029(&msg1029, buff);
+  assert(RC_OK == rtcm3_decode_1029_bounded(buff, len, &msg1029_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_1029_bounded(buff, len - 1, &msg1029_out));
+
+  rtcm_msg_1230 msg1230;
+  memset(&msg1230, 0, sizeof(msg1230));
+  msg1230.fdma_signal_mask = 0x0F;
+  rtcm_msg_1230 msg1230_out;
+  memset(buff, 0, sizeof(buff));
+  len = rtcm3_encode_1230(&msg1230, buff);
+  assert(RC_OK == rtcm3_decode_1230_bounded(buff, len, &msg1230_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_1230_bounded(buff, len - 1, &msg1230_out));
+
+  rtcm_msg_swift_proprietary msg4062;
+  memset(&msg4062, 0, sizeof(msg4062));
+  msg4062.len = 100;
+  rtcm_msg_swift_proprietary msg4062_out;
+  memset(buff, 0, sizeof(buff));
+  len = rtcm3_encode_4062(&msg4062, buff);
+  assert(RC_OK == rtcm3_decode_4062_bounded(buff, len, &msg4062_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_4062_bounded(buff, len - 1, &msg4062_out));
+
+  /* observation header announcing 3 satellites */
+  static rtcm_obs_message obs_out;
+  memset(buff, 0, sizeof(buff));
+  rtcm_setbitu(buff, 0, 12, 1001);
+  rtcm_setbitu(buff, 55, 5, 3);
+  len = (64 + 3 * 58 + 7) / 8;
+  assert(RC_OK == rtcm3_decode_1001_bounded(buff, len, &obs_out));
+  assert(3 == obs_out.header.n_sat);
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_1001_bounded(buff, len - 1, &obs_out));
+
+  /* MSM4 with 2 satellites and 1 signal */
+  static rtcm_msm_message msm;
+  memset(&msm, 0, sizeof(msm));
+  msm.header.msg_num = 1074;
+  msm.header.satellite_mask[0] = true;
+  msm.header.satellite_mask[5] = true;
+  msm.header.signal_mask[1] = true;
+  msm.header.cell_mask[0] = true;
+  msm.header.cell_mask[1] = true;
+  static rtcm_msm_message msm_out;
+  memset(buff, 0, sizeof(buff));
+  len = rtcm3_encode_msm4(&msm, buff);
+  assert(len == (169 + 2 + 2 * 18 + 2 * 48 + 7) / 8);
+  assert(RC_OK == rtcm3_decode_msm4_bounded(buff, len, &msm_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_msm4_bounded(buff, len - 1, &msm_out));
+  assert(RC_MESSAGE_TYPE_MISMATCH ==
+         rtcm3_decode_msm5_bounded(buff, sizeof(buff), &msm_out));
+  /* corrupt masks that imply a cell mask bigger than MSM_MAX_CELLS */
+  rtcm_setbitul(buff, 73, 64, UINT64_MAX);
+  rtcm_setbitu(buff, 137, 32, 0xC0000000);
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_msm4_bounded(buff, sizeof(buff), &msm_out));
+
+  /* ephemerides have fixed lengths */
+  rtcm_msg_eph eph = get_example_keplerian_rtcm_eph(RTCM_CONSTELLATION_GPS);
+  rtcm_msg_eph eph_out;
+  len = rtcm3_encode_gps_eph(&eph, buff);
+  assert(RC_OK == rtcm3_decode_gps_eph_bounded(buff, len, &eph_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_gps_eph_bounded(buff, len - 1, &eph_out));
+  eph = get_example_glonass_rtcm_eph(0);
+  len = rtcm3_encode_glo_eph(&eph, buff);
+  assert(RC_OK == rtcm3_decode_glo_eph_bounded(buff, len, &eph_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_glo_eph_bounded(buff, len - 1, &eph_out));
+  eph = get_example_keplerian_rtcm_eph(RTCM_CONSTELLATION_BDS);
+  len = rtcm3_encode_bds_eph(&eph, buff);
+  assert(RC_OK == rtcm3_decode_bds_eph_bounded(buff, len, &eph_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_bds_eph_bounded(buff, len - 1, &eph_out));
+  eph = get_example_keplerian_rtcm_eph(RTCM_CONSTELLATION_GAL);
+  len = rtcm3_encode_gal_eph_fnav(&eph, buff);
+  assert(RC_OK == rtcm3_decode_gal_eph_fnav_bounded(buff, len, &eph_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_gal_eph_fnav_bounded(buff, len - 1, &eph_out));
+  len = rtcm3_encode_gal_eph_inav(&eph, buff);
+  assert(RC_OK == rtcm3_decode_gal_eph_inav_bounded(buff, len, &eph_out));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_gal_eph_inav_bounded(buff, len - 1, &eph_out));
+
+  /* GPS code bias, one satellite with two biases */
+  static rtcm_msg_code_bias code_bias;
+  memset(buff, 0, sizeof(buff));
+  rtcm_setbitu(buff, 0, 12, 1059);
+  rtcm_setbitu(buff, 61, 6, 1);
+  rtcm_setbitu(buff, 73, 5, 2);
+  len = (67 + 6 + 5 + 2 * 19 + 7) / 8;
+  assert(RC_OK == rtcm3_decode_code_bias_bounded(buff, len, &code_bias));
+  assert(1 == code_bias.header.num_sats);
+  assert(2 == code_bias.sats[0].num_code_biases);
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_code_bias_bounded(buff, len - 1, &code_bias));
+  rtcm_setbitu(buff, 73, 5, 31);
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_code_bias_bounded(buff, len, &code_bias));
+
+  /* GPS clock, two satellites */
+  static rtcm_msg_clock clock;
+  memset(buff, 0, sizeof(buff));
+  rtcm_setbitu(buff, 0, 12, 1058);
+  rtcm_setbitu(buff, 61, 6, 2);
+  len = (67 + 2 * (6 + 70) + 7) / 8;
+  assert(RC_OK == rtcm3_decode_clock_bounded(buff, len, &clock));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_clock_bounded(buff, len - 1, &clock));
+}
+
+/* GPS SSR header without the datum and consistency fields */
+static void write_ssr_gps_header(rtcm_bitwriter *w,
+                                 uint16_t msg_num,
+                                 uint32_t epoch_time,
+                                 bool multi_message,
+                                 uint8_t iod_ssr,
+                                 uint16_t provider_id,
+                                 uint8_t num_sats) {
+  rtcm_write_bitu(w, 12, msg_num);
+  rtcm_write_bitu(w, 20, epoch_time);
+  rtcm_write_bitu(w, 4, 2);
+  rtcm_write_bitu(w, 1, multi_message);
+  rtcm_write_bitu(w, 4, iod_ssr);
+  rtcm_write_bitu(w, 16, provider_id);
+  rtcm_write_bitu(w, 4, 1);
+  rtcm_write_bitu(w, 6, num_sats);
+}
+
+static uint16_t build_ssr_gps_clock(uint8_t buff[],
+                                    uint32_t epoch_time,
+                                    bool multi_message,
+                                    uint8_t iod_ssr,
+                                    uint16_t provider_id,
+                                    uint8_t num_sats,
+                                    const uint8_t sat_ids[],
+                                    const int32_t c0[]) {
+  rtcm_bitwriter w;
+  rtcm_bitwriter_init(&w, buff, 1023, 0);
+  write_ssr_gps_header(
+      &w, 1058, epoch_time, multi_message, iod_ssr, provider_id, num_sats);
+  for (uint8_t i = 0; i < num_sats; i++) {
+    rtcm_write_bitu(&w, 6, sat_ids[i]);
+    rtcm_write_bits(&w, 22, c0[i]);
+    rtcm_write_bits(&w, 21, -5);
+    rtcm_write_bits(&w, 27, 7);
+  }
+  return rtcm_bitwriter_flush(&w);
+}
+
+void test_ssr_state(void) {
+  rtcm_ssr_solution solutions[1];
+  rtcm3_ssr_state state;
+  rtcm3_ssr_state_init(&state, solutions, 1);
+  assert(rtcm3_ssr_state_find(&state, RTCM_CONSTELLATION_GPS, 33, 1) == NULL);
+
+  uint8_t buff[1023];
+  const uint8_t sats_12[] = {1, 2};
+  const uint8_t sats_3[] = {3};
+  const uint8_t sats_123[] = {1, 2, 3};
+  const uint8_t clock_bit = 1u << RTCM_SSR_CLOCK;
+  const uint8_t code_bit = 1u << RTCM_SSR_CODE_BIAS;
+
+  /* first message of a multi-message sequence */
+  const int32_t c0_12[] = {10, 20};
+  uint16_t len =
+      build_ssr_gps_clock(buff, 100, true, 3, 33, 2, sats_12, c0_12);
+  assert(rtcm3_ssr_state_update(&state, buff, len) == RC_OK);
+  assert(state.generation == 1);
+  const rtcm_ssr_solution *solution =
+      rtcm3_ssr_state_find(&state, RTCM_CONSTELLATION_GPS, 33, 1);
+  assert(solution == &solutions[0]);
+  assert(solution->generation == 1);
+  const rtcm_ssr_type_state *clock = &solution->types[RTCM_SSR_CLOCK];
+  assert(clock->valid && !clock->complete);
+  assert(clock->epoch_time == 100 && clock->iod_ssr == 3);
+  assert(clock->update_interval == 2);
+  assert(!solution->types[RTCM_SSR_ORBIT].valid);
+  assert(solution->sats[1].valid == clock_bit);
+  assert(solution->sats[1].generation == 1);
+  assert(solution->sats[1].clock.sat_id == 1);
+  assert(solution->sats[1].clock.c0 == 10);
+  assert(solution->sats[1].clock.c1 == -5);
+  assert(solution->sats[1].clock.c2 == 7);
+  assert(solution->sats[2].clock.c0 == 20);
+  assert(solution->sats[3].valid == 0 && solution->sats[3].generation == 0);
+
+  /* the last message completes the sequence */
+  const int32_t c0_3[] = {30};
+  len = build_ssr_gps_clock(buff, 100, false, 3, 33, 1, sats_3, c0_3);
+  assert(rtcm3_ssr_state_update(&state, buff, len) == RC_OK);
+  assert(state.generation == 2);
+  assert(clock->complete);
+  assert(solution->sats[1].generation == 1);
+  assert(solution->sats[3].generation == 2);
+  assert(solution->sats[3].clock.c0 == 30);
+
+  /* next epoch, only satellite 2 changes */
+  const int32_t c0_123[] = {10, 21, 30};
+  len = build_ssr_gps_clock(buff, 105, false, 3, 33, 3, sats_123, c0_123);
+  assert(rtcm3_ssr_state_update(&state, buff, len) == RC_OK);
+  assert(state.generation == 3);
+  assert(clock->epoch_time == 105 && clock->complete);
+  assert(solution->sats[1].generation == 1);
+  assert(solution->sats[2].generation == 3);
+  assert(solution->sats[3].generation == 2);
+  assert(solution->sats[2].clock.c0 == 21);
+  assert(solution->sats[1].epoch_time[RTCM_SSR_CLOCK] == 105);
+
+  /* repeating the epoch changes nothing */
+  assert(rtcm3_ssr_state_update(&state, buff, len) == RC_OK);
+  assert(state.generation == 3 && solution->generation == 3);
+
+  /* code biases of the same solution are tracked separately */
+  rtcm_bitwriter w;
+  rtcm_bitwriter_init(&w, buff, sizeof(buff), 0);
+  write_ssr_gps_header(&w, 1059, 105, false, 3, 33, 1);
+  rtcm_write_bitu(&w, 6, 1);
+  rtcm_write_bitu(&w, 5, 2);
+  rtcm_write_bitu(&w, 5, 0);
+  rtcm_write_bits(&w, 14, -100);
+  rtcm_write_bitu(&w, 5, 11);
+  rtcm_write_bits(&w, 14, 250);
+  len = rtcm_bitwriter_flush(&w);
+  assert(rtcm3_ssr_state_update(&state, buff, len) == RC_OK);
+  assert(state.generation == 4);
+  assert(solution->sats[1].valid == (clock_bit | code_bit));
+  assert(solution->sats[1].generation == 4);
+  assert(solution->sats[1].code_bias.num_code_biases == 2);
+  assert(solution->sats[1].code_bias.signals[0].code_bias == -100);
+  assert(solution->sats[1].code_bias.signals[1].signal_id == 11);
+  assert(solution->sats[1].code_bias.signals[1].code_bias == 250);
+  assert(solution->types[RTCM_SSR_CODE_BIAS].complete);
+  /* a truncated message is rejected without touching the store */
+  assert(rtcm3_ssr_state_update(&state, buff, (uint16_t)(len - 1)) ==
+         RC_INVALID_MESSAGE);
+  assert(state.generation == 4);
+
+  /* a new IOD SSR drops the clocks of the previous one */
+  len = build_ssr_gps_clock(buff, 110, false, 4, 33, 1, sats_12, c0_12);
+  assert(rtcm3_ssr_state_update(&state, buff, len) == RC_OK);
+  assert(state.generation == 5);
+  assert(clock->iod_ssr == 4);
+  assert(solution->sats[1].valid == (clock_bit | code_bit));
+  assert(solution->sats[1].generation == 5);
+  assert(solution->sats[2].valid == 0 && solution->sats[2].generation == 5);
+  assert(solution->sats[3].valid == 0 && solution->sats[3].generation == 5);
+
+  /* no free slot for another provider */
+  len = build_ssr_gps_clock(buff, 110, false, 4, 34, 1, sats_12, c0_12);
+  assert(rtcm3_ssr_state_update(&state, buff, len) == RC_INVALID_MESSAGE);
+  assert(rtcm3_ssr_state_find(&state, RTCM_CONSTELLATION_GPS, 34, 1) == NULL);
+  assert(state.generation == 5);
+
+  /* not an SSR message */
+  rtcm_setbitu(buff, 0, 12, 1001);
+  assert(rtcm3_ssr_state_update(&state, buff, len) ==
+         RC_MESSAGE_TYPE_MISMATCH);
+}
+
+void test_ssr_bias_sparse(void) {
+  uint8_t buff[1023];
+  memset(buff, 0, sizeof(buff));
+  const uint8_t sat_ids[] = {4, 17};
+  const uint8_t num_biases[] = {3, 2};
+  const uint8_t signal_ids[][3] = {{0, 5, 11}, {2, 11}};
+  /* keep L1 C/A and L5 I */
+  const uint32_t mask = (1u << 0) | (1u << 11);
+
+  /* GPS code bias */
+  rtcm_bitwriter w;
+  rtcm_bitwriter_init(&w, buff, sizeof(buff), 0);
+  write_ssr_gps_header(&w, 1059, 200, false, 1, 33, 2);
+  for (uint8_t i = 0; i < 2; i++) {
+    rtcm_write_bitu(&w, 6, sat_ids[i]);
+    rtcm_write_bitu(&w, 5, num_biases[i]);
+    for (uint8_t j = 0; j < num_biases[i]; j++) {
+      rtcm_write_bitu(&w, 5, signal_ids[i][j]);
+      rtcm_write_bits(&w, 14, -(i * 10 + j));
+    }
+  }
+  uint16_t len = rtcm_bitwriter_flush(&w);
+
+  static rtcm_msg_code_bias code_bias;
+  assert(rtcm3_decode_code_bias_bounded(buff, len, &code_bias) == RC_OK);
+  rtcm_msg_ssr_code_bias_sig code_signals[3];
+  rtcm_msg_code_bias_sparse code_sparse;
+  code_sparse.signals = code_signals;
+  code_sparse.max_signals = 3;
+  assert(rtcm3_decode_code_bias_sparse(buff, len, mask, &code_sparse) ==
+         RC_OK);
+  assert(code_sparse.header.num_sats == 2);
+  assert(code_sparse.header.epoch_time == 200);
+  assert(code_sparse.sat_id[0] == 4 && code_sparse.sat_id[1] == 17);
+  assert(code_sparse.offsets[0] == 0);
+  assert(code_sparse.offsets[1] == 2);
+  assert(code_sparse.offsets[2] == 3);
+  assert(code_signals[0].signal_id == 0);
+  assert(code_signals[0].code_bias == code_bias.sats[0].signals[0].code_bias);
+  assert(code_signals[1].signal_id == 11);
+  assert(code_signals[1].code_bias == code_bias.sats[0].signals[2].code_bias);
+  assert(code_signals[2].signal_id == 11);
+  assert(code_signals[2].code_bias == code_bias.sats[1].signals[1].code_bias);
+
+  /* no signals kept */
+  assert(rtcm3_decode_code_bias_sparse(buff, len, 1u << 30, &code_sparse) ==
+         RC_OK);
+  assert(code_sparse.offsets[0] == 0 && code_sparse.offsets[2] == 0);
+  /* the kept signals do not fit */
+  code_sparse.max_signals = 2;
+  assert(rtcm3_decode_code_bias_sparse(buff, len, mask, &code_sparse) ==
+         RC_INVALID_MESSAGE);
+  code_sparse.max_signals = 3;
+  assert(rtcm3_decode_code_bias_sparse(
+             buff, (uint16_t)(len - 1), mask, &code_sparse) ==
+         RC_INVALID_MESSAGE);
+
+  /* GPS phase bias */
+  memset(buff, 0, sizeof(buff));
+  rtcm_bitwriter_init(&w, buff, sizeof(buff), 0);
+  rtcm_write_bitu(&w, 12, 1265);
+  rtcm_write_bitu(&w, 20, 200);
+  rtcm_write_bitu(&w, 4, 2);
+  rtcm_write_bitu(&w, 1, 0);
+  rtcm_write_bitu(&w, 4, 1);
+  rtcm_write_bitu(&w, 16, 33);
+  rtcm_write_bitu(&w, 4, 1);
+  rtcm_write_bitu(&w, 1, 1);
+  rtcm_write_bitu(&w, 1, 0);
+  rtcm_write_bitu(&w, 6, 2);
+  for (uint8_t i = 0; i < 2; i++) {
+    rtcm_write_bitu(&w, 6, sat_ids[i]);
+    rtcm_write_bitu(&w, 5, num_biases[i]);
+    rtcm_write_bitu(&w, 9, 100 + i);
+    rtcm_write_bits(&w, 8, -3 - i);
+    for (uint8_t j = 0; j < num_biases[i]; j++) {
+      rtcm_write_bitu(&w, 5, signal_ids[i][j]);
+      rtcm_write_bitu(&w, 1, j & 1);
+      rtcm_write_bitu(&w, 2, j);
+      rtcm_write_bitu(&w, 4, i + j);
+      rtcm_write_bits(&w, 20, 1000 * (i + 1) - j);
+    }
+  }
+  len = rtcm_bitwriter_flush(&w);
+
+  static rtcm_msg_phase_bias phase_bias;
+  assert(rtcm3_decode_phase_bias_bounded(buff, len, &phase_bias) == RC_OK);
+  rtcm_msg_ssr_phase_bias_sig phase_signals[3];
+  rtcm_msg_phase_bias_sparse phase_sparse;
+  phase_sparse.signals = phase_signals;
+  phase_sparse.max_signals = 3;
+  assert(rtcm3_decode_phase_bias_sparse(buff, len, mask, &phase_sparse) ==
+         RC_OK);
+  assert(phase_sparse.header.dispersive_bias_consistency);
+  assert(!phase_sparse.header.melbourne_wubbena_consistency);
+  assert(phase_sparse.offsets[1] == 2 && phase_sparse.offsets[2] == 3);
+  const uint8_t full_index[][2] = {{0, 0}, {0, 2}, {1, 1}};
+  for (uint8_t k = 0; k < 3; k++) {
+    const rtcm_msg_ssr_phase_bias_sat *sat =
+        &phase_bias.sats[full_index[k][0]];
+    const rtcm_msg_ssr_phase_bias_sig *full = &sat->signals[full_index[k][1]];
+    assert(phase_sparse.sat_id[full_index[k][0]] == sat->sat_id);
+    assert(phase_sparse.yaw_angle[full_index[k][0]] == sat->yaw_angle);
+    assert(phase_sparse.yaw_rate[full_index[k][0]] == sat->yaw_rate);
+    assert(phase_signals[k].signal_id == full->signal_id);
+    assert(phase_signals[k].integer_indicator == full->integer_indicator);
+    assert(phase_signals[k].widelane_indicator == full->widelane_indicator);
+    assert(phase_signals[k].discontinuity_indicator ==
+           full->discontinuity_indicator);
+    assert(phase_signals[k].phase_bias == full->phase_bias);
+  }
+  assert(phase_signals[2].phase_bias == 1999);
+
+  /* message type mismatch */
+  assert(rtcm3_decode_code_bias_sparse(buff, len, mask, &code_sparse) ==
+         RC_MESSAGE_TYPE_MISMATCH);
+}
+
+void test_msm_columns(void) {
+  /* the captured 1077, padded to its full length */
+  uint8_t buff[sizeof(msm7_raw) + 1];
+  memset(buff, 0, sizeof(buff));
+  memcpy(buff, msm7_raw, sizeof(msm7_raw));
+
+  static rtcm_msm_message msg;
+  assert(RC_OK == rtcm3_decode_msm7(buff, &msg));
+
+  rtcm_msm_header header;
+  rtcm_msm_sat_data sats[RTCM_MAX_SATS];
+  uint8_t sat_index[MSM_MAX_CELLS];
+  uint8_t sig_index[MSM_MAX_CELLS];
+  double pseudorange_ms[MSM_MAX_CELLS];
+  double carrier_phase_ms[MSM_MAX_CELLS];
+  double range_rate_m_s[MSM_MAX_CELLS];
+  double cnr[MSM_MAX_CELLS];
+  double lock_time_s[MSM_MAX_CELLS];
+  rtcm_msm_signal_columns cells = {.sat_index = sat_index,
+                                   .sig_index = sig_index,
+                                   .pseudorange_ms = pseudorange_ms,
+                                   .carrier_phase_ms = carrier_phase_ms,
+                                   .range_rate_m_s = range_rate_m_s,
+                                   .cnr = cnr,
+                                   .lock_time_s = lock_time_s};
+  assert(RC_OK ==
+         rtcm3_decode_msm_columns(buff, sizeof(buff), &header, sats, &cells));
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_msm_columns(
+             msm7_raw, sizeof(msm7_raw), &header, sats, &cells));
+
+  uint8_t num_sats =
+      count_mask_values(MSM_SATELLITE_MASK_SIZE, header.satellite_mask);
+  uint8_t num_sigs =
+      count_mask_values(MSM_SIGNAL_MASK_SIZE, header.signal_mask);
+  assert(cells.num_cells ==
+         count_mask_values(num_sats * num_sigs, header.cell_mask));
+  for (uint8_t sat = 0; sat < num_sats; sat++) {
+    assert(sats[sat].rough_range_ms == msg.sats[sat].rough_range_ms);
+    assert(sats[sat].glo_fcn == msg.sats[sat].glo_fcn);
+  }
+  for (uint8_t i = 0; i < cells.num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg.signals[i];
+    assert(header.cell_mask[sat_index[i] * num_sigs + sig_index[i]]);
+    assert(pseudorange_ms[i] == signal->pseudorange_ms);
+    assert(carrier_phase_ms[i] == signal->carrier_phase_ms);
+    assert(range_rate_m_s[i] == signal->range_rate_m_s);
+    assert(cnr[i] == signal->cnr);
+    assert(lock_time_s[i] == signal->lock_time_s);
+    assert(((cells.hca_indicator >> i) & 1) == signal->hca_indicator);
+    assert(((cells.valid_pr >> i) & 1) == signal->flags.valid_pr);
+    assert(((cells.valid_cp >> i) & 1) == signal->flags.valid_cp);
+    assert(((cells.valid_cnr >> i) & 1) == signal->flags.valid_cnr);
+    assert(((cells.valid_lock >> i) & 1) == signal->flags.valid_lock);
+    assert(((cells.valid_dop >> i) & 1) == signal->flags.valid_dop);
+  }
+  assert(0 != cells.valid_pr && 0 != cells.valid_dop);
+
+  /* only MSM4-7 can be decoded into columns */
+  memset(buff, 0, sizeof(buff));
+  rtcm_setbitu(buff, 0, 12, 1073);
+  assert(RC_MESSAGE_TYPE_MISMATCH ==
+         rtcm3_decode_msm_columns(buff, sizeof(buff), &header, sats, &cells));
+}
+
+static void assert_msm_equal(const rtcm_msm_message *msg,
+                             const rtcm_msm_message *expected) {
+  assert(msg->header.msg_num == expected->header.msg_num);
+  assert(msg->header.stn_id == expected->header.stn_id);
+  assert(msg->header.tow_ms == expected->header.tow_ms);
+  assert(msg->header.multiple == expected->header.multiple);
+  assert(msg->header.iods == expected->header.iods);
+  assert(msg->header.steering == expected->header.steering);
+  assert(msg->header.ext_clock == expected->header.ext_clock);
+  assert(msg->header.div_free == expected->header.div_free);
+  assert(msg->header.smooth == expected->header.smooth);
+  assert(0 == memcmp(msg->header.satellite_mask,
+                     expected->header.satellite_mask,
+                     sizeof(msg->header.satellite_mask)));
+  assert(0 == memcmp(msg->header.signal_mask,
+                     expected->header.signal_mask,
+                     sizeof(msg->header.signal_mask)));
+  assert(0 == memcmp(msg->header.cell_mask,
+                     expected->header.cell_mask,
+                     sizeof(msg->header.cell_mask)));
+
+  uint8_t num_sats =
+      count_mask_values(MSM_SATELLITE_MASK_SIZE, msg->header.satellite_mask);
+  uint8_t num_sigs =
+      count_mask_values(MSM_SIGNAL_MASK_SIZE, msg->header.signal_mask);
+  uint8_t num_cells =
+      count_mask_values(num_sats * num_sigs, msg->header.cell_mask);
+  for (uint8_t sat = 0; sat < num_sats; sat++) {
+    assert(msg->sats[sat].rough_range_ms == expected->sats[sat].rough_range_ms);
+    assert(msg->sats[sat].rough_range_rate_m_s ==
+           expected->sats[sat].rough_range_rate_m_s);
+    assert(msg->sats[sat].glo_fcn == expected->sats[sat].glo_fcn);
+  }
+  for (uint8_t i = 0; i < num_cells; i++) {
+    const rtcm_msm_signal_data *signal = &msg->signals[i];
+    const rtcm_msm_signal_data *expected_signal = &expected->signals[i];
+    assert(signal->pseudorange_ms == expected_signal->pseudorange_ms);
+    assert(signal->carrier_phase_ms == expected_signal->carrier_phase_ms);
+    assert(signal->lock_time_s == expected_signal->lock_time_s);
+    assert(signal->hca_indicator == expected_signal->hca_indicator);
+    assert(signal->cnr == expected_signal->cnr);
+    assert(signal->range_rate_m_s == expected_signal->range_rate_m_s);
+    assert(signal->flags.data == expected_signal->flags.data);
+  }
+}
+
+void test_obs_convert(void) {
+  rtcm_obs_message obs;
+  memset(&obs, 0, sizeof(obs));
+  obs.header.msg_num = 1012;
+  obs.header.stn_id = 7;
+  obs.header.tow_ms = 34700000;
+  obs.header.sync = 1;
+  obs.header.n_sat = 3;
+  /* L1 and L2 C/A */
+  obs.sats[0].svId = 6;
+  obs.sats[0].fcn = 13;
+  obs.sats[0].obs[L1_FREQ].pseudorange = 22000004.4;
+  obs.sats[0].obs[L1_FREQ].carrier_phase = 117809044.6;
+  obs.sats[0].obs[L1_FREQ].lock = 254;
+  obs.sats[0].obs[L1_FREQ].cnr = 50.25;
+  obs.sats[0].obs[L1_FREQ].flags.data = 0x0F;
+  obs.sats[0].obs[L2_FREQ] = obs.sats[0].obs[L1_FREQ];
+  obs.sats[0].obs[L2_FREQ].pseudorange = 22000024.4;
+  obs.sats[0].obs[L2_FREQ].carrier_phase = 91629341.2;
+  /* L1 P only */
+  obs.sats[1].svId = 4;
+  obs.sats[1].fcn = 7;
+  obs.sats[1].obs[L1_FREQ].code = 1;
+  obs.sats[1].obs[L1_FREQ].pseudorange = 20000004.4;
+  obs.sats[1].obs[L1_FREQ].carrier_phase = 106874009.6;
+  obs.sats[1].obs[L1_FREQ].lock = 900;
+  obs.sats[1].obs[L1_FREQ].flags.valid_pr = 1;
+  obs.sats[1].obs[L1_FREQ].flags.valid_cp = 1;
+  obs.sats[1].obs[L1_FREQ].flags.valid_lock = 1;
+  /* unknown frequency channel, no carrier phase */
+  obs.sats[2].svId = 9;
+  obs.sats[2].fcn = 21;
+  obs.sats[2].obs[L1_FREQ].pseudorange = 21000004.4;
+  obs.sats[2].obs[L1_FREQ].carrier_phase = 1;
+  obs.sats[2].obs[L1_FREQ].flags.valid_pr = 1;
+  obs.sats[2].obs[L1_FREQ].flags.valid_cp = 1;
+
+  rtcm_msm_header header;
+  rtcm_msm_sat_data sats[RTCM_MAX_SATS];
+  uint8_t sat_index[MSM_MAX_CELLS];
+  uint8_t sig_index[MSM_MAX_CELLS];
+  double pseudorange_ms[MSM_MAX_CELLS];
+  double carrier_phase_ms[MSM_MAX_CELLS];
+  double range_rate_m_s[MSM_MAX_CELLS];
+  double cnr[MSM_MAX_CELLS];
+  double lock_time_s[MSM_MAX_CELLS];
+  rtcm_msm_signal_columns cells = {.sat_index = sat_index,
+                                   .sig_index = sig_index,
+                                   .pseudorange_ms = pseudorange_ms,
+                                   .carrier_phase_ms = carrier_phase_ms,
+                                   .range_rate_m_s = range_rate_m_s,
+                                   .cnr = cnr,
+                                   .lock_time_s = lock_time_s};
+  assert(rtcm3_obs_to_msm(&obs, MSM7, &header, sats, &cells) == RC_OK);
+  assert(header.msg_num == 1087);
+  assert(header.stn_id == 7 && header.tow_ms == 34700000);
+  assert(header.multiple == 1);
+  rtcm_msm_masks masks;
+  msm_pack_masks(&header, &masks);
+  assert(masks.sats == ((1u << 3) | (1u << 5) | (1u << 8)));
+  /* 1C, 1P and 2C */
+  assert(masks.sigs == ((1u << 1) | (1u << 2) | (1u << 7)));
+  assert(masks.cells == ((1u << 1) | (1u << 3) | (1u << 5) | (1u << 6)));
+  assert(cells.num_cells == 4);
+  const uint8_t expected_sat[] = {0, 1, 1, 2};
+  const uint8_t expected_sig[] = {1, 0, 2, 0};
+  for (uint8_t i = 0; i < 4; i++) {
+    assert(sat_index[i] == expected_sat[i]);
+    assert(sig_index[i] == expected_sig[i]);
+  }
+  assert(cells.valid_pr == 0x0F);
+  assert(cells.valid_cp == 0x07);
+  assert(cells.valid_cnr == 0x06 && cells.valid_lock == 0x07);
+  assert(cells.valid_dop == 0);
+  assert(fabs(pseudorange_ms[1] * PRUNIT_GPS - 22000004.4) < 1e-6);
+  double l1_hz = GLO_L1_HZ + 6 * GLO_L1_DELTA_HZ;
+  assert(fabs(carrier_phase_ms[1] - 117809044.6 * 1000 / l1_hz) < 1e-9);
+  assert(sats[0].glo_fcn == 7 && sats[1].glo_fcn == 13);
+  assert(sats[2].glo_fcn == MSM_GLO_FCN_UNKNOWN);
+  assert(fabs(sats[1].rough_range_ms - pseudorange_ms[1]) <= 1.0 / 2048);
+
+  /* and back, in satellite ID order */
+  rtcm_obs_message obs_out;
+  assert(rtcm3_msm_to_obs(&header, sats, &cells, &obs_out) == RC_OK);
+  assert(obs_out.header.msg_num == 1012 && obs_out.header.sync == 1);
+  assert(obs_out.header.n_sat == 3);
+  const uint8_t order[] = {1, 0, 2};
+  for (uint8_t i = 0; i < 2; i++) {
+    const rtcm_sat_data *in = &obs.sats[order[i]];
+    const rtcm_sat_data *out = &obs_out.sats[i];
+    assert(out->svId == in->svId && out->fcn == in->fcn);
+    for (uint8_t f = 0; f < NUM_FREQS; f++) {
+      assert(out->obs[f].flags.data == in->obs[f].flags.data);
+      if (!in->obs[f].flags.data) {
+        continue;
+      }
+      assert(out->obs[f].code == in->obs[f].code);
+      assert(fabs(out->obs[f].pseudorange - in->obs[f].pseudorange) < 1e-6);
+      assert(fabs(out->obs[f].carrier_phase - in->obs[f].carrier_phase) <
+             1e-6);
+      assert(out->obs[f].lock == in->obs[f].lock);
+      assert(out->obs[f].cnr == in->obs[f].cnr);
+    }
+  }
+  assert(obs_out.sats[2].svId == 9);
+  assert(obs_out.sats[2].obs[L1_FREQ].flags.valid_pr);
+  assert(!obs_out.sats[2].obs[L1_FREQ].flags.valid_cp);
+
+  /* 22 satellites with 1C, 2X and 2P need a 66 bit cell mask */
+  memset(&obs, 0, sizeof(obs));
+  obs.header.msg_num = 1004;
+  obs.header.n_sat = 22;
+  for (uint8_t i = 0; i < obs.header.n_sat; i++) {
+    obs.sats[i].svId = i + 1;
+    obs.sats[i].obs[L1_FREQ].flags.valid_pr = 1;
+    obs.sats[i].obs[L2_FREQ].flags.valid_pr = 1;
+    obs.sats[i].obs[L2_FREQ].code = i % 2;
+  }
+  assert(rtcm3_obs_to_msm(&obs, MSM7, &header, sats, &cells) ==
+         RC_INVALID_MESSAGE);
+  obs.header.n_sat = 21;
+  assert(rtcm3_obs_to_msm(&obs, MSM7, &header, sats, &cells) == RC_OK);
+  assert(cells.num_cells == 42);
+
+  /* the captured 1077: 1C and 2W are kept, 1W, 2X and 5X dropped */
+  uint8_t buff[sizeof(msm7_raw) + 1];
+  memset(buff, 0, sizeof(buff));
+  memcpy(buff, msm7_raw, sizeof(msm7_raw));
+  assert(RC_OK ==
+         rtcm3_decode_msm_columns(buff, sizeof(buff), &header, sats, &cells));
+  assert(rtcm3_msm_to_obs(&header, sats, &cells, &obs_out) == RC_OK);
+  assert(obs_out.header.msg_num == 1004);
+  assert(obs_out.header.tow_ms == 466544000);
+  assert(obs_out.header.n_sat > 0 && obs_out.header.n_sat <= 12);
+  assert(obs_out.sats[0].svId == 1);
+  assert(obs_out.sats[0].obs[L1_FREQ].code == 0);
+  assert(obs_out.sats[0].obs[L1_FREQ].pseudorange ==
+         pseudorange_ms[0] * PRUNIT_GPS);
+  assert(obs_out.sats[0].obs[L2_FREQ].code == 3);
+  assert(obs_out.sats[0].obs[L2_FREQ].pseudorange ==
+         pseudorange_ms[2] * PRUNIT_GPS);
+
+  /* errors */
+  obs.sats[2].svId = 4;
+  assert(rtcm3_obs_to_msm(&obs, MSM7, &header, sats, &cells) ==
+         RC_INVALID_MESSAGE);
+  assert(rtcm3_obs_to_msm(&obs, MSM3, &header, sats, &cells) ==
+         RC_MESSAGE_TYPE_MISMATCH);
+  obs.header.msg_num = 1005;
+  assert(rtcm3_obs_to_msm(&obs, MSM7, &header, sats, &cells) ==
+         RC_MESSAGE_TYPE_MISMATCH);
+  header.msg_num = 1097;
+  assert(rtcm3_msm_to_obs(&header, sats, &cells, &obs_out) ==
+         RC_MESSAGE_TYPE_MISMATCH);
+}
+
+void test_msm_compact(void) {
+  /* the captured 1077, padded to its full length */
+  uint8_t buff[sizeof(msm7_raw) + 1];
+  memset(buff, 0, sizeof(buff));
+  memcpy(buff, msm7_raw, sizeof(msm7_raw));
+
+  static rtcm_msm_message expected;
+  static rtcm_msm_message msg;
+  assert(RC_OK == rtcm3_decode_msm7(buff, &expected));
+
+  /* storage for the largest possible message */
+  static uint64_t storage[sizeof(rtcm_msm_message) / sizeof(uint64_t)];
+  rtcm_msm_compact *compact = (rtcm_msm_compact *)storage;
+
+  uint16_t size = rtcm3_msm_compact_size(buff, sizeof(buff));
+  assert(size > 0 && size <= sizeof(storage));
+  assert(0 == size % RTCM_MSM_COMPACT_ALIGN);
+  assert(size < sizeof(rtcm_msm_message) / 4);
+  assert(RC_OK == rtcm3_decode_msm_compact(buff, sizeof(buff), compact, size));
+  assert(compact->size == size);
+  assert(RC_OK == rtcm3_msm_compact_expand(compact, &msg));
+  assert_msm_equal(&msg, &expected);
+
+  /* too little room, truncated payload */
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_msm_compact(buff, sizeof(buff), compact, size - 1));
+  assert(0 == rtcm3_msm_compact_size(msm7_raw, sizeof(msm7_raw)));
+  assert(RC_INVALID_MESSAGE == rtcm3_decode_msm_compact(
+                                   msm7_raw, sizeof(msm7_raw), compact, size));
+
+  /* the same observations as MSM4 and MSM5 */
+  uint8_t encoded[1024];
+  expected.header.msg_num = 1074;
+  memset(encoded, 0, sizeof(encoded));
+  uint16_t len = rtcm3_encode_msm4(&expected, encoded);
+  assert(len > 0);
+  assert(RC_OK == rtcm3_decode_msm4(encoded, &expected));
+  size = rtcm3_msm_compact_size(encoded, len);
+  assert(size > 0);
+  assert(RC_OK == rtcm3_decode_msm_compact(encoded, len, compact, size));
+  assert(RC_OK == rtcm3_msm_compact_expand(compact, &msg));
+  assert_msm_equal(&msg, &expected);
+
+  expected.header.msg_num = 1075;
+  memset(encoded, 0, sizeof(encoded));
+  len = rtcm3_encode_msm5(&expected, encoded);
+  assert(len > 0);
+  assert(RC_OK == rtcm3_decode_msm5(encoded, &expected));
+  size = rtcm3_msm_compact_size(encoded, len);
+  assert(size > 0);
+  assert(RC_OK == rtcm3_decode_msm_compact(encoded, len, compact, size));
+  assert(RC_OK == rtcm3_msm_compact_expand(compact, &msg));
+  assert_msm_equal(&msg, &expected);
+
+  /* only MSM4-7 have a compact form */
+  memset(buff, 0, sizeof(buff));
+  rtcm_setbitu(buff, 0, 12, 1073);
+  assert(0 == rtcm3_msm_compact_size(buff, sizeof(buff)));
+  assert(RC_MESSAGE_TYPE_MISMATCH ==
+         rtcm3_decode_msm_compact(buff, sizeof(buff), compact, size));
+}
+
+void test_decode_arena(void) {
+  static uint64_t storage[1024];
+  rtcm3_arena arena;
+  rtcm3_arena_init(&arena, storage, sizeof(storage));
+  uint8_t buff[1024];
+
+  /* strings are stored NUL terminated and sized to the message */
+  rtcm_msg_1033 msg1033;
+  memset(&msg1033, 0, sizeof(msg1033));
+  msg1033.stn_id = 555;
+  msg1033.ant_descriptor_counter = 5;
+  strncpy(msg1033.ant_descriptor, "hello", 32);
+  msg1033.ant_setup_id = 7;
+  msg1033.rcv_descriptor_counter = 9;
+  strncpy(msg1033.rcv_descriptor, "LEI - IGS", 32);
+  msg1033.rcv_fw_version_counter = 6;
+  strncpy(msg1033.rcv_fw_version, "1.2.14", 32);
+  memset(buff, 0, sizeof(buff));
+  uint16_t len = rtcm3_encode_1033(&msg1033, buff);
+  rtcm_msg_1033_arena *msg1033_out;
+  assert(RC_OK == rtcm3_decode_1033_arena(buff, len, &arena, &msg1033_out));
+  assert(msg1033_out->stn_id == 555 && msg1033_out->ant_setup_id == 7);
+  assert(msg1033_out->rcv_descriptor_counter == 9);
+  assert(0 == strcmp(msg1033_out->ant_descriptor, "hello"));
+  assert(msg1033_out->ant_serial_num_counter == 0);
+  assert(0 == strcmp(msg1033_out->ant_serial_num, ""));
+  assert(0 == strcmp(msg1033_out->rcv_descriptor, "LEI - IGS"));
+  assert(0 == strcmp(msg1033_out->rcv_fw_version, "1.2.14"));
+  assert(arena.used < sizeof(rtcm_msg_1033));
+  size_t used = arena.used;
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_1033_arena(buff, len - 1, &arena, &msg1033_out));
+  assert(msg1033_out == NULL && arena.used == used);
+
+  rtcm_msg_1029_arena *msg1029;
+  assert(RC_OK ==
+         rtcm3_decode_1029_arena(
+             sample_1029_raw, sizeof(sample_1029_raw), &arena, &msg1029));
+  assert(msg1029->stn_id == 23 && msg1029->mjd_num == 132);
+  assert(msg1029->utc_sec_of_day == 59100 && msg1029->unicode_chars == 21);
+  assert(msg1029->utf8_code_units_n == 30);
+  assert(0 == memcmp(msg1029->utf8_code_units, &sample_1029_raw[9], 30));
+  assert(RC_MESSAGE_TYPE_MISMATCH ==
+         rtcm3_decode_1033_arena(
+             sample_1029_raw, sizeof(sample_1029_raw), &arena, &msg1033_out));
+
+  rtcm_msg_swift_proprietary swift;
+  swift.msg_type = 12345;
+  swift.sender_id = 56789;
+  swift.len = 17;
+  for (uint8_t i = 0; i < swift.len; i++) {
+    swift.data[i] = i * 3;
+  }
+  len = rtcm3_encode_4062(&swift, buff);
+  rtcm_msg_swift_proprietary_arena *swift_out;
+  assert(RC_OK == rtcm3_decode_4062_arena(buff, len, &arena, &swift_out));
+  assert(swift_out->msg_type == 12345 && swift_out->sender_id == 56789);
+  assert(swift_out->len == 17);
+  assert(0 == memcmp(swift_out->data, swift.data, 17));
+
+  /* SSR clocks, one entry per satellite */
+  const uint8_t sat_ids[] = {3, 9, 30};
+  const int32_t c0[] = {-10, 0, 4000};
+  len = build_ssr_gps_clock(buff, 300, false, 2, 33, 3, sat_ids, c0);
+  used = arena.used;
+  rtcm_msg_clock_arena *clock;
+  assert(RC_OK == rtcm3_decode_clock_arena(buff, len, &arena, &clock));
+  assert(clock->header.num_sats == 3 && clock->header.epoch_time == 300);
+  static rtcm_msg_clock clock_full;
+  assert(RC_OK == rtcm3_decode_clock_bounded(buff, len, &clock_full));
+  for (uint8_t i = 0; i < 3; i++) {
+    assert(0 == memcmp(&clock->clock[i],
+                       &clock_full.clock[i],
+                       sizeof(rtcm_msg_ssr_clock_corr)));
+  }
+  assert(arena.used - used <
+         sizeof(rtcm_msg_ssr_header) + 4 * sizeof(rtcm_msg_ssr_clock_corr));
+  /* the orbits of three satellites would not fit */
+  rtcm_msg_orbit_arena *orbit;
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_orbit_arena(buff, len, &arena, &orbit));
+  rtcm_msg_orbit_clock_arena *orbit_clock;
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_orbit_clock_arena(buff, len, &arena, &orbit_clock));
+
+  /* code biases with a different number of signals per satellite */
+  rtcm_bitwriter w;
+  rtcm_bitwriter_init(&w, buff, sizeof(buff), 0);
+  write_ssr_gps_header(&w, 1059, 300, false, 2, 33, 2);
+  rtcm_write_bitu(&w, 6, 4);
+  rtcm_write_bitu(&w, 5, 1);
+  rtcm_write_bitu(&w, 5, 0);
+  rtcm_write_bits(&w, 14, -100);
+  rtcm_write_bitu(&w, 6, 5);
+  rtcm_write_bitu(&w, 5, 2);
+  rtcm_write_bitu(&w, 5, 2);
+  rtcm_write_bits(&w, 14, 50);
+  rtcm_write_bitu(&w, 5, 11);
+  rtcm_write_bits(&w, 14, 250);
+  len = rtcm_bitwriter_flush(&w);
+  rtcm_msg_code_bias_arena *code_bias;
+  assert(RC_OK == rtcm3_decode_code_bias_arena(buff, len, &arena, &code_bias));
+  assert(code_bias->header.num_sats == 2);
+  assert(code_bias->sats[0].sat_id == 4);
+  assert(code_bias->sats[0].num_code_biases == 1);
+  assert(code_bias->sats[0].signals[0].code_bias == -100);
+  assert(code_bias->sats[1].sat_id == 5);
+  assert(code_bias->sats[1].num_code_biases == 2);
+  assert(code_bias->sats[1].signals[1].signal_id == 11);
+  assert(code_bias->sats[1].signals[1].code_bias == 250);
+  rtcm_msg_phase_bias_arena *phase_bias;
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_phase_bias_arena(buff, len, &arena, &phase_bias));
+
+  /* MSM in compact form */
+  uint8_t msm_buff[sizeof(msm7_raw) + 1];
+  memset(msm_buff, 0, sizeof(msm_buff));
+  memcpy(msm_buff, msm7_raw, sizeof(msm7_raw));
+  rtcm_msm_compact *msm;
+  assert(RC_OK ==
+         rtcm3_decode_msm_arena(msm_buff, sizeof(msm_buff), &arena, &msm));
+  assert(msm->msg_num == 1077 && msm->num_cells == 49);
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_msm_arena(msm7_raw, sizeof(msm7_raw), &arena, &msm));
+  assert(RC_MESSAGE_TYPE_MISMATCH ==
+         rtcm3_decode_msm_arena(
+             sample_1029_raw, sizeof(sample_1029_raw), &arena, &msm));
+
+  /* a full arena fails cleanly and reset makes room again */
+  rtcm3_arena small;
+  rtcm3_arena_init(&small, storage, 64);
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_msm_arena(msm_buff, sizeof(msm_buff), &small, &msm));
+  len = build_ssr_gps_clock(buff, 300, false, 2, 33, 3, sat_ids, c0);
+  assert(RC_INVALID_MESSAGE ==
+         rtcm3_decode_clock_arena(buff, len, &small, &clock));
+  assert(small.used == 0);
+  assert(arena.high_water == arena.used && arena.used > 0);
+  rtcm3_arena_reset(&arena);
+  assert(arena.used == 0 && arena.high_water > 0);
+  assert(rtcm3_arena_alloc(&arena, 3) == (void *)storage);
+  assert(rtcm3_arena_alloc(&arena, 1) == (void *)&storage[1]);
+  assert(rtcm3_arena_alloc(&arena, sizeof(storage)) == NULL);
+}
+
+void test_msg_layout(void) {
+  uint8_t buff[32];
+  uint8_t expected[32];
+  for (uint32_t rep = 0; rep < 10000; rep++) {
+    for (uint8_t i = 0; i < sizeof(buff); i++) {
+      expected[i] = buff[i] = rand() & 0xFF;
+    }
+    uint8_t len = 1 + rand() % MSG_LAYOUT_MAX_BITS;
+    uint32_t pos = rand() % (sizeof(buff) * 8 - len + 1);
+    /* through the word load, and through the byte load when the buffer
+     * ends with the field */
+    uint32_t field_len = (pos + len + 7) / 8;
+    assert(msg_layout_get(buff, sizeof(buff), pos, len) ==
+           rtcm_getbitul(buff, pos, len));
+    assert(msg_layout_get(buff, field_len, pos, len) ==
+           rtcm_getbitul(buff, pos, len));
+    assert(msg_layout_get_signed(buff, sizeof(buff), pos, len) ==
+           rtcm_getbitsl(buff, pos, len));
+    assert(msg_layout_get_signed(buff, field_len, pos, len) ==
+           rtcm_getbitsl(buff, pos, len));
+
+    /* the bits around the field are left untouched */
+    uint64_t data = ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^
+                    (uint64_t)rand();
+    rtcm_setbitul(expected, pos, len, data);
+    msg_layout_set(buff, pos, len, data);
+    assert(memcmp(expected, buff, sizeof(buff)) == 0);
+  }
+
+  /* the lengths follow from the tables */
+  assert(64 == LAYOUT_BITS(GPS_OBS_HEADER_FIELDS));
+  assert(61 == LAYOUT_BITS(GLO_OBS_HEADER_FIELDS));
+  assert(140 == LAYOUT_BITS(MSG_1005_FIELDS));
+  assert(29 == LAYOUT_BITS(MSG_1013_ENTRY_FIELDS));
+  assert(488 == 12 + LAYOUT_BITS(GPS_EPH_FIELDS));
+  assert(360 == 12 + LAYOUT_BITS(GLO_EPH_FIELDS) + 1 +
+                    LAYOUT_BITS(GLO_EPH_ADDITIONAL_FIELDS));
+  assert(511 == 12 + LAYOUT_BITS(BDS_EPH_FIELDS));
+  assert(485 == 12 + LAYOUT_BITS(QZSS_EPH_FIELDS));
+  assert(496 == 12 + LAYOUT_BITS(GAL_EPH_FNAV_FIELDS));
+  assert(504 == 12 + LAYOUT_BITS(GAL_EPH_INAV_FIELDS));
+
+  /* sign-magnitude fields, the magnitude truncated to the field */
+  assert(-5 == msg_layout_from_sign_magnitude(0x15, 5));
+  assert(5 == msg_layout_from_sign_magnitude(0x05, 5));
+  assert(0x15 == msg_layout_to_sign_magnitude(-5, 5));
+  assert(0x05 == msg_layout_to_sign_magnitude(21, 5));
+
+  /* unsigned scaled fields are rounded and clamped */
+  assert(0 == msg_layout_unsigned(-1.0, 10.0, 16));
+  assert(0 == msg_layout_unsigned(NAN, 10.0, 16));
+  assert(12 == msg_layout_unsigned(1.24, 10.0, 16));
+  assert(0xFFFF == msg_layout_unsigned(1e9, 10.0, 16));
+}
+
+void test_msm_unpack(void) {
+  printf("MSM unpack SIMD acceleration: %s\n",
+         rtcm3_unpack_accelerated() ? "yes" : "no");
+
+  uint8_t buff[256];
+  srand(7);
+  for (size_t i = 0; i < sizeof(buff); i++) {
+    buff[i] = (uint8_t)rand();
+  }
+
+  int32_t fields[MSM_UNPACK_MAX_FIELDS];
+  int32_t expected[MSM_UNPACK_MAX_FIELDS];
+  double scaled[MSM_UNPACK_MAX_FIELDS];
+  for (uint8_t width = 1; width <= MSM_UNPACK_MAX_WIDTH; width++) {
+    for (uint8_t count = 0; count <= MSM_UNPACK_MAX_FIELDS; count++) {
+      for (uint32_t bit = 0; bit < 16; bit++) {
+        for (int is_signed = 0; is_signed < 2; is_signed++) {
+          /* use the value of one of the fields as the sentinel */
+          int32_t invalid = MSM_UNPACK_NO_SENTINEL;
+          if (count > 0) {
+            uint32_t pos = bit + (uint32_t)(count / 2) * width;
+            invalid = is_signed ? rtcm_getbits(buff, pos, width)
+                                : (int32_t)rtcm_getbitu(buff, pos, width);
+          }
+          uint64_t valid = rtcm3_unpack_fields_scalar(
+              buff, bit, width, is_signed, count, invalid, expected);
+          assert(count == 0 || !((valid >> (count / 2)) & 1));
+          assert(valid == rtcm3_unpack_fields(
+                              buff, bit, width, is_signed, count, invalid,
+                              fields));
+          assert(valid == rtcm3_unpack_fields(
+                              buff, bit, width, is_signed, count, invalid,
+                              NULL));
+          assert(valid == rtcm3_unpack_scaled(buff,
+                                              bit,
+                                              width,
+                                              is_signed,
+                                              count,
+                                              invalid,
+                                              C_1_2P29,
+                                              scaled));
+          for (uint8_t i = 0; i < count; i++) {
+            uint32_t pos = bit + (uint32_t)i * width;
+            int32_t field = is_signed ? rtcm_getbits(buff, pos, width)
+                                      : (int32_t)rtcm_getbitu(buff, pos, width);
+            assert(expected[i] == field);
+            assert(fields[i] == field);
+            assert(scaled[i] == (double)field * C_1_2P29);
+          }
+        }
+      }
+    }
+  }
+
+  /* a run ending at the end of the buffer is not read past */
+  uint8_t *tail = malloc(8);
+  assert(NULL != tail);
+  memcpy(tail, buff, 8);
+  assert(rtcm3_unpack_fields(tail, 0, 4, false, 16, 0, fields) ==
+         rtcm3_unpack_fields_scalar(tail, 0, 4, false, 16, 0, expected));
+  assert(0 == memcmp(fields, expected, 16 * sizeof(fields[0])));
+  free(tail);
+}
+
 static void test_lock_time_decoding(void) {
   double lock_time_s = 0;
   assert(rtcm3_encode_lock_time(lock_time_s) == 0);
@@ -2125,6 +4500,25 @@ static void test_rtcm_log_callback(uint8_t level,
   (*callback_count)++;
 }
 
+static uint32_t test_log_drained = 0;
+
+static void test_log_drain_callback(const rtcm3_log_record *record,
+                                    void *context) {
+  (void)context;
+  assert(record->source == 12);
+  if (0 == test_log_drained) {
+    assert(record->level == LOG_ERR);
+    assert(record->len == RTCM3_LOG_RECORD_LEN);
+    assert(record->msg[RTCM3_LOG_RECORD_LEN - 1] == 'x');
+  } else {
+    /* records 0 to 2 and 3 again after the drop */
+    assert(record->level == LOG_INFO && record->len == 1);
+    assert(record->msg[0] == (test_log_drained < 4 ? test_log_drained - 1
+                                                   : 3));
+  }
+  test_log_drained++;
+}
+
 void test_logging(void) {
   int callback_count = 0;
   rtcm_init_logging(NULL, NULL);
@@ -2133,6 +4527,49 @@ void test_logging(void) {
   rtcm_init_logging(test_rtcm_log_callback, &callback_count);
   rtcm_log(TEST_LOG_LEVEL, (uint8_t *)TEST_LOG_MSG, TEST_LOG_LEN);
   assert(callback_count == 1);
+
+  /* without a logger the global callback is used */
+  RTCM3_LOG(NULL, TEST_LOG_LEVEL, (uint8_t *)TEST_LOG_MSG, TEST_LOG_LEN);
+  assert(callback_count == 2);
+  rtcm_init_logging(NULL, NULL);
+
+  int logger_count = 0;
+  rtcm3_logger logger;
+  rtcm3_logger_init(&logger, test_rtcm_log_callback, &logger_count);
+  RTCM3_LOG(&logger, TEST_LOG_LEVEL, (uint8_t *)TEST_LOG_MSG, TEST_LOG_LEN);
+  assert(logger_count == 1 && callback_count == 2);
+  logger.max_level = LOG_ERR;
+  RTCM3_LOG(&logger, TEST_LOG_LEVEL, (uint8_t *)TEST_LOG_MSG, TEST_LOG_LEN);
+  assert(logger_count == 1);
+
+  /* queued records go to the drain callback, the logger callback is not
+   * called */
+  rtcm3_log_record records[4];
+  rtcm3_log_ring ring;
+  rtcm3_log_ring_init(&ring, records, 4);
+  logger.ring = &ring;
+  logger.source = 12;
+  logger.max_level = LOG_DEBUG;
+  uint8_t long_msg[200];
+  memset(long_msg, 'x', sizeof(long_msg));
+  rtcm3_log(&logger, LOG_ERR, long_msg, sizeof(long_msg));
+  for (uint8_t i = 0; i < 4; i++) {
+    rtcm3_log(&logger, LOG_INFO, &i, 1);
+  }
+  assert(logger_count == 1);
+  assert(ring.dropped == 1);
+
+  test_log_drained = 0;
+  assert(rtcm3_log_ring_drain(&ring, test_log_drain_callback, NULL, 2) == 2);
+  assert(test_log_drained == 2);
+  uint8_t i = 3;
+  rtcm3_log(&logger, LOG_INFO, &i, 1);
+  assert(ring.dropped == 1);
+  assert(rtcm3_log_ring_drain(&ring, test_log_drain_callback, NULL, 10) ==
+         3);
+  assert(test_log_drained == 5);
+  assert(rtcm3_log_ring_drain(&ring, test_log_drain_callback, NULL, 10) ==
+         0);
 }
 
 #undef TEST_LOG_LEVEL
@@ -23,23 +23,48 @@ static void test_rtcm_1005(void);
 static void test_rtcm_1006(void);
 static void test_rtcm_1007(void);
 static void test_rtcm_1008(void);
+static void test_rtcm_1009(void);
 static void test_rtcm_1010(void);
+static void test_rtcm_1011(void);
 static void test_rtcm_1012(void);
+static void test_rtcm_1013(void);
 static void test_rtcm_1019(void);
 static void test_rtcm_1020(void);
 static void test_rtcm_1029(void);
 static void test_rtcm_1033(void);
 static void test_rtcm_1042(void);
+static void test_rtcm_1044(void);
 static void test_rtcm_1045(void);
 static void test_rtcm_1046(void);
 static void test_rtcm_1230(void);
+static void test_eph_store(void);
+static void test_orbit_cache(void);
 static void test_rtcm_msm4(void);
 static void test_rtcm_msm5(void);
 static void test_rtcm_msm5_glo(void);
 static void test_rtcm_msm7(void);
+static void test_rtcm_msm6_encode(void);
+static void test_rtcm_msm7_encode(void);
+static void test_msm_layout(void);
+static void test_msm_epoch_encode(void);
+static void test_epoch_assembler(void);
 static void test_rtcm_4062(void);
+static void test_decode_frame(void);
+static void test_peek_header(void);
+static void test_stats(void);
+static void test_decode_bounded(void);
+static void test_ssr_state(void);
+static void test_ssr_bias_sparse(void);
+static void test_msm_columns(void);
+static void test_obs_convert(void);
+static void test_msm_compact(void);
+static void test_decode_arena(void);
+static void test_msg_layout(void);
+static void test_msm_unpack(void);
 static void test_rtcm_random_bits(void);
 static void test_msm_bit_utils(void);
+static void test_bit_reader(void);
+static void test_bit_writer(void);
 static void test_lock_time_decoding(void);
 static void test_logging(void);
 
@@ -156,8 +181,9 @@ static const rtcm_msm_signal_data msm7_expected_sig_data[] = {
     {79.4953277, 79.49532458, 671.744, 0, 43.2, {31}, -706.011727},
     {79.49532796, 79.49532664, 671.744, 0, 49.8, {31}, -706.026592},
     {84.2867944, 84.28679183, 56.32, 0, 33.2, {31}, 442.470848},
-    {84.28613281, 0, 0, 0, 0, {9}, 0},
-    {84.28613281, 0, 0, 0, 0, {9}, 0},
+    /* DF405 holds the invalid value 0x80000 */
+    {84.28613281, 0, 0, 0, 0, {8}, 0},
+    {84.28613281, 0, 0, 0, 0, {8}, 0},
     {69.67794744, 69.6779482, 671.744, 0, 53.5, {31}, -540.548207},
     {69.67794817, 69.67794836, 671.744, 0, 45.2, {31}, -540.548207},
     {69.6779378, 69.67794838, 671.744, 0, 45.2, {31}, -540.5593074},
@@ -91,6 +91,64 @@ static void test_rf_status_only() {
    * produce one */
 }
 
+static void test_rf_status_sections() {
+  uint8_t buff[83];
+  memset(buff, 0, sizeof(buff));
+  uint16_t bit = 0;
+  rtcm_setbitu(buff, bit, 12, 999);
+  bit += 12;
+  rtcm_setbitu(buff, bit, 8, 24);
+  bit += 8;
+  rtcm_setbitu(buff, bit, 30, 345600000);
+  bit += 30;
+  rtcm_setbitu(buff, bit, 8, 0x1F);
+  bit += 8;
+  /* CW */
+  rtcm_setbitu(buff, bit, 4, 0x3);
+  bit += 4 + 8 + 32 + 8;
+  for (uint32_t i = 0; i < 8; i++) {
+    rtcm_setbitu(buff, bit, 32, 1000 + i);
+    bit += 32;
+  }
+  /* AGC */
+  rtcm_setbitu(buff, bit, 4, 0xF);
+  bit += 4 + 8;
+  for (uint32_t i = 0; i < 4; i++) {
+    rtcm_setbitu(buff, bit, 12, 2000 + i);
+    bit += 12;
+  }
+  /* IFM */
+  bit += 6;
+  rtcm_setbitu(buff, bit, 32, 0xDEADBEEF);
+  bit += 32;
+  /* noise floor */
+  for (uint32_t i = 0; i < 6; i++) {
+    rtcm_setbitu(buff, bit, 32, 3000 + i);
+    bit += 32;
+  }
+  /* antenna sense */
+  rtcm_setbitu(buff, bit, 8, 0xA5);
+  bit += 8;
+  assert(bit == 8 * sizeof(buff));
+
+  sta_rf_status rf_status;
+  assert(sta_decode_rfstatus(buff, &rf_status, bit) == RC_OK);
+  assert(rf_status.gnss_epoch_time == 345600000);
+  assert(rf_status.status_mask == 0x1F);
+  assert(rf_status.cw_detect_mask == 0x3);
+  assert(rf_status.cw_power_array[7] == 1007);
+  assert(rf_status.agc_mask == 0xF);
+  assert(rf_status.agc_array[3] == 2003);
+  assert(rf_status.ifm_constellation_mask == 0xDEADBEEF);
+  assert(rf_status.noise_floor_ddc_array[5] == 3005);
+  assert(rf_status.antenna_sense_power_switch == 1);
+  assert(rf_status.antenna_sense_status == 0x5);
+
+  /* truncated, or with trailing bits */
+  assert(sta_decode_rfstatus(buff, &rf_status, bit - 1) == RC_INVALID_MESSAGE);
+  assert(sta_decode_rfstatus(buff, &rf_status, bit + 1) == RC_INVALID_MESSAGE);
+}
+
 static void test_fw_version() {
   uint8_t* msg_buffer = fw_ver_array;
   /* files include RTCMv3 Framing for now */
@@ -110,4 +168,5 @@ int main(void) {
   test_fw_version();
   test_rf_status();
   test_rf_status_only();
+  test_rf_status_sections();
 }